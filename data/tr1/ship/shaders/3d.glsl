@@ -9,8 +9,11 @@ uniform mat4 matProjection;
 uniform mat4 matModelView;
 
 #ifdef OGL33C
+    layout(location = 3) in float inLayer;
+
     out vec4 vertColor;
     out vec3 vertTexCoords;
+    flat out float vertLayer;
 #else
     varying vec4 vertColor;
     varying vec3 vertTexCoords;
@@ -20,55 +23,98 @@ void main(void) {
     gl_Position = matProjection * matModelView * vec4(inPosition, 1);
     vertColor = inColor / 255.0;
     vertTexCoords = inTexCoords;
+#ifdef OGL33C
+    vertLayer = inLayer;
+#endif
 }
 
 #else
 // Fragment shader
 
-uniform sampler2D tex0;
-uniform bool texturingEnabled;
 uniform bool smoothingEnabled;
 uniform bool alphaPointDiscard;
 uniform float alphaThreshold;
 uniform float brightnessMultiplier;
 
 #ifdef OGL33C
+    // All texture pages live in a texture array, and each vertex tells the
+    // layer to sample from: -1 stands for no texture, -2 for the environment
+    // map.
+    uniform sampler2DArray texArray;
+    uniform sampler2D texEnvMap;
+
     #define OUTCOLOR outColor
-    #define TEXTURESIZE textureSize
-    #define TEXTURE texture
-    #define TEXELFETCH texelFetch
 
     in vec4 vertColor;
     in vec3 vertTexCoords;
+    flat in float vertLayer;
     out vec4 OUTCOLOR;
+
+    bool isTextured() {
+        return vertLayer >= 0.0 || vertLayer < -1.5;
+    }
+
+    ivec2 getTextureSize() {
+        return vertLayer >= 0.0 ? textureSize(texArray, 0).xy
+                                : textureSize(texEnvMap, 0);
+    }
+
+    vec4 fetchTexel(ivec2 pos) {
+        return vertLayer >= 0.0
+            ? texelFetch(texArray, ivec3(pos, int(vertLayer)), 0)
+            : texelFetch(texEnvMap, pos, 0);
+    }
+
+    vec4 sampleTexture(vec2 uv) {
+        return vertLayer >= 0.0 ? texture(texArray, vec3(uv, vertLayer))
+                                : texture(texEnvMap, uv);
+    }
 #else
+    uniform sampler2D tex0;
+    uniform bool texturingEnabled;
+
     #define OUTCOLOR gl_FragColor
-    #define TEXTURESIZE textureSize2D
-    #define TEXELFETCH texelFetch2D
-    #define TEXTURE texture2D
 
     varying vec4 vertColor;
     varying vec3 vertTexCoords;
+
+    bool isTextured() {
+        return texturingEnabled;
+    }
+
+    #if defined(GL_EXT_gpu_shader4)
+    ivec2 getTextureSize() {
+        return textureSize2D(tex0, 0);
+    }
+
+    vec4 fetchTexel(ivec2 pos) {
+        return texelFetch2D(tex0, pos, 0);
+    }
+    #endif
+
+    vec4 sampleTexture(vec2 uv) {
+        return texture2D(tex0, uv);
+    }
 #endif
 
 void main(void) {
     OUTCOLOR = vertColor;
 
-    if (texturingEnabled) {
+    if (isTextured()) {
 #if defined(GL_EXT_gpu_shader4) || defined(OGL33C)
         if (alphaPointDiscard && smoothingEnabled) {
             // do not use smoothing for chroma key
-            ivec2 size = TEXTURESIZE(tex0, 0);
+            ivec2 size = getTextureSize();
             int tx = int((vertTexCoords.x / vertTexCoords.z) * size.x) % size.x;
             int ty = int((vertTexCoords.y / vertTexCoords.z) * size.y) % size.y;
-            vec4 texel = TEXELFETCH(tex0, ivec2(tx, ty), 0);
+            vec4 texel = fetchTexel(ivec2(tx, ty));
             if (texel.a == 0.0) {
                 discard;
             }
         }
 #endif
 
-        vec4 texColor = TEXTURE(tex0, vertTexCoords.xy / vertTexCoords.z);
+        vec4 texColor = sampleTexture(vertTexCoords.xy / vertTexCoords.z);
         if (alphaThreshold >= 0.0 && texColor.a <= alphaThreshold) {
             discard;
         }
@@ -0,0 +1,152 @@
+// Static room geometry. The vertex stage mirrors the software room vertex
+// transform of the game, including the fog, the water shade and the wibble
+// effect. Only used with the OpenGL 3.3 backend.
+
+#define WIBBLE_SIZE 32
+#define W2V_SHIFT 14
+#define MAX_LIGHTING 8191
+#define NO_WIBBLE 1
+
+#ifdef VERTEX
+// Vertex shader
+
+// xyz = position within the room, w = vertex shade
+layout(location = 0) in vec4 inPosition;
+// x = texture, y = texture corner, z = flags, w = water shade phase
+layout(location = 1) in vec4 inTexture;
+
+uniform mat4 matProjection;
+uniform vec4 matRoom[3];
+uniform vec2 viewCenter;
+uniform float persp;
+uniform float nearZ;
+uniform float resZ;
+uniform float resZBuf;
+uniform int drawDistFade;
+uniform int drawDistMax;
+uniform bool clipFar;
+uniform bool waterEffect;
+uniform bool wibbleEffect;
+uniform int wibbleOffset;
+uniform int wibbleTable[WIBBLE_SIZE];
+uniform int shadeTable[WIBBLE_SIZE];
+uniform float brightness;
+uniform vec3 tint;
+uniform bool prettyPixels;
+
+// Each texture takes three texels: the four UV pairs, then the texture page
+// plus one, with zero standing for untextured faces.
+uniform usamplerBuffer texInfo;
+
+noperspective out vec4 vertColor;
+out vec3 vertTexCoords;
+flat out float vertLayer;
+
+int calcFogShade(int depth) {
+    if (depth < drawDistFade) {
+        return 0;
+    }
+    if (depth >= drawDistMax) {
+        return MAX_LIGHTING;
+    }
+    return (depth - drawDistFade) * MAX_LIGHTING / (drawDistMax - drawDistFade);
+}
+
+float getUV(uint uv) {
+    return prettyPixels ? float(uv) / 256.0
+                        : float((uv & 0xFF00u) + 127u) / 256.0;
+}
+
+void main(void) {
+    vec4 pos = vec4(inPosition.xyz, 1.0);
+    float xv = dot(matRoom[0], pos);
+    float yv = dot(matRoom[1], pos);
+    float zv = dot(matRoom[2], pos);
+
+    int shade = int(inPosition.w);
+    if (zv >= nearZ) {
+        int depth = int(zv / float(1 << W2V_SHIFT));
+        if (depth > drawDistMax) {
+            shade = MAX_LIGHTING;
+        } else if (depth != 0) {
+            shade += calcFogShade(depth);
+            if (!waterEffect) {
+                shade = min(shade, MAX_LIGHTING);
+            }
+        }
+
+        if (waterEffect) {
+            int phase = (wibbleOffset + int(inTexture.w)) % WIBBLE_SIZE;
+            shade = clamp(shade + shadeTable[phase], 0, MAX_LIGHTING);
+        }
+    }
+
+    // This is the perspective projection of the software path, multiplied
+    // through by the depth so that the hardware clips against the near plane
+    // and interpolates the texture coordinates.
+    vec2 screen = viewCenter * zv + vec2(xv, yv) * persp;
+    if (wibbleEffect && zv >= nearZ
+        && (int(inTexture.z) & NO_WIBBLE) == 0) {
+        vec2 xy = screen / zv;
+        xy.x += float(
+            wibbleTable[(wibbleOffset + int(xy.y)) & (WIBBLE_SIZE - 1)]);
+        xy.y += float(
+            wibbleTable[(wibbleOffset + int(xy.x)) & (WIBBLE_SIZE - 1)]);
+        screen = xy * zv;
+    }
+    gl_Position = matProjection * vec4(screen, resZBuf * zv - resZ, zv);
+
+    // Vertices beyond the draw distance only get dropped when there is no
+    // skybox to show behind them.
+    float farZ = float(drawDistMax + 1) * float(1 << W2V_SHIFT);
+    gl_ClipDistance[0] = clipFar ? farZ - zv : 1.0;
+
+    float light = (8192.0 - float(shade)) * brightness;
+    vertColor = vec4(vec3(light) * tint / 255.0, 1.0);
+
+    int texIndex = int(inTexture.x) * 3;
+    int corner = int(inTexture.y);
+    uvec4 uvs = texelFetch(texInfo, texIndex + corner / 2);
+    uvec2 uv = (corner & 1) == 0 ? uvs.xy : uvs.zw;
+    vertTexCoords = vec3(getUV(uv.x) / 256.0, getUV(uv.y) / 256.0, 1.0);
+    vertLayer = float(int(texelFetch(texInfo, texIndex + 2).x) - 1);
+}
+
+#else
+// Fragment shader
+
+uniform bool smoothingEnabled;
+uniform bool alphaPointDiscard;
+uniform float alphaThreshold;
+uniform float brightnessMultiplier;
+uniform sampler2DArray texArray;
+
+noperspective in vec4 vertColor;
+in vec3 vertTexCoords;
+flat in float vertLayer;
+out vec4 fragColor;
+
+void main(void) {
+    fragColor = vertColor;
+
+    if (vertLayer >= 0.0) {
+        if (alphaPointDiscard && smoothingEnabled) {
+            // do not use smoothing for chroma key
+            ivec2 size = textureSize(texArray, 0).xy;
+            int tx = int(vertTexCoords.x * size.x) % size.x;
+            int ty = int(vertTexCoords.y * size.y) % size.y;
+            vec4 texel = texelFetch(texArray, ivec3(tx, ty, int(vertLayer)), 0);
+            if (texel.a == 0.0) {
+                discard;
+            }
+        }
+
+        vec4 texColor = texture(texArray, vec3(vertTexCoords.xy, vertLayer));
+        if (alphaThreshold >= 0.0 && texColor.a <= alphaThreshold) {
+            discard;
+        }
+
+        fragColor = vec4(fragColor.rgb * texColor.rgb * brightnessMultiplier, texColor.a);
+    }
+}
+#endif // VERTEX
@@ -2,6 +2,7 @@
 
 #include "log.h"
 #include "memory.h"
+#include "profiler.h"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_error.h>
@@ -19,10 +20,14 @@ static void M_MixerCallback(void *userdata, Uint8 *stream_data, int32_t len);
 
 static void M_MixerCallback(void *userdata, Uint8 *stream_data, int32_t len)
 {
+    PROFILER_ZONE zone;
+    Profiler_BeginZone(&zone, "Audio mix");
+    Audio_Sample_ProcessCommands();
     memset(m_MixBuffer, m_Silence, len);
     Audio_Stream_Mix(m_MixBuffer, len);
     Audio_Sample_Mix(m_MixBuffer, len);
     memcpy(stream_data, m_MixBuffer, len);
+    Profiler_EndZone(&zone);
 }
 
 bool Audio_Init(void)
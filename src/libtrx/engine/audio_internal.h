@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/audio.h"
+#include "virtual_file.h"
 
 #include <SDL2/SDL.h>
 #include <libavformat/avformat.h>
@@ -19,6 +20,23 @@ int32_t Audio_GetSDLAudioFormat(enum AVSampleFormat sample_fmt);
 void Audio_Sample_Init(void);
 void Audio_Sample_Shutdown(void);
 void Audio_Sample_Mix(float *dst_buffer, size_t len);
+// Applies the sound changes queued by the game thread. Must only be called
+// from the mixer callback, or with the audio device locked.
+void Audio_Sample_ProcessCommands(void);
+
+// On-disk cache of decoded samples, keyed by a hash of the original data.
+// Entries hold mono float samples at the working rate.
+typedef struct {
+    VFILE *file;
+    const float *data;
+    int32_t num_samples;
+} AUDIO_SAMPLE_CACHE_ENTRY;
+
+void Audio_SampleCache_Init(void);
+uint64_t Audio_SampleCache_Hash(const char *data, size_t size);
+bool Audio_SampleCache_Load(uint64_t hash, AUDIO_SAMPLE_CACHE_ENTRY *entry);
+void Audio_SampleCache_Store(
+    uint64_t hash, const float *data, int32_t num_samples);
 
 void Audio_Stream_Init(void);
 void Audio_Stream_Shutdown(void);
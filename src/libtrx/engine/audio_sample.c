@@ -3,7 +3,9 @@
 #include "debug.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
+#include <SDL2/SDL_atomic.h>
 #include <SDL2/SDL_audio.h>
 #include <errno.h>
 #include <libavcodec/avcodec.h>
@@ -24,13 +26,25 @@
 #include <string.h>
 #include <time.h>
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+// Number of output frames the mixing kernel processes at a time.
+#define MIX_BLOCK_SIZE 4
+
 typedef struct {
     char *original_data;
     size_t original_size;
 
-    float *sample_data;
+    const float *sample_data;
     int32_t channels;
     int32_t num_samples;
+
+    // set if sample_data points into a mapped sample cache file
+    VFILE *cache_file;
 } AUDIO_SAMPLE;
 
 typedef struct {
@@ -44,12 +58,53 @@ typedef struct {
     int32_t volume; // volume specified in hundredths of decibel
     int32_t pan; // pan specified in hundredths of decibel
 
-    // pitch shift means the same samples can be reused twice, hence float
-    float current_sample;
+    // pitch shift means the same samples can be reused twice, so the read
+    // position has a fractional part
+    int32_t position;
+    float position_frac;
 
     AUDIO_SAMPLE *sample;
+    int32_t generation;
 } AUDIO_SAMPLE_SOUND;
 
+// Game thread view of a sound slot. The mixer publishes the generation of the
+// last sound it finished playing on its own, so that the game thread can tell
+// when the slot is free again.
+typedef struct {
+    bool is_used;
+    bool is_playing;
+    int32_t generation;
+    SDL_atomic_t finished_generation;
+} AUDIO_SAMPLE_SLOT;
+
+typedef enum {
+    AUDIO_SAMPLE_CMD_PLAY,
+    AUDIO_SAMPLE_CMD_CLOSE,
+    AUDIO_SAMPLE_CMD_PAUSE,
+    AUDIO_SAMPLE_CMD_UNPAUSE,
+    AUDIO_SAMPLE_CMD_SET_PAN,
+    AUDIO_SAMPLE_CMD_SET_VOLUME,
+    AUDIO_SAMPLE_CMD_SET_PITCH,
+} AUDIO_SAMPLE_COMMAND_TYPE;
+
+typedef struct {
+    AUDIO_SAMPLE_COMMAND_TYPE type;
+    int32_t sound_id;
+    union {
+        struct {
+            AUDIO_SAMPLE *sample;
+            int32_t generation;
+            int32_t volume;
+            float pitch;
+            int32_t pan;
+            bool is_looped;
+        } play;
+        int32_t pan;
+        int32_t volume;
+        float pitch;
+    };
+} AUDIO_SAMPLE_COMMAND;
+
 typedef struct {
     const char *data;
     const char *ptr;
@@ -60,11 +115,36 @@ typedef struct {
 static int32_t m_LoadedSamplesCount = 0;
 static AUDIO_SAMPLE m_LoadedSamples[AUDIO_MAX_SAMPLES] = {};
 static AUDIO_SAMPLE_SOUND m_Samples[AUDIO_MAX_ACTIVE_SAMPLES] = {};
+static AUDIO_SAMPLE_SLOT m_Slots[AUDIO_MAX_ACTIVE_SAMPLES] = {};
+static AUDIO_INTERPOLATION m_Interpolation = AUDIO_INTERP_LINEAR;
+
+// Single producer (game thread), single consumer (mixer callback) ring buffer
+// of pending sound changes, so that the game thread never needs to take the
+// audio device lock for them.
+#define COMMAND_QUEUE_SIZE 1024
+static AUDIO_SAMPLE_COMMAND m_Commands[COMMAND_QUEUE_SIZE] = {};
+static SDL_atomic_t m_CommandsHead = {};
+static SDL_atomic_t m_CommandsTail = {};
 
 static double M_DecibelToMultiplier(double db_gain);
 static bool M_RecalculateChannelVolumes(int32_t sound_id);
+static bool M_IsSlotFinished(const AUDIO_SAMPLE_SLOT *slot);
+static void M_PushCommand(const AUDIO_SAMPLE_COMMAND *command);
+static void M_ApplyCommand(const AUDIO_SAMPLE_COMMAND *command);
+static void M_FlushCommands(void);
+static float M_GetSampleAt(const AUDIO_SAMPLE *sample, int32_t idx, bool wrap);
+static float M_Interpolate(
+    AUDIO_INTERPOLATION interpolation, float p0, float p1, float p2, float p3,
+    float t);
+static void M_Advance(AUDIO_SAMPLE_SOUND *sound);
+static void M_MixBlock(AUDIO_SAMPLE_SOUND *sound, float *dst, int32_t frames);
+static void M_MixFrame(AUDIO_SAMPLE_SOUND *sound, float *dst);
+static bool M_MixSound(AUDIO_SAMPLE_SOUND *sound, float *dst, int32_t frames);
 static int32_t M_ReadAVBuffer(void *opaque, uint8_t *dst, int32_t dst_size);
 static int64_t M_SeekAVBuffer(void *opaque, int64_t offset, int32_t whence);
+static void M_FreeSampleData(AUDIO_SAMPLE *sample);
+static void M_ConvertS16ToFloat(float *dst, const int16_t *src, int32_t count);
+static bool M_ConvertPCM(AUDIO_SAMPLE *sample);
 static bool M_Convert(const int32_t sample_id);
 
 static double M_DecibelToMultiplier(double db_gain)
@@ -88,6 +168,303 @@ static bool M_RecalculateChannelVolumes(int32_t sound_id)
     return true;
 }
 
+static bool M_IsSlotFinished(const AUDIO_SAMPLE_SLOT *const slot)
+{
+    return SDL_AtomicGet((SDL_atomic_t *)&slot->finished_generation)
+        == slot->generation;
+}
+
+static void M_PushCommand(const AUDIO_SAMPLE_COMMAND *const command)
+{
+    const uint32_t head = SDL_AtomicGet(&m_CommandsHead);
+    const uint32_t tail = SDL_AtomicGet(&m_CommandsTail);
+    if (head - tail >= COMMAND_QUEUE_SIZE) {
+        // The mixer has fallen behind; drain the queue ourselves.
+        M_FlushCommands();
+    }
+
+    m_Commands[head % COMMAND_QUEUE_SIZE] = *command;
+    // SDL_AtomicSet is a full barrier, so the command is visible to the
+    // mixer before the new head is.
+    SDL_AtomicSet(&m_CommandsHead, head + 1);
+}
+
+static void M_ApplyCommand(const AUDIO_SAMPLE_COMMAND *const command)
+{
+    const int32_t sound_id = command->sound_id;
+    AUDIO_SAMPLE_SOUND *const sound = &m_Samples[sound_id];
+
+    switch (command->type) {
+    case AUDIO_SAMPLE_CMD_PLAY:
+        sound->is_used = true;
+        sound->is_playing = true;
+        sound->volume = command->play.volume;
+        sound->pitch = command->play.pitch;
+        sound->pan = command->play.pan;
+        sound->is_looped = command->play.is_looped;
+        sound->position = 0;
+        sound->position_frac = 0.0f;
+        sound->sample = command->play.sample;
+        sound->generation = command->play.generation;
+        M_RecalculateChannelVolumes(sound_id);
+        break;
+
+    case AUDIO_SAMPLE_CMD_CLOSE:
+        sound->is_used = false;
+        sound->is_playing = false;
+        break;
+
+    case AUDIO_SAMPLE_CMD_PAUSE:
+        sound->is_playing = false;
+        break;
+
+    case AUDIO_SAMPLE_CMD_UNPAUSE:
+        sound->is_playing = sound->is_used;
+        break;
+
+    case AUDIO_SAMPLE_CMD_SET_PAN:
+        sound->pan = command->pan;
+        M_RecalculateChannelVolumes(sound_id);
+        break;
+
+    case AUDIO_SAMPLE_CMD_SET_VOLUME:
+        sound->volume = command->volume;
+        M_RecalculateChannelVolumes(sound_id);
+        break;
+
+    case AUDIO_SAMPLE_CMD_SET_PITCH:
+        sound->pitch = command->pitch;
+        M_RecalculateChannelVolumes(sound_id);
+        break;
+    }
+}
+
+// Drains the command queue from the game thread. Holding the device lock
+// keeps the mixer callback, the regular consumer, out in the meantime.
+static void M_FlushCommands(void)
+{
+    SDL_LockAudioDevice(g_AudioDeviceID);
+    Audio_Sample_ProcessCommands();
+    SDL_UnlockAudioDevice(g_AudioDeviceID);
+}
+
+// Reads a sample frame, treating the data outside of the sample as either
+// the start of the next loop iteration or as the edge value.
+static float M_GetSampleAt(
+    const AUDIO_SAMPLE *const sample, int32_t idx, const bool wrap)
+{
+    const int32_t num_samples = sample->num_samples;
+    if (wrap) {
+        idx %= num_samples;
+        if (idx < 0) {
+            idx += num_samples;
+        }
+    } else {
+        CLAMP(idx, 0, num_samples - 1);
+    }
+    return sample->sample_data[idx];
+}
+
+static float M_Interpolate(
+    const AUDIO_INTERPOLATION interpolation, const float p0, const float p1,
+    const float p2, const float p3, const float t)
+{
+    switch (interpolation) {
+    case AUDIO_INTERP_NEAREST:
+        return p1;
+
+    case AUDIO_INTERP_CUBIC: {
+        // Catmull-Rom spline through p0..p3, evaluated between p1 and p2
+        const float c1 = 0.5f * (p2 - p0);
+        const float c2 = p0 - 2.5f * p1 + 2.0f * p2 - 0.5f * p3;
+        const float c3 = 0.5f * (p3 - p0) + 1.5f * (p1 - p2);
+        return ((c3 * t + c2) * t + c1) * t + p1;
+    }
+
+    case AUDIO_INTERP_LINEAR:
+    default:
+        return p1 + (p2 - p1) * t;
+    }
+}
+
+static void M_Advance(AUDIO_SAMPLE_SOUND *const sound)
+{
+    sound->position_frac += sound->pitch;
+    const int32_t step = (int32_t)sound->position_frac;
+    sound->position += step;
+    sound->position_frac -= step;
+}
+
+// Mixes frames whose whole interpolation window lies inside the sample, so
+// that no bounds checks are needed. The caller guarantees that.
+static void M_MixBlock(
+    AUDIO_SAMPLE_SOUND *const sound, float *dst, const int32_t frames)
+{
+    const float *const src = sound->sample->sample_data;
+    const AUDIO_INTERPOLATION interpolation = m_Interpolation;
+    const float volume_l = sound->volume_l;
+    const float volume_r = sound->volume_r;
+
+    int32_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    for (; i + MIX_BLOCK_SIZE <= frames; i += MIX_BLOCK_SIZE) {
+        float p0[MIX_BLOCK_SIZE];
+        float p1[MIX_BLOCK_SIZE];
+        float p2[MIX_BLOCK_SIZE];
+        float p3[MIX_BLOCK_SIZE];
+        float t[MIX_BLOCK_SIZE];
+        for (int32_t j = 0; j < MIX_BLOCK_SIZE; j++) {
+            const int32_t idx = sound->position;
+            p0[j] = src[idx - 1];
+            p1[j] = src[idx];
+            p2[j] = src[idx + 1];
+            p3[j] = src[idx + 2];
+            t[j] = sound->position_frac;
+            M_Advance(sound);
+        }
+
+    #if defined(__SSE2__)
+        const __m128 v1 = _mm_loadu_ps(p1);
+        const __m128 vt = _mm_loadu_ps(t);
+        __m128 out;
+        if (interpolation == AUDIO_INTERP_NEAREST) {
+            out = v1;
+        } else if (interpolation == AUDIO_INTERP_CUBIC) {
+            const __m128 v0 = _mm_loadu_ps(p0);
+            const __m128 v2 = _mm_loadu_ps(p2);
+            const __m128 v3 = _mm_loadu_ps(p3);
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(v2, v0));
+            const __m128 c2 = _mm_sub_ps(
+                _mm_add_ps(
+                    _mm_sub_ps(v0, _mm_mul_ps(_mm_set1_ps(2.5f), v1)),
+                    _mm_mul_ps(_mm_set1_ps(2.0f), v2)),
+                _mm_mul_ps(half, v3));
+            const __m128 c3 = _mm_add_ps(
+                _mm_mul_ps(half, _mm_sub_ps(v3, v0)),
+                _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(v1, v2)));
+            out = _mm_add_ps(_mm_mul_ps(c3, vt), c2);
+            out = _mm_add_ps(_mm_mul_ps(out, vt), c1);
+            out = _mm_add_ps(_mm_mul_ps(out, vt), v1);
+        } else {
+            const __m128 v2 = _mm_loadu_ps(p2);
+            out = _mm_add_ps(v1, _mm_mul_ps(_mm_sub_ps(v2, v1), vt));
+        }
+
+        const __m128 left = _mm_mul_ps(out, _mm_set1_ps(volume_l));
+        const __m128 right = _mm_mul_ps(out, _mm_set1_ps(volume_r));
+        _mm_storeu_ps(
+            dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_unpacklo_ps(left, right)));
+        _mm_storeu_ps(
+            dst + 4,
+            _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_unpackhi_ps(left, right)));
+    #else
+        const float32x4_t v1 = vld1q_f32(p1);
+        const float32x4_t vt = vld1q_f32(t);
+        float32x4_t out;
+        if (interpolation == AUDIO_INTERP_NEAREST) {
+            out = v1;
+        } else if (interpolation == AUDIO_INTERP_CUBIC) {
+            const float32x4_t v0 = vld1q_f32(p0);
+            const float32x4_t v2 = vld1q_f32(p2);
+            const float32x4_t v3 = vld1q_f32(p3);
+            const float32x4_t c1 = vmulq_n_f32(vsubq_f32(v2, v0), 0.5f);
+            const float32x4_t c2 = vsubq_f32(
+                vaddq_f32(
+                    vsubq_f32(v0, vmulq_n_f32(v1, 2.5f)),
+                    vmulq_n_f32(v2, 2.0f)),
+                vmulq_n_f32(v3, 0.5f));
+            const float32x4_t c3 = vaddq_f32(
+                vmulq_n_f32(vsubq_f32(v3, v0), 0.5f),
+                vmulq_n_f32(vsubq_f32(v1, v2), 1.5f));
+            out = vmlaq_f32(c2, c3, vt);
+            out = vmlaq_f32(c1, out, vt);
+            out = vmlaq_f32(v1, out, vt);
+        } else {
+            const float32x4_t v2 = vld1q_f32(p2);
+            out = vmlaq_f32(v1, vsubq_f32(v2, v1), vt);
+        }
+
+        float32x4x2_t mixed = vld2q_f32(dst);
+        mixed.val[0] = vmlaq_n_f32(mixed.val[0], out, volume_l);
+        mixed.val[1] = vmlaq_n_f32(mixed.val[1], out, volume_r);
+        vst2q_f32(dst, mixed);
+    #endif
+
+        dst += MIX_BLOCK_SIZE * AUDIO_WORKING_CHANNELS;
+    }
+#endif
+
+    for (; i < frames; i++) {
+        const int32_t idx = sound->position;
+        const float value = M_Interpolate(
+            interpolation, src[idx - 1], src[idx], src[idx + 1], src[idx + 2],
+            sound->position_frac);
+        *dst++ += value * volume_l;
+        *dst++ += value * volume_r;
+        M_Advance(sound);
+    }
+}
+
+// Mixes a single frame close to the sample edges, where the interpolation
+// window needs to be wrapped around or clamped.
+static void M_MixFrame(AUDIO_SAMPLE_SOUND *const sound, float *const dst)
+{
+    const AUDIO_SAMPLE *const sample = sound->sample;
+    const int32_t idx = sound->position;
+    const bool wrap = sound->is_looped;
+    const float value = M_Interpolate(
+        m_Interpolation, M_GetSampleAt(sample, idx - 1, wrap),
+        M_GetSampleAt(sample, idx, wrap), M_GetSampleAt(sample, idx + 1, wrap),
+        M_GetSampleAt(sample, idx + 2, wrap), sound->position_frac);
+    dst[0] += value * sound->volume_l;
+    dst[1] += value * sound->volume_r;
+    M_Advance(sound);
+}
+
+// Returns false once a sound that does not loop has played out.
+static bool M_MixSound(
+    AUDIO_SAMPLE_SOUND *const sound, float *dst, int32_t frames)
+{
+    const int32_t num_samples = sound->sample->num_samples;
+    if (num_samples <= 0) {
+        return false;
+    }
+
+    while (frames > 0) {
+        if (sound->position >= num_samples) {
+            if (!sound->is_looped) {
+                return false;
+            }
+            sound->position %= num_samples;
+        }
+
+        // Count how many frames can be mixed before the interpolation window
+        // reaches past the end of the sample. The position advances in single
+        // precision, so keep one step of margin against rounding drift.
+        int32_t safe_frames = 0;
+        const double span = (double)(num_samples - 3 - sound->position)
+            - sound->position_frac;
+        if (sound->position >= 1 && span >= 0.0) {
+            safe_frames = sound->pitch > 0.0f
+                ? MIN(frames, (int32_t)(span / sound->pitch))
+                : frames;
+        }
+
+        if (safe_frames > 0) {
+            M_MixBlock(sound, dst, safe_frames);
+            dst += safe_frames * AUDIO_WORKING_CHANNELS;
+            frames -= safe_frames;
+        } else {
+            M_MixFrame(sound, dst);
+            dst += AUDIO_WORKING_CHANNELS;
+            frames--;
+        }
+    }
+
+    return sound->is_looped || sound->position < num_samples;
+}
+
 static int32_t M_ReadAVBuffer(void *opaque, uint8_t *dst, int32_t dst_size)
 {
     ASSERT(opaque != NULL);
@@ -136,6 +513,152 @@ static int64_t M_SeekAVBuffer(void *opaque, int64_t offset, int32_t whence)
     return src->ptr - src->data;
 }
 
+static void M_FreeSampleData(AUDIO_SAMPLE *const sample)
+{
+    if (sample->cache_file != NULL) {
+        VFile_Close(sample->cache_file);
+        sample->cache_file = NULL;
+        sample->sample_data = NULL;
+    } else {
+        Memory_FreePointer(&sample->sample_data);
+    }
+}
+
+static void M_ConvertS16ToFloat(
+    float *const dst, const int16_t *const src, const int32_t count)
+{
+    const float scale = 1.0f / 32768.0f;
+    int32_t i = 0;
+#if defined(__SSE2__)
+    const __m128 scale_v = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i in = _mm_loadu_si128((const __m128i *)&src[i]);
+        // sign-extend the 16-bit lanes to 32 bits
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale_v));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale_v));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+// Fast path for plain PCM WAV files, which is what the vast majority of the
+// game samples are. Bypasses libav entirely; the sample is downmixed to mono
+// and upsampled to the working rate with linear interpolation. Returns false
+// for anything it does not handle, leaving the sample to M_Convert's libav
+// path.
+static bool M_ConvertPCM(AUDIO_SAMPLE *const sample)
+{
+    const uint8_t *const data = (const uint8_t *)sample->original_data;
+    const size_t size = sample->original_size;
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0
+        || memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    int32_t format = 0;
+    int32_t channels = 0;
+    int32_t sample_rate = 0;
+    int32_t bits_per_sample = 0;
+    const uint8_t *pcm_data = NULL;
+    uint32_t pcm_size = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t *const chunk = data + pos;
+        uint32_t chunk_size;
+        memcpy(&chunk_size, chunk + 4, sizeof(uint32_t));
+        if (chunk_size > size - pos - 8) {
+            chunk_size = size - pos - 8;
+        }
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+            uint16_t u16;
+            uint32_t u32;
+            memcpy(&u16, chunk + 8, sizeof(uint16_t));
+            format = u16;
+            memcpy(&u16, chunk + 10, sizeof(uint16_t));
+            channels = u16;
+            memcpy(&u32, chunk + 12, sizeof(uint32_t));
+            sample_rate = u32;
+            memcpy(&u16, chunk + 22, sizeof(uint16_t));
+            bits_per_sample = u16;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            pcm_data = chunk + 8;
+            pcm_size = chunk_size;
+            break;
+        }
+
+        pos += 8 + ((chunk_size + 1) & ~1);
+    }
+
+    if (pcm_data == NULL || format != 1 || channels < 1 || channels > 2
+        || (bits_per_sample != 8 && bits_per_sample != 16) || sample_rate <= 0
+        || AUDIO_WORKING_RATE % sample_rate != 0) {
+        return false;
+    }
+
+    const int32_t frame_size = channels * bits_per_sample / 8;
+    const int32_t num_frames = pcm_size / frame_size;
+    if (num_frames == 0) {
+        return false;
+    }
+
+    // Convert to mono float at the source rate.
+    float *const mono = Memory_Alloc(sizeof(float) * num_frames);
+    if (bits_per_sample == 16) {
+        if (channels == 1) {
+            M_ConvertS16ToFloat(mono, (const int16_t *)pcm_data, num_frames);
+        } else {
+            float *const stereo =
+                Memory_Alloc(sizeof(float) * num_frames * channels);
+            M_ConvertS16ToFloat(
+                stereo, (const int16_t *)pcm_data, num_frames * channels);
+            for (int32_t i = 0; i < num_frames; i++) {
+                mono[i] = (stereo[i * 2] + stereo[i * 2 + 1]) * 0.5f;
+            }
+            Memory_FreePointer(&stereo);
+        }
+    } else {
+        for (int32_t i = 0; i < num_frames; i++) {
+            float value = 0.0f;
+            for (int32_t j = 0; j < channels; j++) {
+                value += (pcm_data[i * channels + j] - 128) / 128.0f;
+            }
+            mono[i] = value / channels;
+        }
+    }
+
+    // Upsample by an integer factor.
+    const int32_t ratio = AUDIO_WORKING_RATE / sample_rate;
+    const int32_t num_samples = num_frames * ratio;
+    float *output;
+    if (ratio == 1) {
+        output = mono;
+    } else {
+        output = Memory_Alloc(sizeof(float) * num_samples);
+        const float step = 1.0f / ratio;
+        for (int32_t i = 0; i < num_frames; i++) {
+            const float a = mono[i];
+            const float b = i + 1 < num_frames ? mono[i + 1] : a;
+            const float delta = (b - a) * step;
+            float *const dst = &output[i * ratio];
+            for (int32_t k = 0; k < ratio; k++) {
+                dst[k] = a + delta * k;
+            }
+        }
+        Memory_FreePointer(&mono);
+    }
+
+    sample->sample_data = output;
+    sample->num_samples = num_samples;
+    sample->channels = 1;
+    return true;
+}
+
 static bool M_Convert(const int32_t sample_id)
 {
     ASSERT(sample_id >= 0 && sample_id < m_LoadedSamplesCount);
@@ -147,6 +670,21 @@ static bool M_Convert(const int32_t sample_id)
         return true;
     }
 
+    if (M_ConvertPCM(sample)) {
+        return true;
+    }
+
+    const uint64_t hash =
+        Audio_SampleCache_Hash(sample->original_data, sample->original_size);
+    AUDIO_SAMPLE_CACHE_ENTRY cache_entry;
+    if (Audio_SampleCache_Load(hash, &cache_entry)) {
+        sample->cache_file = cache_entry.file;
+        sample->sample_data = cache_entry.data;
+        sample->num_samples = cache_entry.num_samples;
+        sample->channels = 1;
+        return true;
+    }
+
     const clock_t time_start = clock();
     size_t working_buffer_size = 0;
     float *working_buffer = NULL;
@@ -354,10 +892,12 @@ static bool M_Convert(const int32_t sample_id)
     int32_t sample_format_bytes = av_get_bytes_per_sample(swr.dst_format);
     sample->num_samples =
         working_buffer_size / sample_format_bytes / swr.dst_channels;
-    sample->channels = swr.src_channels;
+    sample->channels = swr.dst_channels;
     sample->sample_data = working_buffer;
     result = true;
 
+    Audio_SampleCache_Store(hash, working_buffer, sample->num_samples);
+
     const clock_t time_end = clock();
     const double time_delta =
         (((double)(time_end - time_start)) / CLOCKS_PER_SEC) * 1000.0f;
@@ -414,6 +954,8 @@ cleanup:
 
 void Audio_Sample_Init(void)
 {
+    Audio_SampleCache_Init();
+
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
         AUDIO_SAMPLE_SOUND *sound = &m_Samples[sound_id];
@@ -422,9 +964,20 @@ void Audio_Sample_Init(void)
         sound->volume = 0.0f;
         sound->pitch = 1.0f;
         sound->pan = 0.0f;
-        sound->current_sample = 0.0f;
+        sound->position = 0;
+        sound->position_frac = 0.0f;
         sound->sample = NULL;
+        sound->generation = 0;
+
+        AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+        slot->is_used = false;
+        slot->is_playing = false;
+        slot->generation = 0;
+        SDL_AtomicSet(&slot->finished_generation, 0);
     }
+
+    SDL_AtomicSet(&m_CommandsHead, 0);
+    SDL_AtomicSet(&m_CommandsTail, 0);
 }
 
 void Audio_Sample_Shutdown(void)
@@ -437,6 +990,17 @@ void Audio_Sample_Shutdown(void)
     Audio_Sample_UnloadAll();
 }
 
+void Audio_Sample_ProcessCommands(void)
+{
+    const uint32_t head = SDL_AtomicGet(&m_CommandsHead);
+    uint32_t tail = SDL_AtomicGet(&m_CommandsTail);
+    while (tail != head) {
+        M_ApplyCommand(&m_Commands[tail % COMMAND_QUEUE_SIZE]);
+        tail++;
+    }
+    SDL_AtomicSet(&m_CommandsTail, tail);
+}
+
 bool Audio_Sample_Unload(const int32_t sample_id)
 {
     if (!g_AudioDeviceID) {
@@ -455,7 +1019,11 @@ bool Audio_Sample_Unload(const int32_t sample_id)
         LOG_ERROR("Sample %d is already unloaded", sample_id);
         return false;
     }
-    Memory_FreePointer(&sample->sample_data);
+
+    // Make sure the mixer has seen any pending close commands before the
+    // sample data goes away.
+    M_FlushCommands();
+    M_FreeSampleData(sample);
     Memory_FreePointer(&sample->original_data);
     m_LoadedSamplesCount--;
     return true;
@@ -468,10 +1036,11 @@ bool Audio_Sample_UnloadAll(void)
         return false;
     }
 
+    M_FlushCommands();
     m_LoadedSamplesCount = 0;
     for (int32_t i = 0; i < AUDIO_MAX_SAMPLES; i++) {
         AUDIO_SAMPLE *const sample = &m_LoadedSamples[i];
-        Memory_FreePointer(&sample->sample_data);
+        M_FreeSampleData(sample);
         Memory_FreePointer(&sample->original_data);
     }
     return true;
@@ -507,6 +1076,20 @@ bool Audio_Sample_LoadSingle(
     return true;
 }
 
+bool Audio_Sample_Decode(const int32_t sample_id)
+{
+    if (!g_AudioDeviceID) {
+        return false;
+    }
+
+    if (sample_id < 0 || sample_id >= m_LoadedSamplesCount) {
+        LOG_DEBUG("Invalid sample id: %d", sample_id);
+        return false;
+    }
+
+    return M_Convert(sample_id);
+}
+
 bool Audio_Sample_LoadMany(size_t count, const char **contents, size_t *sizes)
 {
     ASSERT(contents != NULL);
@@ -546,31 +1129,41 @@ int32_t Audio_Sample_Play(
 
     int32_t result = AUDIO_NO_SOUND;
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
-        AUDIO_SAMPLE_SOUND *sound = &m_Samples[sound_id];
-        if (sound->is_used) {
+        AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+        if (slot->is_used && !M_IsSlotFinished(slot)) {
             continue;
         }
 
-        M_Convert(sample_id);
-
-        sound->is_used = true;
-        sound->is_playing = true;
-        sound->volume = volume;
-        sound->pitch = pitch;
-        sound->pan = pan;
-        sound->is_looped = is_looped;
-        sound->current_sample = 0.0f;
-        sound->sample = &m_LoadedSamples[sample_id];
+        // The mixer never touches a sample before it receives the play
+        // command, so it is safe to decode it without holding any lock.
+        if (!M_Convert(sample_id)) {
+            LOG_ERROR("Failed to convert sample %d", sample_id);
+            return AUDIO_NO_SOUND;
+        }
 
-        M_RecalculateChannelVolumes(sound_id);
+        slot->is_used = true;
+        slot->is_playing = true;
+        slot->generation++;
+
+        const AUDIO_SAMPLE_COMMAND command = {
+            .type = AUDIO_SAMPLE_CMD_PLAY,
+            .sound_id = sound_id,
+            .play = {
+                .sample = &m_LoadedSamples[sample_id],
+                .generation = slot->generation,
+                .volume = volume,
+                .pitch = pitch,
+                .pan = pan,
+                .is_looped = is_looped,
+            },
+        };
+        M_PushCommand(&command);
 
         result = sound_id;
         break;
     }
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
 
     if (result == AUDIO_NO_SOUND) {
         LOG_ERROR("All sample buffers are used!");
@@ -586,19 +1179,24 @@ bool Audio_Sample_IsPlaying(int32_t sound_id)
         return false;
     }
 
-    return m_Samples[sound_id].is_playing;
+    const AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+    return slot->is_playing && !M_IsSlotFinished(slot);
 }
 
 bool Audio_Sample_Pause(int32_t sound_id)
 {
-    if (!g_AudioDeviceID) {
+    if (!g_AudioDeviceID || sound_id < 0
+        || sound_id >= AUDIO_MAX_ACTIVE_SAMPLES) {
         return false;
     }
 
-    if (m_Samples[sound_id].is_playing) {
-        SDL_LockAudioDevice(g_AudioDeviceID);
-        m_Samples[sound_id].is_playing = false;
-        SDL_UnlockAudioDevice(g_AudioDeviceID);
+    AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+    if (slot->is_playing) {
+        slot->is_playing = false;
+        M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+            .type = AUDIO_SAMPLE_CMD_PAUSE,
+            .sound_id = sound_id,
+        });
     }
 
     return true;
@@ -612,7 +1210,7 @@ bool Audio_Sample_PauseAll(void)
 
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
-        if (m_Samples[sound_id].is_used) {
+        if (m_Slots[sound_id].is_used) {
             Audio_Sample_Pause(sound_id);
         }
     }
@@ -622,14 +1220,18 @@ bool Audio_Sample_PauseAll(void)
 
 bool Audio_Sample_Unpause(int32_t sound_id)
 {
-    if (!g_AudioDeviceID) {
+    if (!g_AudioDeviceID || sound_id < 0
+        || sound_id >= AUDIO_MAX_ACTIVE_SAMPLES) {
         return false;
     }
 
-    if (!m_Samples[sound_id].is_playing) {
-        SDL_LockAudioDevice(g_AudioDeviceID);
-        m_Samples[sound_id].is_playing = true;
-        SDL_UnlockAudioDevice(g_AudioDeviceID);
+    AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+    if (!slot->is_playing) {
+        slot->is_playing = true;
+        M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+            .type = AUDIO_SAMPLE_CMD_UNPAUSE,
+            .sound_id = sound_id,
+        });
     }
 
     return true;
@@ -643,7 +1245,7 @@ bool Audio_Sample_UnpauseAll(void)
 
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
-        if (m_Samples[sound_id].is_used) {
+        if (m_Slots[sound_id].is_used) {
             Audio_Sample_Unpause(sound_id);
         }
     }
@@ -658,10 +1260,13 @@ bool Audio_Sample_Close(int32_t sound_id)
         return false;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
-    m_Samples[sound_id].is_used = false;
-    m_Samples[sound_id].is_playing = false;
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
+    AUDIO_SAMPLE_SLOT *const slot = &m_Slots[sound_id];
+    slot->is_used = false;
+    slot->is_playing = false;
+    M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+        .type = AUDIO_SAMPLE_CMD_CLOSE,
+        .sound_id = sound_id,
+    });
 
     return true;
 }
@@ -674,7 +1279,7 @@ bool Audio_Sample_CloseAll(void)
 
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
-        if (m_Samples[sound_id].is_used) {
+        if (m_Slots[sound_id].is_used) {
             Audio_Sample_Close(sound_id);
         }
     }
@@ -689,10 +1294,11 @@ bool Audio_Sample_SetPan(int32_t sound_id, int32_t pan)
         return false;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
-    m_Samples[sound_id].pan = pan;
-    M_RecalculateChannelVolumes(sound_id);
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
+    M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+        .type = AUDIO_SAMPLE_CMD_SET_PAN,
+        .sound_id = sound_id,
+        .pan = pan,
+    });
 
     return true;
 }
@@ -704,10 +1310,11 @@ bool Audio_Sample_SetVolume(int32_t sound_id, int32_t volume)
         return false;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
-    m_Samples[sound_id].volume = volume;
-    M_RecalculateChannelVolumes(sound_id);
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
+    M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+        .type = AUDIO_SAMPLE_CMD_SET_VOLUME,
+        .sound_id = sound_id,
+        .volume = volume,
+    });
 
     return true;
 }
@@ -719,16 +1326,25 @@ bool Audio_Sample_SetPitch(int32_t sound_id, float pitch)
         return false;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
-    m_Samples[sound_id].pitch = pitch;
-    M_RecalculateChannelVolumes(sound_id);
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
+    M_PushCommand(&(AUDIO_SAMPLE_COMMAND) {
+        .type = AUDIO_SAMPLE_CMD_SET_PITCH,
+        .sound_id = sound_id,
+        .pitch = pitch,
+    });
 
     return true;
 }
 
+void Audio_Sample_SetInterpolation(const AUDIO_INTERPOLATION interpolation)
+{
+    m_Interpolation = interpolation;
+}
+
 void Audio_Sample_Mix(float *dst_buffer, size_t len)
 {
+    const int32_t frames =
+        len / sizeof(AUDIO_WORKING_FORMAT) / AUDIO_WORKING_CHANNELS;
+
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_SAMPLES;
          sound_id++) {
         AUDIO_SAMPLE_SOUND *sound = &m_Samples[sound_id];
@@ -736,40 +1352,15 @@ void Audio_Sample_Mix(float *dst_buffer, size_t len)
             continue;
         }
 
-        int32_t samples_requested =
-            len / sizeof(AUDIO_WORKING_FORMAT) / AUDIO_WORKING_CHANNELS;
-        float src_sample_idx = sound->current_sample;
-        const float *src_buffer = sound->sample->sample_data;
-        float *dst_ptr = dst_buffer;
-
-        while ((dst_ptr - dst_buffer) / AUDIO_WORKING_CHANNELS
-               < samples_requested) {
-
-            // because we handle 3d sound ourselves, downmix to mono
-            float src_sample = 0.0f;
-            for (int32_t i = 0; i < sound->sample->channels; i++) {
-                src_sample += src_buffer
-                    [(int32_t)src_sample_idx * sound->sample->channels + i];
-            }
-            src_sample /= (float)sound->sample->channels;
-
-            *dst_ptr++ += src_sample * sound->volume_l;
-            *dst_ptr++ += src_sample * sound->volume_r;
-            src_sample_idx += sound->pitch;
-
-            if ((int32_t)src_sample_idx >= sound->sample->num_samples) {
-                if (sound->is_looped) {
-                    src_sample_idx = 0.0f;
-                } else {
-                    break;
-                }
-            }
-        }
+        // Samples are always downmixed to mono when they are decoded, since
+        // we handle 3d sound ourselves.
+        ASSERT(sound->sample->channels == 1);
 
-        sound->current_sample = src_sample_idx;
-        if (sound->current_sample >= sound->sample->num_samples
-            && !sound->is_looped) {
-            Audio_Sample_Close(sound_id);
+        if (!M_MixSound(sound, dst_buffer, frames)) {
+            sound->is_used = false;
+            sound->is_playing = false;
+            SDL_AtomicSet(
+                &m_Slots[sound_id].finished_generation, sound->generation);
         }
     }
 }
@@ -0,0 +1,201 @@
+#include "audio_internal.h"
+
+#include "filesystem.h"
+#include "log.h"
+#include "memory.h"
+#include "strings.h"
+#include "virtual_file.h"
+
+#include <SDL2/SDL_atomic.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_DIR "cache"
+#define CACHE_PREFIX CACHE_DIR "/sample_"
+#define CACHE_MAGIC "TRXS"
+#define CACHE_VERSION 1
+#define CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+// The header is 32 bytes long so that the sample data that follows it stays
+// suitably aligned for floats within the mapped file.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t num_samples;
+    uint32_t reserved;
+} CACHE_HEADER;
+
+static SDL_atomic_t m_TempCounter = {};
+
+static char *M_GetPath(uint64_t hash);
+static char *M_GetTempPath(uint64_t hash);
+static bool M_IsCurrentVersion(const char *path);
+static int M_CompareAge(const void *a, const void *b);
+static void M_Prune(void);
+
+static char *M_GetPath(const uint64_t hash)
+{
+    char path[64];
+    snprintf(path, sizeof(path), CACHE_PREFIX "%016" PRIx64 ".bin", hash);
+    return Memory_DupStr(path);
+}
+
+static char *M_GetTempPath(const uint64_t hash)
+{
+    // Decode jobs run in parallel, so every store gets its own file.
+    char path[80];
+    snprintf(
+        path, sizeof(path), CACHE_PREFIX "%016" PRIx64 "_%d.tmp", hash,
+        SDL_AtomicAdd(&m_TempCounter, 1));
+    return Memory_DupStr(path);
+}
+
+static bool M_IsCurrentVersion(const char *const path)
+{
+    MYFILE *const fp = File_Open(path, FILE_OPEN_READ);
+    if (fp == NULL) {
+        return false;
+    }
+    CACHE_HEADER header = {};
+    File_ReadData(fp, &header, sizeof(CACHE_HEADER));
+    File_Close(fp);
+    return memcmp(header.magic, CACHE_MAGIC, 4) == 0
+        && header.version == CACHE_VERSION;
+}
+
+static int M_CompareAge(const void *const a, const void *const b)
+{
+    const int64_t age_a = ((const FILE_INFO *)a)->modified;
+    const int64_t age_b = ((const FILE_INFO *)b)->modified;
+    return (age_a > age_b) - (age_a < age_b);
+}
+
+static void M_Prune(void)
+{
+    FILE_INFO *files;
+    const int32_t count = File_ListDirectory(CACHE_DIR, &files);
+
+    // Drop leftovers of interrupted stores and entries written by other
+    // versions, then the oldest entries until the cache fits in its budget.
+    size_t total_size = 0;
+    for (int32_t i = 0; i < count; i++) {
+        FILE_INFO *const file = &files[i];
+        if (strncmp(file->path, CACHE_PREFIX, strlen(CACHE_PREFIX)) != 0) {
+            file->size = 0;
+            continue;
+        }
+        if (!String_EndsWith(file->path, ".bin")
+            || !M_IsCurrentVersion(file->path)) {
+            File_Delete(file->path);
+            file->size = 0;
+            continue;
+        }
+        total_size += file->size;
+    }
+
+    if (total_size > CACHE_MAX_SIZE) {
+        qsort(files, count, sizeof(FILE_INFO), M_CompareAge);
+        for (int32_t i = 0; i < count && total_size > CACHE_MAX_SIZE; i++) {
+            if (files[i].size != 0 && File_Delete(files[i].path)) {
+                total_size -= files[i].size;
+            }
+        }
+    }
+
+    File_FreeList(files, count);
+}
+
+void Audio_SampleCache_Init(void)
+{
+    File_CreateDirectory(CACHE_DIR);
+    M_Prune();
+}
+
+uint64_t Audio_SampleCache_Hash(const char *const data, const size_t size)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    const uint8_t *const bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+bool Audio_SampleCache_Load(
+    const uint64_t hash, AUDIO_SAMPLE_CACHE_ENTRY *const entry)
+{
+    char *path = M_GetPath(hash);
+    VFILE *file = NULL;
+    if (File_Exists(path)) {
+        file = VFile_CreateFromPath(path);
+    }
+    Memory_FreePointer(&path);
+    if (file == NULL) {
+        return false;
+    }
+
+    if (file->size < sizeof(CACHE_HEADER)) {
+        goto fail;
+    }
+
+    CACHE_HEADER header;
+    VFile_Read(file, &header, sizeof(CACHE_HEADER));
+    if (memcmp(header.magic, CACHE_MAGIC, 4) != 0
+        || header.version != CACHE_VERSION || header.hash != hash
+        || header.sample_rate != AUDIO_WORKING_RATE || header.channels != 1
+        || file->size
+            != sizeof(CACHE_HEADER) + header.num_samples * sizeof(float)) {
+        LOG_WARNING("Ignoring stale sample cache entry %016" PRIx64, hash);
+        goto fail;
+    }
+
+    entry->file = file;
+    entry->num_samples = header.num_samples;
+    entry->data = VFile_View(file, header.num_samples * sizeof(float));
+    return true;
+
+fail:
+    VFile_Close(file);
+    return false;
+}
+
+void Audio_SampleCache_Store(
+    const uint64_t hash, const float *const data, const int32_t num_samples)
+{
+    // Write the entry under a unique name and move it into place once it is
+    // complete, so that nobody can see a partially written file.
+    char *temp_path = M_GetTempPath(hash);
+    MYFILE *const fp = File_Open(temp_path, FILE_OPEN_WRITE);
+    if (fp == NULL) {
+        LOG_WARNING("Can't write sample cache file %s", temp_path);
+        Memory_FreePointer(&temp_path);
+        return;
+    }
+
+    CACHE_HEADER header = {
+        .version = CACHE_VERSION,
+        .hash = hash,
+        .sample_rate = AUDIO_WORKING_RATE,
+        .channels = 1,
+        .num_samples = num_samples,
+    };
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    File_WriteData(fp, &header, sizeof(CACHE_HEADER));
+    File_WriteData(fp, data, num_samples * sizeof(float));
+    File_Close(fp);
+
+    char *path = M_GetPath(hash);
+    if (!File_Rename(temp_path, path)) {
+        // Most likely another job stored the same sample first.
+        File_Delete(temp_path);
+    }
+    Memory_FreePointer(&path);
+    Memory_FreePointer(&temp_path);
+}
@@ -4,9 +4,13 @@
 #include "filesystem.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
+#include <SDL2/SDL_atomic.h>
 #include <SDL2/SDL_audio.h>
 #include <SDL2/SDL_error.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
 #include <errno.h>
 #include <libavcodec/avcodec.h>
 #include <libavcodec/codec.h>
@@ -25,14 +29,21 @@
 #include <stdio.h>
 #include <string.h>
 
-#define READ_BUFFER_SIZE                                                       \
-    (AUDIO_SAMPLES * AUDIO_WORKING_CHANNELS * sizeof(AUDIO_WORKING_FORMAT))
+// Size of the PCM ring between a stream's decoder thread and the mixer, in
+// floats. Must be a power of two; 1 << 16 is roughly 0.75 s of stereo audio.
+#define RING_SIZE (1 << 16)
+#define RING_MASK (RING_SIZE - 1)
+// How much audio to decode up front, before the decoder thread takes over.
+#define PREFILL_SIZE (AUDIO_SAMPLES * AUDIO_WORKING_CHANNELS * 4)
+// The decoder thread is woken up by the mixer, but also polls on its own in
+// case the mixer is paused.
+#define DECODER_WAIT_MS 50
 
 typedef struct {
     bool is_used;
     bool is_playing;
-    bool is_read_done;
     bool is_looped;
+    bool is_closing;
     float volume;
     double duration;
     double timestamp;
@@ -62,23 +73,47 @@ typedef struct {
         SwrContext *ctx;
     } swr;
 
+    // The decoder thread owns the libav state and the pending buffer; the
+    // game thread only touches them with the mutex held. Streams are only
+    // ever opened and torn down on the game thread.
     struct {
-        SDL_AudioStream *stream;
-    } sdl;
+        SDL_Thread *thread;
+        SDL_mutex *mutex;
+        SDL_sem *wake;
+        SDL_atomic_t stop;
+        SDL_atomic_t is_read_done;
+        SDL_atomic_t is_drained;
+        float *buffer;
+        size_t buffer_capacity;
+        size_t pending_size;
+        size_t pending_pos;
+        // Stream time at the end of the decoded audio.
+        double end_timestamp;
+    } decoder;
+
+    // Single producer (decoder thread), single consumer (mixer) ring of
+    // resampled audio in the working format. Positions are counted in floats
+    // and wrap around freely.
+    struct {
+        float *data;
+        SDL_atomic_t head;
+        SDL_atomic_t tail;
+        SDL_atomic_t skip_to;
+    } ring;
 } AUDIO_STREAM_SOUND;
 
 extern SDL_AudioDeviceID g_AudioDeviceID;
 
 static AUDIO_STREAM_SOUND m_Streams[AUDIO_MAX_ACTIVE_STREAMS] = {};
-static float m_MixBuffer[AUDIO_SAMPLES * AUDIO_WORKING_CHANNELS] = {};
-
-static size_t m_DecodeBufferCapacity = 0;
-static float *m_DecodeBuffer = NULL;
 
 static void M_SeekToStart(AUDIO_STREAM_SOUND *stream);
 static bool M_DecodeFrame(AUDIO_STREAM_SOUND *stream);
 static bool M_EnqueueFrame(AUDIO_STREAM_SOUND *stream);
+static bool M_PushPending(AUDIO_STREAM_SOUND *stream);
+static bool M_Fill(AUDIO_STREAM_SOUND *stream);
+static int M_DecoderThread(void *arg);
 static bool M_InitialiseFromPath(int32_t sound_id, const char *file_path);
+static void M_Teardown(int32_t sound_id);
 static void M_Clear(AUDIO_STREAM_SOUND *stream);
 
 static void M_SeekToStart(AUDIO_STREAM_SOUND *stream)
@@ -86,6 +121,7 @@ static void M_SeekToStart(AUDIO_STREAM_SOUND *stream)
     ASSERT(stream != NULL);
 
     stream->timestamp = stream->start_at;
+    stream->decoder.end_timestamp = stream->timestamp;
     if (stream->start_at <= 0.0) {
         // reset to start of file
         avio_seek(stream->av.format_ctx->pb, 0, SEEK_SET);
@@ -197,20 +233,21 @@ static bool M_EnqueueFrame(AUDIO_STREAM_SOUND *stream)
             (const uint8_t **)stream->av.frame->data,
             stream->av.frame->nb_samples);
 
-        size_t out_pos = 0;
+        const size_t frame_pos = stream->decoder.pending_size;
+        size_t out_pos = frame_pos;
         while (resampled_size > 0) {
             const size_t out_buffer_size = av_samples_get_buffer_size(
                 NULL, stream->swr.dst_channels, resampled_size,
                 stream->swr.dst_format, 1);
 
-            if (out_pos + out_buffer_size > m_DecodeBufferCapacity) {
-                m_DecodeBufferCapacity = out_pos + out_buffer_size;
-                m_DecodeBuffer =
-                    Memory_Realloc(m_DecodeBuffer, m_DecodeBufferCapacity);
+            if (out_pos + out_buffer_size > stream->decoder.buffer_capacity) {
+                stream->decoder.buffer_capacity = out_pos + out_buffer_size;
+                stream->decoder.buffer = Memory_Realloc(
+                    stream->decoder.buffer, stream->decoder.buffer_capacity);
             }
-            if (m_DecodeBuffer != NULL && out_buffer != NULL) {
+            if (stream->decoder.buffer != NULL && out_buffer != NULL) {
                 memcpy(
-                    (uint8_t *)m_DecodeBuffer + out_pos, out_buffer,
+                    (uint8_t *)stream->decoder.buffer + out_pos, out_buffer,
                     out_buffer_size);
             }
             out_pos += out_buffer_size;
@@ -219,15 +256,15 @@ static bool M_EnqueueFrame(AUDIO_STREAM_SOUND *stream)
                 swr_convert(stream->swr.ctx, &out_buffer, out_samples, NULL, 0);
         }
 
-        if (SDL_AudioStreamPut(stream->sdl.stream, m_DecodeBuffer, out_pos)) {
-            LOG_ERROR("Got an error when decoding frame: %s", SDL_GetError());
-            av_frame_unref(stream->av.frame);
-            break;
-        }
+        stream->decoder.pending_size = out_pos;
 
         double time_base_sec = av_q2d(stream->av.stream->time_base);
         stream->timestamp =
             stream->av.frame->best_effort_timestamp * time_base_sec;
+        stream->decoder.end_timestamp = stream->timestamp
+            + (double)(out_pos - frame_pos)
+                / (sizeof(float) * stream->swr.dst_channels
+                   * stream->swr.dst_sample_rate);
         av_freep(&out_buffer);
         av_frame_unref(stream->av.frame);
     }
@@ -244,6 +281,73 @@ cleanup:
     return true;
 }
 
+// Moves as much of the pending decoded audio into the ring as fits. Returns
+// true if nothing is left pending.
+static bool M_PushPending(AUDIO_STREAM_SOUND *const stream)
+{
+    const uint32_t head = SDL_AtomicGet(&stream->ring.head);
+    const uint32_t tail = SDL_AtomicGet(&stream->ring.tail);
+    const size_t pending =
+        (stream->decoder.pending_size - stream->decoder.pending_pos)
+        / sizeof(float);
+
+    // Only ever push whole frames, so that the mixer stays in step with the
+    // channel layout.
+    size_t count = MIN(RING_SIZE - (head - tail), pending);
+    count -= count % AUDIO_WORKING_CHANNELS;
+
+    const float *const src = (const float *)((uint8_t *)stream->decoder.buffer
+                                             + stream->decoder.pending_pos);
+    const size_t first = MIN(count, RING_SIZE - (head & RING_MASK));
+    memcpy(&stream->ring.data[head & RING_MASK], src, first * sizeof(float));
+    memcpy(stream->ring.data, src + first, (count - first) * sizeof(float));
+
+    stream->decoder.pending_pos += count * sizeof(float);
+    SDL_AtomicSet(&stream->ring.head, head + count);
+    return stream->decoder.pending_pos >= stream->decoder.pending_size;
+}
+
+// Runs one step of decoding. Returns false if the decoder has to wait for the
+// mixer, either because the ring is full or because the file is read in full.
+static bool M_Fill(AUDIO_STREAM_SOUND *const stream)
+{
+    if (stream->decoder.pending_pos < stream->decoder.pending_size) {
+        return M_PushPending(stream);
+    }
+
+    if (SDL_AtomicGet(&stream->decoder.is_read_done)) {
+        return false;
+    }
+
+    stream->decoder.pending_size = 0;
+    stream->decoder.pending_pos = 0;
+    if (M_DecodeFrame(stream)) {
+        M_EnqueueFrame(stream);
+    } else {
+        SDL_AtomicSet(&stream->decoder.is_read_done, 1);
+    }
+    return true;
+}
+
+static int M_DecoderThread(void *const arg)
+{
+    AUDIO_STREAM_SOUND *const stream = arg;
+
+    // Once the stream played out, Audio_Stream_ProcessFinished closes it
+    // from the game thread.
+    SDL_LockMutex(stream->decoder.mutex);
+    while (!SDL_AtomicGet(&stream->decoder.stop)
+           && !SDL_AtomicGet(&stream->decoder.is_drained)) {
+        if (!M_Fill(stream)) {
+            SDL_UnlockMutex(stream->decoder.mutex);
+            SDL_SemWaitTimeout(stream->decoder.wake, DECODER_WAIT_MS);
+            SDL_LockMutex(stream->decoder.mutex);
+        }
+    }
+    SDL_UnlockMutex(stream->decoder.mutex);
+    return 0;
+}
+
 static bool M_InitialiseFromPath(int32_t sound_id, const char *file_path)
 {
     ASSERT(file_path != NULL);
@@ -254,8 +358,6 @@ static bool M_InitialiseFromPath(int32_t sound_id, const char *file_path)
     }
 
     bool ret = false;
-    SDL_LockAudioDevice(g_AudioDeviceID);
-
     int32_t error_code;
     char *full_path = File_GetFullPath(file_path);
 
@@ -321,17 +423,12 @@ static bool M_InitialiseFromPath(int32_t sound_id, const char *file_path)
         goto cleanup;
     }
 
-    M_DecodeFrame(stream);
-
-    int32_t sdl_sample_rate = stream->av.codec_ctx->sample_rate;
-    int32_t sdl_channels = stream->av.codec_ctx->channels;
-
-    stream->is_read_done = false;
     stream->is_used = true;
-    stream->is_playing = true;
+    stream->is_playing = false;
     stream->is_looped = false;
     stream->volume = 1.0f;
     stream->timestamp = 0.0;
+    stream->decoder.end_timestamp = 0.0;
     stream->finish_callback = NULL;
     stream->finish_callback_user_data = NULL;
     stream->duration =
@@ -339,16 +436,30 @@ static bool M_InitialiseFromPath(int32_t sound_id, const char *file_path)
     stream->start_at = -1.0; // negative value means unset
     stream->stop_at = -1.0; // negative value means unset
 
-    stream->sdl.stream = SDL_NewAudioStream(
-        AUDIO_WORKING_FORMAT, sdl_channels, AUDIO_WORKING_RATE,
-        AUDIO_WORKING_FORMAT, sdl_channels, AUDIO_WORKING_RATE);
-    if (!stream->sdl.stream) {
-        LOG_ERROR("Failed to create SDL stream: %s", SDL_GetError());
+    stream->ring.data = Memory_Alloc(RING_SIZE * sizeof(float));
+    SDL_AtomicSet(&stream->ring.head, 0);
+    SDL_AtomicSet(&stream->ring.tail, 0);
+    SDL_AtomicSet(&stream->ring.skip_to, 0);
+    SDL_AtomicSet(&stream->decoder.stop, 0);
+    SDL_AtomicSet(&stream->decoder.is_read_done, 0);
+    SDL_AtomicSet(&stream->decoder.is_drained, 0);
+
+    // Decode the beginning right away so that playback does not start with
+    // an underrun. Nobody else can see the stream yet, so no locking needed.
+    while ((uint32_t)SDL_AtomicGet(&stream->ring.head) < PREFILL_SIZE
+           && M_Fill(stream)) { }
+
+    stream->decoder.thread =
+        SDL_CreateThread(M_DecoderThread, "audio_stream", stream);
+    if (stream->decoder.thread == NULL) {
+        LOG_ERROR("SDL_CreateThread(): %s", SDL_GetError());
         goto cleanup;
     }
 
+    SDL_LockAudioDevice(g_AudioDeviceID);
+    stream->is_playing = true;
+    SDL_UnlockAudioDevice(g_AudioDeviceID);
     ret = true;
-    M_EnqueueFrame(stream);
 
 cleanup:
     if (error_code) {
@@ -361,7 +472,6 @@ cleanup:
         Audio_Stream_Close(sound_id);
     }
 
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
     Memory_FreePointer(&full_path);
     return ret;
 }
@@ -372,36 +482,113 @@ static void M_Clear(AUDIO_STREAM_SOUND *stream)
 
     stream->is_used = false;
     stream->is_playing = false;
-    stream->is_read_done = true;
     stream->is_looped = false;
+    stream->is_closing = false;
     stream->volume = 0.0f;
     stream->duration = 0.0;
     stream->timestamp = 0.0;
-    stream->sdl.stream = NULL;
     stream->finish_callback = NULL;
     stream->finish_callback_user_data = NULL;
+    stream->decoder.thread = NULL;
+    stream->decoder.pending_size = 0;
+    stream->decoder.pending_pos = 0;
+    stream->decoder.end_timestamp = 0.0;
+    SDL_AtomicSet(&stream->decoder.is_read_done, 1);
+    stream->ring.data = NULL;
+}
+
+static void M_Teardown(const int32_t sound_id)
+{
+    // Taking the device lock guarantees the mixer is not reading the ring
+    // while it goes away, and the decoder mutex keeps the other stream
+    // functions away from the libav state.
+    SDL_LockAudioDevice(g_AudioDeviceID);
+
+    AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+
+    if (stream->av.codec_ctx) {
+        avcodec_close(stream->av.codec_ctx);
+
+        // XXX: potential libav bug - avcodec_close should free this info
+        if (stream->av.codec_ctx->extradata != NULL) {
+            av_freep(&stream->av.codec_ctx->extradata);
+        }
+
+        av_free(stream->av.codec_ctx);
+        stream->av.codec_ctx = NULL;
+    }
+
+    if (stream->av.format_ctx) {
+        avformat_close_input(&stream->av.format_ctx);
+        stream->av.format_ctx = NULL;
+    }
+
+    if (stream->swr.ctx) {
+        swr_free(&stream->swr.ctx);
+    }
+
+    if (stream->av.frame) {
+        av_frame_free(&stream->av.frame);
+        stream->av.frame = NULL;
+    }
+
+    if (stream->av.packet) {
+        av_packet_free(&stream->av.packet);
+        stream->av.packet = NULL;
+    }
+
+    stream->av.stream = NULL;
+    stream->av.codec = NULL;
+
+    Memory_FreePointer(&stream->ring.data);
+
+    void (*finish_callback)(int32_t, void *) = stream->finish_callback;
+    void *finish_callback_user_data = stream->finish_callback_user_data;
+    M_Clear(stream);
+    SDL_UnlockMutex(stream->decoder.mutex);
+
+    SDL_UnlockAudioDevice(g_AudioDeviceID);
+
+    if (finish_callback) {
+        finish_callback(sound_id, finish_callback_user_data);
+    }
 }
 
 void Audio_Stream_Init(void)
 {
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_STREAMS;
          sound_id++) {
-        M_Clear(&m_Streams[sound_id]);
+        AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+        M_Clear(stream);
+        stream->decoder.mutex = SDL_CreateMutex();
+        stream->decoder.wake = SDL_CreateSemaphore(0);
     }
 }
 
 void Audio_Stream_Shutdown(void)
 {
-    Memory_FreePointer(&m_DecodeBuffer);
-    m_DecodeBufferCapacity = 0;
-    if (!g_AudioDeviceID) {
-        return;
+    if (g_AudioDeviceID) {
+        for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_STREAMS;
+             sound_id++) {
+            if (m_Streams[sound_id].is_used) {
+                Audio_Stream_Close(sound_id);
+            }
+        }
     }
 
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_STREAMS;
          sound_id++) {
-        if (m_Streams[sound_id].is_used) {
-            Audio_Stream_Close(sound_id);
+        AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+        Memory_FreePointer(&stream->decoder.buffer);
+        stream->decoder.buffer_capacity = 0;
+        if (stream->decoder.wake != NULL) {
+            SDL_DestroySemaphore(stream->decoder.wake);
+            stream->decoder.wake = NULL;
+        }
+        if (stream->decoder.mutex != NULL) {
+            SDL_DestroyMutex(stream->decoder.mutex);
+            stream->decoder.mutex = NULL;
         }
     }
 }
@@ -470,59 +657,25 @@ bool Audio_Stream_Close(int32_t sound_id)
         return false;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
-
-    AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
-
-    if (stream->av.codec_ctx) {
-        avcodec_close(stream->av.codec_ctx);
-
-        // XXX: potential libav bug - avcodec_close should free this info
-        if (stream->av.codec_ctx->extradata != NULL) {
-            av_freep(&stream->av.codec_ctx->extradata);
-        }
-
-        av_free(stream->av.codec_ctx);
-        stream->av.codec_ctx = NULL;
-    }
-
-    if (stream->av.format_ctx) {
-        avformat_close_input(&stream->av.format_ctx);
-        stream->av.format_ctx = NULL;
-    }
-
-    if (stream->swr.ctx) {
-        swr_free(&stream->swr.ctx);
-    }
-
-    if (stream->av.frame) {
-        av_frame_free(&stream->av.frame);
-        stream->av.frame = NULL;
-    }
-
-    if (stream->av.packet) {
-        av_packet_free(&stream->av.packet);
-        stream->av.packet = NULL;
-    }
-
-    stream->av.stream = NULL;
-    stream->av.codec = NULL;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
 
-    if (stream->sdl.stream) {
-        SDL_FreeAudioStream(stream->sdl.stream);
+    SDL_LockMutex(stream->decoder.mutex);
+    if (stream->is_closing) {
+        SDL_UnlockMutex(stream->decoder.mutex);
+        return true;
     }
+    stream->is_closing = true;
+    SDL_Thread *const thread = stream->decoder.thread;
+    stream->decoder.thread = NULL;
+    SDL_AtomicSet(&stream->decoder.stop, 1);
+    SDL_UnlockMutex(stream->decoder.mutex);
 
-    void (*finish_callback)(int32_t, void *) = stream->finish_callback;
-    void *finish_callback_user_data = stream->finish_callback_user_data;
-
-    M_Clear(stream);
-
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
-
-    if (finish_callback) {
-        finish_callback(sound_id, finish_callback_user_data);
+    if (thread != NULL) {
+        SDL_SemPost(stream->decoder.wake);
+        SDL_WaitThread(thread, NULL);
     }
 
+    M_Teardown(sound_id);
     return true;
 }
 
@@ -533,9 +686,15 @@ bool Audio_Stream_SetVolume(int32_t sound_id, float volume)
         return false;
     }
 
-    m_Streams[sound_id].volume = volume;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    const bool is_closing = stream->is_closing;
+    if (!is_closing) {
+        stream->volume = volume;
+    }
+    SDL_UnlockMutex(stream->decoder.mutex);
 
-    return true;
+    return !is_closing;
 }
 
 bool Audio_Stream_IsLooped(int32_t sound_id)
@@ -555,7 +714,10 @@ bool Audio_Stream_SetIsLooped(int32_t sound_id, bool is_looped)
         return false;
     }
 
-    m_Streams[sound_id].is_looped = is_looped;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    stream->is_looped = is_looped;
+    SDL_UnlockMutex(stream->decoder.mutex);
 
     return true;
 }
@@ -569,83 +731,72 @@ bool Audio_Stream_SetFinishCallback(
         return false;
     }
 
-    m_Streams[sound_id].finish_callback = callback;
-    m_Streams[sound_id].finish_callback_user_data = user_data;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    stream->finish_callback = callback;
+    stream->finish_callback_user_data = user_data;
+    SDL_UnlockMutex(stream->decoder.mutex);
 
     return true;
 }
 
+void Audio_Stream_ProcessFinished(void)
+{
+    if (!g_AudioDeviceID) {
+        return;
+    }
+
+    for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_STREAMS;
+         sound_id++) {
+        const AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+        if (stream->is_used && SDL_AtomicGet(&stream->decoder.is_drained)) {
+            Audio_Stream_Close(sound_id);
+        }
+    }
+}
+
 void Audio_Stream_Mix(float *dst_buffer, size_t len)
 {
+    // Only reads what the decoder threads have prepared; never blocks on I/O
+    // or decoding.
+    const uint32_t requested = len / sizeof(AUDIO_WORKING_FORMAT);
+
     for (int32_t sound_id = 0; sound_id < AUDIO_MAX_ACTIVE_STREAMS;
          sound_id++) {
         AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
-        if (!stream->is_playing) {
+        if (!stream->is_playing || SDL_AtomicGet(&stream->decoder.is_drained)) {
             continue;
         }
 
-        while ((SDL_AudioStreamAvailable(stream->sdl.stream) < (int32_t)len)
-               && !stream->is_read_done) {
-            if (M_DecodeFrame(stream)) {
-                M_EnqueueFrame(stream);
-            } else {
-                stream->is_read_done = true;
-            }
+        // Check for the end of the file before looking at the ring, so that
+        // the last chunk of audio is not mistaken for the end.
+        const bool is_read_done = SDL_AtomicGet(&stream->decoder.is_read_done);
+        uint32_t tail = SDL_AtomicGet(&stream->ring.tail);
+        const uint32_t skip_to = SDL_AtomicGet(&stream->ring.skip_to);
+        if ((int32_t)(skip_to - tail) > 0) {
+            // discard audio decoded before a seek
+            tail = skip_to;
         }
-
-        memset(m_MixBuffer, 0, READ_BUFFER_SIZE);
-        int32_t bytes_gotten = SDL_AudioStreamGet(
-            stream->sdl.stream, m_MixBuffer, READ_BUFFER_SIZE);
-        if (bytes_gotten < 0) {
-            LOG_ERROR("Error reading from sdl.stream: %s", SDL_GetError());
-            stream->is_playing = false;
-            stream->is_used = false;
-            stream->is_read_done = true;
-        } else if (bytes_gotten == 0) {
-            // legit end of stream. looping is handled in
-            // M_DecodeFrame
-            stream->is_playing = false;
-            stream->is_used = false;
-            stream->is_read_done = true;
-        } else {
-            int32_t samples_gotten = bytes_gotten
-                / (AUDIO_WORKING_CHANNELS * sizeof(AUDIO_WORKING_FORMAT));
-
-            const float *src_ptr = &m_MixBuffer[0];
-            float *dst_ptr = dst_buffer;
-
-            if (stream->av.codec_ctx->channels == AUDIO_WORKING_CHANNELS) {
-                for (int32_t s = 0; s < samples_gotten; s++) {
-                    for (int32_t c = 0; c < AUDIO_WORKING_CHANNELS; c++) {
-                        *dst_ptr++ += *src_ptr++ * stream->volume;
-                    }
-                }
-            } else if (stream->av.codec_ctx->channels == 1) {
-                for (int32_t s = 0; s < samples_gotten; s++) {
-                    for (int32_t c = 0; c < AUDIO_WORKING_CHANNELS; c++) {
-                        *dst_ptr++ += *src_ptr * stream->volume;
-                    }
-                    src_ptr++;
-                }
-            } else {
-                for (int32_t s = 0; s < samples_gotten; s++) {
-                    // downmix to mono
-                    float src_sample = 0.0f;
-                    for (int32_t i = 0; i < stream->av.codec_ctx->channels;
-                         i++) {
-                        src_sample += *src_ptr++;
-                    }
-                    src_sample /= (float)stream->av.codec_ctx->channels;
-                    for (int32_t c = 0; c < AUDIO_WORKING_CHANNELS; c++) {
-                        *dst_ptr++ += src_sample * stream->volume;
-                    }
-                }
-            }
+        const uint32_t head = SDL_AtomicGet(&stream->ring.head);
+        const uint32_t available = head - tail;
+
+        if (available == 0 && is_read_done) {
+            // legit end of stream. looping is handled in M_DecodeFrame;
+            // the game thread closes the stream.
+            SDL_AtomicSet(&stream->decoder.is_drained, 1);
+            SDL_SemPost(stream->decoder.wake);
+            continue;
         }
 
-        if (!stream->is_used) {
-            Audio_Stream_Close(sound_id);
+        // On an underrun, play what there is and leave the rest silent.
+        const uint32_t count = MIN(available, requested);
+        const float *const src = stream->ring.data;
+        for (uint32_t i = 0; i < count; i++) {
+            dst_buffer[i] += src[(tail + i) & RING_MASK] * stream->volume;
         }
+
+        SDL_AtomicSet(&stream->ring.tail, tail + count);
+        SDL_SemPost(stream->decoder.wake);
     }
 }
 
@@ -659,11 +810,26 @@ double Audio_Stream_GetTimestamp(int32_t sound_id)
     double timestamp = -1.0;
     AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
 
-    if (stream->duration > 0.0) {
-        SDL_LockAudioDevice(g_AudioDeviceID);
-        timestamp = stream->timestamp;
-        SDL_UnlockAudioDevice(g_AudioDeviceID);
+    SDL_LockMutex(stream->decoder.mutex);
+    if (stream->is_used && !stream->is_closing && stream->duration > 0.0) {
+        // The decoder runs ahead of the mixer, so step back from the end of
+        // the decoded audio by what has not been played yet.
+        const uint32_t head = SDL_AtomicGet(&stream->ring.head);
+        const uint32_t skip_to = SDL_AtomicGet(&stream->ring.skip_to);
+        uint32_t tail = SDL_AtomicGet(&stream->ring.tail);
+        if ((int32_t)(skip_to - tail) > 0) {
+            tail = skip_to;
+        }
+        const size_t buffered = (head - tail)
+            + (stream->decoder.pending_size - stream->decoder.pending_pos)
+                / sizeof(float);
+        timestamp = stream->decoder.end_timestamp
+            - (double)buffered
+                / (AUDIO_WORKING_CHANNELS * AUDIO_WORKING_RATE);
+        // Right after looping back, the ring still holds the end of the file.
+        timestamp = MAX(timestamp, 0.0);
     }
+    SDL_UnlockMutex(stream->decoder.mutex);
 
     return timestamp;
 }
@@ -675,10 +841,10 @@ double Audio_Stream_GetDuration(int32_t sound_id)
         return -1.0;
     }
 
-    SDL_LockAudioDevice(g_AudioDeviceID);
     AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
     double duration = stream->duration;
-    SDL_UnlockAudioDevice(g_AudioDeviceID);
+    SDL_UnlockMutex(stream->decoder.mutex);
     return duration;
 }
 
@@ -689,17 +855,28 @@ bool Audio_Stream_SeekTimestamp(int32_t sound_id, double timestamp)
         return false;
     }
 
-    if (m_Streams[sound_id].is_playing) {
-        SDL_LockAudioDevice(g_AudioDeviceID);
-        AUDIO_STREAM_SOUND *stream = &m_Streams[sound_id];
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    if (stream->is_used && !stream->is_closing && stream->is_playing) {
         const double time_base_sec = av_q2d(stream->av.stream->time_base);
         av_seek_frame(
             stream->av.format_ctx, 0, timestamp / time_base_sec,
             AVSEEK_FLAG_ANY);
         avcodec_flush_buffers(stream->av.codec_ctx);
-        SDL_UnlockAudioDevice(g_AudioDeviceID);
+
+        // drop whatever was decoded from the old position
+        stream->decoder.pending_size = 0;
+        stream->decoder.pending_pos = 0;
+        stream->timestamp = timestamp;
+        stream->decoder.end_timestamp = timestamp;
+        SDL_AtomicSet(&stream->decoder.is_read_done, 0);
+        SDL_AtomicSet(
+            &stream->ring.skip_to, SDL_AtomicGet(&stream->ring.head));
+        SDL_UnlockMutex(stream->decoder.mutex);
+        SDL_SemPost(stream->decoder.wake);
         return true;
     }
+    SDL_UnlockMutex(stream->decoder.mutex);
 
     return false;
 }
@@ -711,7 +888,10 @@ bool Audio_Stream_SetStartTimestamp(int32_t sound_id, double timestamp)
         return false;
     }
 
-    m_Streams[sound_id].start_at = timestamp;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    stream->start_at = timestamp;
+    SDL_UnlockMutex(stream->decoder.mutex);
     return true;
 }
 
@@ -722,6 +902,9 @@ bool Audio_Stream_SetStopTimestamp(int32_t sound_id, double timestamp)
         return false;
     }
 
-    m_Streams[sound_id].stop_at = timestamp;
+    AUDIO_STREAM_SOUND *const stream = &m_Streams[sound_id];
+    SDL_LockMutex(stream->decoder.mutex);
+    stream->stop_at = timestamp;
+    SDL_UnlockMutex(stream->decoder.mutex);
     return true;
 }
@@ -9,12 +9,14 @@
 #include <SDL2/SDL_filesystem.h>
 #include <dirent.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <sys/stat.h>
 
 #if defined(_WIN32)
     #include <direct.h>
+    #include <windows.h>
     #define PATH_SEPARATOR "\\"
 #else
-    #include <sys/stat.h>
     #define PATH_SEPARATOR "/"
 #endif
 
@@ -434,3 +436,82 @@ void File_CreateDirectory(const char *path)
 #endif
     Memory_FreePointer(&full_path);
 }
+
+bool File_Rename(const char *const src_path, const char *const dst_path)
+{
+    char *full_src_path = File_GetFullPath(src_path);
+    char *full_dst_path = File_GetFullPath(dst_path);
+#if defined(_WIN32)
+    const bool result = MoveFileExA(
+        full_src_path, full_dst_path, MOVEFILE_REPLACE_EXISTING);
+#else
+    const bool result = rename(full_src_path, full_dst_path) == 0;
+#endif
+    Memory_FreePointer(&full_src_path);
+    Memory_FreePointer(&full_dst_path);
+    return result;
+}
+
+bool File_Delete(const char *const path)
+{
+    char *full_path = File_GetFullPath(path);
+    const bool result = remove(full_path) == 0;
+    Memory_FreePointer(&full_path);
+    return result;
+}
+
+int32_t File_ListDirectory(const char *const path, FILE_INFO **const out_files)
+{
+    ASSERT(out_files != NULL);
+    *out_files = NULL;
+
+    char *full_path = File_GetFullPath(path);
+    DIR *const dir = opendir(full_path);
+    if (dir == NULL) {
+        Memory_FreePointer(&full_path);
+        return 0;
+    }
+
+    int32_t count = 0;
+    int32_t capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const size_t full_size =
+            strlen(full_path) + strlen(entry->d_name) + 2;
+        char *const full_file_path = Memory_Alloc(full_size);
+        snprintf(
+            full_file_path, full_size, "%s" PATH_SEPARATOR "%s", full_path,
+            entry->d_name);
+        struct stat st;
+        const bool is_file =
+            stat(full_file_path, &st) == 0 && S_ISREG(st.st_mode);
+        Memory_Free(full_file_path);
+        if (!is_file) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = MAX(capacity * 2, 16);
+            *out_files =
+                Memory_Realloc(*out_files, sizeof(FILE_INFO) * capacity);
+        }
+        const size_t size = strlen(path) + strlen(entry->d_name) + 2;
+        FILE_INFO *const info = &(*out_files)[count++];
+        info->path = Memory_Alloc(size);
+        snprintf(info->path, size, "%s/%s", path, entry->d_name);
+        info->size = st.st_size;
+        info->modified = st.st_mtime;
+    }
+
+    closedir(dir);
+    Memory_FreePointer(&full_path);
+    return count;
+}
+
+void File_FreeList(FILE_INFO *files, const int32_t count)
+{
+    for (int32_t i = 0; i < count; i++) {
+        Memory_FreePointer(&files[i].path);
+    }
+    Memory_Free(files);
+}
@@ -3,6 +3,7 @@
 #include "game/clock/const.h"
 #include "game/clock/timer.h"
 #include "game/clock/turbo.h"
+#include "game/headless.h"
 
 #include <SDL2/SDL_stdinc.h>
 #include <SDL2/SDL_timer.h>
@@ -58,6 +59,11 @@ void Clock_SyncTick(void)
 
 int32_t Clock_WaitTick(void)
 {
+    if (Headless_IsEnabled()) {
+        // Run uncapped, exactly one frame per tick.
+        return 1;
+    }
+
     const Uint64 current_counter = SDL_GetPerformanceCounter();
 
     // If this is the first call, just initialize and return a frame.
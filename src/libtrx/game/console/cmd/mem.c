@@ -0,0 +1,53 @@
+#include "game/console/cmd/mem.h"
+
+#include "enum_map.h"
+#include "game/console/common.h"
+#include "game/game_string.h"
+#include "game/gamebuf.h"
+#include "strings.h"
+
+#define TOP_CATEGORIES 3
+#define TO_MB(bytes) ((bytes) / (1024.0f * 1024.0f))
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    if (!String_IsEmpty(ctx->args)) {
+        return CR_BAD_INVOCATION;
+    }
+
+    Console_Log(
+        GS(OSD_MEM_USAGE), TO_MB(GameBuf_GetTotalUsage()),
+        TO_MB(GameBuf_GetTotalPeakUsage()), TO_MB(GameBuf_GetReservedSize()),
+        GameBuf_GetChunkCount());
+
+    // Show the biggest categories here; the full breakdown goes to the log.
+    bool shown[GBUF_NUM_MALLOC_TYPES] = {};
+    for (int32_t i = 0; i < TOP_CATEGORIES; i++) {
+        int32_t best = -1;
+        size_t best_usage = 0;
+        for (int32_t j = 0; j < GBUF_NUM_MALLOC_TYPES; j++) {
+            const size_t usage = GameBuf_GetUsage(j);
+            if (!shown[j] && usage > best_usage) {
+                best = j;
+                best_usage = usage;
+            }
+        }
+        if (best == -1) {
+            break;
+        }
+        shown[best] = true;
+        Console_Log(
+            GS(OSD_MEM_CATEGORY), ENUM_MAP_TO_STRING(GAME_BUFFER, best),
+            TO_MB(best_usage));
+    }
+
+    GameBuf_LogUsage();
+    return CR_SUCCESS;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_Mem = {
+    .prefix = "mem",
+    .proc = M_Entrypoint,
+};
@@ -0,0 +1,62 @@
+#include "game/console/cmd/perf.h"
+
+#include "game/clock.h"
+#include "game/console/common.h"
+#include "game/frame_stats.h"
+#include "game/game_string.h"
+#include "memory.h"
+#include "strings.h"
+
+#include <stdio.h>
+
+static char *M_GetStatsPath(void);
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static char *M_GetStatsPath(void)
+{
+    char date_time[30];
+    Clock_GetDateTime(date_time, 30);
+
+    const char *const fmt = "perf_%s.csv";
+    const size_t out_size = snprintf(NULL, 0, fmt, date_time) + 1;
+    char *out = Memory_Alloc(out_size);
+    snprintf(out, out_size, fmt, date_time);
+    return out;
+}
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    if (String_Equivalent(ctx->args, "on")) {
+        FrameStats_SetEnabled(true);
+        Console_Log(GS(OSD_PERF_ON));
+        return CR_SUCCESS;
+    }
+
+    if (String_Equivalent(ctx->args, "off")) {
+        FrameStats_SetEnabled(false);
+        Console_Log(GS(OSD_PERF_OFF));
+        return CR_SUCCESS;
+    }
+
+    if (String_Equivalent(ctx->args, "dump")) {
+        if (!FrameStats_IsEnabled()) {
+            return CR_UNAVAILABLE;
+        }
+        char *path = M_GetStatsPath();
+        const int32_t count = FrameStats_Export(path);
+        if (count < 0) {
+            Console_Log(GS(OSD_PERF_SAVE_FAIL));
+        } else {
+            Console_Log(GS(OSD_PERF_SAVED), count, path);
+        }
+        Memory_FreePointer(&path);
+        return CR_SUCCESS;
+    }
+
+    return CR_BAD_INVOCATION;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_Perf = {
+    .prefix = "perf",
+    .proc = M_Entrypoint,
+};
@@ -0,0 +1,59 @@
+#include "game/console/cmd/profile.h"
+
+#include "game/clock.h"
+#include "game/console/common.h"
+#include "game/game_string.h"
+#include "memory.h"
+#include "profiler.h"
+#include "strings.h"
+
+#include <stdio.h>
+
+static char *M_GetProfilePath(void);
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static char *M_GetProfilePath(void)
+{
+    char date_time[30];
+    Clock_GetDateTime(date_time, 30);
+
+    const char *const fmt = "profile_%s.json";
+    const size_t out_size = snprintf(NULL, 0, fmt, date_time) + 1;
+    char *out = Memory_Alloc(out_size);
+    snprintf(out, out_size, fmt, date_time);
+    return out;
+}
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    if (String_Equivalent(ctx->args, "on")) {
+        Profiler_SetEnabled(true);
+        Console_Log(GS(OSD_PROFILER_ON));
+        return CR_SUCCESS;
+    }
+
+    if (String_Equivalent(ctx->args, "off")) {
+        Profiler_SetEnabled(false);
+        Console_Log(GS(OSD_PROFILER_OFF));
+        return CR_SUCCESS;
+    }
+
+    if (String_Equivalent(ctx->args, "dump")) {
+        char *path = M_GetProfilePath();
+        const int32_t count = Profiler_Export(path);
+        if (count < 0) {
+            Console_Log(GS(OSD_PROFILER_SAVE_FAIL));
+        } else {
+            Console_Log(GS(OSD_PROFILER_SAVED), count, path);
+        }
+        Memory_FreePointer(&path);
+        return CR_SUCCESS;
+    }
+
+    return CR_BAD_INVOCATION;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_Profile = {
+    .prefix = "profile",
+    .proc = M_Entrypoint,
+};
@@ -0,0 +1,262 @@
+#include "game/frame_stats.h"
+
+#include "filesystem.h"
+#include "game/clock.h"
+#include "game/effects.h"
+#include "game/game_string.h"
+#include "game/gamebuf.h"
+#include "game/items.h"
+#include "game/lot.h"
+#include "game/ui/common.h"
+#include "game/ui/widgets/label.h"
+#include "game/ui/widgets/stack.h"
+#include "gfx/context.h"
+#include "log.h"
+
+#include <SDL2/SDL_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FRAMES 600
+#define WINDOW_MARGIN 5
+#define LABEL_SCALE 0.8
+#define REFRESH_INTERVAL 0.25
+#define TO_MS(ticks) ((ticks) * 1000.0 / SDL_GetPerformanceFrequency())
+#define TO_MB(bytes) ((bytes) / (1024.0 * 1024.0))
+
+typedef enum {
+    M_LINE_FRAME_TIME,
+    M_LINE_SECTIONS,
+    M_LINE_DRAW_CALLS,
+    M_LINE_MEMORY,
+    M_LINE_WORLD,
+    M_LINE_NUMBER_OF,
+} M_LINE;
+
+typedef struct {
+    float section_ms[FRAME_STATS_NUMBER_OF];
+    int32_t draw_calls;
+    int32_t vertices;
+    int32_t items;
+    int32_t effects;
+    int32_t creatures;
+    size_t memory;
+} M_FRAME;
+
+static bool m_Enabled = false;
+static Uint64 m_LastMark = 0;
+static Uint64 m_Sections[FRAME_STATS_NUMBER_OF] = {};
+static M_FRAME m_Frames[MAX_FRAMES];
+static int32_t m_FrameCount = 0;
+static int32_t m_FrameHead = 0;
+static CLOCK_TIMER m_RefreshTimer = { .type = CLOCK_TIMER_REAL };
+
+static UI_WIDGET *m_Container = NULL;
+static UI_WIDGET *m_Labels[M_LINE_NUMBER_OF] = {};
+
+static float M_GetFrameTime(const M_FRAME *frame);
+static int M_CompareFloats(const void *a, const void *b);
+static const M_FRAME *M_GetFrame(int32_t idx);
+static void M_Refresh(void);
+static void M_DoLayout(void);
+
+static float M_GetFrameTime(const M_FRAME *const frame)
+{
+    float result = 0.0f;
+    for (int32_t i = 0; i < FRAME_STATS_NUMBER_OF; i++) {
+        result += frame->section_ms[i];
+    }
+    return result;
+}
+
+static int M_CompareFloats(const void *const a, const void *const b)
+{
+    const float fa = *(const float *)a;
+    const float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static const M_FRAME *M_GetFrame(const int32_t idx)
+{
+    const int32_t first =
+        (m_FrameHead - m_FrameCount + MAX_FRAMES) % MAX_FRAMES;
+    return &m_Frames[(first + idx) % MAX_FRAMES];
+}
+
+static void M_Refresh(void)
+{
+    if (m_FrameCount == 0) {
+        return;
+    }
+
+    float frame_times[MAX_FRAMES];
+    float section_ms[FRAME_STATS_NUMBER_OF] = {};
+    for (int32_t i = 0; i < m_FrameCount; i++) {
+        const M_FRAME *const frame = M_GetFrame(i);
+        frame_times[i] = M_GetFrameTime(frame);
+        for (int32_t j = 0; j < FRAME_STATS_NUMBER_OF; j++) {
+            section_ms[j] += frame->section_ms[j] / m_FrameCount;
+        }
+    }
+    qsort(frame_times, m_FrameCount, sizeof(float), M_CompareFloats);
+
+    // Nearest-rank percentiles.
+    const float p50 = frame_times[(m_FrameCount - 1) * 50 / 100];
+    const float p95 = frame_times[(m_FrameCount - 1) * 95 / 100];
+    const float p99 = frame_times[(m_FrameCount - 1) * 99 / 100];
+
+    const M_FRAME *const last = M_GetFrame(m_FrameCount - 1);
+    char buf[100];
+    snprintf(buf, sizeof(buf), GS(PERF_FRAME_TIME), p50, p95, p99);
+    UI_Label_ChangeText(m_Labels[M_LINE_FRAME_TIME], buf);
+    snprintf(
+        buf, sizeof(buf), GS(PERF_SECTIONS), section_ms[FRAME_STATS_CONTROL],
+        section_ms[FRAME_STATS_DRAW], section_ms[FRAME_STATS_WAIT]);
+    UI_Label_ChangeText(m_Labels[M_LINE_SECTIONS], buf);
+    snprintf(
+        buf, sizeof(buf), GS(PERF_DRAW_CALLS), last->draw_calls,
+        last->vertices);
+    UI_Label_ChangeText(m_Labels[M_LINE_DRAW_CALLS], buf);
+    snprintf(buf, sizeof(buf), GS(PERF_MEMORY), TO_MB(last->memory));
+    UI_Label_ChangeText(m_Labels[M_LINE_MEMORY], buf);
+    snprintf(
+        buf, sizeof(buf), GS(PERF_WORLD), last->items, last->effects,
+        last->creatures);
+    UI_Label_ChangeText(m_Labels[M_LINE_WORLD], buf);
+
+    M_DoLayout();
+}
+
+static void M_DoLayout(void)
+{
+    UI_Stack_SetSize(
+        m_Container, UI_GetCanvasWidth() - 2 * WINDOW_MARGIN,
+        UI_GetCanvasHeight() - 2 * WINDOW_MARGIN);
+    m_Container->set_position(m_Container, WINDOW_MARGIN, WINDOW_MARGIN);
+}
+
+void FrameStats_Init(void)
+{
+    m_Container = UI_Stack_Create(
+        UI_STACK_LAYOUT_VERTICAL, UI_STACK_AUTO_SIZE, UI_STACK_AUTO_SIZE);
+    UI_Stack_SetHAlign(m_Container, UI_STACK_H_ALIGN_RIGHT);
+    UI_Stack_SetVAlign(m_Container, UI_STACK_V_ALIGN_CENTER);
+    for (int32_t i = 0; i < M_LINE_NUMBER_OF; i++) {
+        m_Labels[i] =
+            UI_Label_Create("", UI_LABEL_AUTO_SIZE, UI_LABEL_AUTO_SIZE);
+        UI_Label_SetScale(m_Labels[i], LABEL_SCALE);
+        UI_Stack_AddChild(m_Container, m_Labels[i]);
+    }
+}
+
+void FrameStats_Shutdown(void)
+{
+    for (int32_t i = 0; i < M_LINE_NUMBER_OF; i++) {
+        if (m_Labels[i] != NULL) {
+            m_Labels[i]->free(m_Labels[i]);
+            m_Labels[i] = NULL;
+        }
+    }
+    if (m_Container != NULL) {
+        m_Container->free(m_Container);
+        m_Container = NULL;
+    }
+    m_Enabled = false;
+}
+
+void FrameStats_SetEnabled(const bool enabled)
+{
+    if (enabled && !m_Enabled) {
+        m_FrameCount = 0;
+        m_FrameHead = 0;
+        m_LastMark = SDL_GetPerformanceCounter();
+        for (int32_t i = 0; i < FRAME_STATS_NUMBER_OF; i++) {
+            m_Sections[i] = 0;
+        }
+        for (int32_t i = 0; i < M_LINE_NUMBER_OF; i++) {
+            UI_Label_ChangeText(m_Labels[i], "");
+        }
+        ClockTimer_Sync(&m_RefreshTimer);
+    }
+    m_Enabled = enabled;
+}
+
+bool FrameStats_IsEnabled(void)
+{
+    return m_Enabled;
+}
+
+void FrameStats_Mark(const FRAME_STATS_SECTION section)
+{
+    if (!m_Enabled) {
+        return;
+    }
+    const Uint64 now = SDL_GetPerformanceCounter();
+    m_Sections[section] += now - m_LastMark;
+    m_LastMark = now;
+}
+
+void FrameStats_EndFrame(void)
+{
+    if (!m_Enabled) {
+        return;
+    }
+
+    M_FRAME *const frame = &m_Frames[m_FrameHead];
+    for (int32_t i = 0; i < FRAME_STATS_NUMBER_OF; i++) {
+        frame->section_ms[i] = TO_MS((double)m_Sections[i]);
+        m_Sections[i] = 0;
+    }
+    const GFX_DRAW_STATS draw_stats = GFX_Context_GetDrawStats();
+    frame->draw_calls = draw_stats.draw_calls;
+    frame->vertices = draw_stats.vertices;
+    frame->items = Item_GetActiveCount();
+    frame->effects = Effect_GetActiveCount();
+    frame->creatures = LOT_GetActiveCount();
+    frame->memory = GameBuf_GetTotalUsage();
+
+    m_FrameHead = (m_FrameHead + 1) % MAX_FRAMES;
+    if (m_FrameCount < MAX_FRAMES) {
+        m_FrameCount++;
+    }
+}
+
+void FrameStats_Draw(void)
+{
+    if (!m_Enabled || m_Container == NULL) {
+        return;
+    }
+    if (ClockTimer_CheckElapsedAndTake(&m_RefreshTimer, REFRESH_INTERVAL)) {
+        M_Refresh();
+    }
+    m_Container->draw(m_Container);
+}
+
+int32_t FrameStats_Export(const char *const path)
+{
+    MYFILE *const fp = File_Open(path, FILE_OPEN_WRITE);
+    if (fp == NULL) {
+        LOG_ERROR("Cannot write frame stats to %s", path);
+        return -1;
+    }
+
+    const char *const header =
+        "frame,frame_ms,control_ms,draw_ms,wait_ms,draw_calls,vertices,"
+        "items,effects,creatures,memory_kb\n";
+    File_WriteData(fp, header, strlen(header));
+    for (int32_t i = 0; i < m_FrameCount; i++) {
+        const M_FRAME *const frame = M_GetFrame(i);
+        char line[200];
+        const int32_t line_size = snprintf(
+            line, sizeof(line), "%d,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,%zu\n",
+            i, M_GetFrameTime(frame), frame->section_ms[FRAME_STATS_CONTROL],
+            frame->section_ms[FRAME_STATS_DRAW],
+            frame->section_ms[FRAME_STATS_WAIT], frame->draw_calls,
+            frame->vertices, frame->items, frame->effects, frame->creatures,
+            frame->memory / 1024);
+        File_WriteData(fp, line, line_size);
+    }
+    File_Close(fp);
+    return m_FrameCount;
+}
@@ -1,52 +1,166 @@
 #include "game/gamebuf.h"
 
 #include "enum_map.h"
-#include "game/shell.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
-static size_t m_Cap = 0;
-static size_t m_MemUsed = 0;
-static size_t m_MemFree = 0;
-static char *m_MemBase = NULL;
-static char *m_MemPtr = NULL;
+typedef struct GAMEBUF_CHUNK {
+    struct GAMEBUF_CHUNK *next;
+    size_t size;
+    size_t used;
+    char data[];
+} GAMEBUF_CHUNK;
 
-void GameBuf_Init(const size_t cap)
+static size_t m_ChunkSize = 0;
+static GAMEBUF_CHUNK *m_FirstChunk = NULL;
+static GAMEBUF_CHUNK *m_CurrentChunk = NULL;
+static int32_t m_ChunkCount = 0;
+static size_t m_Reserved = 0;
+
+static size_t m_TotalUsage = 0;
+static size_t m_TotalPeakUsage = 0;
+static size_t m_Usage[GBUF_NUM_MALLOC_TYPES] = {};
+static size_t m_PeakUsage[GBUF_NUM_MALLOC_TYPES] = {};
+
+static GAMEBUF_CHUNK *M_CreateChunk(size_t size);
+static void M_FreeChunks(GAMEBUF_CHUNK *chunk);
+
+static GAMEBUF_CHUNK *M_CreateChunk(const size_t size)
+{
+    GAMEBUF_CHUNK *const chunk = Memory_Alloc(sizeof(GAMEBUF_CHUNK) + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    m_ChunkCount++;
+    m_Reserved += size;
+    return chunk;
+}
+
+static void M_FreeChunks(GAMEBUF_CHUNK *chunk)
+{
+    while (chunk != NULL) {
+        GAMEBUF_CHUNK *next = chunk->next;
+        m_ChunkCount--;
+        m_Reserved -= chunk->size;
+        Memory_Free(chunk);
+        chunk = next;
+    }
+}
+
+void GameBuf_Init(const size_t chunk_size)
 {
-    m_Cap = cap;
-    m_MemBase = Memory_Alloc(cap);
+    m_ChunkSize = chunk_size;
+    m_FirstChunk = M_CreateChunk(chunk_size);
+    m_CurrentChunk = m_FirstChunk;
     GameBuf_Reset();
 }
 
 void GameBuf_Reset(void)
 {
-    m_MemPtr = m_MemBase;
-    m_MemFree = m_Cap;
-    m_MemUsed = 0;
+    if (m_TotalUsage > 0) {
+        GameBuf_LogUsage();
+    }
+
+    // Give back the memory of any chunks that a big level needed on top of
+    // the first one.
+    if (m_FirstChunk != NULL) {
+        M_FreeChunks(m_FirstChunk->next);
+        m_FirstChunk->next = NULL;
+        m_FirstChunk->used = 0;
+    }
+    m_CurrentChunk = m_FirstChunk;
+
+    m_TotalUsage = 0;
+    for (int32_t i = 0; i < GBUF_NUM_MALLOC_TYPES; i++) {
+        m_Usage[i] = 0;
+    }
 }
 
 void GameBuf_Shutdown(void)
 {
-    Memory_FreePointer(&m_MemBase);
-    m_Cap = 0;
-    m_MemFree = 0;
-    m_MemUsed = 0;
+    GameBuf_Reset();
+    M_FreeChunks(m_FirstChunk);
+    m_FirstChunk = NULL;
+    m_CurrentChunk = NULL;
+    m_ChunkSize = 0;
 }
 
 void *GameBuf_Alloc(const size_t alloc_size, const GAME_BUFFER buffer)
 {
     const size_t aligned_size = (alloc_size + 3) & ~3;
 
-    const char *const buffer_name = ENUM_MAP_TO_STRING(GAME_BUFFER, buffer);
-    if (aligned_size > m_MemFree) {
-        Shell_ExitSystemFmt(
-            "Ran out of memory while trying to allocate %d bytes for %s",
-            aligned_size, buffer_name);
+    GAMEBUF_CHUNK *chunk = m_CurrentChunk;
+    if (chunk == NULL || chunk->used + aligned_size > chunk->size) {
+        // The rest of the current chunk is left unused; allocations are
+        // never split across chunks.
+        const size_t size = MAX(m_ChunkSize, aligned_size);
+        GAMEBUF_CHUNK *const new_chunk = M_CreateChunk(size);
+        if (chunk != NULL) {
+            chunk->next = new_chunk;
+        } else {
+            m_FirstChunk = new_chunk;
+        }
+        chunk = new_chunk;
+        m_CurrentChunk = new_chunk;
+        LOG_INFO(
+            "Growing game buffer by %zu bytes for %s (%d chunks, %zu bytes)",
+            size, ENUM_MAP_TO_STRING(GAME_BUFFER, buffer), m_ChunkCount,
+            m_Reserved);
     }
 
-    void *const result = m_MemPtr;
-    m_MemFree -= aligned_size;
-    m_MemUsed += aligned_size;
-    m_MemPtr += aligned_size;
+    void *const result = chunk->data + chunk->used;
+    chunk->used += aligned_size;
+
+    m_Usage[buffer] += aligned_size;
+    m_PeakUsage[buffer] = MAX(m_PeakUsage[buffer], m_Usage[buffer]);
+    m_TotalUsage += aligned_size;
+    m_TotalPeakUsage = MAX(m_TotalPeakUsage, m_TotalUsage);
     return result;
 }
+
+size_t GameBuf_GetUsage(const GAME_BUFFER buffer)
+{
+    return m_Usage[buffer];
+}
+
+size_t GameBuf_GetTotalUsage(void)
+{
+    return m_TotalUsage;
+}
+
+size_t GameBuf_GetPeakUsage(const GAME_BUFFER buffer)
+{
+    return m_PeakUsage[buffer];
+}
+
+size_t GameBuf_GetTotalPeakUsage(void)
+{
+    return m_TotalPeakUsage;
+}
+
+size_t GameBuf_GetReservedSize(void)
+{
+    return m_Reserved;
+}
+
+int32_t GameBuf_GetChunkCount(void)
+{
+    return m_ChunkCount;
+}
+
+void GameBuf_LogUsage(void)
+{
+    LOG_INFO(
+        "Game buffer: %zu bytes used (peak %zu), %zu bytes reserved in %d "
+        "chunks",
+        m_TotalUsage, m_TotalPeakUsage, m_Reserved, m_ChunkCount);
+    for (int32_t i = 0; i < GBUF_NUM_MALLOC_TYPES; i++) {
+        if (m_PeakUsage[i] == 0) {
+            continue;
+        }
+        LOG_INFO(
+            "  %-28s %10zu bytes (peak %zu)", ENUM_MAP_TO_STRING(GAME_BUFFER, i),
+            m_Usage[i], m_PeakUsage[i]);
+    }
+}
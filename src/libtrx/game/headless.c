@@ -0,0 +1,171 @@
+#include "game/headless.h"
+
+#include "filesystem.h"
+#include "game/clock.h"
+#include "game/items.h"
+#include "game/shell.h"
+#include "log.h"
+#include "memory.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TRACE_PATH "headless.trace"
+#define FNV_OFFSET 0xCBF29CE484222325ull
+#define FNV_PRIME 0x100000001B3ull
+
+static bool m_Enabled = false;
+static int32_t m_DemoNum = 0;
+static char *m_InputPath = NULL;
+static MYFILE *m_TraceFile = NULL;
+static int32_t m_FrameCount = 0;
+static double m_StartTime = 0.0;
+
+static uint64_t M_Hash(uint64_t hash, int32_t value);
+static uint64_t M_HashState(void);
+
+static uint64_t M_Hash(uint64_t hash, const int32_t value)
+{
+    for (int32_t i = 0; i < 4; i++) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t M_HashState(void)
+{
+    uint64_t hash = FNV_OFFSET;
+    const int32_t item_count = Item_GetTotalCount();
+    hash = M_Hash(hash, item_count);
+    for (int32_t i = 0; i < item_count; i++) {
+        const ITEM *const item = Item_Get(i);
+        hash = M_Hash(hash, item->object_id);
+        hash = M_Hash(hash, item->pos.x);
+        hash = M_Hash(hash, item->pos.y);
+        hash = M_Hash(hash, item->pos.z);
+        hash = M_Hash(hash, item->rot.x);
+        hash = M_Hash(hash, item->rot.y);
+        hash = M_Hash(hash, item->rot.z);
+        hash = M_Hash(hash, item->room_num);
+        hash = M_Hash(hash, item->anim_num);
+        hash = M_Hash(hash, item->frame_num);
+        hash = M_Hash(hash, item->current_anim_state);
+        hash = M_Hash(hash, item->goal_anim_state);
+        hash = M_Hash(hash, item->speed);
+        hash = M_Hash(hash, item->fall_speed);
+        hash = M_Hash(hash, item->hit_points);
+        hash = M_Hash(hash, item->flags);
+        hash = M_Hash(hash, item->status);
+        hash = M_Hash(hash, item->active);
+    }
+    return hash;
+}
+
+void Headless_ParseArgs(const int32_t arg_count, char **const args)
+{
+    const char *trace_path = DEFAULT_TRACE_PATH;
+    for (int32_t i = 0; i < arg_count; i++) {
+        if (!strcmp(args[i], "-headless")) {
+            m_Enabled = true;
+        } else if (!strcmp(args[i], "-headless-demo") && i + 1 < arg_count) {
+            m_DemoNum = atoi(args[++i]);
+        } else if (!strcmp(args[i], "-headless-trace") && i + 1 < arg_count) {
+            trace_path = args[++i];
+        } else if (!strcmp(args[i], "-headless-input") && i + 1 < arg_count) {
+            Memory_FreePointer(&m_InputPath);
+            m_InputPath = Memory_DupStr(args[++i]);
+        }
+    }
+
+    if (!m_Enabled) {
+        return;
+    }
+
+    // Open the trace right away, as the caller may free the arguments.
+    m_TraceFile = File_Open(trace_path, FILE_OPEN_WRITE);
+    if (m_TraceFile == NULL) {
+        LOG_ERROR("Cannot open the headless trace: %s", trace_path);
+    }
+
+    LOG_INFO("Running headless, demo %d", m_DemoNum);
+}
+
+void Headless_Shutdown(void)
+{
+    if (!m_Enabled) {
+        return;
+    }
+
+    const double elapsed = Clock_GetRealTime() - m_StartTime;
+    LOG_INFO(
+        "Headless run finished: %d frames in %.3f s (%.1f frames/s)",
+        m_FrameCount, elapsed, elapsed > 0.0 ? m_FrameCount / elapsed : 0.0);
+    if (m_TraceFile != NULL) {
+        File_Close(m_TraceFile);
+        m_TraceFile = NULL;
+    }
+    Memory_FreePointer(&m_InputPath);
+}
+
+bool Headless_IsEnabled(void)
+{
+    return m_Enabled;
+}
+
+int32_t Headless_GetDemoNum(void)
+{
+    return m_DemoNum;
+}
+
+bool Headless_LoadInput(uint32_t *const data, const int32_t max_count)
+{
+    if (!m_Enabled || m_InputPath == NULL) {
+        return false;
+    }
+
+    char *content = NULL;
+    size_t size = 0;
+    if (!File_Load(m_InputPath, &content, &size)) {
+        Shell_ExitSystemFmt("Cannot read the headless input: %s", m_InputPath);
+        return false;
+    }
+
+    int32_t count = size / sizeof(uint32_t);
+    if (count > max_count) {
+        LOG_WARNING(
+            "The headless input is too long, only %d of %d words are used",
+            max_count, count);
+        count = max_count;
+    }
+    memcpy(data, content, count * sizeof(uint32_t));
+    if (count < max_count) {
+        data[count] = (uint32_t)-1;
+    }
+    Memory_FreePointer(&content);
+
+    LOG_INFO("Replaying %d words of input from %s", count, m_InputPath);
+    return true;
+}
+
+void Headless_TraceFrame(void)
+{
+    if (!m_Enabled) {
+        return;
+    }
+
+    if (m_FrameCount == 0) {
+        m_StartTime = Clock_GetRealTime();
+    }
+
+    if (m_TraceFile != NULL) {
+        char line[64];
+        const int32_t length = snprintf(
+            line, sizeof(line), "%d %016" PRIx64 "\n", m_FrameCount,
+            M_HashState());
+        File_WriteData(m_TraceFile, line, length);
+    }
+    m_FrameCount++;
+}
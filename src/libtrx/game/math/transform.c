@@ -0,0 +1,458 @@
+#include "game/math/transform.h"
+
+#include "log.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #if defined(__SSE2__)
+        #define M_USE_SSE2
+    #endif
+    // MinGW only keeps the stack 16-byte aligned, and GCC may spill AVX
+    // registers to it with aligned moves (GCC bug 54412).
+    #if defined(__GNUC__) && !defined(_WIN32)
+        #define M_USE_AVX2
+    #endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define M_USE_NEON
+#endif
+
+// The vectorised variants compute the screen position as a multiply-add,
+// which NEON fuses. The scalar path has to round the same way to give the
+// same results.
+#if defined(M_USE_NEON)
+    #define M_MADD(a, b, c) fma((a), (b), (c))
+#else
+    #define M_MADD(a, b, c) ((a) * (b) + (c))
+#endif
+
+#define M_OUTPUT(type, field, index, stride)                                   \
+    (*(type *)((char *)(field) + (size_t)(index) * (stride)))
+
+#define BLOCK_MAX 8
+#define CHECK_COUNT 64
+
+// Intermediate results for one block of vertices, in structure-of-arrays
+// form.
+typedef struct {
+    int32_t xv[BLOCK_MAX];
+    int32_t yv[BLOCK_MAX];
+    int32_t zv[BLOCK_MAX];
+    double xs[BLOCK_MAX];
+    double ys[BLOCK_MAX];
+    double persp[BLOCK_MAX];
+} BLOCK;
+
+typedef void (*BLOCK_FUNC)(
+    const MATH_PROJECTION *proj, const int16_t *vertices, int32_t stride,
+    BLOCK *block);
+
+static bool m_KernelSelected = false;
+static BLOCK_FUNC m_BlockFunc = NULL;
+static int32_t m_BlockSize = 0;
+
+static int32_t M_Dot(const int32_t *row, int32_t x, int32_t y, int32_t z);
+static uint16_t M_StoreVertex(
+    const MATH_PROJECTION *proj, const MATH_VERTEX_OUTPUT *output,
+    int32_t index, int32_t xv, int32_t yv, int32_t zv, double xs, double ys,
+    double persp);
+static uint16_t M_TransformRange(
+    const MATH_PROJECTION *proj, const int16_t *vertices, int32_t stride,
+    int32_t start, int32_t end, const MATH_VERTEX_OUTPUT *output);
+static uint16_t M_TransformBlocks(
+    const MATH_PROJECTION *proj, const int16_t *vertices, int32_t stride,
+    int32_t count, const MATH_VERTEX_OUTPUT *output);
+static bool M_CheckKernel(void);
+static void M_SelectKernel(void);
+
+static inline int32_t M_Dot(
+    const int32_t *const row, const int32_t x, const int32_t y,
+    const int32_t z)
+{
+    // Wrap around on overflow like the vector units do.
+    return (int32_t)((uint32_t)row[0] * (uint32_t)x
+                     + (uint32_t)row[1] * (uint32_t)y
+                     + (uint32_t)row[2] * (uint32_t)z + (uint32_t)row[3]);
+}
+
+static inline uint16_t M_StoreVertex(
+    const MATH_PROJECTION *const proj, const MATH_VERTEX_OUTPUT *const output,
+    const int32_t index, const int32_t xv, const int32_t yv, const int32_t zv,
+    const double xs, const double ys, const double persp)
+{
+    const double zv_d = zv;
+    const bool is_near = zv_d < proj->near_z;
+
+    const bool is_left = xs < proj->left;
+    const bool is_right = !is_left & (xs > proj->right);
+    const bool is_top = ys < proj->top;
+    const bool is_bottom = !is_top & (ys > proj->bottom);
+    const int16_t screen_clip =
+        is_left | (is_right << 1) | (is_top << 2) | (is_bottom << 3);
+    const int16_t clip = is_near ? proj->near_clip : screen_clip;
+
+    const double zv_biased =
+        zv_d >= proj->far_z ? proj->far_z : zv_d + proj->z_bias;
+    const double zv_out = is_near ? zv_d : zv_biased;
+
+    const size_t stride = output->stride;
+    M_OUTPUT(float, output->xv, index, stride) = xv;
+    M_OUTPUT(float, output->yv, index, stride) = yv;
+    M_OUTPUT(float, output->zv, index, stride) = zv_out;
+    M_OUTPUT(float, output->xs, index, stride) = xs;
+    M_OUTPUT(float, output->ys, index, stride) = ys;
+    M_OUTPUT(int16_t, output->clip, index, stride) = clip;
+    if (output->rhw != NULL) {
+        M_OUTPUT(float, output->rhw, index, stride) = persp * proj->rhw_scale;
+    }
+    if (output->zv_int != NULL) {
+        output->zv_int[index] = zv;
+    }
+    return clip;
+}
+
+static uint16_t M_TransformRange(
+    const MATH_PROJECTION *const proj, const int16_t *const vertices,
+    const int32_t stride, const int32_t start, const int32_t end,
+    const MATH_VERTEX_OUTPUT *const output)
+{
+    const int32_t *const m = proj->matrix;
+    uint16_t total_clip = 0xFFFF;
+    for (int32_t i = start; i < end; i++) {
+        const int16_t *const vertex = &vertices[i * stride];
+        const int32_t xv = M_Dot(&m[0], vertex[0], vertex[1], vertex[2]);
+        const int32_t yv = M_Dot(&m[4], vertex[0], vertex[1], vertex[2]);
+        const int32_t zv = M_Dot(&m[8], vertex[0], vertex[1], vertex[2]);
+
+        const double zv_d = zv;
+        const double persp = zv_d < proj->near_z ? 0.0 : proj->persp / zv_d;
+        const double xs = M_MADD((double)xv, persp, proj->center_x);
+        const double ys = M_MADD((double)yv, persp, proj->center_y);
+
+        total_clip &=
+            M_StoreVertex(proj, output, i, xv, yv, zv, xs, ys, persp);
+    }
+    return total_clip;
+}
+
+#if defined(M_USE_SSE2)
+static inline __m128i M_MulLo_SSE2(const __m128i a, const __m128i b)
+{
+    // SSE2 has no 32-bit multiply that keeps the low halves, so multiply the
+    // even and odd lanes separately and interleave the results.
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd =
+        _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(
+        _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline __m128i M_Dot_SSE2(
+    const int32_t *const row, const __m128i x, const __m128i y,
+    const __m128i z)
+{
+    __m128i result = _mm_set1_epi32(row[3]);
+    result = _mm_add_epi32(result, M_MulLo_SSE2(_mm_set1_epi32(row[0]), x));
+    result = _mm_add_epi32(result, M_MulLo_SSE2(_mm_set1_epi32(row[1]), y));
+    result = _mm_add_epi32(result, M_MulLo_SSE2(_mm_set1_epi32(row[2]), z));
+    return result;
+}
+
+static void M_TransformBlock_SSE2(
+    const MATH_PROJECTION *const proj, const int16_t *const v,
+    const int32_t s, BLOCK *const block)
+{
+    const int32_t *const m = proj->matrix;
+    const __m128i x = _mm_setr_epi32(v[0], v[s], v[s * 2], v[s * 3]);
+    const __m128i y =
+        _mm_setr_epi32(v[1], v[s + 1], v[s * 2 + 1], v[s * 3 + 1]);
+    const __m128i z =
+        _mm_setr_epi32(v[2], v[s + 2], v[s * 2 + 2], v[s * 3 + 2]);
+
+    const __m128i xv = M_Dot_SSE2(&m[0], x, y, z);
+    const __m128i yv = M_Dot_SSE2(&m[4], x, y, z);
+    const __m128i zv = M_Dot_SSE2(&m[8], x, y, z);
+    _mm_storeu_si128((__m128i *)block->xv, xv);
+    _mm_storeu_si128((__m128i *)block->yv, yv);
+    _mm_storeu_si128((__m128i *)block->zv, zv);
+
+    const __m128d near_z = _mm_set1_pd(proj->near_z);
+    const __m128d persp = _mm_set1_pd(proj->persp);
+    const __m128d center_x = _mm_set1_pd(proj->center_x);
+    const __m128d center_y = _mm_set1_pd(proj->center_y);
+    const __m128i halves[3][2] = {
+        { xv, _mm_unpackhi_epi64(xv, xv) },
+        { yv, _mm_unpackhi_epi64(yv, yv) },
+        { zv, _mm_unpackhi_epi64(zv, zv) },
+    };
+    for (int32_t half = 0; half < 2; half++) {
+        const __m128d xv_d = _mm_cvtepi32_pd(halves[0][half]);
+        const __m128d yv_d = _mm_cvtepi32_pd(halves[1][half]);
+        const __m128d zv_d = _mm_cvtepi32_pd(halves[2][half]);
+
+        const __m128d is_near = _mm_cmplt_pd(zv_d, near_z);
+        const __m128d p = _mm_andnot_pd(is_near, _mm_div_pd(persp, zv_d));
+        const __m128d xs = _mm_add_pd(_mm_mul_pd(xv_d, p), center_x);
+        const __m128d ys = _mm_add_pd(_mm_mul_pd(yv_d, p), center_y);
+        _mm_storeu_pd(&block->persp[half * 2], p);
+        _mm_storeu_pd(&block->xs[half * 2], xs);
+        _mm_storeu_pd(&block->ys[half * 2], ys);
+    }
+}
+#endif
+
+#if defined(M_USE_AVX2)
+__attribute__((target("avx2"))) static inline __m256i M_Dot_AVX2(
+    const int32_t *const row, const __m256i x, const __m256i y,
+    const __m256i z)
+{
+    __m256i result = _mm256_set1_epi32(row[3]);
+    result = _mm256_add_epi32(
+        result, _mm256_mullo_epi32(_mm256_set1_epi32(row[0]), x));
+    result = _mm256_add_epi32(
+        result, _mm256_mullo_epi32(_mm256_set1_epi32(row[1]), y));
+    result = _mm256_add_epi32(
+        result, _mm256_mullo_epi32(_mm256_set1_epi32(row[2]), z));
+    return result;
+}
+
+__attribute__((target("avx2"))) static void M_TransformBlock_AVX2(
+    const MATH_PROJECTION *const proj, const int16_t *const v,
+    const int32_t s, BLOCK *const block)
+{
+    const int32_t *const m = proj->matrix;
+    const __m256i x = _mm256_setr_epi32(
+        v[0], v[s], v[s * 2], v[s * 3], v[s * 4], v[s * 5], v[s * 6],
+        v[s * 7]);
+    const __m256i y = _mm256_setr_epi32(
+        v[1], v[s + 1], v[s * 2 + 1], v[s * 3 + 1], v[s * 4 + 1],
+        v[s * 5 + 1], v[s * 6 + 1], v[s * 7 + 1]);
+    const __m256i z = _mm256_setr_epi32(
+        v[2], v[s + 2], v[s * 2 + 2], v[s * 3 + 2], v[s * 4 + 2],
+        v[s * 5 + 2], v[s * 6 + 2], v[s * 7 + 2]);
+
+    const __m256i xv = M_Dot_AVX2(&m[0], x, y, z);
+    const __m256i yv = M_Dot_AVX2(&m[4], x, y, z);
+    const __m256i zv = M_Dot_AVX2(&m[8], x, y, z);
+    _mm256_storeu_si256((__m256i *)block->xv, xv);
+    _mm256_storeu_si256((__m256i *)block->yv, yv);
+    _mm256_storeu_si256((__m256i *)block->zv, zv);
+
+    const __m256d near_z = _mm256_set1_pd(proj->near_z);
+    const __m256d persp = _mm256_set1_pd(proj->persp);
+    const __m256d center_x = _mm256_set1_pd(proj->center_x);
+    const __m256d center_y = _mm256_set1_pd(proj->center_y);
+    const __m128i halves[3][2] = {
+        { _mm256_castsi256_si128(xv), _mm256_extracti128_si256(xv, 1) },
+        { _mm256_castsi256_si128(yv), _mm256_extracti128_si256(yv, 1) },
+        { _mm256_castsi256_si128(zv), _mm256_extracti128_si256(zv, 1) },
+    };
+    for (int32_t half = 0; half < 2; half++) {
+        const __m256d xv_d = _mm256_cvtepi32_pd(halves[0][half]);
+        const __m256d yv_d = _mm256_cvtepi32_pd(halves[1][half]);
+        const __m256d zv_d = _mm256_cvtepi32_pd(halves[2][half]);
+
+        const __m256d is_near = _mm256_cmp_pd(zv_d, near_z, _CMP_LT_OQ);
+        const __m256d p =
+            _mm256_andnot_pd(is_near, _mm256_div_pd(persp, zv_d));
+        const __m256d xs = _mm256_add_pd(_mm256_mul_pd(xv_d, p), center_x);
+        const __m256d ys = _mm256_add_pd(_mm256_mul_pd(yv_d, p), center_y);
+        _mm256_storeu_pd(&block->persp[half * 4], p);
+        _mm256_storeu_pd(&block->xs[half * 4], xs);
+        _mm256_storeu_pd(&block->ys[half * 4], ys);
+    }
+}
+#endif
+
+#if defined(M_USE_NEON)
+static inline int32x4_t M_Dot_NEON(
+    const int32_t *const row, const int32x4_t x, const int32x4_t y,
+    const int32x4_t z)
+{
+    int32x4_t result = vdupq_n_s32(row[3]);
+    result = vmlaq_n_s32(result, x, row[0]);
+    result = vmlaq_n_s32(result, y, row[1]);
+    result = vmlaq_n_s32(result, z, row[2]);
+    return result;
+}
+
+static void M_TransformBlock_NEON(
+    const MATH_PROJECTION *const proj, const int16_t *const v,
+    const int32_t s, BLOCK *const block)
+{
+    const int32_t *const m = proj->matrix;
+    const int32_t xs_in[4] = { v[0], v[s], v[s * 2], v[s * 3] };
+    const int32_t ys_in[4] = { v[1], v[s + 1], v[s * 2 + 1], v[s * 3 + 1] };
+    const int32_t zs_in[4] = { v[2], v[s + 2], v[s * 2 + 2], v[s * 3 + 2] };
+    const int32x4_t x = vld1q_s32(xs_in);
+    const int32x4_t y = vld1q_s32(ys_in);
+    const int32x4_t z = vld1q_s32(zs_in);
+
+    const int32x4_t xv = M_Dot_NEON(&m[0], x, y, z);
+    const int32x4_t yv = M_Dot_NEON(&m[4], x, y, z);
+    const int32x4_t zv = M_Dot_NEON(&m[8], x, y, z);
+    vst1q_s32(block->xv, xv);
+    vst1q_s32(block->yv, yv);
+    vst1q_s32(block->zv, zv);
+
+    const float64x2_t near_z = vdupq_n_f64(proj->near_z);
+    const float64x2_t persp = vdupq_n_f64(proj->persp);
+    const float64x2_t center_x = vdupq_n_f64(proj->center_x);
+    const float64x2_t center_y = vdupq_n_f64(proj->center_y);
+    const int64x2_t halves[3][2] = {
+        { vmovl_s32(vget_low_s32(xv)), vmovl_high_s32(xv) },
+        { vmovl_s32(vget_low_s32(yv)), vmovl_high_s32(yv) },
+        { vmovl_s32(vget_low_s32(zv)), vmovl_high_s32(zv) },
+    };
+    for (int32_t half = 0; half < 2; half++) {
+        const float64x2_t xv_d = vcvtq_f64_s64(halves[0][half]);
+        const float64x2_t yv_d = vcvtq_f64_s64(halves[1][half]);
+        const float64x2_t zv_d = vcvtq_f64_s64(halves[2][half]);
+
+        const uint64x2_t is_near = vcltq_f64(zv_d, near_z);
+        const float64x2_t p = vreinterpretq_f64_u64(vbicq_u64(
+            vreinterpretq_u64_f64(vdivq_f64(persp, zv_d)), is_near));
+        const float64x2_t xs = vfmaq_f64(center_x, xv_d, p);
+        const float64x2_t ys = vfmaq_f64(center_y, yv_d, p);
+        vst1q_f64(&block->persp[half * 2], p);
+        vst1q_f64(&block->xs[half * 2], xs);
+        vst1q_f64(&block->ys[half * 2], ys);
+    }
+}
+#endif
+
+static uint16_t M_TransformBlocks(
+    const MATH_PROJECTION *const proj, const int16_t *const vertices,
+    const int32_t stride, const int32_t count,
+    const MATH_VERTEX_OUTPUT *const output)
+{
+    uint16_t total_clip = 0xFFFF;
+    int32_t i = 0;
+    if (m_BlockFunc != NULL) {
+        BLOCK block;
+        for (; i + m_BlockSize <= count; i += m_BlockSize) {
+            m_BlockFunc(proj, &vertices[i * stride], stride, &block);
+            for (int32_t j = 0; j < m_BlockSize; j++) {
+                total_clip &= M_StoreVertex(
+                    proj, output, i + j, block.xv[j], block.yv[j],
+                    block.zv[j], block.xs[j], block.ys[j], block.persp[j]);
+            }
+        }
+    }
+
+    return total_clip
+        & M_TransformRange(proj, vertices, stride, i, count, output);
+}
+
+// Transforms a fixed set of vertices with the selected kernel and with the
+// plain C path, and tells whether the results are bit for bit the same.
+static bool M_CheckKernel(void)
+{
+    typedef struct {
+        float xv;
+        float yv;
+        float zv;
+        float xs;
+        float ys;
+        float rhw;
+        int16_t clip;
+    } CHECK_VERTEX;
+
+    // Some rotation and translation, with the vertices spread so that the
+    // set covers every clip code, the near plane and both Z limits.
+    const int32_t matrix[12] = {
+        14189, 0,     -8192, 1000 << 14,  -2048, 16255,
+        -3547, -500 << 14,   8192,        1774,  14189, 4000 << 14,
+    };
+    const MATH_PROJECTION proj = {
+        .matrix = matrix,
+        .persp = 400.0,
+        .center_x = 320.0,
+        .center_y = 240.0,
+        .near_z = 20 << 14,
+        .far_z = 70000000.0,
+        .z_bias = 1 << 22,
+        .rhw_scale = 1.0 / 400.0,
+        .left = 0.0,
+        .top = 0.0,
+        .right = 640.0,
+        .bottom = 480.0,
+        .near_clip = (int16_t)0x8000,
+    };
+
+    int16_t vertices[CHECK_COUNT * 3];
+    uint32_t seed = 0x12345678;
+    for (int32_t i = 0; i < CHECK_COUNT * 3; i++) {
+        seed = seed * 1103515245 + 12345;
+        vertices[i] = (int16_t)((seed >> 16) & 0x3FFF) - 0x2000;
+    }
+
+    CHECK_VERTEX results[2][CHECK_COUNT] = {};
+    int32_t zv_int[2][CHECK_COUNT] = {};
+    uint16_t total_clip[2];
+    for (int32_t i = 0; i < 2; i++) {
+        const MATH_VERTEX_OUTPUT output = {
+            .stride = sizeof(CHECK_VERTEX),
+            .xv = &results[i][0].xv,
+            .yv = &results[i][0].yv,
+            .zv = &results[i][0].zv,
+            .xs = &results[i][0].xs,
+            .ys = &results[i][0].ys,
+            .rhw = &results[i][0].rhw,
+            .clip = &results[i][0].clip,
+            .zv_int = zv_int[i],
+        };
+        total_clip[i] = i == 0
+            ? M_TransformBlocks(&proj, vertices, 3, CHECK_COUNT, &output)
+            : M_TransformRange(&proj, vertices, 3, 0, CHECK_COUNT, &output);
+    }
+
+    return total_clip[0] == total_clip[1]
+        && memcmp(results[0], results[1], sizeof(results[0])) == 0
+        && memcmp(zv_int[0], zv_int[1], sizeof(zv_int[0])) == 0;
+}
+
+static void M_SelectKernel(void)
+{
+    m_KernelSelected = true;
+#if defined(M_USE_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        m_BlockFunc = M_TransformBlock_AVX2;
+        m_BlockSize = 8;
+    }
+#endif
+#if defined(M_USE_SSE2)
+    if (m_BlockFunc == NULL) {
+        m_BlockFunc = M_TransformBlock_SSE2;
+        m_BlockSize = 4;
+    }
+#elif defined(M_USE_NEON)
+    m_BlockFunc = M_TransformBlock_NEON;
+    m_BlockSize = 4;
+#endif
+
+    if (m_BlockFunc != NULL && !M_CheckKernel()) {
+        LOG_WARNING(
+            "Vectorised vertex transform does not match the plain C version, "
+            "falling back to it");
+        m_BlockFunc = NULL;
+        m_BlockSize = 0;
+    }
+}
+
+uint16_t Math_TransformVertices(
+    const MATH_PROJECTION *const proj, const int16_t *const vertices,
+    const int32_t stride, const int32_t count,
+    const MATH_VERTEX_OUTPUT *const output)
+{
+    if (!m_KernelSelected) {
+        M_SelectKernel();
+    }
+    return M_TransformBlocks(proj, vertices, stride, count, output);
+}
@@ -3,12 +3,80 @@
 #include "game/anims.h"
 #include "game/gamebuf.h"
 
+#include <SDL2/SDL_atomic.h>
+
+#define MAX_TYPE_SETS 32
+#define TYPE_SET_WORDS ((O_NUMBER_OF + 31) / 32)
+
+// Membership bitsets for the object type arrays, built the first time an
+// array is queried. Entries are only ever appended, and the count is
+// published after the entry is complete, so lookups do not need the lock.
+typedef struct {
+    const GAME_OBJECT_ID *test_arr;
+    uint32_t bits[TYPE_SET_WORDS];
+} M_TYPE_SET;
+
 static OBJECT_MESH **m_MeshPointers = NULL;
 static int32_t m_MeshCount = 0;
+static M_TYPE_SET m_TypeSets[MAX_TYPE_SETS] = {};
+static SDL_atomic_t m_TypeSetCount = {};
+static SDL_SpinLock m_TypeSetLock = 0;
+
+static const M_TYPE_SET *M_FindTypeSet(
+    const GAME_OBJECT_ID *test_arr, int32_t count);
+static const M_TYPE_SET *M_GetTypeSet(const GAME_OBJECT_ID *test_arr);
+
+static const M_TYPE_SET *M_FindTypeSet(
+    const GAME_OBJECT_ID *const test_arr, const int32_t count)
+{
+    for (int32_t i = 0; i < count; i++) {
+        if (m_TypeSets[i].test_arr == test_arr) {
+            return &m_TypeSets[i];
+        }
+    }
+    return NULL;
+}
+
+static const M_TYPE_SET *M_GetTypeSet(const GAME_OBJECT_ID *const test_arr)
+{
+    const M_TYPE_SET *set =
+        M_FindTypeSet(test_arr, SDL_AtomicGet(&m_TypeSetCount));
+    if (set != NULL) {
+        return set;
+    }
+
+    SDL_AtomicLock(&m_TypeSetLock);
+    const int32_t count = SDL_AtomicGet(&m_TypeSetCount);
+    set = M_FindTypeSet(test_arr, count);
+    if (set == NULL && count < MAX_TYPE_SETS) {
+        M_TYPE_SET *const new_set = &m_TypeSets[count];
+        new_set->test_arr = test_arr;
+        for (int32_t i = 0; test_arr[i] != NO_OBJECT; i++) {
+            const GAME_OBJECT_ID object_id = test_arr[i];
+            if (object_id < 0 || object_id >= O_NUMBER_OF) {
+                continue;
+            }
+            new_set->bits[object_id / 32] |= 1u << (object_id % 32);
+        }
+        SDL_AtomicSet(&m_TypeSetCount, count + 1);
+        set = new_set;
+    }
+    SDL_AtomicUnlock(&m_TypeSetLock);
+    return set;
+}
 
 bool Object_IsObjectType(
     GAME_OBJECT_ID object_id, const GAME_OBJECT_ID *test_arr)
 {
+    if (object_id < 0 || object_id >= O_NUMBER_OF) {
+        return false;
+    }
+
+    const M_TYPE_SET *const set = M_GetTypeSet(test_arr);
+    if (set != NULL) {
+        return (set->bits[object_id / 32] >> (object_id % 32)) & 1;
+    }
+
     for (int i = 0; test_arr[i] != NO_OBJECT; i++) {
         if (test_arr[i] == object_id) {
             return true;
@@ -1,10 +1,14 @@
 #include "game/phase/executor.h"
 
 #include "game/clock.h"
+#include "game/frame_stats.h"
 #include "game/game.h"
 #include "game/gameflow.h"
+#include "game/headless.h"
 #include "game/interpolation.h"
 #include "game/output.h"
+#include "game/shell.h"
+#include "profiler.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -27,7 +31,11 @@ static PHASE_CONTROL M_Control(PHASE *const phase, const int32_t nframes)
         return (PHASE_CONTROL) { .action = PHASE_ACTION_END, .gf_cmd = gf_cmd };
     }
     if (phase != NULL && phase->control != NULL) {
-        return phase->control(phase, nframes);
+        PROFILER_ZONE zone;
+        Profiler_BeginZone(&zone, "Control");
+        const PHASE_CONTROL control = phase->control(phase, nframes);
+        Profiler_EndZone(&zone);
+        return control;
     }
     return (PHASE_CONTROL) {
         .action = PHASE_ACTION_END,
@@ -37,20 +45,33 @@ static PHASE_CONTROL M_Control(PHASE *const phase, const int32_t nframes)
 
 static void M_Draw(PHASE *const phase)
 {
+    if (Headless_IsEnabled()) {
+        // Output_EndScene normally pumps the event queue; without it quit
+        // requests and SIGINT would go unnoticed.
+        Shell_ProcessEvents();
+        return;
+    }
+    PROFILER_ZONE zone;
+    Profiler_BeginZone(&zone, "Draw");
     Output_BeginScene();
     if (phase != NULL && phase->draw != NULL) {
         phase->draw(phase);
     }
     Output_EndScene();
+    Profiler_EndZone(&zone);
+    FrameStats_Mark(FRAME_STATS_DRAW);
 }
 
 static int32_t M_Wait(PHASE *const phase)
 {
+    int32_t nframes;
     if (phase != NULL && phase->wait != NULL) {
-        return phase->wait(phase);
+        nframes = phase->wait(phase);
     } else {
-        return Clock_WaitTick();
+        nframes = Clock_WaitTick();
     }
+    FrameStats_Mark(FRAME_STATS_WAIT);
+    return nframes;
 }
 
 GAME_FLOW_COMMAND PhaseExecutor_Run(PHASE *const phase)
@@ -79,6 +100,7 @@ GAME_FLOW_COMMAND PhaseExecutor_Run(PHASE *const phase)
     int32_t nframes = Clock_WaitTick();
     while (true) {
         const PHASE_CONTROL control = M_Control(phase, nframes);
+        FrameStats_Mark(FRAME_STATS_CONTROL);
 
         if (control.action == PHASE_ACTION_END) {
             if (Game_IsExiting()) {
@@ -101,6 +123,8 @@ GAME_FLOW_COMMAND PhaseExecutor_Run(PHASE *const phase)
             Interpolation_SetRate(1.0);
             M_Draw(phase);
             nframes += M_Wait(phase);
+            Profiler_EndFrame();
+            FrameStats_EndFrame();
         }
     }
 
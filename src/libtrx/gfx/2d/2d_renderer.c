@@ -3,11 +3,13 @@
 #include "debug.h"
 #include "gfx/context.h"
 #include "gfx/gl/gl_core_3_3.h"
+#include "gfx/gl/ring_buffer.h"
 #include "gfx/gl/utils.h"
 #include "log.h"
 #include "memory.h"
 #include "utils.h"
 
+#include <stddef.h>
 #include <string.h>
 
 typedef enum {
@@ -31,7 +33,7 @@ typedef struct {
 
 struct GFX_2D_RENDERER {
     GFX_GL_VERTEX_ARRAY vertex_format;
-    GFX_GL_BUFFER surface_buffer;
+    GFX_GL_RING_BUFFER surface_buffer;
     GFX_GL_TEXTURE surface_texture;
     GFX_GL_TEXTURE palette_texture;
     GFX_GL_TEXTURE alpha_texture;
@@ -56,6 +58,8 @@ struct GFX_2D_RENDERER {
     GLint loc[M_UNIFORM_NUMBER_OF];
 } M_PRIV;
 
+#define SURFACE_BUFFER_SIZE (3 * 64 * 1024)
+
 static const M_VERTEX m_Vertices[] = {
     { .x = 0.0, .y = 0.0, .u = 0.0, .v = 0.0 },
     { .x = 1.0, .y = 0.0, .u = 1.0, .v = 0.0 },
@@ -65,6 +69,24 @@ static const M_VERTEX m_Vertices[] = {
     { .x = 1.0, .y = 1.0, .u = 1.0, .v = 1.0 },
 };
 
+static void M_SetVertices(
+    GFX_2D_RENDERER *const r, const M_VERTEX *const vertices,
+    const int32_t count)
+{
+    // Stream the vertices so that replacing them while the previous ones are
+    // still being drawn does not stall.
+    const size_t offset = GFX_GL_RingBuffer_Push(
+        &r->surface_buffer, vertices, count * sizeof(M_VERTEX));
+    GFX_GL_VertexArray_Bind(&r->vertex_format);
+    GFX_GL_VertexArray_Attribute(
+        &r->vertex_format, 0, 2, GL_FLOAT, GL_FALSE, sizeof(M_VERTEX),
+        offset + offsetof(M_VERTEX, x));
+    GFX_GL_VertexArray_Attribute(
+        &r->vertex_format, 1, 2, GL_FLOAT, GL_FALSE, sizeof(M_VERTEX),
+        offset + offsetof(M_VERTEX, u));
+    GFX_GL_CheckError();
+}
+
 static void M_UploadVertices(GFX_2D_RENDERER *const r)
 {
     const int32_t mapping[] = { 0, 1, 3, 3, 1, 2 };
@@ -92,10 +114,7 @@ static void M_UploadVertices(GFX_2D_RENDERER *const r)
         }
     }
     LOG_DEBUG("%d %d", r->repeat.x, r->repeat.y);
-    GFX_GL_Buffer_Bind(&r->surface_buffer);
-    GFX_GL_Buffer_Data(
-        &r->surface_buffer, sizeof(M_VERTEX) * 6 * r->repeat.x * r->repeat.y,
-        r->vertices, GL_STATIC_DRAW);
+    M_SetVertices(r, r->vertices, r->vertex_count);
 }
 
 GFX_2D_RENDERER *GFX_2D_Renderer_Create(void)
@@ -115,18 +134,11 @@ GFX_2D_RENDERER *GFX_2D_Renderer_Create(void)
     r->vertex_count = 6;
     r->vertex_format.initialized = false;
 
-    GFX_GL_Buffer_Init(&r->surface_buffer, GL_ARRAY_BUFFER);
-    GFX_GL_Buffer_Bind(&r->surface_buffer);
-    GFX_GL_Buffer_Data(
-        &r->surface_buffer, sizeof(m_Vertices), m_Vertices, GL_STATIC_DRAW);
-
+    GFX_GL_RingBuffer_Init(
+        &r->surface_buffer, GL_ARRAY_BUFFER, SURFACE_BUFFER_SIZE,
+        config->backend);
     GFX_GL_VertexArray_Init(&r->vertex_format);
-    GFX_GL_VertexArray_Bind(&r->vertex_format);
-    GFX_GL_VertexArray_Attribute(
-        &r->vertex_format, 0, 2, GL_FLOAT, GL_FALSE, 16, 0);
-    GFX_GL_VertexArray_Attribute(
-        &r->vertex_format, 1, 2, GL_FLOAT, GL_FALSE, 16, 8);
-    GFX_GL_CheckError();
+    M_SetVertices(r, m_Vertices, 6);
 
     GFX_GL_Texture_Init(&r->surface_texture, GL_TEXTURE_2D);
     GFX_GL_Texture_Init(&r->palette_texture, GL_TEXTURE_1D);
@@ -183,7 +195,7 @@ void GFX_2D_Renderer_Destroy(GFX_2D_RENDERER *const r)
     ASSERT(r != NULL);
 
     GFX_GL_VertexArray_Close(&r->vertex_format);
-    GFX_GL_Buffer_Close(&r->surface_buffer);
+    GFX_GL_RingBuffer_Close(&r->surface_buffer);
     GFX_GL_Texture_Close(&r->surface_texture);
     GFX_GL_Texture_Close(&r->palette_texture);
     GFX_GL_Texture_Close(&r->alpha_texture);
@@ -386,7 +398,6 @@ void GFX_2D_Renderer_Render(GFX_2D_RENDERER *const r)
     ASSERT(r != NULL);
 
     GFX_GL_Program_Bind(&r->program);
-    GFX_GL_Buffer_Bind(&r->surface_buffer);
     GFX_GL_VertexArray_Bind(&r->vertex_format);
 
     glActiveTexture(GL_TEXTURE0);
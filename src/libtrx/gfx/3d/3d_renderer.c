@@ -5,8 +5,17 @@
 #include "gfx/gl/utils.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
 
 #include <stddef.h>
+#include <string.h>
+
+// With the OpenGL 3.3 backend, all texture pages live in a single texture
+// array and every vertex carries the layer it samples from, so switching
+// pages does not break the batch. These values must match the shader.
+#define LAYER_NONE (-1.0f)
+#define LAYER_ENV_MAP (-2.0f)
+#define TEXTURE_ARRAY_MIN_CAPACITY 16
 
 struct GFX_3D_RENDERER {
     const GFX_CONFIG *config;
@@ -18,8 +27,26 @@ struct GFX_3D_RENDERER {
     GFX_GL_TEXTURE *textures[GFX_MAX_TEXTURES];
     GFX_GL_TEXTURE *env_map_texture;
     int selected_texture_num;
+    bool is_texturing_enabled;
     GFX_BLEND_MODE selected_blend_mode;
 
+    bool use_texture_array;
+    // Created on first use, as only some games draw rooms through it.
+    GFX_3D_ROOM_RENDERER *room_renderer;
+    GLfloat projection[4][4];
+    bool is_smoothing_enabled;
+    bool is_alpha_point_discard;
+    float alpha_threshold;
+    float brightness_multiplier;
+    struct {
+        GFX_GL_TEXTURE *texture;
+        int width;
+        int height;
+        int capacity;
+        bool is_used[GFX_MAX_TEXTURES];
+        bool needs_mipmaps;
+    } texture_array;
+
     // shader variable locations
     GLint loc_mat_projection;
     GLint loc_mat_model_view;
@@ -31,20 +58,194 @@ struct GFX_3D_RENDERER {
 };
 
 static void M_Flush(GFX_3D_RENDERER *renderer);
+static void M_UpdateLayer(GFX_3D_RENDERER *renderer);
+static void M_BindTextureArray(GFX_3D_RENDERER *renderer);
+static bool M_IsTextureArrayUsed(const GFX_3D_RENDERER *renderer);
+static void M_GrowTextureArray(GFX_3D_RENDERER *renderer, int min_capacity);
+static int M_RegisterTextureLayer(
+    GFX_3D_RENDERER *renderer, const void *data, int width, int height);
+static bool M_UnregisterTextureLayer(
+    GFX_3D_RENDERER *renderer, int texture_num);
 static void M_SelectTextureImpl(GFX_3D_RENDERER *renderer, int texture_num);
 static void M_RestoreTexture(GFX_3D_RENDERER *const renderer);
+static GFX_3D_ROOM_RENDERER *M_GetRoomRenderer(GFX_3D_RENDERER *renderer);
 
 static void M_Flush(GFX_3D_RENDERER *const renderer)
 {
+    if (!renderer->vertex_stream.pending_vertices.count) {
+        return;
+    }
+
     glLineWidth(renderer->config->line_width);
     glPolygonMode(
         GL_FRONT_AND_BACK,
         renderer->config->enable_wireframe ? GL_LINE : GL_FILL);
     GFX_GL_CheckError();
 
+    if (renderer->use_texture_array) {
+        // Other renderers may have used the texture units in the meantime.
+        M_BindTextureArray(renderer);
+    }
+
     GFX_3D_VertexStream_RenderPending(&renderer->vertex_stream);
 }
 
+static void M_UpdateLayer(GFX_3D_RENDERER *const renderer)
+{
+    float layer = LAYER_NONE;
+    if (renderer->is_texturing_enabled) {
+        if (renderer->selected_texture_num == GFX_ENV_MAP_TEXTURE) {
+            layer = LAYER_ENV_MAP;
+        } else if (renderer->selected_texture_num >= 0) {
+            layer = renderer->selected_texture_num;
+        }
+    }
+    GFX_3D_VertexStream_SetLayer(&renderer->vertex_stream, layer);
+}
+
+static void M_BindTextureArray(GFX_3D_RENDERER *const renderer)
+{
+    glActiveTexture(GL_TEXTURE1);
+    if (renderer->env_map_texture != NULL) {
+        GFX_GL_Texture_Bind(renderer->env_map_texture);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    GFX_GL_CheckError();
+
+    GFX_GL_TEXTURE *const texture = renderer->texture_array.texture;
+    if (texture == NULL) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        GFX_GL_CheckError();
+        return;
+    }
+
+    // Mipmaps are generated once all pages of a level are uploaded, rather
+    // than after every single page.
+    if (renderer->texture_array.needs_mipmaps) {
+        GFX_GL_Texture_GenerateMipmap(texture);
+        renderer->texture_array.needs_mipmaps = false;
+    }
+    GFX_GL_Texture_Bind(texture);
+}
+
+static bool M_IsTextureArrayUsed(const GFX_3D_RENDERER *const renderer)
+{
+    for (int i = 0; i < renderer->texture_array.capacity; i++) {
+        if (renderer->texture_array.is_used[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void M_GrowTextureArray(
+    GFX_3D_RENDERER *const renderer, const int min_capacity)
+{
+    const int old_capacity = renderer->texture_array.capacity;
+    int new_capacity = MAX(old_capacity * 2, TEXTURE_ARRAY_MIN_CAPACITY);
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    new_capacity = MIN(new_capacity, GFX_MAX_TEXTURES);
+
+    const int width = renderer->texture_array.width;
+    const int height = renderer->texture_array.height;
+    const size_t layer_size = width * height * 4;
+
+    // OpenGL 3.3 cannot copy between textures directly, so the pages that
+    // are already uploaded make a round trip through the CPU.
+    char *old_data = NULL;
+    if (renderer->texture_array.texture == NULL) {
+        renderer->texture_array.texture =
+            GFX_GL_Texture_Create(GL_TEXTURE_2D_ARRAY);
+    } else if (old_capacity > 0 && M_IsTextureArrayUsed(renderer)) {
+        old_data = Memory_Alloc(layer_size * old_capacity);
+        GFX_GL_Texture_Bind(renderer->texture_array.texture);
+        glGetTexImage(
+            GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, old_data);
+        GFX_GL_CheckError();
+    }
+
+    LOG_INFO("Texture array resize: %d -> %d", old_capacity, new_capacity);
+    GFX_GL_Texture_LoadArray(
+        renderer->texture_array.texture, NULL, width, height, new_capacity,
+        GL_RGBA, GL_RGBA);
+    if (old_data != NULL) {
+        for (int i = 0; i < old_capacity; i++) {
+            if (renderer->texture_array.is_used[i]) {
+                GFX_GL_Texture_LoadArrayLayer(
+                    renderer->texture_array.texture, i,
+                    old_data + layer_size * i, width, height, GL_RGBA);
+            }
+        }
+        Memory_FreePointer(&old_data);
+    }
+
+    renderer->texture_array.capacity = new_capacity;
+    renderer->texture_array.needs_mipmaps = true;
+}
+
+static int M_RegisterTextureLayer(
+    GFX_3D_RENDERER *const renderer, const void *const data, const int width,
+    const int height)
+{
+    int layer = GFX_NO_TEXTURE;
+    for (int i = 0; i < GFX_MAX_TEXTURES; i++) {
+        if (!renderer->texture_array.is_used[i]) {
+            layer = i;
+            break;
+        }
+    }
+    if (layer == GFX_NO_TEXTURE) {
+        LOG_ERROR("Texture array is full");
+        return GFX_NO_TEXTURE;
+    }
+
+    if (width != renderer->texture_array.width
+        || height != renderer->texture_array.height) {
+        if (M_IsTextureArrayUsed(renderer)) {
+            LOG_ERROR(
+                "Texture page size mismatch: %dx%d (expected %dx%d)", width,
+                height, renderer->texture_array.width,
+                renderer->texture_array.height);
+            return GFX_NO_TEXTURE;
+        }
+        renderer->texture_array.width = width;
+        renderer->texture_array.height = height;
+        renderer->texture_array.capacity = 0;
+    }
+
+    if (layer >= renderer->texture_array.capacity) {
+        M_GrowTextureArray(renderer, layer + 1);
+    }
+
+    GFX_GL_Texture_LoadArrayLayer(
+        renderer->texture_array.texture, layer, data, width, height, GL_RGBA);
+    renderer->texture_array.is_used[layer] = true;
+    renderer->texture_array.needs_mipmaps = true;
+    return layer;
+}
+
+static bool M_UnregisterTextureLayer(
+    GFX_3D_RENDERER *const renderer, const int texture_num)
+{
+    if (!renderer->texture_array.is_used[texture_num]) {
+        LOG_ERROR("Invalid texture handle");
+        return false;
+    }
+
+    if (texture_num == renderer->selected_texture_num) {
+        renderer->selected_texture_num = GFX_NO_TEXTURE;
+        M_UpdateLayer(renderer);
+    }
+
+    // The storage is kept around for the pages of the next level.
+    renderer->texture_array.is_used[texture_num] = false;
+    return true;
+}
+
 static void M_SelectTextureImpl(
     GFX_3D_RENDERER *const renderer, const int texture_num)
 {
@@ -71,7 +272,24 @@ static void M_SelectTextureImpl(
 static void M_RestoreTexture(GFX_3D_RENDERER *const renderer)
 {
     ASSERT(renderer != NULL);
-    M_SelectTextureImpl(renderer, renderer->selected_texture_num);
+    if (renderer->use_texture_array) {
+        M_BindTextureArray(renderer);
+    } else {
+        M_SelectTextureImpl(renderer, renderer->selected_texture_num);
+    }
+}
+
+static GFX_3D_ROOM_RENDERER *M_GetRoomRenderer(
+    GFX_3D_RENDERER *const renderer)
+{
+    ASSERT(renderer->use_texture_array);
+    if (renderer->room_renderer == NULL) {
+        renderer->room_renderer = Memory_Alloc(sizeof(GFX_3D_ROOM_RENDERER));
+        GFX_3D_RoomRenderer_Init(
+            renderer->room_renderer, renderer->config->backend);
+        GFX_GL_Program_Bind(&renderer->program);
+    }
+    return renderer->room_renderer;
 }
 
 GFX_3D_RENDERER *GFX_3D_Renderer_Create(void)
@@ -79,14 +297,22 @@ GFX_3D_RENDERER *GFX_3D_Renderer_Create(void)
     LOG_INFO("");
     GFX_3D_RENDERER *const renderer = Memory_Alloc(sizeof(GFX_3D_RENDERER));
     renderer->config = GFX_Context_GetConfig();
+    renderer->use_texture_array = renderer->config->backend == GFX_GL_33C;
+    LOG_INFO(
+        "Texture pages: %s",
+        renderer->use_texture_array ? "texture array" : "separate textures");
 
     renderer->selected_texture_num = GFX_NO_TEXTURE;
+    renderer->is_texturing_enabled = false;
     for (int i = 0; i < GFX_MAX_TEXTURES; i++) {
         renderer->textures[i] = NULL;
     }
 
     GFX_GL_Sampler_Init(&renderer->sampler);
     GFX_GL_Sampler_Bind(&renderer->sampler, 0);
+    if (renderer->use_texture_array) {
+        GFX_GL_Sampler_Bind(&renderer->sampler, 1);
+    }
     GFX_GL_Sampler_Parameterf(
         &renderer->sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, 1);
     GFX_GL_Sampler_Parameteri(
@@ -107,8 +333,12 @@ GFX_3D_RENDERER *GFX_3D_Renderer_Create(void)
         GFX_GL_Program_UniformLocation(&renderer->program, "matProjection");
     renderer->loc_mat_model_view =
         GFX_GL_Program_UniformLocation(&renderer->program, "matModelView");
-    renderer->loc_texturing_enabled =
-        GFX_GL_Program_UniformLocation(&renderer->program, "texturingEnabled");
+    // With the texture array, texturing is a per-vertex property instead.
+    renderer->loc_texturing_enabled = -1;
+    if (!renderer->use_texture_array) {
+        renderer->loc_texturing_enabled = GFX_GL_Program_UniformLocation(
+            &renderer->program, "texturingEnabled");
+    }
     renderer->loc_smoothing_enabled =
         GFX_GL_Program_UniformLocation(&renderer->program, "smoothingEnabled");
     renderer->loc_alpha_point_discard =
@@ -136,8 +366,21 @@ GFX_3D_RENDERER *GFX_3D_Renderer_Create(void)
         &renderer->program, renderer->loc_alpha_threshold, -1.0);
     GFX_GL_Program_Uniform1f(
         &renderer->program, renderer->loc_brightness_multiplier, 1.0);
+    renderer->is_alpha_point_discard = false;
+    renderer->alpha_threshold = -1.0f;
+    renderer->brightness_multiplier = 1.0f;
+    if (renderer->use_texture_array) {
+        GFX_GL_Program_Uniform1i(
+            &renderer->program,
+            GFX_GL_Program_UniformLocation(&renderer->program, "texArray"), 0);
+        GFX_GL_Program_Uniform1i(
+            &renderer->program,
+            GFX_GL_Program_UniformLocation(&renderer->program, "texEnvMap"),
+            1);
+    }
 
-    GFX_3D_VertexStream_Init(&renderer->vertex_stream);
+    GFX_3D_VertexStream_Init(
+        &renderer->vertex_stream, renderer->config->backend);
     return renderer;
 }
 
@@ -146,7 +389,12 @@ void GFX_3D_Renderer_Destroy(GFX_3D_RENDERER *const renderer)
     LOG_INFO("");
     ASSERT(renderer != NULL);
 
+    if (renderer->room_renderer != NULL) {
+        GFX_3D_RoomRenderer_Close(renderer->room_renderer);
+        Memory_FreePointer(&renderer->room_renderer);
+    }
     GFX_3D_VertexStream_Close(&renderer->vertex_stream);
+    GFX_GL_Texture_Free(renderer->texture_array.texture);
     GFX_GL_Program_Close(&renderer->program);
     GFX_GL_Sampler_Close(&renderer->sampler);
     Memory_Free(renderer);
@@ -161,6 +409,9 @@ void GFX_3D_Renderer_RenderBegin(GFX_3D_RENDERER *const renderer)
     GFX_GL_Program_Bind(&renderer->program);
     GFX_3D_VertexStream_Bind(&renderer->vertex_stream);
     GFX_GL_Sampler_Bind(&renderer->sampler, 0);
+    if (renderer->use_texture_array) {
+        GFX_GL_Sampler_Bind(&renderer->sampler, 1);
+    }
 
     M_RestoreTexture(renderer);
 
@@ -168,13 +419,14 @@ void GFX_3D_Renderer_RenderBegin(GFX_3D_RENDERER *const renderer)
     const float top = 0.0f;
     const float right = GFX_Context_GetDisplayWidth();
     const float bottom = GFX_Context_GetDisplayHeight();
-    GLfloat projection[4][4] = {
+    const GLfloat projection[4][4] = {
         { 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
         { 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
         { 0.0f, 0.0f, 1.0f, 0.0f },
         { -(right + left) / (right - left), -(top + bottom) / (top - bottom),
           0.0f, 1.0f },
     };
+    memcpy(renderer->projection, projection, sizeof(projection));
 
     GFX_GL_Program_UniformMatrix4fv(
         &renderer->program, renderer->loc_mat_projection, 1, GL_FALSE,
@@ -231,8 +483,10 @@ bool GFX_3D_Renderer_UnregisterEnvironmentMap(
 
     // unbind texture if currently bound
     if (renderer->selected_texture_num == texture_num) {
+        M_Flush(renderer);
         M_SelectTextureImpl(renderer, GFX_NO_TEXTURE);
         renderer->selected_texture_num = GFX_NO_TEXTURE;
+        M_UpdateLayer(renderer);
     }
 
     GFX_GL_Texture_Free(texture);
@@ -247,7 +501,14 @@ void GFX_3D_Renderer_FillEnvironmentMap(GFX_3D_RENDERER *const renderer)
     GFX_GL_TEXTURE *const env_map = renderer->env_map_texture;
     if (env_map != NULL) {
         M_Flush(renderer);
-        GFX_GL_Texture_LoadFromBackBuffer(env_map);
+        if (renderer->use_texture_array) {
+            glActiveTexture(GL_TEXTURE1);
+            GFX_GL_Texture_LoadFromBackBuffer(env_map);
+            glActiveTexture(GL_TEXTURE0);
+            GFX_GL_CheckError();
+        } else {
+            GFX_GL_Texture_LoadFromBackBuffer(env_map);
+        }
         M_RestoreTexture(renderer);
     }
 }
@@ -258,6 +519,10 @@ int GFX_3D_Renderer_RegisterTexturePage(
 {
     ASSERT(renderer != NULL);
     ASSERT(data != NULL);
+    if (renderer->use_texture_array) {
+        return M_RegisterTextureLayer(renderer, data, width, height);
+    }
+
     GFX_GL_TEXTURE *const texture = GFX_GL_Texture_Create(GL_TEXTURE_2D);
     GFX_GL_Texture_Load(texture, data, width, height, GL_RGBA, GL_RGBA);
 
@@ -281,6 +546,9 @@ bool GFX_3D_Renderer_UnregisterTexturePage(
     ASSERT(renderer != NULL);
     ASSERT(texture_num >= 0);
     ASSERT(texture_num < GFX_MAX_TEXTURES);
+    if (renderer->use_texture_array) {
+        return M_UnregisterTextureLayer(renderer, texture_num);
+    }
 
     GFX_GL_TEXTURE *const texture = renderer->textures[texture_num];
     if (!texture) {
@@ -331,9 +599,16 @@ void GFX_3D_Renderer_SelectTexture(
     GFX_3D_RENDERER *const renderer, int texture_num)
 {
     ASSERT(renderer != NULL);
+    if (renderer->use_texture_array) {
+        renderer->selected_texture_num = texture_num;
+        M_UpdateLayer(renderer);
+        return;
+    }
+
     M_Flush(renderer);
     renderer->selected_texture_num = texture_num;
     M_SelectTextureImpl(renderer, texture_num);
+    M_UpdateLayer(renderer);
 }
 
 void GFX_3D_Renderer_SetPrimType(
@@ -359,6 +634,7 @@ void GFX_3D_Renderer_SetTextureFilter(
     GFX_GL_Program_Uniform1i(
         &renderer->program, renderer->loc_smoothing_enabled,
         filter == GFX_TF_BILINEAR);
+    renderer->is_smoothing_enabled = filter == GFX_TF_BILINEAR;
 }
 
 void GFX_3D_Renderer_SetDepthWritesEnabled(
@@ -427,6 +703,7 @@ void GFX_3D_Renderer_SetAlphaPointDiscard(
     GFX_GL_Program_Bind(&renderer->program);
     GFX_GL_Program_Uniform1f(
         &renderer->program, renderer->loc_alpha_point_discard, is_enabled);
+    renderer->is_alpha_point_discard = is_enabled;
 }
 
 void GFX_3D_Renderer_SetAlphaThreshold(
@@ -437,6 +714,7 @@ void GFX_3D_Renderer_SetAlphaThreshold(
     GFX_GL_Program_Bind(&renderer->program);
     GFX_GL_Program_Uniform1f(
         &renderer->program, renderer->loc_alpha_threshold, value);
+    renderer->alpha_threshold = value;
 }
 
 void GFX_3D_Renderer_SetBrightnessMultiplier(
@@ -447,16 +725,24 @@ void GFX_3D_Renderer_SetBrightnessMultiplier(
     GFX_GL_Program_Bind(&renderer->program);
     GFX_GL_Program_Uniform1f(
         &renderer->program, renderer->loc_brightness_multiplier, value);
+    renderer->brightness_multiplier = value;
 }
 
 void GFX_3D_Renderer_SetTexturingEnabled(
     GFX_3D_RENDERER *const renderer, const bool is_enabled)
 {
     ASSERT(renderer != NULL);
+    renderer->is_texturing_enabled = is_enabled;
+    if (renderer->use_texture_array) {
+        M_UpdateLayer(renderer);
+        return;
+    }
+
     M_Flush(renderer);
     GFX_GL_Program_Bind(&renderer->program);
     GFX_GL_Program_Uniform1i(
         &renderer->program, renderer->loc_texturing_enabled, is_enabled);
+    M_UpdateLayer(renderer);
 }
 
 void GFX_3D_Renderer_SetAnisotropyFilter(
@@ -466,3 +752,71 @@ void GFX_3D_Renderer_SetAnisotropyFilter(
     GFX_GL_Sampler_Parameterf(
         &renderer->sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, value);
 }
+
+bool GFX_3D_Renderer_IsRoomGeometrySupported(
+    const GFX_3D_RENDERER *const renderer)
+{
+    ASSERT(renderer != NULL);
+    return renderer->use_texture_array;
+}
+
+void GFX_3D_Renderer_UploadRoomGeometry(
+    GFX_3D_RENDERER *const renderer, const GFX_3D_ROOM_VERTEX *const vertices,
+    const int vertex_count, const uint32_t *const indices,
+    const int index_count)
+{
+    ASSERT(renderer != NULL);
+    M_Flush(renderer);
+    GFX_3D_RoomRenderer_UploadGeometry(
+        M_GetRoomRenderer(renderer), vertices, vertex_count, indices,
+        index_count);
+}
+
+void GFX_3D_Renderer_UploadRoomTextures(
+    GFX_3D_RENDERER *const renderer, const GFX_3D_ROOM_TEXTURE *const textures,
+    const int count)
+{
+    ASSERT(renderer != NULL);
+    M_Flush(renderer);
+    GFX_3D_RoomRenderer_UploadTextures(
+        M_GetRoomRenderer(renderer), textures, count);
+}
+
+void GFX_3D_Renderer_SetRoomTables(
+    GFX_3D_RENDERER *const renderer, const int32_t *const wibble_table,
+    const int32_t *const shade_table)
+{
+    ASSERT(renderer != NULL);
+    M_Flush(renderer);
+    GFX_3D_RoomRenderer_SetTables(
+        M_GetRoomRenderer(renderer), wibble_table, shade_table);
+    GFX_GL_Program_Bind(&renderer->program);
+}
+
+void GFX_3D_Renderer_DrawRoomGeometry(
+    GFX_3D_RENDERER *const renderer, const GFX_3D_ROOM_PARAMS *const params,
+    const int first_index, const int index_count, const int vertex_count)
+{
+    ASSERT(renderer != NULL);
+    ASSERT(renderer->room_renderer != NULL);
+    M_Flush(renderer);
+
+    glPolygonMode(
+        GL_FRONT_AND_BACK,
+        renderer->config->enable_wireframe ? GL_LINE : GL_FILL);
+    M_BindTextureArray(renderer);
+
+    const GFX_3D_ROOM_SHARED_STATE shared = {
+        .projection = &renderer->projection[0][0],
+        .smoothing_enabled = renderer->is_smoothing_enabled,
+        .alpha_point_discard = renderer->is_alpha_point_discard,
+        .alpha_threshold = renderer->alpha_threshold,
+        .brightness_multiplier = renderer->brightness_multiplier,
+    };
+    GFX_3D_RoomRenderer_Draw(
+        renderer->room_renderer, &shared, params, first_index, index_count,
+        vertex_count);
+    renderer->vertex_stream.rendered_count += index_count;
+
+    GFX_GL_Program_Bind(&renderer->program);
+}
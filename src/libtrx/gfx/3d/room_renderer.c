@@ -0,0 +1,284 @@
+#include "gfx/3d/room_renderer.h"
+
+#include "debug.h"
+#include "gfx/context.h"
+#include "gfx/gl/utils.h"
+#include "log.h"
+#include "memory.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Each texture takes three RGBA16UI texels in the texture buffer: two for the
+// four UV pairs and one for the texture page. These must match the shader.
+#define TEXTURE_TEXELS 3
+#define TEXTURE_COMPONENTS (TEXTURE_TEXELS * 4)
+#define TEXTURE_INFO_UNIT 2
+
+void GFX_3D_RoomRenderer_Init(
+    GFX_3D_ROOM_RENDERER *const room_renderer, const GFX_GL_BACKEND backend)
+{
+    ASSERT(room_renderer != NULL);
+    ASSERT(backend == GFX_GL_33C);
+    room_renderer->texture_capacity = 0;
+
+    GFX_GL_Program_Init(&room_renderer->program);
+    GFX_GL_Program_AttachShader(
+        &room_renderer->program, GL_VERTEX_SHADER, "shaders/room.glsl",
+        backend);
+    GFX_GL_Program_AttachShader(
+        &room_renderer->program, GL_FRAGMENT_SHADER, "shaders/room.glsl",
+        backend);
+    GFX_GL_Program_Link(&room_renderer->program);
+    GFX_GL_Program_FragmentData(&room_renderer->program, "fragColor");
+
+    GFX_GL_PROGRAM *const program = &room_renderer->program;
+    room_renderer->loc_mat_projection =
+        GFX_GL_Program_UniformLocation(program, "matProjection");
+    room_renderer->loc_mat_room =
+        GFX_GL_Program_UniformLocation(program, "matRoom");
+    room_renderer->loc_view_center =
+        GFX_GL_Program_UniformLocation(program, "viewCenter");
+    room_renderer->loc_persp = GFX_GL_Program_UniformLocation(program, "persp");
+    room_renderer->loc_near_z =
+        GFX_GL_Program_UniformLocation(program, "nearZ");
+    room_renderer->loc_res_z = GFX_GL_Program_UniformLocation(program, "resZ");
+    room_renderer->loc_res_z_buf =
+        GFX_GL_Program_UniformLocation(program, "resZBuf");
+    room_renderer->loc_draw_dist_fade =
+        GFX_GL_Program_UniformLocation(program, "drawDistFade");
+    room_renderer->loc_draw_dist_max =
+        GFX_GL_Program_UniformLocation(program, "drawDistMax");
+    room_renderer->loc_clip_far =
+        GFX_GL_Program_UniformLocation(program, "clipFar");
+    room_renderer->loc_water_effect =
+        GFX_GL_Program_UniformLocation(program, "waterEffect");
+    room_renderer->loc_wibble_effect =
+        GFX_GL_Program_UniformLocation(program, "wibbleEffect");
+    room_renderer->loc_wibble_offset =
+        GFX_GL_Program_UniformLocation(program, "wibbleOffset");
+    room_renderer->loc_wibble_table =
+        GFX_GL_Program_UniformLocation(program, "wibbleTable");
+    room_renderer->loc_shade_table =
+        GFX_GL_Program_UniformLocation(program, "shadeTable");
+    room_renderer->loc_brightness =
+        GFX_GL_Program_UniformLocation(program, "brightness");
+    room_renderer->loc_tint = GFX_GL_Program_UniformLocation(program, "tint");
+    room_renderer->loc_pretty_pixels =
+        GFX_GL_Program_UniformLocation(program, "prettyPixels");
+    room_renderer->loc_smoothing_enabled =
+        GFX_GL_Program_UniformLocation(program, "smoothingEnabled");
+    room_renderer->loc_alpha_point_discard =
+        GFX_GL_Program_UniformLocation(program, "alphaPointDiscard");
+    room_renderer->loc_alpha_threshold =
+        GFX_GL_Program_UniformLocation(program, "alphaThreshold");
+    room_renderer->loc_brightness_multiplier =
+        GFX_GL_Program_UniformLocation(program, "brightnessMultiplier");
+
+    GFX_GL_Program_Bind(program);
+    GFX_GL_Program_Uniform1i(
+        program, GFX_GL_Program_UniformLocation(program, "texArray"), 0);
+    GFX_GL_Program_Uniform1i(
+        program, GFX_GL_Program_UniformLocation(program, "texInfo"),
+        TEXTURE_INFO_UNIT);
+
+    GFX_GL_Buffer_Init(&room_renderer->texture_buffer, GL_TEXTURE_BUFFER);
+    GFX_GL_Texture_Init(&room_renderer->texture_info, GL_TEXTURE_BUFFER);
+
+    GFX_GL_VertexArray_Init(&room_renderer->vertex_format);
+    GFX_GL_VertexArray_Bind(&room_renderer->vertex_format);
+    GFX_GL_Buffer_Init(&room_renderer->vertex_buffer, GL_ARRAY_BUFFER);
+    GFX_GL_Buffer_Bind(&room_renderer->vertex_buffer);
+    // The element buffer binding is part of the vertex array state.
+    GFX_GL_Buffer_Init(&room_renderer->index_buffer, GL_ELEMENT_ARRAY_BUFFER);
+    GFX_GL_Buffer_Bind(&room_renderer->index_buffer);
+
+    const GLsizei stride = sizeof(GFX_3D_ROOM_VERTEX);
+    GFX_GL_VertexArray_Attribute(
+        &room_renderer->vertex_format, 0, 4, GL_SHORT, GL_FALSE, stride,
+        offsetof(GFX_3D_ROOM_VERTEX, x));
+    GFX_GL_VertexArray_Attribute(
+        &room_renderer->vertex_format, 1, 4, GL_UNSIGNED_SHORT, GL_FALSE,
+        stride, offsetof(GFX_3D_ROOM_VERTEX, texture));
+    glBindVertexArray(0);
+    GFX_GL_CheckError();
+}
+
+void GFX_3D_RoomRenderer_Close(GFX_3D_ROOM_RENDERER *const room_renderer)
+{
+    ASSERT(room_renderer != NULL);
+    GFX_GL_VertexArray_Close(&room_renderer->vertex_format);
+    GFX_GL_Buffer_Close(&room_renderer->index_buffer);
+    GFX_GL_Buffer_Close(&room_renderer->vertex_buffer);
+    GFX_GL_Texture_Close(&room_renderer->texture_info);
+    GFX_GL_Buffer_Close(&room_renderer->texture_buffer);
+    GFX_GL_Program_Close(&room_renderer->program);
+}
+
+void GFX_3D_RoomRenderer_UploadGeometry(
+    GFX_3D_ROOM_RENDERER *const room_renderer,
+    const GFX_3D_ROOM_VERTEX *const vertices, const int vertex_count,
+    const uint32_t *const indices, const int index_count)
+{
+    ASSERT(room_renderer != NULL);
+    LOG_INFO(
+        "Room geometry: %d vertices, %d indices", vertex_count, index_count);
+
+    GFX_GL_VertexArray_Bind(&room_renderer->vertex_format);
+    GFX_GL_Buffer_Bind(&room_renderer->vertex_buffer);
+    GFX_GL_Buffer_Data(
+        &room_renderer->vertex_buffer,
+        vertex_count * sizeof(GFX_3D_ROOM_VERTEX), vertices, GL_STATIC_DRAW);
+    GFX_GL_Buffer_Bind(&room_renderer->index_buffer);
+    GFX_GL_Buffer_Data(
+        &room_renderer->index_buffer, index_count * sizeof(uint32_t), indices,
+        GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    GFX_GL_CheckError();
+}
+
+void GFX_3D_RoomRenderer_UploadTextures(
+    GFX_3D_ROOM_RENDERER *const room_renderer,
+    const GFX_3D_ROOM_TEXTURE *const textures, const int count)
+{
+    ASSERT(room_renderer != NULL);
+    if (count <= 0) {
+        return;
+    }
+
+    uint16_t *const data =
+        Memory_Alloc(count * TEXTURE_COMPONENTS * sizeof(uint16_t));
+    for (int i = 0; i < count; i++) {
+        const GFX_3D_ROOM_TEXTURE *const texture = &textures[i];
+        uint16_t *const target = &data[i * TEXTURE_COMPONENTS];
+        for (int j = 0; j < 4; j++) {
+            target[j * 2 + 0] = texture->uv[j][0];
+            target[j * 2 + 1] = texture->uv[j][1];
+        }
+        // Shifted by one so that untextured faces end up as zero.
+        target[8] = texture->layer + 1;
+    }
+
+    const GLsizei size = count * TEXTURE_COMPONENTS * sizeof(uint16_t);
+    GFX_GL_Buffer_Bind(&room_renderer->texture_buffer);
+    if (count > room_renderer->texture_capacity) {
+        GFX_GL_Buffer_Data(
+            &room_renderer->texture_buffer, size, data, GL_DYNAMIC_DRAW);
+        room_renderer->texture_capacity = count;
+
+        // Reallocating the buffer storage requires attaching it again.
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_INFO_UNIT);
+        GFX_GL_Texture_Bind(&room_renderer->texture_info);
+        glTexBuffer(
+            GL_TEXTURE_BUFFER, GL_RGBA16UI, room_renderer->texture_buffer.id);
+        glActiveTexture(GL_TEXTURE0);
+        GFX_GL_CheckError();
+    } else {
+        GFX_GL_Buffer_SubData(&room_renderer->texture_buffer, 0, size, data);
+    }
+    Memory_Free(data);
+}
+
+void GFX_3D_RoomRenderer_SetTables(
+    GFX_3D_ROOM_RENDERER *const room_renderer, const int32_t *const wibble_table,
+    const int32_t *const shade_table)
+{
+    ASSERT(room_renderer != NULL);
+    GFX_GL_PROGRAM *const program = &room_renderer->program;
+    GFX_GL_Program_Bind(program);
+    GFX_GL_Program_Uniform1iv(
+        program, room_renderer->loc_wibble_table, GFX_3D_ROOM_WIBBLE_SIZE,
+        (const GLint *)wibble_table);
+    GFX_GL_Program_Uniform1iv(
+        program, room_renderer->loc_shade_table, GFX_3D_ROOM_WIBBLE_SIZE,
+        (const GLint *)shade_table);
+}
+
+void GFX_3D_RoomRenderer_Draw(
+    GFX_3D_ROOM_RENDERER *const room_renderer,
+    const GFX_3D_ROOM_SHARED_STATE *const shared,
+    const GFX_3D_ROOM_PARAMS *const params, const int first_index,
+    const int index_count, const int vertex_count)
+{
+    ASSERT(room_renderer != NULL);
+    ASSERT(shared != NULL);
+    ASSERT(params != NULL);
+    if (index_count <= 0) {
+        return;
+    }
+
+    GFX_GL_PROGRAM *const program = &room_renderer->program;
+    GFX_GL_Program_Bind(program);
+
+    GFX_GL_Program_UniformMatrix4fv(
+        program, room_renderer->loc_mat_projection, 1, GL_FALSE,
+        shared->projection);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_smoothing_enabled,
+        shared->smoothing_enabled);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_alpha_point_discard,
+        shared->alpha_point_discard);
+    GFX_GL_Program_Uniform1f(
+        program, room_renderer->loc_alpha_threshold, shared->alpha_threshold);
+    GFX_GL_Program_Uniform1f(
+        program, room_renderer->loc_brightness_multiplier,
+        shared->brightness_multiplier);
+
+    GFX_GL_Program_Uniform4fv(
+        program, room_renderer->loc_mat_room, 3, &params->matrix[0][0]);
+    GFX_GL_Program_Uniform2f(
+        program, room_renderer->loc_view_center, params->center_x,
+        params->center_y);
+    GFX_GL_Program_Uniform1f(program, room_renderer->loc_persp, params->persp);
+    GFX_GL_Program_Uniform1f(
+        program, room_renderer->loc_near_z, params->near_z);
+    GFX_GL_Program_Uniform1f(program, room_renderer->loc_res_z, params->res_z);
+    GFX_GL_Program_Uniform1f(
+        program, room_renderer->loc_res_z_buf, params->res_z_buf);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_draw_dist_fade, params->draw_dist_fade);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_draw_dist_max, params->draw_dist_max);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_clip_far, params->clip_far);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_water_effect, params->water_effect);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_wibble_effect, params->wibble_effect);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_wibble_offset, params->wibble_offset);
+    GFX_GL_Program_Uniform1f(
+        program, room_renderer->loc_brightness, params->brightness);
+    GFX_GL_Program_Uniform3f(
+        program, room_renderer->loc_tint, params->tint[0], params->tint[1],
+        params->tint[2]);
+    GFX_GL_Program_Uniform1i(
+        program, room_renderer->loc_pretty_pixels, params->pretty_pixels);
+
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_INFO_UNIT);
+    GFX_GL_Texture_Bind(&room_renderer->texture_info);
+    glActiveTexture(GL_TEXTURE0);
+    GFX_GL_CheckError();
+
+    // The software path rejects back faces by their screen space winding,
+    // which after the projection flips the Y axis is clockwise.
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glFrontFace(GL_CW);
+    if (params->clip_far) {
+        glEnable(GL_CLIP_DISTANCE0);
+    }
+    GFX_GL_CheckError();
+
+    GFX_GL_VertexArray_Bind(&room_renderer->vertex_format);
+    glDrawElements(
+        GL_TRIANGLES, index_count, GL_UNSIGNED_INT,
+        (void *)(intptr_t)(first_index * sizeof(uint32_t)));
+    GFX_GL_CheckError();
+    GFX_Context_CountDraw(1, vertex_count);
+
+    glDisable(GL_CLIP_DISTANCE0);
+    glDisable(GL_CULL_FACE);
+    GFX_GL_CheckError();
+}
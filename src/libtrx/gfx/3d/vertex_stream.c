@@ -1,54 +1,166 @@
 #include "gfx/3d/vertex_stream.h"
 
+#include "gfx/context.h"
 #include "gfx/gl/gl_core_3_3.h"
 #include "gfx/gl/utils.h"
 #include "log.h"
 #include "memory.h"
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MIN_CAPACITY 1024
+#define VERTEX_BUFFER_SIZE (3 * 1024 * 1024)
+#define INDEX_BUFFER_SIZE (3 * 256 * 1024)
+#define MAX_BATCH_VERTICES (UINT16_MAX + 1)
 
 static const GLenum GL_PRIM_MODES[] = {
     GL_LINES, // GFX_3D_PRIM_LINE
     GL_TRIANGLES, // GFX_3D_PRIM_TRI
 };
 
+static void *M_Reserve(
+    void *data, size_t *capacity, size_t required, size_t item_size);
+static void M_SetVertexFormat(
+    GFX_3D_VERTEX_STREAM *vertex_stream, size_t offset);
+static uint16_t M_BeginPrim(GFX_3D_VERTEX_STREAM *vertex_stream, int count);
 static void M_PushVertex(
     GFX_3D_VERTEX_STREAM *vertex_stream, const GFX_3D_VERTEX *vertex);
+static void M_PushIndex(GFX_3D_VERTEX_STREAM *vertex_stream, uint16_t index);
+static void M_PushVertices(
+    GFX_3D_VERTEX_STREAM *vertex_stream, const GFX_3D_VERTEX *vertices,
+    int count);
+
+static void *M_Reserve(
+    void *const data, size_t *const capacity, const size_t required,
+    const size_t item_size)
+{
+    if (required <= *capacity) {
+        return data;
+    }
+
+    size_t new_capacity = MAX(*capacity * 2, (size_t)MIN_CAPACITY);
+    while (new_capacity < required) {
+        new_capacity *= 2;
+    }
+    *capacity = new_capacity;
+    return Memory_Realloc(data, new_capacity * item_size);
+}
+
+static void M_SetVertexFormat(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const size_t offset)
+{
+    const GLsizei stride = sizeof(GFX_3D_VERTEX);
+    const GLsizei base = offset;
+    GFX_GL_VertexArray_Attribute(
+        &vertex_stream->vtc_format, 0, 3, GL_FLOAT, GL_FALSE, stride,
+        base + offsetof(GFX_3D_VERTEX, x));
+    GFX_GL_VertexArray_Attribute(
+        &vertex_stream->vtc_format, 1, 3, GL_FLOAT, GL_FALSE, stride,
+        base + offsetof(GFX_3D_VERTEX, s));
+    GFX_GL_VertexArray_Attribute(
+        &vertex_stream->vtc_format, 2, 4, GL_FLOAT, GL_FALSE, stride,
+        base + offsetof(GFX_3D_VERTEX, r));
+    GFX_GL_VertexArray_Attribute(
+        &vertex_stream->vtc_format, 3, 1, GL_FLOAT, GL_FALSE, stride,
+        base + offsetof(GFX_3D_VERTEX, layer));
+}
+
+static uint16_t M_BeginPrim(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const int count)
+{
+    const size_t vertex_count = vertex_stream->pending_vertices.count;
+    const size_t batch_count = vertex_stream->pending_batches.count;
+    if (batch_count == 0
+        || vertex_count + count
+            > vertex_stream->pending_batches.data[batch_count - 1].first_vertex
+                + MAX_BATCH_VERTICES) {
+        vertex_stream->pending_batches.data = M_Reserve(
+            vertex_stream->pending_batches.data,
+            &vertex_stream->pending_batches.capacity, batch_count + 1,
+            sizeof(GFX_3D_VERTEX_BATCH));
+        vertex_stream->pending_batches.data[batch_count] =
+            (GFX_3D_VERTEX_BATCH) {
+                .first_vertex = vertex_count,
+                .first_index = vertex_stream->pending_indices.count,
+            };
+        vertex_stream->pending_batches.count++;
+    }
+
+    // Fans and strips with n vertices need 3 * (n - 2) indices.
+    vertex_stream->pending_vertices.data = M_Reserve(
+        vertex_stream->pending_vertices.data,
+        &vertex_stream->pending_vertices.capacity, vertex_count + count,
+        sizeof(GFX_3D_VERTEX));
+    vertex_stream->pending_indices.data = M_Reserve(
+        vertex_stream->pending_indices.data,
+        &vertex_stream->pending_indices.capacity,
+        vertex_stream->pending_indices.count + MAX(count, 3 * (count - 2)),
+        sizeof(uint16_t));
+
+    const GFX_3D_VERTEX_BATCH *const batch =
+        &vertex_stream->pending_batches
+             .data[vertex_stream->pending_batches.count - 1];
+    return vertex_count - batch->first_vertex;
+}
 
 static void M_PushVertex(
     GFX_3D_VERTEX_STREAM *const vertex_stream,
     const GFX_3D_VERTEX *const vertex)
 {
-    if (vertex_stream->pending_vertices.count + 1
-        >= vertex_stream->pending_vertices.capacity) {
-        vertex_stream->pending_vertices.capacity += 1000;
-        vertex_stream->pending_vertices.data = Memory_Realloc(
-            vertex_stream->pending_vertices.data,
-            vertex_stream->pending_vertices.capacity * sizeof(GFX_3D_VERTEX));
-    }
+    GFX_3D_VERTEX *const target =
+        &vertex_stream->pending_vertices
+             .data[vertex_stream->pending_vertices.count++];
+    *target = *vertex;
+    target->layer = vertex_stream->layer;
+}
 
-    vertex_stream->pending_vertices
-        .data[vertex_stream->pending_vertices.count++] = *vertex;
+static void M_PushIndex(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const uint16_t index)
+{
+    vertex_stream->pending_indices
+        .data[vertex_stream->pending_indices.count++] = index;
+}
+
+static void M_PushVertices(
+    GFX_3D_VERTEX_STREAM *const vertex_stream,
+    const GFX_3D_VERTEX *const vertices, const int count)
+{
+    const uint16_t base = M_BeginPrim(vertex_stream, count);
+    for (int i = 0; i < count; i++) {
+        M_PushVertex(vertex_stream, &vertices[i]);
+        M_PushIndex(vertex_stream, base + i);
+    }
 }
 
-void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *const vertex_stream)
+void GFX_3D_VertexStream_Init(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const GFX_GL_BACKEND backend)
 {
     vertex_stream->prim_type = GFX_3D_PRIM_TRI;
-    vertex_stream->buffer_size = 0;
+    vertex_stream->layer = -1.0f;
     vertex_stream->pending_vertices.data = NULL;
     vertex_stream->pending_vertices.count = 0;
     vertex_stream->pending_vertices.capacity = 0;
+    vertex_stream->pending_indices.data = NULL;
+    vertex_stream->pending_indices.count = 0;
+    vertex_stream->pending_indices.capacity = 0;
+    vertex_stream->pending_batches.data = NULL;
+    vertex_stream->pending_batches.count = 0;
+    vertex_stream->pending_batches.capacity = 0;
     vertex_stream->rendered_count = 0;
 
-    GFX_GL_Buffer_Init(&vertex_stream->buffer, GL_ARRAY_BUFFER);
-    GFX_GL_Buffer_Bind(&vertex_stream->buffer);
+    GFX_GL_RingBuffer_Init(
+        &vertex_stream->buffer, GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE, backend);
 
     GFX_GL_VertexArray_Init(&vertex_stream->vtc_format);
     GFX_GL_VertexArray_Bind(&vertex_stream->vtc_format);
-    GFX_GL_VertexArray_Attribute(
-        &vertex_stream->vtc_format, 0, 3, GL_FLOAT, GL_FALSE, 40, 0);
-    GFX_GL_VertexArray_Attribute(
-        &vertex_stream->vtc_format, 1, 3, GL_FLOAT, GL_FALSE, 40, 12);
-    GFX_GL_VertexArray_Attribute(
-        &vertex_stream->vtc_format, 2, 4, GL_FLOAT, GL_FALSE, 40, 24);
+    M_SetVertexFormat(vertex_stream, 0);
+
+    // The element array binding is part of the vertex array state.
+    GFX_GL_RingBuffer_Init(
+        &vertex_stream->index_buffer, GL_ELEMENT_ARRAY_BUFFER,
+        INDEX_BUFFER_SIZE, backend);
 
     GFX_GL_CheckError();
 }
@@ -56,13 +168,16 @@ void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *const vertex_stream)
 void GFX_3D_VertexStream_Close(GFX_3D_VERTEX_STREAM *const vertex_stream)
 {
     GFX_GL_VertexArray_Close(&vertex_stream->vtc_format);
-    GFX_GL_Buffer_Close(&vertex_stream->buffer);
+    GFX_GL_RingBuffer_Close(&vertex_stream->index_buffer);
+    GFX_GL_RingBuffer_Close(&vertex_stream->buffer);
     Memory_FreePointer(&vertex_stream->pending_vertices.data);
+    Memory_FreePointer(&vertex_stream->pending_indices.data);
+    Memory_FreePointer(&vertex_stream->pending_batches.data);
 }
 
 void GFX_3D_VertexStream_Bind(GFX_3D_VERTEX_STREAM *const vertex_stream)
 {
-    GFX_GL_Buffer_Bind(&vertex_stream->buffer);
+    GFX_GL_Buffer_Bind(&vertex_stream->buffer.buffer);
 }
 
 void GFX_3D_VertexStream_SetPrimType(
@@ -71,6 +186,12 @@ void GFX_3D_VertexStream_SetPrimType(
     vertex_stream->prim_type = prim_type;
 }
 
+void GFX_3D_VertexStream_SetLayer(
+    GFX_3D_VERTEX_STREAM *const vertex_stream, const float layer)
+{
+    vertex_stream->layer = layer;
+}
+
 bool GFX_3D_VertexStream_PushPrimStrip(
     GFX_3D_VERTEX_STREAM *const vertex_stream,
     const GFX_3D_VERTEX *const vertices, const int count)
@@ -81,16 +202,19 @@ bool GFX_3D_VertexStream_PushPrimStrip(
     }
 
     if (count <= 2) {
-        for (int i = 0; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
-    } else {
-        // convert strip to raw triangles
-        for (int i = 2; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i - 2]);
-            M_PushVertex(vertex_stream, &vertices[i - 1]);
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
+        M_PushVertices(vertex_stream, vertices, count);
+        return true;
+    }
+
+    // convert strip to indexed triangles
+    const uint16_t base = M_BeginPrim(vertex_stream, count);
+    for (int i = 0; i < count; i++) {
+        M_PushVertex(vertex_stream, &vertices[i]);
+    }
+    for (int i = 2; i < count; i++) {
+        M_PushIndex(vertex_stream, base + i - 2);
+        M_PushIndex(vertex_stream, base + i - 1);
+        M_PushIndex(vertex_stream, base + i);
     }
 
     return true;
@@ -106,16 +230,19 @@ bool GFX_3D_VertexStream_PushPrimFan(
     }
 
     if (count <= 2) {
-        for (int i = 0; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
-    } else {
-        // convert fan to raw triangles
-        for (int i = 2; i < count; i++) {
-            M_PushVertex(vertex_stream, &vertices[0]);
-            M_PushVertex(vertex_stream, &vertices[i - 1]);
-            M_PushVertex(vertex_stream, &vertices[i]);
-        }
+        M_PushVertices(vertex_stream, vertices, count);
+        return true;
+    }
+
+    // convert fan to indexed triangles
+    const uint16_t base = M_BeginPrim(vertex_stream, count);
+    for (int i = 0; i < count; i++) {
+        M_PushVertex(vertex_stream, &vertices[i]);
+    }
+    for (int i = 2; i < count; i++) {
+        M_PushIndex(vertex_stream, base);
+        M_PushIndex(vertex_stream, base + i - 1);
+        M_PushIndex(vertex_stream, base + i);
     }
 
     return true;
@@ -125,9 +252,7 @@ bool GFX_3D_VertexStream_PushPrimList(
     GFX_3D_VERTEX_STREAM *const vertex_stream,
     const GFX_3D_VERTEX *const vertices, const int count)
 {
-    for (int i = 0; i < count; i++) {
-        M_PushVertex(vertex_stream, &vertices[i]);
-    }
+    M_PushVertices(vertex_stream, vertices, count);
     return true;
 }
 
@@ -138,30 +263,40 @@ void GFX_3D_VertexStream_RenderPending(
         return;
     }
 
-    GFX_GL_Buffer_Bind(&vertex_stream->buffer);
+    // Both uploads go to regions of the ring buffers that no earlier draw
+    // call reads from, so they do not stall.
     GFX_GL_VertexArray_Bind(&vertex_stream->vtc_format);
+    const size_t vertex_offset = GFX_GL_RingBuffer_Push(
+        &vertex_stream->buffer, vertex_stream->pending_vertices.data,
+        sizeof(GFX_3D_VERTEX) * vertex_stream->pending_vertices.count);
+    const size_t index_offset = GFX_GL_RingBuffer_Push(
+        &vertex_stream->index_buffer, vertex_stream->pending_indices.data,
+        sizeof(uint16_t) * vertex_stream->pending_indices.count);
 
-    // resize GPU buffer if required
-    size_t buffer_size =
-        sizeof(GFX_3D_VERTEX) * vertex_stream->pending_vertices.count;
-    if (buffer_size > vertex_stream->buffer_size) {
-        LOG_INFO(
-            "Vertex buffer resize: %d -> %d", vertex_stream->buffer_size,
-            buffer_size);
-        GFX_GL_Buffer_Data(
-            &vertex_stream->buffer, buffer_size, NULL, GL_STREAM_DRAW);
-        vertex_stream->buffer_size = buffer_size;
-    }
+    const size_t batch_count = vertex_stream->pending_batches.count;
+    for (size_t i = 0; i < batch_count; i++) {
+        const GFX_3D_VERTEX_BATCH *const batch =
+            &vertex_stream->pending_batches.data[i];
+        const size_t end_index = i + 1 < batch_count
+            ? vertex_stream->pending_batches.data[i + 1].first_index
+            : vertex_stream->pending_indices.count;
 
-    GFX_GL_Buffer_SubData(
-        &vertex_stream->buffer, 0, buffer_size,
-        vertex_stream->pending_vertices.data);
-
-    glDrawArrays(
-        GL_PRIM_MODES[vertex_stream->prim_type], 0,
-        vertex_stream->pending_vertices.count);
-    GFX_GL_CheckError();
+        // Pointing the attributes at the first vertex of the batch stands in
+        // for a base vertex, which OpenGL 2.1 lacks.
+        M_SetVertexFormat(
+            vertex_stream,
+            vertex_offset + batch->first_vertex * sizeof(GFX_3D_VERTEX));
+        glDrawElements(
+            GL_PRIM_MODES[vertex_stream->prim_type],
+            end_index - batch->first_index, GL_UNSIGNED_SHORT,
+            (void *)(intptr_t)(index_offset
+                               + batch->first_index * sizeof(uint16_t)));
+        GFX_GL_CheckError();
+    }
 
-    vertex_stream->rendered_count += vertex_stream->pending_vertices.count;
+    GFX_Context_CountDraw(batch_count, vertex_stream->pending_vertices.count);
+    vertex_stream->rendered_count += vertex_stream->pending_indices.count;
     vertex_stream->pending_vertices.count = 0;
+    vertex_stream->pending_indices.count = 0;
+    vertex_stream->pending_batches.count = 0;
 }
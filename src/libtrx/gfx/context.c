@@ -31,6 +31,9 @@ typedef struct {
 
     char *scheduled_screenshot_path;
     GFX_RENDERER *renderer;
+
+    GFX_DRAW_STATS draw_stats;
+    GFX_DRAW_STATS last_draw_stats;
 } GFX_CONTEXT;
 
 static GFX_CONTEXT m_Context = {};
@@ -289,6 +292,9 @@ void GFX_Context_SwapBuffers(void)
         && m_Context.renderer->swap_buffers != NULL) {
         m_Context.renderer->swap_buffers(m_Context.renderer);
     }
+
+    m_Context.last_draw_stats = m_Context.draw_stats;
+    m_Context.draw_stats = (GFX_DRAW_STATS) {};
 }
 
 void GFX_Context_ScheduleScreenshot(const char *path)
@@ -311,3 +317,14 @@ GFX_CONFIG *GFX_Context_GetConfig(void)
 {
     return &m_Context.config;
 }
+
+void GFX_Context_CountDraw(const int32_t draw_calls, const int32_t vertices)
+{
+    m_Context.draw_stats.draw_calls += draw_calls;
+    m_Context.draw_stats.vertices += vertices;
+}
+
+GFX_DRAW_STATS GFX_Context_GetDrawStats(void)
+{
+    return m_Context.last_draw_stats;
+}
@@ -185,6 +185,14 @@ GLint GFX_GL_Program_UniformLocation(GFX_GL_PROGRAM *program, const char *name)
     return location;
 }
 
+void GFX_GL_Program_Uniform2f(
+    GFX_GL_PROGRAM *program, GLint loc, GLfloat v0, GLfloat v1)
+{
+    ASSERT(program != NULL);
+    glUniform2f(loc, v0, v1);
+    GFX_GL_CheckError();
+}
+
 void GFX_GL_Program_Uniform3f(
     GFX_GL_PROGRAM *program, GLint loc, GLfloat v0, GLfloat v1, GLfloat v2)
 {
@@ -216,6 +224,22 @@ void GFX_GL_Program_Uniform1f(GFX_GL_PROGRAM *program, GLint loc, GLfloat v0)
     GFX_GL_CheckError();
 }
 
+void GFX_GL_Program_Uniform1iv(
+    GFX_GL_PROGRAM *program, GLint loc, GLsizei count, const GLint *value)
+{
+    ASSERT(program != NULL);
+    glUniform1iv(loc, count, value);
+    GFX_GL_CheckError();
+}
+
+void GFX_GL_Program_Uniform4fv(
+    GFX_GL_PROGRAM *program, GLint loc, GLsizei count, const GLfloat *value)
+{
+    ASSERT(program != NULL);
+    glUniform4fv(loc, count, value);
+    GFX_GL_CheckError();
+}
+
 void GFX_GL_Program_UniformMatrix4fv(
     GFX_GL_PROGRAM *program, GLint loc, GLsizei count, GLboolean transpose,
     const GLfloat *value)
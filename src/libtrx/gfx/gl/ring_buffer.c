@@ -0,0 +1,194 @@
+#include "gfx/gl/ring_buffer.h"
+
+#include "debug.h"
+#include "gfx/gl/utils.h"
+#include "log.h"
+#include "utils.h"
+
+#include <string.h>
+
+#define ALIGNMENT 16
+#define WAIT_TIMEOUT_NS 1000000
+
+static size_t M_GetSegmentSize(const GFX_GL_RING_BUFFER *ring);
+static void M_Allocate(GFX_GL_RING_BUFFER *ring, size_t segment_size);
+static void M_Release(GFX_GL_RING_BUFFER *ring);
+static void M_WaitForSegment(GFX_GL_RING_BUFFER *ring, int32_t segment);
+static size_t M_PushPersistent(
+    GFX_GL_RING_BUFFER *ring, const void *data, size_t size, size_t offset);
+static size_t M_PushOrphan(
+    GFX_GL_RING_BUFFER *ring, const void *data, size_t size, size_t offset);
+
+static size_t M_GetSegmentSize(const GFX_GL_RING_BUFFER *const ring)
+{
+    return ring->size / GFX_GL_RING_BUFFER_SEGMENTS;
+}
+
+static void M_Allocate(
+    GFX_GL_RING_BUFFER *const ring, const size_t segment_size)
+{
+    const GLenum target = ring->buffer.target;
+    ring->size = ALIGN(segment_size, ALIGNMENT) * GFX_GL_RING_BUFFER_SEGMENTS;
+    ring->offset = 0;
+    ring->segment = 0;
+
+    GFX_GL_Buffer_Init(&ring->buffer, target);
+    GFX_GL_Buffer_Bind(&ring->buffer);
+    if (ring->mode == GFX_GL_RING_BUFFER_PERSISTENT) {
+        const GLbitfield flags =
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, ring->size, NULL, flags);
+        GFX_GL_CheckError();
+        ring->mapped = glMapBufferRange(target, 0, ring->size, flags);
+        GFX_GL_CheckError();
+        ASSERT(ring->mapped != NULL);
+    } else {
+        GFX_GL_Buffer_Data(&ring->buffer, ring->size, NULL, GL_STREAM_DRAW);
+    }
+}
+
+static void M_Release(GFX_GL_RING_BUFFER *const ring)
+{
+    for (int32_t i = 0; i < GFX_GL_RING_BUFFER_SEGMENTS; i++) {
+        if (ring->fences[i] != NULL) {
+            glDeleteSync(ring->fences[i]);
+            ring->fences[i] = NULL;
+        }
+    }
+
+    if (ring->mapped != NULL) {
+        GFX_GL_Buffer_Bind(&ring->buffer);
+        GFX_GL_Buffer_Unmap(&ring->buffer);
+        ring->mapped = NULL;
+    }
+
+    // Draw calls that still read from the buffer keep its storage alive.
+    GFX_GL_Buffer_Close(&ring->buffer);
+}
+
+static void M_WaitForSegment(
+    GFX_GL_RING_BUFFER *const ring, const int32_t segment)
+{
+    const GLsync fence = ring->fences[segment];
+    if (fence == NULL) {
+        return;
+    }
+
+    while (true) {
+        const GLenum result = glClientWaitSync(
+            fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS);
+        if (result == GL_ALREADY_SIGNALED
+            || result == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        if (result == GL_WAIT_FAILED) {
+            GFX_GL_CheckError();
+            break;
+        }
+    }
+
+    glDeleteSync(fence);
+    ring->fences[segment] = NULL;
+}
+
+static size_t M_PushPersistent(
+    GFX_GL_RING_BUFFER *const ring, const void *const data, const size_t size,
+    size_t offset)
+{
+    const size_t segment_size = M_GetSegmentSize(ring);
+    if (size > segment_size) {
+        const size_t new_segment_size = MAX(size, segment_size * 2);
+        LOG_INFO(
+            "Ring buffer resize: %d -> %d", ring->size,
+            new_segment_size * GFX_GL_RING_BUFFER_SEGMENTS);
+        M_Release(ring);
+        M_Allocate(ring, new_segment_size);
+        offset = 0;
+    } else if (offset + size > (size_t)(ring->segment + 1) * segment_size) {
+        // Retire the current segment once the GPU is done with the draw
+        // calls issued so far, and move on to the oldest one.
+        ring->fences[ring->segment] =
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        GFX_GL_CheckError();
+        ring->segment = (ring->segment + 1) % GFX_GL_RING_BUFFER_SEGMENTS;
+        M_WaitForSegment(ring, ring->segment);
+        offset = ring->segment * segment_size;
+    }
+
+    memcpy(ring->mapped + offset, data, size);
+    return offset;
+}
+
+static size_t M_PushOrphan(
+    GFX_GL_RING_BUFFER *const ring, const void *const data, const size_t size,
+    size_t offset)
+{
+    if (offset + size > ring->size) {
+        if (size > ring->size) {
+            const size_t new_size = MAX(size, ring->size * 2);
+            LOG_INFO("Ring buffer resize: %d -> %d", ring->size, new_size);
+            ring->size = new_size;
+        }
+        // Orphan the old storage instead of waiting for the GPU to finish
+        // with it.
+        GFX_GL_Buffer_Data(&ring->buffer, ring->size, NULL, GL_STREAM_DRAW);
+        offset = 0;
+    }
+
+    if (ring->mode == GFX_GL_RING_BUFFER_MAP_RANGE) {
+        void *const target = glMapBufferRange(
+            ring->buffer.target, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+                | GL_MAP_UNSYNCHRONIZED_BIT);
+        GFX_GL_CheckError();
+        ASSERT(target != NULL);
+        memcpy(target, data, size);
+        GFX_GL_Buffer_Unmap(&ring->buffer);
+    } else {
+        GFX_GL_Buffer_SubData(&ring->buffer, offset, size, data);
+    }
+    return offset;
+}
+
+void GFX_GL_RingBuffer_Init(
+    GFX_GL_RING_BUFFER *const ring, const GLenum target, const size_t size,
+    const GFX_GL_BACKEND backend)
+{
+    ASSERT(ring != NULL);
+    if (backend == GFX_GL_21) {
+        ring->mode = GFX_GL_RING_BUFFER_SUB_DATA;
+    } else if (ogl_ext_ARB_buffer_storage) {
+        ring->mode = GFX_GL_RING_BUFFER_PERSISTENT;
+    } else {
+        ring->mode = GFX_GL_RING_BUFFER_MAP_RANGE;
+    }
+
+    ring->mapped = NULL;
+    for (int32_t i = 0; i < GFX_GL_RING_BUFFER_SEGMENTS; i++) {
+        ring->fences[i] = NULL;
+    }
+    ring->buffer.target = target;
+    M_Allocate(ring, size / GFX_GL_RING_BUFFER_SEGMENTS);
+}
+
+void GFX_GL_RingBuffer_Close(GFX_GL_RING_BUFFER *const ring)
+{
+    ASSERT(ring != NULL);
+    if (ring->buffer.initialized) {
+        M_Release(ring);
+    }
+}
+
+size_t GFX_GL_RingBuffer_Push(
+    GFX_GL_RING_BUFFER *const ring, const void *const data, const size_t size)
+{
+    ASSERT(ring != NULL);
+    GFX_GL_Buffer_Bind(&ring->buffer);
+
+    const size_t offset = ALIGN(ring->offset, (size_t)ALIGNMENT);
+    const size_t result = ring->mode == GFX_GL_RING_BUFFER_PERSISTENT
+        ? M_PushPersistent(ring, data, size, offset)
+        : M_PushOrphan(ring, data, size, offset);
+    ring->offset = result + size;
+    return result;
+}
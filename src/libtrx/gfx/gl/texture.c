@@ -92,3 +92,48 @@ void GFX_GL_Texture_LoadFromBackBuffer(GFX_GL_TEXTURE *const texture)
     glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, x, y, w, h, 0);
     GFX_GL_CheckError();
 }
+
+void GFX_GL_Texture_LoadArray(
+    GFX_GL_TEXTURE *const texture, const void *const data, const int width,
+    const int height, const int layer_count, const GLint internal_format,
+    const GLint format)
+{
+    ASSERT(texture != NULL);
+    ASSERT(texture->initialized);
+    ASSERT(texture->target == GL_TEXTURE_2D_ARRAY);
+
+    GFX_GL_Texture_Bind(texture);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, internal_format, width, height, layer_count, 0,
+        format, GL_UNSIGNED_BYTE, data);
+    GFX_GL_CheckError();
+}
+
+void GFX_GL_Texture_LoadArrayLayer(
+    GFX_GL_TEXTURE *const texture, const int layer, const void *const data,
+    const int width, const int height, const GLint format)
+{
+    ASSERT(texture != NULL);
+    ASSERT(texture->initialized);
+    ASSERT(texture->target == GL_TEXTURE_2D_ARRAY);
+    ASSERT(data != NULL);
+
+    GFX_GL_Texture_Bind(texture);
+    glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format,
+        GL_UNSIGNED_BYTE, data);
+    GFX_GL_CheckError();
+}
+
+void GFX_GL_Texture_GenerateMipmap(GFX_GL_TEXTURE *const texture)
+{
+    ASSERT(texture != NULL);
+    ASSERT(texture->initialized);
+
+    GFX_GL_Texture_Bind(texture);
+    glGenerateMipmap(texture->target);
+    GFX_GL_CheckError();
+}
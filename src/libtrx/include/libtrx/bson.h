@@ -22,6 +22,13 @@ JSON_VALUE *BSON_Parse(const char *src, size_t src_size);
 JSON_VALUE *BSON_ParseEx(
     const char *src, size_t src_size, BSON_PARSE_RESULT *result);
 
+// Like BSON_ParseEx, but takes ownership of src, which must come from
+// Memory_Alloc. Keys and strings point into the source instead of being
+// copied, and the source is freed with the document by JSON_ValueFree, also
+// when parsing fails.
+JSON_VALUE *BSON_ParseInPlace(
+    char *src, size_t src_size, BSON_PARSE_RESULT *result);
+
 const char *BSON_GetErrorDescription(BSON_PARSE_ERROR error);
 
 /* Write out a BSON binary string. Return 0 if an error occurred (malformed
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../engine/audio_common.h"
 #include "../game/sound/enum.h"
 #include "../gfx/common.h"
 #include "../screenshot.h"
@@ -124,6 +125,7 @@ typedef struct {
         bool enable_pitched_sounds;
         bool load_music_triggers;
         UNDERWATER_MUSIC_MODE underwater_music_mode;
+        AUDIO_INTERPOLATION sample_interpolation;
         MUSIC_LOAD_CONDITION music_load_condition;
     } audio;
 
@@ -172,6 +174,7 @@ typedef struct {
         bool fix_alligator_ai;
         bool fix_shotgun_targeting;
         bool fix_bear_ai;
+        bool enable_shared_pathfinding;
         bool revert_to_pistols;
         bool change_pierre_spawn;
         bool disable_trex_collision;
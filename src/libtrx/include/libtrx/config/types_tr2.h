@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../game/input.h"
+#include "../engine/audio_common.h"
 #include "../game/sound/enum.h"
 #include "../gfx/common.h"
 #include "../screenshot.h"
@@ -60,6 +61,7 @@ typedef struct {
         int32_t music_volume;
         bool enable_lara_mic;
         UNDERWATER_MUSIC_MODE underwater_music_mode;
+        AUDIO_INTERPOLATION sample_interpolation;
     } audio;
 
     struct {
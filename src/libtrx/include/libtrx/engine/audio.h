@@ -1,5 +1,7 @@
 #pragma once
 
+#include "audio_common.h"
+
 #include <SDL2/SDL_audio.h>
 #include <libavutil/samplefmt.h>
 #include <stdbool.h>
@@ -7,7 +9,7 @@
 #include <stdint.h>
 
 #define AUDIO_MAX_SAMPLES 1000
-#define AUDIO_MAX_ACTIVE_SAMPLES 50
+#define AUDIO_MAX_ACTIVE_SAMPLES 128
 #define AUDIO_MAX_ACTIVE_STREAMS 10
 #define AUDIO_NO_SOUND (-1)
 
@@ -29,10 +31,16 @@ double Audio_Stream_GetDuration(int32_t sound_id);
 bool Audio_Stream_SeekTimestamp(int32_t sound_id, double timestamp);
 bool Audio_Stream_SetStartTimestamp(int32_t sound_id, double timestamp);
 bool Audio_Stream_SetStopTimestamp(int32_t sound_id, double timestamp);
+// Closes the streams that played out by themselves, running their finish
+// callbacks. Call regularly from the game thread.
+void Audio_Stream_ProcessFinished(void);
 
 bool Audio_Sample_LoadMany(size_t count, const char **contents, size_t *sizes);
 bool Audio_Sample_LoadSingle(
     int32_t sample_num, const char *content, size_t size);
+// Decodes a loaded sample ahead of its first playback. Distinct samples can
+// be decoded concurrently from worker threads.
+bool Audio_Sample_Decode(int32_t sample_id);
 bool Audio_Sample_Unload(int32_t sample_id);
 bool Audio_Sample_UnloadAll(void);
 
@@ -49,3 +57,4 @@ bool Audio_Sample_CloseAll(void);
 bool Audio_Sample_SetPan(int32_t sound_id, int32_t pan);
 bool Audio_Sample_SetVolume(int32_t sound_id, int32_t volume);
 bool Audio_Sample_SetPitch(int32_t sound_id, float pan);
+void Audio_Sample_SetInterpolation(AUDIO_INTERPOLATION interpolation);
@@ -0,0 +1,7 @@
+#pragma once
+
+typedef enum {
+    AUDIO_INTERP_NEAREST,
+    AUDIO_INTERP_LINEAR,
+    AUDIO_INTERP_CUBIC,
+} AUDIO_INTERPOLATION;
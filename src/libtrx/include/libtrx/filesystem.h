@@ -18,6 +18,12 @@ typedef enum {
 
 typedef struct MYFILE MYFILE;
 
+typedef struct {
+    char *path;
+    size_t size;
+    int64_t modified;
+} FILE_INFO;
+
 bool File_DirExists(const char *path);
 
 bool File_IsAbsolute(const char *path);
@@ -74,3 +80,14 @@ void File_Close(MYFILE *file);
 bool File_Load(const char *path, char **output_data, size_t *output_size);
 
 void File_CreateDirectory(const char *path);
+
+// Replaces the destination file if it exists. On platforms that allow it,
+// the replacement is atomic.
+bool File_Rename(const char *src_path, const char *dst_path);
+bool File_Delete(const char *path);
+
+// Lists the regular files directly inside the given directory. The returned
+// paths are the directory path joined with the file names. Release the
+// result with File_FreeList.
+int32_t File_ListDirectory(const char *path, FILE_INFO **out_files);
+void File_FreeList(FILE_INFO *files, int32_t count);
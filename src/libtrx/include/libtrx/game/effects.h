@@ -1,3 +1,4 @@
 #pragma once
 
+#include "effects/common.h"
 #include "effects/types.h"
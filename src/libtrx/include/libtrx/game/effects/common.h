@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdint.h>
+
+int32_t Effect_GetActiveCount(void);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Per-frame performance readout. While enabled, it keeps a rolling window
+// of frame timings and world counts, shows a summary on screen and can
+// write the window to a CSV file for comparing builds and settings.
+
+typedef enum {
+    FRAME_STATS_CONTROL,
+    FRAME_STATS_DRAW,
+    FRAME_STATS_WAIT,
+    FRAME_STATS_NUMBER_OF,
+} FRAME_STATS_SECTION;
+
+void FrameStats_Init(void);
+void FrameStats_Shutdown(void);
+
+void FrameStats_SetEnabled(bool enabled);
+bool FrameStats_IsEnabled(void);
+
+// Attributes the time since the previous mark to the given section.
+void FrameStats_Mark(FRAME_STATS_SECTION section);
+void FrameStats_EndFrame(void);
+
+void FrameStats_Draw(void);
+
+// Returns the number of exported frames, or -1 on failure.
+int32_t FrameStats_Export(const char *path);
@@ -1,13 +1,19 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
-// Internal game memory manager. It allocates its internal buffer once per
-// level launch. All subsequent "allocation" requests operate with pointer
-// arithmetic. This makes it fast and convenient to request more memory as we
-// go, but it makes freeing memory really inconvenient which is why it is
-// intentionally not implemented. To use more dynamic memory management, use
+// Internal game memory manager. It hands out memory from large chunks with
+// pointer arithmetic, which makes it fast and convenient to request more
+// memory as we go, but makes freeing individual allocations really
+// inconvenient which is why it is intentionally not implemented. Instead, all
+// memory is released at once with GameBuf_Reset when a level is unloaded.
+// When a chunk runs out, a new one is added, so levels are not limited to the
+// size of the first chunk. To use more dynamic memory management, use
 // Memory_Alloc / Memory_Free.
+//
+// Every allocation is accounted to its GAME_BUFFER category; the usage of the
+// level is logged whenever the buffer is reset.
 
 typedef enum {
     // clang-format off
@@ -48,8 +54,20 @@ typedef enum {
     // clang-format on
 } GAME_BUFFER;
 
-void GameBuf_Init(size_t cap);
+void GameBuf_Init(size_t chunk_size);
 void GameBuf_Shutdown(void);
 void GameBuf_Reset(void);
 
 void *GameBuf_Alloc(size_t alloc_size, GAME_BUFFER buffer);
+
+// Bytes allocated in the current level, per category and in total.
+size_t GameBuf_GetUsage(GAME_BUFFER buffer);
+size_t GameBuf_GetTotalUsage(void);
+// The highest usage seen in any level since the game started.
+size_t GameBuf_GetPeakUsage(GAME_BUFFER buffer);
+size_t GameBuf_GetTotalPeakUsage(void);
+// Bytes currently reserved for all chunks.
+size_t GameBuf_GetReservedSize(void);
+int32_t GameBuf_GetChunkCount(void);
+
+void GameBuf_LogUsage(void);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Headless mode replays a demo as fast as the CPU allows, and traces a hash
+// of the game state after every logic frame. It is meant for performance
+// regression tests and determinism checks. The window stays hidden, nothing
+// is drawn, textures are never uploaded to the GPU and no audio device is
+// opened, so sound samples are not decoded either.
+//
+// Command line:
+//   -headless               enable headless mode
+//   -headless-demo <num>    demo whose level to load (default: the first one)
+//   -headless-trace <path>  where to write the per-frame state hashes
+//   -headless-input <path>  replay this input instead of the level's demo
+//
+// An input file has the layout of a level's demo data: little-endian 32-bit
+// words with Lara's starting position, rotation and room (and in TR2 her
+// last gun type), followed by one word of input bits per logic frame. The
+// replay ends at the first word that is -1 or at the end of the file.
+
+void Headless_ParseArgs(int32_t arg_count, char **args);
+void Headless_Shutdown(void);
+
+bool Headless_IsEnabled(void);
+int32_t Headless_GetDemoNum(void);
+
+// Replaces the demo data of the level that was just loaded with the input
+// file, if one was given. Returns false if the demo data is left as is.
+bool Headless_LoadInput(uint32_t *data, int32_t max_count);
+
+// Appends the hash of the current game state to the trace. Called once per
+// logic frame; does nothing outside of headless mode.
+void Headless_TraceFrame(void);
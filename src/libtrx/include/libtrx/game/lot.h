@@ -23,3 +23,5 @@ typedef struct {
     int16_t required_box;
     XYZ_32 target;
 } LOT_INFO;
+
+int32_t LOT_GetActiveCount(void);
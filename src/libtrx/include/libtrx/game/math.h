@@ -2,4 +2,5 @@
 
 #include "./math/const.h"
 #include "./math/func.h"
+#include "./math/transform.h"
 #include "./math/types.h"
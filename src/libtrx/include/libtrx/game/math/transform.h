@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Batched view space transform and perspective projection of mesh vertices.
+// The vertices are processed in structure-of-arrays blocks of 4 or 8 using
+// SSE2, AVX2 or NEON when available, and one at a time otherwise. All
+// variants give bit-exact results: the matrix product is computed in integer
+// arithmetic and the projection in double precision, like the original code.
+// The vectorised kernel is checked against the plain C path on first use,
+// and is not used if they disagree.
+//
+// The input stays in the array-of-structs layout of the level meshes, which
+// collision, lighting and the savegame code read as well; each block is
+// transposed into lanes as it is loaded.
+
+typedef struct {
+    // 3x4 fixed point matrix in row-major order, laid out like MATRIX.
+    const int32_t *matrix;
+    double persp;
+    double center_x;
+    double center_y;
+    double near_z;
+    // The view Z of vertices in front of the near plane is offset by z_bias,
+    // unless it reaches far_z, in which case it is clamped to far_z.
+    double far_z;
+    double z_bias;
+    // Multiplies the perspective factor to give the reciprocal W.
+    double rhw_scale;
+    // Vertices outside of these screen bounds get the clip codes 1 (left),
+    // 2 (right), 4 (top) and 8 (bottom).
+    double left;
+    double top;
+    double right;
+    double bottom;
+    // Clip code for vertices behind the near plane, which replaces all the
+    // other codes.
+    int16_t near_clip;
+} MATH_PROJECTION;
+
+typedef struct {
+    // Distance in bytes between the outputs of consecutive vertices. The
+    // field pointers point at the output of the first vertex.
+    size_t stride;
+    float *xv;
+    float *yv;
+    float *zv;
+    float *xs;
+    float *ys;
+    // Optional.
+    float *rhw;
+    int16_t *clip;
+    // Optional, tightly packed integer view Z.
+    int32_t *zv_int;
+} MATH_VERTEX_OUTPUT;
+
+// Transforms count vertices whose X, Y and Z are consecutive int16s, with
+// the vertices being stride int16s apart. Vertices behind the near plane get
+// the screen coordinates of the view center. Returns the bitwise AND of all
+// clip codes.
+uint16_t Math_TransformVertices(
+    const MATH_PROJECTION *proj, const int16_t *vertices, int32_t stride,
+    int32_t count, const MATH_VERTEX_OUTPUT *output);
@@ -14,6 +14,8 @@ typedef struct {
 
 extern OBJECT *Object_GetObject(GAME_OBJECT_ID object_id);
 
+// The lookup is cached by the address of test_arr, which therefore needs to
+// be one of the static NO_OBJECT-terminated type arrays.
 bool Object_IsObjectType(
     GAME_OBJECT_ID object_id, const GAME_OBJECT_ID *test_arr);
 
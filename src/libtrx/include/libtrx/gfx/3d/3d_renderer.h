@@ -6,6 +6,7 @@
 #include "../gl/program.h"
 #include "../gl/sampler.h"
 #include "../gl/texture.h"
+#include "room_renderer.h"
 #include "vertex_stream.h"
 
 #define GFX_MAX_TEXTURES 128
@@ -70,3 +71,19 @@ void GFX_3D_Renderer_SetAlphaPointDiscard(
 void GFX_3D_Renderer_SetAlphaThreshold(GFX_3D_RENDERER *renderer, float value);
 void GFX_3D_Renderer_SetBrightnessMultiplier(
     GFX_3D_RENDERER *renderer, float value);
+
+// Retained room geometry, available with the texture array only. Texture
+// layers in the room textures are the handles returned by
+// GFX_3D_Renderer_RegisterTexturePage.
+bool GFX_3D_Renderer_IsRoomGeometrySupported(const GFX_3D_RENDERER *renderer);
+void GFX_3D_Renderer_UploadRoomGeometry(
+    GFX_3D_RENDERER *renderer, const GFX_3D_ROOM_VERTEX *vertices,
+    int vertex_count, const uint32_t *indices, int index_count);
+void GFX_3D_Renderer_UploadRoomTextures(
+    GFX_3D_RENDERER *renderer, const GFX_3D_ROOM_TEXTURE *textures, int count);
+void GFX_3D_Renderer_SetRoomTables(
+    GFX_3D_RENDERER *renderer, const int32_t *wibble_table,
+    const int32_t *shade_table);
+void GFX_3D_Renderer_DrawRoomGeometry(
+    GFX_3D_RENDERER *renderer, const GFX_3D_ROOM_PARAMS *params,
+    int first_index, int index_count, int vertex_count);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../gl/buffer.h"
+#include "../gl/program.h"
+#include "../gl/texture.h"
+#include "../gl/vertex_array.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Draws static room geometry that is uploaded once per level. The vertices
+// are transformed, lit and fogged in the vertex shader the same way the
+// software path in the game does it, so the CPU only has to set a handful of
+// uniforms per room. Requires the OpenGL 3.3 backend.
+
+#define GFX_3D_ROOM_WIBBLE_SIZE 32
+
+// The vertex is not moved by the underwater wibble effect.
+#define GFX_3D_ROOM_VERTEX_NO_WIBBLE 1
+
+typedef struct {
+    int16_t x, y, z;
+    int16_t shade;
+    // Index into the texture table, and which of its four UV pairs to use.
+    uint16_t texture;
+    uint16_t corner;
+    uint16_t flags;
+    // Per-vertex phase of the water shade table.
+    uint16_t shade_phase;
+} GFX_3D_ROOM_VERTEX;
+
+typedef struct {
+    // Texture page handle, or GFX_NO_TEXTURE.
+    int16_t layer;
+    uint16_t uv[4][2];
+} GFX_3D_ROOM_TEXTURE;
+
+typedef struct {
+    // Room to view space transform, in the game's fixed point units.
+    float matrix[3][4];
+    float center_x;
+    float center_y;
+    float persp;
+    float near_z;
+    // Depth mapping: depth = res_z_buf - res_z / z.
+    float res_z;
+    float res_z_buf;
+    int32_t draw_dist_fade;
+    int32_t draw_dist_max;
+    bool clip_far;
+    bool water_effect;
+    bool wibble_effect;
+    int32_t wibble_offset;
+    float brightness;
+    float tint[3];
+    bool pretty_pixels;
+} GFX_3D_ROOM_PARAMS;
+
+// State shared with the main 3D renderer program.
+typedef struct {
+    const float *projection;
+    bool smoothing_enabled;
+    bool alpha_point_discard;
+    float alpha_threshold;
+    float brightness_multiplier;
+} GFX_3D_ROOM_SHARED_STATE;
+
+typedef struct {
+    GFX_GL_PROGRAM program;
+    GFX_GL_VERTEX_ARRAY vertex_format;
+    GFX_GL_BUFFER vertex_buffer;
+    GFX_GL_BUFFER index_buffer;
+    GFX_GL_BUFFER texture_buffer;
+    GFX_GL_TEXTURE texture_info;
+    int texture_capacity;
+
+    // shader variable locations
+    GLint loc_mat_projection;
+    GLint loc_mat_room;
+    GLint loc_view_center;
+    GLint loc_persp;
+    GLint loc_near_z;
+    GLint loc_res_z;
+    GLint loc_res_z_buf;
+    GLint loc_draw_dist_fade;
+    GLint loc_draw_dist_max;
+    GLint loc_clip_far;
+    GLint loc_water_effect;
+    GLint loc_wibble_effect;
+    GLint loc_wibble_offset;
+    GLint loc_wibble_table;
+    GLint loc_shade_table;
+    GLint loc_brightness;
+    GLint loc_tint;
+    GLint loc_pretty_pixels;
+    GLint loc_smoothing_enabled;
+    GLint loc_alpha_point_discard;
+    GLint loc_alpha_threshold;
+    GLint loc_brightness_multiplier;
+} GFX_3D_ROOM_RENDERER;
+
+void GFX_3D_RoomRenderer_Init(
+    GFX_3D_ROOM_RENDERER *room_renderer, GFX_GL_BACKEND backend);
+void GFX_3D_RoomRenderer_Close(GFX_3D_ROOM_RENDERER *room_renderer);
+
+void GFX_3D_RoomRenderer_UploadGeometry(
+    GFX_3D_ROOM_RENDERER *room_renderer, const GFX_3D_ROOM_VERTEX *vertices,
+    int vertex_count, const uint32_t *indices, int index_count);
+void GFX_3D_RoomRenderer_UploadTextures(
+    GFX_3D_ROOM_RENDERER *room_renderer, const GFX_3D_ROOM_TEXTURE *textures,
+    int count);
+void GFX_3D_RoomRenderer_SetTables(
+    GFX_3D_ROOM_RENDERER *room_renderer, const int32_t *wibble_table,
+    const int32_t *shade_table);
+
+// Draws a range of the uploaded index buffer, which references vertex_count
+// distinct vertices. Leaves the room program and its vertex array bound.
+void GFX_3D_RoomRenderer_Draw(
+    GFX_3D_ROOM_RENDERER *room_renderer,
+    const GFX_3D_ROOM_SHARED_STATE *shared, const GFX_3D_ROOM_PARAMS *params,
+    int first_index, int index_count, int vertex_count);
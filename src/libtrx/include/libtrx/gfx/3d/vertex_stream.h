@@ -1,10 +1,12 @@
 #pragma once
 
-#include "../gl/buffer.h"
+#include "../common.h"
+#include "../gl/ring_buffer.h"
 #include "../gl/vertex_array.h"
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef enum {
     GFX_3D_PRIM_LINE = 0,
@@ -15,22 +17,46 @@ typedef struct {
     float x, y, z;
     float s, t, w;
     float r, g, b, a;
+    // Texture array layer, filled in by the vertex stream. Negative values
+    // stand for untextured polygons and the environment map.
+    float layer;
 } GFX_3D_VERTEX;
 
+// A run of pending indices that all refer to the same window of at most
+// 65536 vertices, so that they fit in 16 bits.
+typedef struct {
+    size_t first_vertex;
+    size_t first_index;
+} GFX_3D_VERTEX_BATCH;
+
+// Primitives are submitted indexed: each vertex of a fan or a strip is
+// stored once, and the triangles are made up by the index buffer.
 typedef struct {
     GFX_3D_PRIM_TYPE prim_type;
-    size_t buffer_size;
-    GFX_GL_BUFFER buffer;
+    float layer;
+    GFX_GL_RING_BUFFER buffer;
+    GFX_GL_RING_BUFFER index_buffer;
     GFX_GL_VERTEX_ARRAY vtc_format;
     struct {
         GFX_3D_VERTEX *data;
         size_t count;
         size_t capacity;
     } pending_vertices;
+    struct {
+        uint16_t *data;
+        size_t count;
+        size_t capacity;
+    } pending_indices;
+    struct {
+        GFX_3D_VERTEX_BATCH *data;
+        size_t count;
+        size_t capacity;
+    } pending_batches;
     size_t rendered_count;
 } GFX_3D_VERTEX_STREAM;
 
-void GFX_3D_VertexStream_Init(GFX_3D_VERTEX_STREAM *vertex_stream);
+void GFX_3D_VertexStream_Init(
+    GFX_3D_VERTEX_STREAM *vertex_stream, GFX_GL_BACKEND backend);
 void GFX_3D_VertexStream_Close(GFX_3D_VERTEX_STREAM *vertex_stream);
 
 void GFX_3D_VertexStream_Bind(GFX_3D_VERTEX_STREAM *vertex_stream);
@@ -38,6 +64,10 @@ void GFX_3D_VertexStream_Bind(GFX_3D_VERTEX_STREAM *vertex_stream);
 void GFX_3D_VertexStream_SetPrimType(
     GFX_3D_VERTEX_STREAM *vertex_stream, GFX_3D_PRIM_TYPE prim_type);
 
+// Sets the texture layer stamped onto the vertices pushed from now on.
+void GFX_3D_VertexStream_SetLayer(
+    GFX_3D_VERTEX_STREAM *vertex_stream, float layer);
+
 bool GFX_3D_VertexStream_PushPrimStrip(
     GFX_3D_VERTEX_STREAM *vertex_stream, const GFX_3D_VERTEX *vertices,
     int count);
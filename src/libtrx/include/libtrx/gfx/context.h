@@ -8,6 +8,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+typedef struct {
+    int32_t draw_calls;
+    int32_t vertices;
+} GFX_DRAW_STATS;
+
 bool GFX_Context_Attach(void *window_handle, GFX_GL_BACKEND backend);
 void GFX_Context_Detach(void);
 
@@ -37,3 +42,8 @@ const char *GFX_Context_GetScheduledScreenshotPath(void);
 void GFX_Context_ClearScheduledScreenshotPath(void);
 
 GFX_CONFIG *GFX_Context_GetConfig(void);
+
+// Counts 3D draw calls; the totals of the last presented frame can be
+// retrieved with GFX_Context_GetDrawStats.
+void GFX_Context_CountDraw(int32_t draw_calls, int32_t vertices);
+GFX_DRAW_STATS GFX_Context_GetDrawStats(void);
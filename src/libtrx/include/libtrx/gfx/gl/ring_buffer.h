@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../common.h"
+#include "buffer.h"
+#include "gl_core_3_3.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming buffer for data that is rewritten every frame. Writes are
+// appended after the data of earlier draw calls, so the driver never has to
+// wait for the GPU to finish reading a region before it gets overwritten.
+
+#define GFX_GL_RING_BUFFER_SEGMENTS 3
+
+typedef enum {
+    // Immutable storage that stays mapped, split into segments that are
+    // guarded by fences. Needs ARB_buffer_storage.
+    GFX_GL_RING_BUFFER_PERSISTENT,
+    // Unsynchronized glMapBufferRange writes; the storage is orphaned when
+    // the write head wraps around.
+    GFX_GL_RING_BUFFER_MAP_RANGE,
+    // Like the above, but with glBufferSubData, for OpenGL 2.1.
+    GFX_GL_RING_BUFFER_SUB_DATA,
+} GFX_GL_RING_BUFFER_MODE;
+
+typedef struct {
+    GFX_GL_BUFFER buffer;
+    GFX_GL_RING_BUFFER_MODE mode;
+    size_t size;
+    size_t offset;
+    uint8_t *mapped;
+    int32_t segment;
+    GLsync fences[GFX_GL_RING_BUFFER_SEGMENTS];
+} GFX_GL_RING_BUFFER;
+
+void GFX_GL_RingBuffer_Init(
+    GFX_GL_RING_BUFFER *ring, GLenum target, size_t size,
+    GFX_GL_BACKEND backend);
+void GFX_GL_RingBuffer_Close(GFX_GL_RING_BUFFER *ring);
+
+// Copies the data into the buffer and returns its offset in bytes. Leaves
+// the buffer bound. The buffer object may be replaced if the data does not
+// fit, so vertex attribute pointers need to be set after this call.
+size_t GFX_GL_RingBuffer_Push(
+    GFX_GL_RING_BUFFER *ring, const void *data, size_t size);
@@ -20,3 +20,13 @@ void GFX_GL_Texture_Load(
     GFX_GL_TEXTURE *texture, const void *data, int width, int height,
     GLint internal_format, GLint format);
 void GFX_GL_Texture_LoadFromBackBuffer(GFX_GL_TEXTURE *texture);
+
+// Allocates storage for a GL_TEXTURE_2D_ARRAY texture. If data is not NULL,
+// it must hold all of the layers one after another.
+void GFX_GL_Texture_LoadArray(
+    GFX_GL_TEXTURE *texture, const void *data, int width, int height,
+    int layer_count, GLint internal_format, GLint format);
+void GFX_GL_Texture_LoadArrayLayer(
+    GFX_GL_TEXTURE *texture, int layer, const void *data, int width,
+    int height, GLint format);
+void GFX_GL_Texture_GenerateMipmap(GFX_GL_TEXTURE *texture);
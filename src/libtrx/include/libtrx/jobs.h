@@ -0,0 +1,41 @@
+#pragma once
+
+// A small job system backed by a pool of worker threads. Jobs are grouped in
+// graphs; a job only starts once all of the jobs it depends on have finished.
+// Jobs must not touch state that other jobs of the same graph may touch at the
+// same time – in particular, GameBuf is not thread safe, so jobs that allocate
+// from it must be chained with dependencies.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct JOB_GRAPH JOB_GRAPH;
+typedef int32_t JOB_ID;
+typedef void (*JOB_FUNC)(void *user_data);
+
+// Spawns the worker threads. The pool size is derived from the CPU count.
+// If the pool is not initialised, graphs run serially on the calling thread.
+void Jobs_Init(void);
+void Jobs_Shutdown(void);
+
+// Returns the number of worker threads, not counting the calling thread.
+int32_t Jobs_GetWorkerCount(void);
+
+JOB_GRAPH *Jobs_CreateGraph(void);
+void Jobs_FreeGraph(JOB_GRAPH *graph);
+
+// Adds a job to a graph that is not running yet, and returns its handle.
+JOB_ID Jobs_Add(JOB_GRAPH *graph, JOB_FUNC func, void *user_data);
+
+// Makes the job wait for the dependency to finish before it starts.
+void Jobs_AddDependency(JOB_GRAPH *graph, JOB_ID job, JOB_ID dependency);
+
+// Hands all jobs of the graph to the workers without waiting for them.
+void Jobs_Start(JOB_GRAPH *graph);
+
+// Blocks until all jobs of a started graph have finished. The calling thread
+// helps with executing the remaining jobs while it waits.
+void Jobs_Wait(JOB_GRAPH *graph);
+
+// Shorthand for Jobs_Start followed by Jobs_Wait.
+void Jobs_Run(JOB_GRAPH *graph);
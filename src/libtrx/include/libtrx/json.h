@@ -58,6 +58,10 @@ typedef struct {
     JSON_OBJECT_ELEMENT *start;
     size_t length;
     size_t ref_count;
+    // Open addressing hash table of the elements, keyed by name. NULL for
+    // small objects, which are scanned linearly.
+    JSON_OBJECT_ELEMENT **index;
+    size_t index_size;
 } JSON_OBJECT;
 
 typedef struct JSON_ARRAY_ELEMENT {
@@ -70,6 +74,10 @@ typedef struct {
     JSON_ARRAY_ELEMENT *start;
     size_t length;
     size_t ref_count;
+    // Elements in order, for random access. May be NULL, in which case the
+    // list is walked.
+    JSON_ARRAY_ELEMENT **elements;
+    size_t capacity;
 } JSON_ARRAY;
 
 typedef struct {
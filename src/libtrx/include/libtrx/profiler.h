@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL2/SDL_stdinc.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Zone profiler for finding out where the frame time goes. Zones live on
+// the stack of the code they measure and may nest. Closed zones are kept
+// per frame in a ring of the most recent frames, which can be exported as a
+// Chrome trace, viewable in chrome://tracing or ui.perfetto.dev. While the
+// profiler is off, a zone costs a single branch.
+
+typedef struct {
+    const char *name;
+    Uint64 start;
+} PROFILER_ZONE;
+
+// Measures a single statement. The name must be a string literal.
+#define PROFILER_CALL(name, call)                                              \
+    do {                                                                       \
+        PROFILER_ZONE profiler_zone;                                           \
+        Profiler_BeginZone(&profiler_zone, name);                              \
+        call;                                                                  \
+        Profiler_EndZone(&profiler_zone);                                      \
+    } while (0)
+
+void Profiler_SetEnabled(bool enabled);
+bool Profiler_IsEnabled(void);
+
+// The name must be a string literal or otherwise outlive the profiler.
+void Profiler_BeginZone(PROFILER_ZONE *zone, const char *name);
+void Profiler_EndZone(const PROFILER_ZONE *zone);
+
+// Closes the frame zone that spans everything since the previous call.
+void Profiler_EndFrame(void);
+
+// Writes the recorded zones as Chrome trace JSON. Returns the number of
+// exported zones, or -1 on failure.
+int32_t Profiler_Export(const char *path);
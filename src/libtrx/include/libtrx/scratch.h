@@ -0,0 +1,40 @@
+#pragma once
+
+// A bump allocator for short-lived temporaries, mostly used while a level is
+// being loaded. Instead of freeing individual allocations, callers take a mark
+// before allocating and rewind to it once they are done, which releases
+// everything allocated since in one go. The memory itself is kept around, so
+// repeated loads do not hit the system allocator again.
+//
+// The arena is not thread safe and must only be used from the main thread;
+// jobs may read scratch memory that was allocated before they started, but
+// must not allocate from it.
+
+#include <stddef.h>
+
+typedef struct {
+    void *chunk;
+    size_t used;
+} SCRATCH_MARK;
+
+void Scratch_Init(void);
+void Scratch_Shutdown(void);
+
+// Rewinds the whole arena and gives back any memory that a big allocation
+// needed on top of the first chunk. Outstanding marks become invalid.
+void Scratch_Reset(void);
+
+// Remembers the current state of the arena, to be passed to Scratch_Rewind.
+SCRATCH_MARK Scratch_Mark(void);
+
+// Frees everything allocated after the given mark was taken. Marks must be
+// rewound in the reverse order they were taken in.
+void Scratch_Rewind(SCRATCH_MARK mark);
+
+// Allocates n bytes that stay valid until the arena is rewound past them.
+// The memory is filled with zeros.
+void *Scratch_Alloc(size_t size);
+
+// Like Scratch_Alloc, but leaves the contents of the memory undefined. Use it
+// for buffers that get overwritten in full right away.
+void *Scratch_AllocNoZero(size_t size);
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
-    char *content;
+    const char *content;
     size_t size;
-    char *cur_ptr;
+    const char *cur_ptr;
+    bool is_mapped;
+    void *mapping;
 } VFILE;
 
+// Opens the file at the given path. Where the platform supports it, the file
+// is memory-mapped read-only rather than copied into the heap, so views
+// obtained with VFile_View* stay valid until VFile_Close.
 VFILE *VFile_CreateFromPath(const char *path);
 VFILE *VFile_CreateFromBuffer(const char *data, size_t size);
 void VFile_Close(VFILE *file);
@@ -24,3 +30,17 @@ int32_t VFile_ReadS32(VFILE *file);
 uint8_t VFile_ReadU8(VFILE *file);
 uint16_t VFile_ReadU16(VFILE *file);
 uint32_t VFile_ReadU32(VFILE *file);
+
+// Returns a pointer to the next n bytes of the file and advances past them,
+// without copying anything. The returned memory is read-only, is only valid
+// until the file is closed, and carries no alignment guarantees beyond those
+// of the on-disk layout. The typed variants assert that the data is aligned
+// for their type, so only use them where the layout guarantees that; read
+// unaligned arrays with VFile_Read instead.
+const void *VFile_View(VFILE *file, size_t size);
+const int8_t *VFile_ViewS8(VFILE *file, size_t count);
+const int16_t *VFile_ViewS16(VFILE *file, size_t count);
+const int32_t *VFile_ViewS32(VFILE *file, size_t count);
+const uint8_t *VFile_ViewU8(VFILE *file, size_t count);
+const uint16_t *VFile_ViewU16(VFILE *file, size_t count);
+const uint32_t *VFile_ViewU32(VFILE *file, size_t count);
@@ -0,0 +1,298 @@
+#include "jobs.h"
+
+#include "debug.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+#include "vector.h"
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+
+#define JOBS_MAX_WORKERS 16
+
+typedef struct {
+    JOB_FUNC func;
+    void *user_data;
+    int32_t pending_deps;
+    VECTOR *dependents;
+    JOB_GRAPH *graph;
+} JOB;
+
+struct JOB_GRAPH {
+    VECTOR *jobs;
+    int32_t remaining;
+    bool is_started;
+};
+
+static SDL_mutex *m_Mutex = NULL;
+static SDL_cond *m_JobReady = NULL;
+static SDL_cond *m_GraphDone = NULL;
+static SDL_Thread *m_Workers[JOBS_MAX_WORKERS] = {};
+static int32_t m_WorkerCount = 0;
+static bool m_IsShuttingDown = false;
+static VECTOR *m_ReadyQueue = NULL;
+
+static JOB *M_GetJob(JOB_GRAPH *graph, JOB_ID job_id);
+static void M_PushReady(JOB *job);
+static JOB *M_PopReady(void);
+static void M_FinishJob(JOB *job);
+static void M_ExecuteLocked(JOB *job);
+static void M_RunSerial(JOB_GRAPH *graph);
+static int M_WorkerThread(void *arg);
+
+static JOB *M_GetJob(JOB_GRAPH *const graph, const JOB_ID job_id)
+{
+    ASSERT(job_id >= 0 && job_id < graph->jobs->count);
+    return Vector_Get(graph->jobs, job_id);
+}
+
+static void M_PushReady(JOB *job)
+{
+    Vector_Add(m_ReadyQueue, &job);
+    SDL_CondSignal(m_JobReady);
+}
+
+static JOB *M_PopReady(void)
+{
+    if (m_ReadyQueue->count == 0) {
+        return NULL;
+    }
+    JOB *const job = *(JOB **)Vector_Get(m_ReadyQueue, 0);
+    Vector_RemoveAt(m_ReadyQueue, 0);
+    return job;
+}
+
+static void M_FinishJob(JOB *const job)
+{
+    JOB_GRAPH *const graph = job->graph;
+    for (int32_t i = 0; i < job->dependents->count; i++) {
+        const JOB_ID dependent_id = *(JOB_ID *)Vector_Get(job->dependents, i);
+        JOB *const dependent = M_GetJob(graph, dependent_id);
+        dependent->pending_deps--;
+        if (dependent->pending_deps == 0) {
+            M_PushReady(dependent);
+        }
+    }
+
+    graph->remaining--;
+    if (graph->remaining == 0) {
+        SDL_CondBroadcast(m_GraphDone);
+    }
+}
+
+static void M_ExecuteLocked(JOB *const job)
+{
+    SDL_UnlockMutex(m_Mutex);
+    job->func(job->user_data);
+    SDL_LockMutex(m_Mutex);
+    M_FinishJob(job);
+}
+
+static void M_RunSerial(JOB_GRAPH *const graph)
+{
+    VECTOR *const queue = Vector_Create(sizeof(JOB *));
+    for (int32_t i = 0; i < graph->jobs->count; i++) {
+        JOB *job = M_GetJob(graph, i);
+        if (job->pending_deps == 0) {
+            Vector_Add(queue, &job);
+        }
+    }
+
+    while (queue->count > 0) {
+        JOB *const job = *(JOB **)Vector_Get(queue, 0);
+        Vector_RemoveAt(queue, 0);
+        job->func(job->user_data);
+        for (int32_t i = 0; i < job->dependents->count; i++) {
+            const JOB_ID dependent_id =
+                *(JOB_ID *)Vector_Get(job->dependents, i);
+            JOB *dependent = M_GetJob(graph, dependent_id);
+            dependent->pending_deps--;
+            if (dependent->pending_deps == 0) {
+                Vector_Add(queue, &dependent);
+            }
+        }
+        graph->remaining--;
+    }
+
+    Vector_Free(queue);
+    ASSERT(graph->remaining == 0);
+}
+
+static int M_WorkerThread(void *const arg)
+{
+    SDL_LockMutex(m_Mutex);
+    while (true) {
+        while (!m_IsShuttingDown && m_ReadyQueue->count == 0) {
+            SDL_CondWait(m_JobReady, m_Mutex);
+        }
+        if (m_IsShuttingDown) {
+            break;
+        }
+        M_ExecuteLocked(M_PopReady());
+    }
+    SDL_UnlockMutex(m_Mutex);
+    return 0;
+}
+
+void Jobs_Init(void)
+{
+    if (m_Mutex != NULL) {
+        return;
+    }
+
+    m_Mutex = SDL_CreateMutex();
+    m_JobReady = SDL_CreateCond();
+    m_GraphDone = SDL_CreateCond();
+    m_ReadyQueue = Vector_Create(sizeof(JOB *));
+    m_IsShuttingDown = false;
+
+    // The thread that waits on a graph takes part in executing it, so leave
+    // one core for it.
+    int32_t worker_count = SDL_GetCPUCount() - 1;
+    CLAMP(worker_count, 0, JOBS_MAX_WORKERS);
+    m_WorkerCount = 0;
+    for (int32_t i = 0; i < worker_count; i++) {
+        SDL_Thread *const thread =
+            SDL_CreateThread(M_WorkerThread, "job_worker", NULL);
+        if (thread == NULL) {
+            LOG_ERROR("SDL_CreateThread(): %s", SDL_GetError());
+            break;
+        }
+        m_Workers[m_WorkerCount++] = thread;
+    }
+    LOG_INFO("Started %d job workers", m_WorkerCount);
+}
+
+void Jobs_Shutdown(void)
+{
+    if (m_Mutex == NULL) {
+        return;
+    }
+
+    SDL_LockMutex(m_Mutex);
+    m_IsShuttingDown = true;
+    SDL_CondBroadcast(m_JobReady);
+    SDL_UnlockMutex(m_Mutex);
+
+    for (int32_t i = 0; i < m_WorkerCount; i++) {
+        SDL_WaitThread(m_Workers[i], NULL);
+        m_Workers[i] = NULL;
+    }
+    m_WorkerCount = 0;
+
+    Vector_Free(m_ReadyQueue);
+    m_ReadyQueue = NULL;
+    SDL_DestroyCond(m_GraphDone);
+    SDL_DestroyCond(m_JobReady);
+    SDL_DestroyMutex(m_Mutex);
+    m_GraphDone = NULL;
+    m_JobReady = NULL;
+    m_Mutex = NULL;
+}
+
+int32_t Jobs_GetWorkerCount(void)
+{
+    return m_WorkerCount;
+}
+
+JOB_GRAPH *Jobs_CreateGraph(void)
+{
+    JOB_GRAPH *const graph = Memory_Alloc(sizeof(JOB_GRAPH));
+    graph->jobs = Vector_Create(sizeof(JOB));
+    graph->remaining = 0;
+    graph->is_started = false;
+    return graph;
+}
+
+void Jobs_FreeGraph(JOB_GRAPH *graph)
+{
+    ASSERT(graph != NULL);
+    ASSERT(graph->remaining == 0);
+    for (int32_t i = 0; i < graph->jobs->count; i++) {
+        JOB *const job = M_GetJob(graph, i);
+        Vector_Free(job->dependents);
+    }
+    Vector_Free(graph->jobs);
+    Memory_FreePointer(&graph);
+}
+
+JOB_ID Jobs_Add(
+    JOB_GRAPH *const graph, const JOB_FUNC func, void *const user_data)
+{
+    ASSERT(graph != NULL);
+    ASSERT(func != NULL);
+    ASSERT(!graph->is_started);
+    JOB job = {
+        .func = func,
+        .user_data = user_data,
+        .pending_deps = 0,
+        .dependents = Vector_Create(sizeof(JOB_ID)),
+        .graph = graph,
+    };
+    Vector_Add(graph->jobs, &job);
+    graph->remaining++;
+    return graph->jobs->count - 1;
+}
+
+void Jobs_AddDependency(
+    JOB_GRAPH *const graph, const JOB_ID job_id, const JOB_ID dependency_id)
+{
+    ASSERT(!graph->is_started);
+    ASSERT(job_id != dependency_id);
+    JOB *const job = M_GetJob(graph, job_id);
+    JOB *const dependency = M_GetJob(graph, dependency_id);
+    Vector_Add(dependency->dependents, (void *)&job_id);
+    job->pending_deps++;
+}
+
+void Jobs_Start(JOB_GRAPH *const graph)
+{
+    ASSERT(graph != NULL);
+    ASSERT(!graph->is_started);
+    graph->is_started = true;
+
+    if (m_Mutex == NULL || m_WorkerCount == 0) {
+        // Without workers there is nobody to hand the jobs to, so run them
+        // when the graph is awaited.
+        return;
+    }
+
+    SDL_LockMutex(m_Mutex);
+    for (int32_t i = 0; i < graph->jobs->count; i++) {
+        JOB *const job = M_GetJob(graph, i);
+        if (job->pending_deps == 0) {
+            M_PushReady(job);
+        }
+    }
+    SDL_UnlockMutex(m_Mutex);
+}
+
+void Jobs_Wait(JOB_GRAPH *const graph)
+{
+    ASSERT(graph != NULL);
+    ASSERT(graph->is_started);
+
+    if (m_Mutex == NULL || m_WorkerCount == 0) {
+        M_RunSerial(graph);
+        return;
+    }
+
+    SDL_LockMutex(m_Mutex);
+    while (graph->remaining > 0) {
+        JOB *const job = M_PopReady();
+        if (job != NULL) {
+            M_ExecuteLocked(job);
+        } else {
+            SDL_CondWait(m_GraphDone, m_Mutex);
+        }
+    }
+    SDL_UnlockMutex(m_Mutex);
+}
+
+void Jobs_Run(JOB_GRAPH *const graph)
+{
+    Jobs_Start(graph);
+    Jobs_Wait(graph);
+}
@@ -1,6 +1,7 @@
 #include "bson.h"
 
 #include "debug.h"
+#include "json/priv.h"
 #include "log.h"
 #include "memory.h"
 
@@ -18,6 +19,7 @@ typedef struct {
     char *dom;
     size_t dom_size;
     size_t data_size;
+    bool borrow_strings;
 
     size_t error;
 } M_STATE;
@@ -53,15 +55,21 @@ static void M_HandleObject(M_STATE *state, JSON_OBJECT *object);
 static void M_HandleObjectValue(M_STATE *state, JSON_VALUE *value);
 static void M_HandleValue(M_STATE *state, JSON_VALUE *value, uint8_t marker);
 
+static JSON_VALUE *M_Parse(
+    const char *src, size_t src_size, BSON_PARSE_RESULT *result,
+    bool in_place);
+
 static bool M_GetObjectKeySize(M_STATE *state)
 {
     ASSERT(state != NULL);
+    const size_t start_offset = state->offset;
     while (state->src[state->offset]) {
-        state->data_size++;
         state->offset++;
     }
-    state->data_size++;
     state->offset++;
+    if (!state->borrow_strings) {
+        state->data_size += state->offset - start_offset;
+    }
     return true;
 }
 
@@ -142,7 +150,9 @@ static bool M_GetStringValueSize(M_STATE *state)
     }
     state->offset += size;
     state->dom_size += sizeof(JSON_STRING);
-    state->data_size += size;
+    if (!state->borrow_strings) {
+        state->data_size += size;
+    }
     return true;
 }
 
@@ -179,12 +189,16 @@ static bool M_GetArraySize(M_STATE *state)
     const int size = *(int32_t *)&state->src[state->offset];
     state->offset += sizeof(int32_t);
 
+    size_t count = 0;
     while (state->offset < start_offset + size - 1) {
         state->dom_size += sizeof(JSON_ARRAY_ELEMENT);
         if (!M_GetArrayElementWrappedSize(state)) {
             return false;
         }
+        count++;
     }
+    state->dom_size +=
+        sizeof(JSON_ARRAY_ELEMENT *) * JSON_GetArrayIndexSize(count);
 
     if (state->offset + sizeof(char) > state->size) {
         state->error = BSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
@@ -237,12 +251,16 @@ static bool M_GetObjectSize(M_STATE *state)
     const int size = *(int32_t *)&state->src[state->offset];
     state->offset += sizeof(int32_t);
 
+    size_t count = 0;
     while (state->offset < start_offset + size - 1) {
         state->dom_size += sizeof(JSON_OBJECT_ELEMENT);
         if (!M_GetObjectElementWrappedSize(state)) {
             return false;
         }
+        count++;
     }
+    state->dom_size +=
+        sizeof(JSON_OBJECT_ELEMENT *) * JSON_GetObjectIndexSize(count);
 
     if (state->offset + sizeof(char) > state->size) {
         state->error = BSON_PARSE_ERROR_PREMATURE_END_OF_BUFFER;
@@ -298,8 +316,15 @@ static void M_HandleObjectKey(M_STATE *state, JSON_STRING *string)
 {
     ASSERT(state != NULL);
     ASSERT(string != NULL);
-    size_t size = 0;
     string->ref_count = 1;
+    if (state->borrow_strings) {
+        string->string = (char *)&state->src[state->offset];
+        string->string_size = strlen(string->string);
+        state->offset += string->string_size + 1;
+        return;
+    }
+
+    size_t size = 0;
     string->string = state->data;
     while (state->src[state->offset]) {
         state->data[size++] = state->src[state->offset++];
@@ -403,12 +428,15 @@ static void M_HandleStringValue(M_STATE *state, JSON_VALUE *value)
     string->ref_count = 1;
     state->dom += sizeof(JSON_STRING);
 
-    memcpy(state->data, state->src + state->offset, size);
-    state->offset += size;
-
-    string->string = state->data;
+    if (state->borrow_strings) {
+        string->string = (char *)&state->src[state->offset];
+    } else {
+        memcpy(state->data, state->src + state->offset, size);
+        string->string = state->data;
+        state->data += size;
+    }
     string->string_size = size;
-    state->data += size;
+    state->offset += size;
 
     value->type = JSON_TYPE_STRING;
     value->payload = string;
@@ -472,6 +500,9 @@ static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
     }
     array->ref_count = 1;
     array->length = count;
+    JSON_ARRAY_ELEMENT **const table = (JSON_ARRAY_ELEMENT **)state->dom;
+    state->dom += sizeof(JSON_ARRAY_ELEMENT *) * JSON_GetArrayIndexSize(count);
+    JSON_ArrayBuildIndex(array, table);
     ASSERT(state->offset + sizeof(char) <= state->size);
     ASSERT(state->src[state->offset] == '\0');
     state->offset++;
@@ -550,6 +581,10 @@ static void M_HandleObject(M_STATE *state, JSON_OBJECT *object)
     }
     object->ref_count = 1;
     object->length = count;
+    JSON_OBJECT_ELEMENT **const index = (JSON_OBJECT_ELEMENT **)state->dom;
+    const size_t index_size = JSON_GetObjectIndexSize(count);
+    state->dom += sizeof(JSON_OBJECT_ELEMENT *) * index_size;
+    JSON_ObjectBuildIndex(object, index, index_size);
     ASSERT(state->offset + sizeof(char) <= state->size);
     ASSERT(state->src[state->offset] == '\0');
     state->offset++;
@@ -606,8 +641,9 @@ JSON_VALUE *BSON_Parse(const char *src, size_t src_size)
     return BSON_ParseEx(src, src_size, NULL);
 }
 
-JSON_VALUE *BSON_ParseEx(
-    const char *src, size_t src_size, BSON_PARSE_RESULT *result)
+static JSON_VALUE *M_Parse(
+    const char *src, size_t src_size, BSON_PARSE_RESULT *result,
+    const bool in_place)
 {
     M_STATE state;
     void *allocation;
@@ -629,6 +665,7 @@ JSON_VALUE *BSON_ParseEx(
     state.error = BSON_PARSE_ERROR_NONE;
     state.dom_size = 0;
     state.data_size = 0;
+    state.borrow_strings = in_place;
 
     if (M_GetRootSize(&state)) {
         if (state.offset != state.size) {
@@ -644,12 +681,24 @@ JSON_VALUE *BSON_ParseEx(
         LOG_ERROR(
             "Error while reading BSON near offset %d: %s", state.offset,
             BSON_GetErrorDescription(state.error));
+        if (in_place) {
+            Memory_Free((void *)src);
+        }
         return NULL;
     }
 
     total_size = state.dom_size + state.data_size;
 
-    allocation = Memory_Alloc(total_size);
+    if (in_place) {
+        // Move the source to the end of the allocation, so that the root
+        // value stays at its start and frees the strings with the rest.
+        allocation = Memory_Realloc((void *)src, total_size + src_size);
+        memmove((char *)allocation + total_size, allocation, src_size);
+        memset(allocation, 0, total_size);
+        state.src = (char *)allocation + total_size;
+    } else {
+        allocation = Memory_Alloc(total_size);
+    }
     state.offset = 0;
     state.dom = (char *)allocation;
     state.data = state.dom + state.dom_size;
@@ -666,6 +715,18 @@ JSON_VALUE *BSON_ParseEx(
     return value;
 }
 
+JSON_VALUE *BSON_ParseEx(
+    const char *src, size_t src_size, BSON_PARSE_RESULT *result)
+{
+    return M_Parse(src, src_size, result, false);
+}
+
+JSON_VALUE *BSON_ParseInPlace(
+    char *src, size_t src_size, BSON_PARSE_RESULT *result)
+{
+    return M_Parse(src, src_size, result, true);
+}
+
 const char *BSON_GetErrorDescription(BSON_PARSE_ERROR error)
 {
     switch (error) {
@@ -1,5 +1,6 @@
 #include "json.h"
 
+#include "json/priv.h"
 #include "memory.h"
 
 #include <inttypes.h>
@@ -24,6 +25,14 @@ static JSON_ARRAY *M_ValueAsArray(JSON_VALUE *const value);
 static void M_ArrayElementFree(JSON_ARRAY_ELEMENT *element);
 static void M_ObjectElementFree(JSON_OBJECT_ELEMENT *element);
 
+static size_t M_HashKey(const char *key);
+static void M_ObjectIndexInsert(
+    JSON_OBJECT_ELEMENT **index, size_t index_size,
+    JSON_OBJECT_ELEMENT *elem);
+static void M_ObjectReindex(JSON_OBJECT *obj);
+static JSON_OBJECT_ELEMENT *M_ObjectFindElement(
+    const JSON_OBJECT *obj, const char *key);
+
 static JSON_NUMBER *M_NumberNewInt(const int number)
 {
     const size_t size = snprintf(NULL, 0, "%d", number) + 1;
@@ -155,6 +164,128 @@ static void M_ObjectElementFree(JSON_OBJECT_ELEMENT *element)
     }
 }
 
+static size_t M_HashKey(const char *key)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*key != '\0') {
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void M_ObjectIndexInsert(
+    JSON_OBJECT_ELEMENT **const index, const size_t index_size,
+    JSON_OBJECT_ELEMENT *const elem)
+{
+    const size_t mask = index_size - 1;
+    size_t slot = M_HashKey(elem->name->string) & mask;
+    while (index[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    index[slot] = elem;
+}
+
+static void M_ObjectReindex(JSON_OBJECT *const obj)
+{
+    if (obj->ref_count != 0) {
+        // The index of a parsed object lives in the parser's allocation and
+        // cannot be resized, so fall back to linear lookups.
+        obj->index = NULL;
+        obj->index_size = 0;
+        return;
+    }
+
+    const size_t index_size = JSON_GetObjectIndexSize(obj->length);
+    if (index_size == 0) {
+        Memory_FreePointer(&obj->index);
+        obj->index_size = 0;
+        return;
+    }
+    if (index_size != obj->index_size) {
+        obj->index = Memory_Realloc(
+            obj->index, sizeof(JSON_OBJECT_ELEMENT *) * index_size);
+    }
+    JSON_ObjectBuildIndex(obj, obj->index, index_size);
+}
+
+static JSON_OBJECT_ELEMENT *M_ObjectFindElement(
+    const JSON_OBJECT *const obj, const char *const key)
+{
+    if (obj->index == NULL) {
+        JSON_OBJECT_ELEMENT *elem = obj->start;
+        while (elem != NULL) {
+            if (!strcmp(elem->name->string, key)) {
+                return elem;
+            }
+            elem = elem->next;
+        }
+        return NULL;
+    }
+
+    // Probing visits duplicate keys in insertion order, so this returns the
+    // same element as the linear scan.
+    const size_t mask = obj->index_size - 1;
+    size_t slot = M_HashKey(key) & mask;
+    while (obj->index[slot] != NULL) {
+        if (!strcmp(obj->index[slot]->name->string, key)) {
+            return obj->index[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+size_t JSON_GetArrayIndexSize(const size_t length)
+{
+    return length;
+}
+
+size_t JSON_GetObjectIndexSize(const size_t length)
+{
+    if (length <= JSON_OBJECT_INDEX_THRESHOLD) {
+        return 0;
+    }
+    // Keep the load factor at or below one half.
+    size_t index_size = 1;
+    while (index_size < length * 2) {
+        index_size <<= 1;
+    }
+    return index_size;
+}
+
+void JSON_ArrayBuildIndex(
+    JSON_ARRAY *const arr, JSON_ARRAY_ELEMENT **const elements)
+{
+    size_t i = 0;
+    for (JSON_ARRAY_ELEMENT *elem = arr->start; elem != NULL;
+         elem = elem->next) {
+        elements[i++] = elem;
+    }
+    arr->elements = elements;
+    arr->capacity = arr->length;
+}
+
+void JSON_ObjectBuildIndex(
+    JSON_OBJECT *const obj, JSON_OBJECT_ELEMENT **const index,
+    const size_t index_size)
+{
+    if (index_size == 0) {
+        obj->index = NULL;
+        obj->index_size = 0;
+        return;
+    }
+
+    memset(index, 0, sizeof(JSON_OBJECT_ELEMENT *) * index_size);
+    for (JSON_OBJECT_ELEMENT *elem = obj->start; elem != NULL;
+         elem = elem->next) {
+        M_ObjectIndexInsert(index, index_size, elem);
+    }
+    obj->index = index;
+    obj->index_size = index_size;
+}
+
 JSON_VALUE *JSON_ValueFromBool(const int b)
 {
     JSON_VALUE *const value = Memory_Alloc(sizeof(JSON_VALUE));
@@ -295,6 +426,8 @@ JSON_ARRAY *JSON_ArrayNew(void)
     JSON_ARRAY *const arr = Memory_Alloc(sizeof(JSON_ARRAY));
     arr->start = NULL;
     arr->length = 0;
+    arr->elements = NULL;
+    arr->capacity = 0;
     return arr;
 }
 
@@ -308,6 +441,7 @@ void JSON_ArrayFree(JSON_ARRAY *const arr)
         elem = next;
     }
     if (arr->ref_count == 0) {
+        Memory_Free(arr->elements);
         Memory_Free(arr);
     }
 }
@@ -317,7 +451,9 @@ void JSON_ArrayAppend(JSON_ARRAY *const arr, JSON_VALUE *const value)
     JSON_ARRAY_ELEMENT *elem = Memory_Alloc(sizeof(JSON_ARRAY_ELEMENT));
     elem->value = value;
     elem->next = NULL;
-    if (arr->start) {
+    if (arr->elements != NULL && arr->length > 0) {
+        arr->elements[arr->length - 1]->next = elem;
+    } else if (arr->start) {
         JSON_ARRAY_ELEMENT *target = arr->start;
         while (target->next) {
             target = target->next;
@@ -326,6 +462,20 @@ void JSON_ArrayAppend(JSON_ARRAY *const arr, JSON_VALUE *const value)
     } else {
         arr->start = elem;
     }
+
+    if (arr->ref_count != 0) {
+        // The table of a parsed array lives in the parser's allocation and
+        // cannot grow, so fall back to walking the list.
+        arr->elements = NULL;
+        arr->capacity = 0;
+    } else {
+        if (arr->length >= arr->capacity) {
+            arr->capacity = arr->capacity == 0 ? 8 : arr->capacity * 2;
+            arr->elements = Memory_Realloc(
+                arr->elements, sizeof(JSON_ARRAY_ELEMENT *) * arr->capacity);
+        }
+        arr->elements[arr->length] = elem;
+    }
     arr->length++;
 }
 
@@ -364,6 +514,9 @@ JSON_VALUE *JSON_ArrayGetValue(JSON_ARRAY *const arr, const size_t idx)
     if (arr == NULL || idx >= arr->length) {
         return NULL;
     }
+    if (arr->elements != NULL) {
+        return arr->elements[idx]->value;
+    }
     JSON_ARRAY_ELEMENT *elem = arr->start;
     for (size_t i = 0; i < idx; i++) {
         elem = elem->next;
@@ -415,6 +568,8 @@ JSON_OBJECT *JSON_ObjectNew(void)
     JSON_OBJECT *obj = Memory_Alloc(sizeof(JSON_OBJECT));
     obj->start = NULL;
     obj->length = 0;
+    obj->index = NULL;
+    obj->index_size = 0;
     return obj;
 }
 
@@ -429,6 +584,7 @@ void JSON_ObjectFree(JSON_OBJECT *obj)
         elem = next;
     }
     if (obj->ref_count == 0) {
+        Memory_Free(obj->index);
         Memory_Free(obj);
     }
 }
@@ -450,6 +606,13 @@ void JSON_ObjectAppend(
         obj->start = elem;
     }
     obj->length++;
+
+    if (obj->index != NULL && obj->ref_count == 0
+        && obj->index_size >= JSON_GetObjectIndexSize(obj->length)) {
+        M_ObjectIndexInsert(obj->index, obj->index_size, elem);
+    } else {
+        M_ObjectReindex(obj);
+    }
 }
 
 void JSON_ObjectAppendBool(JSON_OBJECT *obj, const char *key, int b)
@@ -491,16 +654,7 @@ void JSON_ObjectAppendObject(
 
 bool JSON_ObjectContainsKey(JSON_OBJECT *const obj, const char *const key)
 {
-    JSON_OBJECT_ELEMENT *elem = obj->start;
-    while (elem != NULL) {
-        if (!strcmp(elem->name->string, key)) {
-            return true;
-        }
-
-        elem = elem->next;
-    }
-
-    return false;
+    return M_ObjectFindElement(obj, key) != NULL;
 }
 
 void JSON_ObjectEvictKey(JSON_OBJECT *const obj, const char *const key)
@@ -518,6 +672,8 @@ void JSON_ObjectEvictKey(JSON_OBJECT *const obj, const char *const key)
                 prev->next = elem->next;
             }
             M_ObjectElementFree(elem);
+            obj->length--;
+            M_ObjectReindex(obj);
             return;
         }
         prev = elem;
@@ -540,14 +696,8 @@ JSON_VALUE *JSON_ObjectGetValue(JSON_OBJECT *const obj, const char *const key)
     if (obj == NULL) {
         return NULL;
     }
-    JSON_OBJECT_ELEMENT *elem = obj->start;
-    while (elem) {
-        if (!strcmp(elem->name->string, key)) {
-            return elem->value;
-        }
-        elem = elem->next;
-    }
-    return NULL;
+    const JSON_OBJECT_ELEMENT *const elem = M_ObjectFindElement(obj, key);
+    return elem != NULL ? elem->value : NULL;
 }
 
 int JSON_ObjectGetBool(
@@ -1,5 +1,6 @@
 #include "json.h"
 
+#include "json/priv.h"
 #include "memory.h"
 
 typedef struct {
@@ -614,6 +615,8 @@ static int M_GetObjectSize(M_STATE *state, int is_global_object)
     }
 
     state->dom_size += sizeof(JSON_OBJECT_ELEMENT) * elements;
+    state->dom_size +=
+        sizeof(JSON_OBJECT_ELEMENT *) * JSON_GetObjectIndexSize(elements);
 
     return 0;
 }
@@ -648,6 +651,8 @@ static int M_GetArraySize(M_STATE *state)
             state->offset++;
 
             state->dom_size += sizeof(JSON_ARRAY_ELEMENT) * elements;
+            state->dom_size +=
+                sizeof(JSON_ARRAY_ELEMENT *) * JSON_GetArrayIndexSize(elements);
 
             /* finished the object! */
             return 0;
@@ -1325,6 +1330,12 @@ static void M_HandleObject(
 
     object->ref_count = 1;
     object->length = elements;
+
+    /* the hash index is carved out of the dom right after the elements. */
+    JSON_OBJECT_ELEMENT **const index = (JSON_OBJECT_ELEMENT **)state->dom;
+    const size_t index_size = JSON_GetObjectIndexSize(elements);
+    state->dom += sizeof(JSON_OBJECT_ELEMENT *) * index_size;
+    JSON_ObjectBuildIndex(object, index, index_size);
 }
 
 static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
@@ -1415,6 +1426,12 @@ static void M_HandleArray(M_STATE *state, JSON_ARRAY *array)
 
     array->ref_count = 1;
     array->length = elements;
+
+    /* the random access table is carved out of the dom after the elements. */
+    JSON_ARRAY_ELEMENT **const table = (JSON_ARRAY_ELEMENT **)state->dom;
+    state->dom +=
+        sizeof(JSON_ARRAY_ELEMENT *) * JSON_GetArrayIndexSize(elements);
+    JSON_ArrayBuildIndex(array, table);
 }
 
 static void M_HandleNumber(M_STATE *state, JSON_NUMBER *number)
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "json.h"
+
+#include <stddef.h>
+
+// Objects with more keys than this get a hash index; smaller ones are
+// scanned linearly.
+#define JSON_OBJECT_INDEX_THRESHOLD 8
+
+// Number of slots the parsers reserve next to each container, so that the
+// lookup tables live in the same allocation as the rest of the DOM.
+size_t JSON_GetArrayIndexSize(size_t length);
+size_t JSON_GetObjectIndexSize(size_t length);
+
+// Fill the lookup tables of a freshly parsed container from its element
+// list. The tables are owned by the caller.
+void JSON_ArrayBuildIndex(JSON_ARRAY *arr, JSON_ARRAY_ELEMENT **elements);
+void JSON_ObjectBuildIndex(
+    JSON_OBJECT *obj, JSON_OBJECT_ELEMENT **index, size_t index_size);
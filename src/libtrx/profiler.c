@@ -0,0 +1,221 @@
+#include "profiler.h"
+
+#include "filesystem.h"
+#include "json.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_timer.h>
+#include <string.h>
+
+#define MAX_FRAMES 64
+#define MAX_FRAME_EVENTS 256
+#define MAX_THREADS 8
+
+typedef struct {
+    const char *name;
+    Uint64 start;
+    Uint64 end;
+    SDL_threadID thread_id;
+} M_EVENT;
+
+typedef struct {
+    M_EVENT events[MAX_FRAME_EVENTS];
+    int32_t event_count;
+    int32_t dropped_count;
+} M_FRAME;
+
+static SDL_atomic_t m_Enabled = { 0 };
+static SDL_SpinLock m_Lock = 0;
+static M_FRAME m_Frames[MAX_FRAMES];
+static int32_t m_FrameCount = 0;
+static int32_t m_FrameHead = 0;
+static Uint64 m_FrameStart = 0;
+
+static void M_Reset(void);
+static void M_Record(const char *name, Uint64 start, Uint64 end);
+static int32_t M_GetThreadNum(
+    SDL_threadID *thread_ids, int32_t *thread_count, SDL_threadID thread_id);
+
+static void M_Reset(void)
+{
+    m_FrameHead = 0;
+    m_FrameCount = 1;
+    m_Frames[0].event_count = 0;
+    m_Frames[0].dropped_count = 0;
+    m_FrameStart = SDL_GetPerformanceCounter();
+}
+
+static void M_Record(
+    const char *const name, const Uint64 start, const Uint64 end)
+{
+    // Zones are also closed on the audio thread.
+    SDL_AtomicLock(&m_Lock);
+    if (SDL_AtomicGet(&m_Enabled)) {
+        M_FRAME *const frame = &m_Frames[m_FrameHead];
+        if (frame->event_count < MAX_FRAME_EVENTS) {
+            frame->events[frame->event_count++] = (M_EVENT) {
+                .name = name,
+                .start = start,
+                .end = end,
+                .thread_id = SDL_ThreadID(),
+            };
+        } else {
+            frame->dropped_count++;
+        }
+    }
+    SDL_AtomicUnlock(&m_Lock);
+}
+
+static int32_t M_GetThreadNum(
+    SDL_threadID *const thread_ids, int32_t *const thread_count,
+    const SDL_threadID thread_id)
+{
+    for (int32_t i = 0; i < *thread_count; i++) {
+        if (thread_ids[i] == thread_id) {
+            return i;
+        }
+    }
+    if (*thread_count == MAX_THREADS) {
+        return MAX_THREADS;
+    }
+    thread_ids[*thread_count] = thread_id;
+    return (*thread_count)++;
+}
+
+void Profiler_SetEnabled(const bool enabled)
+{
+    SDL_AtomicLock(&m_Lock);
+    if (enabled && !SDL_AtomicGet(&m_Enabled)) {
+        M_Reset();
+    }
+    SDL_AtomicSet(&m_Enabled, enabled);
+    SDL_AtomicUnlock(&m_Lock);
+}
+
+bool Profiler_IsEnabled(void)
+{
+    return SDL_AtomicGet(&m_Enabled);
+}
+
+void Profiler_BeginZone(PROFILER_ZONE *const zone, const char *const name)
+{
+    if (!SDL_AtomicGet(&m_Enabled)) {
+        zone->start = 0;
+        return;
+    }
+    zone->name = name;
+    zone->start = SDL_GetPerformanceCounter();
+}
+
+void Profiler_EndZone(const PROFILER_ZONE *const zone)
+{
+    if (zone->start == 0) {
+        return;
+    }
+    M_Record(zone->name, zone->start, SDL_GetPerformanceCounter());
+}
+
+void Profiler_EndFrame(void)
+{
+    if (!SDL_AtomicGet(&m_Enabled)) {
+        return;
+    }
+    const Uint64 now = SDL_GetPerformanceCounter();
+    M_Record("Frame", m_FrameStart, now);
+    m_FrameStart = now;
+
+    // Start the next frame in the oldest slot, so a long session keeps the
+    // most recent frames whole instead of overwriting them event by event.
+    SDL_AtomicLock(&m_Lock);
+    m_FrameHead = (m_FrameHead + 1) % MAX_FRAMES;
+    m_FrameCount = MIN(m_FrameCount + 1, MAX_FRAMES);
+    m_Frames[m_FrameHead].event_count = 0;
+    m_Frames[m_FrameHead].dropped_count = 0;
+    SDL_AtomicUnlock(&m_Lock);
+}
+
+int32_t Profiler_Export(const char *const path)
+{
+    // Stop recording while the buffer is read.
+    SDL_AtomicLock(&m_Lock);
+    const bool was_enabled = SDL_AtomicGet(&m_Enabled);
+    SDL_AtomicSet(&m_Enabled, false);
+    SDL_AtomicUnlock(&m_Lock);
+
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    // Skip the frame that is still open; its zones are incomplete.
+    const int32_t frame_count = MAX(m_FrameCount - 1, 0);
+    const int32_t first_frame =
+        (m_FrameHead - frame_count + MAX_FRAMES) % MAX_FRAMES;
+    // Zones are stored in the order they were closed, so an outer zone comes
+    // after the zones nested in it.
+    Uint64 origin = UINT64_MAX;
+    int32_t dropped_count = 0;
+    for (int32_t i = 0; i < frame_count; i++) {
+        const M_FRAME *const frame =
+            &m_Frames[(first_frame + i) % MAX_FRAMES];
+        for (int32_t j = 0; j < frame->event_count; j++) {
+            origin = MIN(origin, frame->events[j].start);
+        }
+        dropped_count += frame->dropped_count;
+    }
+    if (dropped_count > 0) {
+        LOG_WARNING(
+            "%d zones did not fit in their frame and were dropped",
+            dropped_count);
+    }
+    SDL_threadID thread_ids[MAX_THREADS];
+    int32_t thread_count = 0;
+
+    int32_t exported = 0;
+    JSON_ARRAY *const events_arr = JSON_ArrayNew();
+    for (int32_t i = 0; i < frame_count; i++) {
+        const M_FRAME *const frame =
+            &m_Frames[(first_frame + i) % MAX_FRAMES];
+        for (int32_t j = 0; j < frame->event_count; j++) {
+            const M_EVENT *const event = &frame->events[j];
+            JSON_OBJECT *const event_obj = JSON_ObjectNew();
+            JSON_ObjectAppendString(event_obj, "name", event->name);
+            JSON_ObjectAppendString(event_obj, "ph", "X");
+            JSON_ObjectAppendDouble(
+                event_obj, "ts",
+                (double)(event->start - origin) * 1000000.0 / freq);
+            JSON_ObjectAppendDouble(
+                event_obj, "dur",
+                (double)(event->end - event->start) * 1000000.0 / freq);
+            JSON_ObjectAppendInt(event_obj, "pid", 1);
+            JSON_ObjectAppendInt(
+                event_obj, "tid",
+                M_GetThreadNum(thread_ids, &thread_count, event->thread_id));
+            JSON_ArrayAppendObject(events_arr, event_obj);
+            exported++;
+        }
+    }
+
+    JSON_OBJECT *const root_obj = JSON_ObjectNew();
+    JSON_ObjectAppendArray(root_obj, "traceEvents", events_arr);
+    JSON_ObjectAppendString(root_obj, "displayTimeUnit", "ms");
+    JSON_VALUE *const root = JSON_ValueFromObject(root_obj);
+
+    size_t size;
+    char *data = JSON_WriteMinified(root, &size);
+    JSON_ValueFree(root);
+
+    int32_t result = -1;
+    MYFILE *const fp = File_Open(path, FILE_OPEN_WRITE);
+    if (fp == NULL) {
+        LOG_ERROR("Cannot write profile to %s", path);
+    } else {
+        File_WriteData(fp, data, strlen(data));
+        File_Close(fp);
+        result = exported;
+    }
+    Memory_FreePointer(&data);
+
+    SDL_AtomicSet(&m_Enabled, was_enabled);
+    return result;
+}
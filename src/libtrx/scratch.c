@@ -0,0 +1,124 @@
+#include "scratch.h"
+
+#include "debug.h"
+#include "memory.h"
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SCRATCH_CHUNK_SIZE 0x100000
+// malloc returns memory aligned for any type, so keep the same guarantee.
+#define SCRATCH_ALIGNMENT _Alignof(max_align_t)
+
+typedef struct SCRATCH_CHUNK {
+    struct SCRATCH_CHUNK *next;
+    size_t size;
+    size_t used;
+    _Alignas(max_align_t) char data[];
+} SCRATCH_CHUNK;
+
+static SCRATCH_CHUNK *m_FirstChunk = NULL;
+static SCRATCH_CHUNK *m_CurrentChunk = NULL;
+
+static SCRATCH_CHUNK *M_CreateChunk(size_t size);
+static void M_FreeChunks(SCRATCH_CHUNK *chunk);
+
+static SCRATCH_CHUNK *M_CreateChunk(const size_t size)
+{
+    // The chunk contents are never read before being allocated, so there is
+    // no point in having Memory_Alloc clear them.
+    SCRATCH_CHUNK *const chunk =
+        Memory_Realloc(NULL, sizeof(SCRATCH_CHUNK) + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+static void M_FreeChunks(SCRATCH_CHUNK *chunk)
+{
+    while (chunk != NULL) {
+        SCRATCH_CHUNK *next = chunk->next;
+        Memory_Free(chunk);
+        chunk = next;
+    }
+}
+
+void Scratch_Init(void)
+{
+    if (m_FirstChunk != NULL) {
+        return;
+    }
+    m_FirstChunk = M_CreateChunk(SCRATCH_CHUNK_SIZE);
+    m_CurrentChunk = m_FirstChunk;
+}
+
+void Scratch_Shutdown(void)
+{
+    M_FreeChunks(m_FirstChunk);
+    m_FirstChunk = NULL;
+    m_CurrentChunk = NULL;
+}
+
+void Scratch_Reset(void)
+{
+    if (m_FirstChunk == NULL) {
+        return;
+    }
+    M_FreeChunks(m_FirstChunk->next);
+    m_FirstChunk->next = NULL;
+    m_FirstChunk->used = 0;
+    m_CurrentChunk = m_FirstChunk;
+}
+
+SCRATCH_MARK Scratch_Mark(void)
+{
+    ASSERT(m_CurrentChunk != NULL);
+    return (SCRATCH_MARK) {
+        .chunk = m_CurrentChunk,
+        .used = m_CurrentChunk->used,
+    };
+}
+
+void Scratch_Rewind(const SCRATCH_MARK mark)
+{
+    // The chunks that follow the marked one are kept for reuse; their usage
+    // is cleared once the arena advances into them again.
+    SCRATCH_CHUNK *const chunk = mark.chunk;
+    ASSERT(chunk != NULL);
+    chunk->used = mark.used;
+    m_CurrentChunk = chunk;
+}
+
+void *Scratch_AllocNoZero(const size_t size)
+{
+    ASSERT(m_CurrentChunk != NULL);
+    const size_t aligned =
+        (size + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+
+    SCRATCH_CHUNK *chunk = m_CurrentChunk;
+    if (chunk->size - chunk->used < aligned) {
+        SCRATCH_CHUNK *next = chunk->next;
+        if (next == NULL || next->size < aligned) {
+            next = M_CreateChunk(MAX((size_t)SCRATCH_CHUNK_SIZE, aligned));
+            next->next = chunk->next;
+            chunk->next = next;
+        }
+        next->used = 0;
+        chunk = next;
+        m_CurrentChunk = chunk;
+    }
+
+    void *const result = chunk->data + chunk->used;
+    chunk->used += aligned;
+    return result;
+}
+
+void *Scratch_Alloc(const size_t size)
+{
+    void *const result = Scratch_AllocNoZero(size);
+    memset(result, 0, size);
+    return result;
+}
@@ -5,14 +5,107 @@
 #include "log.h"
 #include "memory.h"
 
+#include <stdbool.h>
 #include <string.h>
 
-VFILE *VFile_CreateFromPath(const char *const path)
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static bool M_MapFile(VFILE *file, const char *path);
+static void M_UnmapFile(VFILE *file);
+static bool M_ReadFile(VFILE *file, const char *path);
+static const void *M_ViewAligned(VFILE *file, size_t size, size_t alignment);
+
+#if defined(_WIN32)
+static bool M_MapFile(VFILE *const file, const char *const path)
+{
+    char *full_path = File_GetFullPath(path);
+    const HANDLE handle = CreateFileA(
+        full_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    Memory_FreePointer(&full_path);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    const HANDLE mapping =
+        CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if (mapping == NULL) {
+        return false;
+    }
+
+    const void *const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    file->content = data;
+    file->size = (size_t)size.QuadPart;
+    file->is_mapped = true;
+    file->mapping = mapping;
+    return true;
+}
+
+static void M_UnmapFile(VFILE *const file)
+{
+    UnmapViewOfFile(file->content);
+    CloseHandle(file->mapping);
+}
+#else
+static bool M_MapFile(VFILE *const file, const char *const path)
+{
+    char *full_path = File_GetFullPath(path);
+    const int fd = open(full_path, O_RDONLY);
+    Memory_FreePointer(&full_path);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void *const data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    file->content = data;
+    file->size = st.st_size;
+    file->is_mapped = true;
+    file->mapping = NULL;
+    return true;
+}
+
+static void M_UnmapFile(VFILE *const file)
+{
+    munmap((void *)file->content, file->size);
+}
+#endif
+
+static bool M_ReadFile(VFILE *const file, const char *const path)
 {
     MYFILE *fp = File_Open(path, FILE_OPEN_READ);
     if (!fp) {
         LOG_ERROR("Can't open file %s", path);
-        return NULL;
+        return false;
     }
 
     const size_t data_size = File_Size(fp);
@@ -22,13 +115,24 @@ VFILE *VFile_CreateFromPath(const char *const path)
         LOG_ERROR("Can't read file %s", path);
         Memory_FreePointer(&data);
         File_Close(fp);
-        return NULL;
+        return false;
     }
     File_Close(fp);
 
-    VFILE *const file = Memory_Alloc(sizeof(VFILE));
     file->content = data;
     file->size = data_size;
+    file->is_mapped = false;
+    file->mapping = NULL;
+    return true;
+}
+
+VFILE *VFile_CreateFromPath(const char *const path)
+{
+    VFILE *file = Memory_Alloc(sizeof(VFILE));
+    if (!M_MapFile(file, path) && !M_ReadFile(file, path)) {
+        Memory_FreePointer(&file);
+        return NULL;
+    }
     file->cur_ptr = file->content;
     return file;
 }
@@ -45,7 +149,11 @@ VFILE *VFile_CreateFromBuffer(const char *data, size_t size)
 void VFile_Close(VFILE *file)
 {
     ASSERT(file != NULL);
-    Memory_FreePointer(&file->content);
+    if (file->is_mapped) {
+        M_UnmapFile(file);
+    } else {
+        Memory_FreePointer(&file->content);
+    }
     Memory_FreePointer(&file);
 }
 
@@ -116,3 +224,49 @@ uint32_t VFile_ReadU32(VFILE *file)
     VFile_Read(file, &result, sizeof(result));
     return result;
 }
+
+const void *VFile_View(VFILE *const file, const size_t size)
+{
+    const size_t cur_pos = VFile_GetPos(file);
+    ASSERT(cur_pos + size <= file->size);
+    const void *const result = file->cur_ptr;
+    file->cur_ptr += size;
+    return result;
+}
+
+static const void *M_ViewAligned(
+    VFILE *const file, const size_t size, const size_t alignment)
+{
+    ASSERT((uintptr_t)file->cur_ptr % alignment == 0);
+    return VFile_View(file, size);
+}
+
+const int8_t *VFile_ViewS8(VFILE *const file, const size_t count)
+{
+    return VFile_View(file, sizeof(int8_t) * count);
+}
+
+const int16_t *VFile_ViewS16(VFILE *const file, const size_t count)
+{
+    return M_ViewAligned(file, sizeof(int16_t) * count, sizeof(int16_t));
+}
+
+const int32_t *VFile_ViewS32(VFILE *const file, const size_t count)
+{
+    return M_ViewAligned(file, sizeof(int32_t) * count, sizeof(int32_t));
+}
+
+const uint8_t *VFile_ViewU8(VFILE *const file, const size_t count)
+{
+    return VFile_View(file, sizeof(uint8_t) * count);
+}
+
+const uint16_t *VFile_ViewU16(VFILE *const file, const size_t count)
+{
+    return M_ViewAligned(file, sizeof(uint16_t) * count, sizeof(uint16_t));
+}
+
+const uint32_t *VFile_ViewU32(VFILE *const file, const size_t count)
+{
+    return M_ViewAligned(file, sizeof(uint32_t) * count, sizeof(uint32_t));
+}
@@ -5,19 +5,349 @@
 #include "global/const.h"
 #include "global/vars.h"
 
+#include <libtrx/config.h>
+#include <libtrx/game/gamebuf.h>
 #include <libtrx/utils.h>
 
-bool Box_SearchLOT(LOT_INFO *lot, int32_t expansion)
+#include <string.h>
+
+#define PATH_CACHE_SIZE 16
+
+typedef enum {
+    PATH_UNREACHED = 0,
+    PATH_REACHED = 1,
+    PATH_BLOCKED = 2,
+} PATH_STATE;
+
+// The result of a complete search towards a single box, shared by all
+// creatures that move the same way within the same zone. It is kept in the
+// layout of a creature's node array, so that creatures can copy it as is.
+typedef struct {
+    bool is_valid;
+    const int16_t *zone;
+    int16_t target_box;
+    int16_t step;
+    int16_t drop;
+    uint16_t block_mask;
+    uint32_t block_version;
+    uint32_t last_used;
+    uint16_t search_num;
+    BOX_NODE *node;
+} PATH_FIELD;
+
+static PATH_FIELD m_PathCache[PATH_CACHE_SIZE] = {};
+static uint32_t m_PathClock = 0;
+static uint32_t m_BlockVersion = 0;
+static uint16_t m_SearchNum = 0;
+
+// Work area of the search, shared by all fields.
+static uint8_t *m_State = NULL;
+static uint16_t *m_Hops = NULL;
+static int32_t *m_Dist = NULL;
+static int16_t *m_Heap = NULL;
+static int16_t *m_HeapPos = NULL;
+static int32_t m_HeapSize = 0;
+
+static int16_t *M_GetZone(const LOT_INFO *lot);
+static bool M_CanExpand(const PATH_FIELD *field, int16_t from, int16_t to);
+static int32_t M_GetBoxDistance(int16_t box_num1, int16_t box_num2);
+static bool M_IsCloser(int16_t box_num1, int16_t box_num2);
+static void M_HeapSiftUp(int32_t idx);
+static void M_HeapSiftDown(int32_t idx);
+static void M_HeapPush(int16_t box_num);
+static int16_t M_HeapPop(void);
+static void M_ComputeField(PATH_FIELD *field);
+static PATH_FIELD *M_AcquireField(const LOT_INFO *lot);
+static bool M_SearchShared(LOT_INFO *lot);
+static bool M_SearchIncremental(LOT_INFO *lot, int32_t expansion);
+
+static int16_t *M_GetZone(const LOT_INFO *const lot)
 {
-    int16_t *zone;
     if (lot->fly) {
-        zone = g_FlyZone[g_FlipStatus];
+        return g_FlyZone[g_FlipStatus];
     } else if (lot->step == STEP_L) {
-        zone = g_GroundZone[g_FlipStatus];
+        return g_GroundZone[g_FlipStatus];
     } else {
-        zone = g_GroundZone2[g_FlipStatus];
+        return g_GroundZone2[g_FlipStatus];
+    }
+}
+
+static bool M_CanExpand(
+    const PATH_FIELD *const field, const int16_t from, const int16_t to)
+{
+    if (field->zone[to] != field->zone[field->target_box]) {
+        return false;
+    }
+    const int32_t change = g_Boxes[to].height - g_Boxes[from].height;
+    return change <= field->step && change >= field->drop;
+}
+
+static int32_t M_GetBoxDistance(const int16_t box_num1, const int16_t box_num2)
+{
+    const BOX_INFO *const box1 = &g_Boxes[box_num1];
+    const BOX_INFO *const box2 = &g_Boxes[box_num2];
+    const int32_t dz = ((box1->left + box1->right) >> 1)
+        - ((box2->left + box2->right) >> 1);
+    const int32_t dx = ((box1->top + box1->bottom) >> 1)
+        - ((box2->top + box2->bottom) >> 1);
+    return ABS(dx) + ABS(dz);
+}
+
+static bool M_IsCloser(const int16_t box_num1, const int16_t box_num2)
+{
+    // Paths are first ranked by the number of boxes they go through like the
+    // original breadth-first search did, and only then by their length.
+    if (m_Hops[box_num1] != m_Hops[box_num2]) {
+        return m_Hops[box_num1] < m_Hops[box_num2];
+    }
+    return m_Dist[box_num1] < m_Dist[box_num2];
+}
+
+static void M_HeapSiftUp(int32_t idx)
+{
+    const int16_t box_num = m_Heap[idx];
+    while (idx > 0) {
+        const int32_t parent = (idx - 1) / 2;
+        if (!M_IsCloser(box_num, m_Heap[parent])) {
+            break;
+        }
+        m_Heap[idx] = m_Heap[parent];
+        m_HeapPos[m_Heap[idx]] = idx;
+        idx = parent;
+    }
+    m_Heap[idx] = box_num;
+    m_HeapPos[box_num] = idx;
+}
+
+static void M_HeapSiftDown(int32_t idx)
+{
+    const int16_t box_num = m_Heap[idx];
+    while (true) {
+        int32_t child = idx * 2 + 1;
+        if (child >= m_HeapSize) {
+            break;
+        }
+        if (child + 1 < m_HeapSize
+            && M_IsCloser(m_Heap[child + 1], m_Heap[child])) {
+            child++;
+        }
+        if (!M_IsCloser(m_Heap[child], box_num)) {
+            break;
+        }
+        m_Heap[idx] = m_Heap[child];
+        m_HeapPos[m_Heap[idx]] = idx;
+        idx = child;
+    }
+    m_Heap[idx] = box_num;
+    m_HeapPos[box_num] = idx;
+}
+
+static void M_HeapPush(const int16_t box_num)
+{
+    m_Heap[m_HeapSize] = box_num;
+    M_HeapSiftUp(m_HeapSize++);
+}
+
+static int16_t M_HeapPop(void)
+{
+    const int16_t box_num = m_Heap[0];
+    m_HeapPos[box_num] = -1;
+    m_HeapSize--;
+    if (m_HeapSize > 0) {
+        m_Heap[0] = m_Heap[m_HeapSize];
+        M_HeapSiftDown(0);
+    }
+    return box_num;
+}
+
+static void M_ComputeField(PATH_FIELD *const field)
+{
+    BOX_NODE *const node = field->node;
+    for (int32_t i = 0; i < g_NumberBoxes; i++) {
+        node[i].exit_box = NO_BOX;
+        node[i].next_expansion = NO_BOX;
+        m_State[i] = PATH_UNREACHED;
+        m_Hops[i] = UINT16_MAX;
+        m_HeapPos[i] = -1;
+    }
+
+    // Dijkstra's search outwards from the target through the boxes that are
+    // not blocked for this kind of creature. The target itself always counts
+    // as passable.
+    m_HeapSize = 0;
+    m_Hops[field->target_box] = 0;
+    m_Dist[field->target_box] = 0;
+    m_State[field->target_box] = PATH_REACHED;
+    M_HeapPush(field->target_box);
+
+    while (m_HeapSize > 0) {
+        const int16_t box_num = M_HeapPop();
+        int32_t index = g_Boxes[box_num].overlap_index & OVERLAP_INDEX;
+        bool done = false;
+        while (!done) {
+            int16_t next_box = g_Overlap[index++];
+            if (next_box & END_BIT) {
+                done = true;
+                next_box &= BOX_NUMBER;
+            }
+
+            if (!M_CanExpand(field, box_num, next_box)
+                || (g_Boxes[next_box].overlap_index & field->block_mask)) {
+                continue;
+            }
+
+            const uint16_t hops = m_Hops[box_num] + 1;
+            const int32_t dist =
+                m_Dist[box_num] + M_GetBoxDistance(box_num, next_box);
+            if (m_Hops[next_box] == UINT16_MAX) {
+                m_Hops[next_box] = hops;
+                m_Dist[next_box] = dist;
+                node[next_box].exit_box = box_num;
+                m_State[next_box] = PATH_REACHED;
+                M_HeapPush(next_box);
+            } else if (
+                m_HeapPos[next_box] >= 0
+                && (hops < m_Hops[next_box]
+                    || (hops == m_Hops[next_box] && dist < m_Dist[next_box]))) {
+                m_Hops[next_box] = hops;
+                m_Dist[next_box] = dist;
+                node[next_box].exit_box = box_num;
+                M_HeapSiftUp(m_HeapPos[next_box]);
+            }
+        }
     }
 
+    // Everything else the creature could walk to only leads to the target
+    // through a blocked box. Flood it so that creatures standing there know
+    // that they are cut off.
+    int32_t queue_head = 0;
+    int32_t queue_tail = 0;
+    for (int32_t i = 0; i < g_NumberBoxes; i++) {
+        if (m_State[i] == PATH_REACHED) {
+            m_Heap[queue_tail++] = i;
+        }
+    }
+    while (queue_head < queue_tail) {
+        const int16_t box_num = m_Heap[queue_head++];
+        int32_t index = g_Boxes[box_num].overlap_index & OVERLAP_INDEX;
+        bool done = false;
+        while (!done) {
+            int16_t next_box = g_Overlap[index++];
+            if (next_box & END_BIT) {
+                done = true;
+                next_box &= BOX_NUMBER;
+            }
+
+            if (m_State[next_box] != PATH_UNREACHED
+                || !M_CanExpand(field, box_num, next_box)) {
+                continue;
+            }
+            m_State[next_box] = PATH_BLOCKED;
+            m_Heap[queue_tail++] = next_box;
+        }
+    }
+
+    // Every result gets its own search number, so that a creature can take
+    // the number over together with the nodes.
+    m_SearchNum = m_SearchNum % SEARCH_NUMBER + 1;
+    field->search_num = m_SearchNum;
+    for (int32_t i = 0; i < g_NumberBoxes; i++) {
+        switch (m_State[i]) {
+        case PATH_REACHED:
+            node[i].search_num = m_SearchNum;
+            break;
+        case PATH_BLOCKED:
+            node[i].search_num = m_SearchNum | BLOCKED_SEARCH;
+            break;
+        default:
+            node[i].search_num = 0;
+            break;
+        }
+    }
+
+    field->block_version = m_BlockVersion;
+    field->is_valid = true;
+}
+
+static PATH_FIELD *M_AcquireField(const LOT_INFO *const lot)
+{
+    const int16_t *const zone = M_GetZone(lot);
+    m_PathClock++;
+
+    PATH_FIELD *victim = &m_PathCache[0];
+    for (int32_t i = 0; i < PATH_CACHE_SIZE; i++) {
+        PATH_FIELD *const field = &m_PathCache[i];
+        if (field->is_valid && field->zone == zone
+            && field->target_box == lot->target_box && field->step == lot->step
+            && field->drop == lot->drop && field->block_mask == lot->block_mask
+            && field->block_version == m_BlockVersion) {
+            field->last_used = m_PathClock;
+            return field;
+        }
+        if (!field->is_valid
+            || (victim->is_valid && field->last_used < victim->last_used)) {
+            victim = field;
+        }
+    }
+
+    victim->zone = zone;
+    victim->target_box = lot->target_box;
+    victim->step = lot->step;
+    victim->drop = lot->drop;
+    victim->block_mask = lot->block_mask;
+    victim->last_used = m_PathClock;
+    M_ComputeField(victim);
+    return victim;
+}
+
+void Box_InitialisePathCache(void)
+{
+    for (int32_t i = 0; i < PATH_CACHE_SIZE; i++) {
+        PATH_FIELD *const field = &m_PathCache[i];
+        field->is_valid = false;
+        field->node =
+            GameBuf_Alloc(sizeof(BOX_NODE) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    }
+    m_State = GameBuf_Alloc(sizeof(uint8_t) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    m_Hops = GameBuf_Alloc(sizeof(uint16_t) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    m_Dist = GameBuf_Alloc(sizeof(int32_t) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    m_Heap = GameBuf_Alloc(sizeof(int16_t) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    m_HeapPos =
+        GameBuf_Alloc(sizeof(int16_t) * g_NumberBoxes, GBUF_CREATURE_LOT);
+    m_PathClock = 0;
+}
+
+void Box_SetBlocked(const int16_t box_num, const bool is_blocked)
+{
+    BOX_INFO *const box = &g_Boxes[box_num];
+    const int16_t overlap_index = is_blocked
+        ? (box->overlap_index | BLOCKED)
+        : (box->overlap_index & ~BLOCKED);
+    if (overlap_index != box->overlap_index) {
+        box->overlap_index = overlap_index;
+        m_BlockVersion++;
+    }
+}
+
+static bool M_SearchShared(LOT_INFO *const lot)
+{
+    if (lot->head == NO_BOX || lot->target_box == NO_BOX) {
+        return false;
+    }
+
+    const PATH_FIELD *const field = M_AcquireField(lot);
+    memcpy(lot->node, field->node, sizeof(BOX_NODE) * g_NumberBoxes);
+    lot->search_num = field->search_num;
+    lot->head = NO_BOX;
+    lot->tail = NO_BOX;
+    return true;
+}
+
+// The original search, which expands a few boxes every frame. Creatures
+// see its partial results while it runs, and the demos rely on that.
+static bool M_SearchIncremental(LOT_INFO *const lot, const int32_t expansion)
+{
+    const int16_t *const zone = M_GetZone(lot);
     int16_t search_zone = zone[lot->head];
     for (int i = 0; i < expansion; i++) {
         if (lot->head == NO_BOX) {
@@ -85,7 +415,15 @@ bool Box_SearchLOT(LOT_INFO *lot, int32_t expansion)
     return true;
 }
 
-bool Box_UpdateLOT(LOT_INFO *lot, int32_t expansion)
+bool Box_SearchLOT(LOT_INFO *const lot, const int32_t expansion)
+{
+    if (g_Config.gameplay.enable_shared_pathfinding) {
+        return M_SearchShared(lot);
+    }
+    return M_SearchIncremental(lot, expansion);
+}
+
+bool Box_UpdateLOT(LOT_INFO *const lot, const int32_t expansion)
 {
     if (lot->required_box != NO_BOX && lot->required_box != lot->target_box) {
         lot->target_box = lot->required_box;
@@ -178,15 +516,7 @@ bool Box_EscapeBox(ITEM *item, int16_t box_num)
 bool Box_ValidBox(ITEM *item, int16_t zone_num, int16_t box_num)
 {
     CREATURE *creature = item->data;
-
-    int16_t *zone;
-    if (creature->lot.fly) {
-        zone = g_FlyZone[g_FlipStatus];
-    } else if (creature->lot.step == STEP_L) {
-        zone = g_GroundZone[g_FlipStatus];
-    } else {
-        zone = g_GroundZone2[g_FlipStatus];
-    }
+    const int16_t *const zone = M_GetZone(&creature->lot);
 
     if (zone[box_num] != zone_num) {
         return false;
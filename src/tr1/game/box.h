@@ -5,6 +5,17 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Sets up the shared cache of complete searches. Creatures that share the
+// same zone, movement limits and target reuse a single search result.
+void Box_InitialisePathCache(void);
+
+// Blocks or unblocks a box for pathfinding, invalidating the cached searches
+// if its state changes.
+void Box_SetBlocked(int16_t box_num, bool is_blocked);
+
+// With shared pathfinding enabled, searches run to completion in one go and
+// their results are shared. Otherwise each creature expands its own search by
+// a few boxes per call, like the original game.
 bool Box_SearchLOT(LOT_INFO *lot, int32_t expansion);
 bool Box_UpdateLOT(LOT_INFO *lot, int32_t expansion);
 void Box_TargetBox(LOT_INFO *lot, int16_t box_num);
@@ -13,9 +13,12 @@
 #include <libtrx/game/console/cmd/heal.h>
 #include <libtrx/game/console/cmd/kill.h>
 #include <libtrx/game/console/cmd/load_game.h>
+#include <libtrx/game/console/cmd/mem.h>
+#include <libtrx/game/console/cmd/perf.h>
 #include <libtrx/game/console/cmd/play_demo.h>
 #include <libtrx/game/console/cmd/play_level.h>
 #include <libtrx/game/console/cmd/pos.h>
+#include <libtrx/game/console/cmd/profile.h>
 #include <libtrx/game/console/cmd/save_game.h>
 #include <libtrx/game/console/cmd/set_health.h>
 #include <libtrx/game/console/cmd/sfx.h>
@@ -46,6 +49,9 @@ CONSOLE_COMMAND *g_ConsoleCommands[] = {
     &g_Console_Cmd_Config,
     &g_Console_Cmd_GiveItem,
     &g_Console_Cmd_SFX,
+    &g_Console_Cmd_Mem,
+    &g_Console_Cmd_Profile,
+    &g_Console_Cmd_Perf,
     // clang-format on
     NULL,
 };
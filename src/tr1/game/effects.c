@@ -56,6 +56,17 @@ int16_t Effect_GetActiveNum(void)
     return m_NextEffectActive;
 }
 
+int32_t Effect_GetActiveCount(void)
+{
+    int32_t count = 0;
+    int16_t effect_num = m_NextEffectActive;
+    while (effect_num != NO_EFFECT) {
+        count++;
+        effect_num = m_Effects[effect_num].next_active;
+    }
+    return count;
+}
+
 int16_t Effect_Create(int16_t room_num)
 {
     int16_t effect_num = m_NextEffectFree;
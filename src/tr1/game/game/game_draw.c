@@ -12,6 +12,7 @@
 #include "global/vars.h"
 
 #include <libtrx/config.h>
+#include <libtrx/profiler.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -22,7 +23,10 @@ void Game_Draw(bool draw_overlay)
     Camera_Apply();
 
     if (g_Objects[O_LARA].loaded) {
-        Room_DrawAllRooms(g_Camera.interp.room_num, g_Camera.target.room_num);
+        PROFILER_CALL(
+            "Rooms",
+            Room_DrawAllRooms(
+                g_Camera.interp.room_num, g_Camera.target.room_num));
 
         if (g_Config.visuals.enable_reflections) {
             Output_FillEnvironmentMap();
@@ -14,6 +14,7 @@
 #include <libtrx/game/level.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/scratch.h>
 #include <libtrx/utils.h>
 #include <libtrx/virtual_file.h>
 
@@ -378,7 +379,8 @@ static void M_LoadTexturePages(
     // Read in each page for this injection and realign the pixels
     // to the level's palette.
     const size_t pixel_count = PAGE_SIZE * inj_info->texture_page_count;
-    uint8_t *indices = Memory_Alloc(pixel_count);
+    const SCRATCH_MARK mark = Scratch_Mark();
+    uint8_t *const indices = Scratch_AllocNoZero(pixel_count);
     VFile_Read(fp, indices, pixel_count);
     uint8_t *input = indices;
     RGBA_8888 *output = page_ptr;
@@ -394,7 +396,7 @@ static void M_LoadTexturePages(
         }
         output++;
     }
-    Memory_FreePointer(&indices);
+    Scratch_Rewind(mark);
 
     Benchmark_End(benchmark, NULL);
 }
@@ -473,7 +475,8 @@ static void M_MeshData(const INJECTION *injection, LEVEL_INFO *const level_info)
     level_info->mesh_count += inj_info->mesh_count;
 
     const int32_t alloc_size = inj_info->mesh_ptr_count * sizeof(int32_t);
-    int32_t *mesh_indices = Memory_Alloc(alloc_size);
+    const SCRATCH_MARK mark = Scratch_Mark();
+    int32_t *const mesh_indices = Scratch_AllocNoZero(alloc_size);
     VFile_Read(fp, mesh_indices, alloc_size);
 
     const size_t end_pos = VFile_GetPos(fp);
@@ -482,7 +485,7 @@ static void M_MeshData(const INJECTION *injection, LEVEL_INFO *const level_info)
     Level_ReadObjectMeshes(inj_info->mesh_ptr_count, mesh_indices, fp);
 
     VFile_SetPos(fp, end_pos);
-    Memory_FreePointer(&mesh_indices);
+    Scratch_Rewind(mark);
 
     Benchmark_End(benchmark, NULL);
 }
@@ -732,8 +735,9 @@ static void M_MeshEdits(INJECTION *injection, uint16_t *palette_map)
 
     BENCHMARK *const benchmark = Benchmark_Start();
 
-    MESH_EDIT *mesh_edits =
-        Memory_Alloc(sizeof(MESH_EDIT) * inj_info->mesh_edit_count);
+    const SCRATCH_MARK mark = Scratch_Mark();
+    MESH_EDIT *const mesh_edits =
+        Scratch_Alloc(sizeof(MESH_EDIT) * inj_info->mesh_edit_count);
 
     for (int32_t i = 0; i < inj_info->mesh_edit_count; i++) {
         MESH_EDIT *mesh_edit = &mesh_edits[i];
@@ -749,7 +753,7 @@ static void M_MeshEdits(INJECTION *injection, uint16_t *palette_map)
 
         mesh_edit->face_edit_count = VFile_ReadS32(fp);
         mesh_edit->face_edits =
-            Memory_Alloc(sizeof(FACE_EDIT) * mesh_edit->face_edit_count);
+            Scratch_AllocNoZero(sizeof(FACE_EDIT) * mesh_edit->face_edit_count);
         for (int32_t j = 0; j < mesh_edit->face_edit_count; j++) {
             FACE_EDIT *face_edit = &mesh_edit->face_edits[j];
             face_edit->object_id = VFile_ReadS32(fp);
@@ -759,15 +763,15 @@ static void M_MeshEdits(INJECTION *injection, uint16_t *palette_map)
 
             face_edit->target_count = VFile_ReadS32(fp);
             face_edit->targets =
-                Memory_Alloc(sizeof(int16_t) * face_edit->target_count);
+                Scratch_AllocNoZero(sizeof(int16_t) * face_edit->target_count);
             VFile_Read(
                 fp, face_edit->targets,
                 sizeof(int16_t) * face_edit->target_count);
         }
 
         mesh_edit->vertex_edit_count = VFile_ReadS32(fp);
-        mesh_edit->vertex_edits =
-            Memory_Alloc(sizeof(VERTEX_EDIT) * mesh_edit->vertex_edit_count);
+        mesh_edit->vertex_edits = Scratch_AllocNoZero(
+            sizeof(VERTEX_EDIT) * mesh_edit->vertex_edit_count);
         for (int32_t i = 0; i < mesh_edit->vertex_edit_count; i++) {
             VERTEX_EDIT *vertex_edit = &mesh_edit->vertex_edits[i];
             vertex_edit->vertex_index = VFile_ReadS16(fp);
@@ -777,17 +781,9 @@ static void M_MeshEdits(INJECTION *injection, uint16_t *palette_map)
         }
 
         M_ApplyMeshEdit(mesh_edit, palette_map);
-
-        for (int32_t j = 0; j < mesh_edit->face_edit_count; j++) {
-            FACE_EDIT *face_edit = &mesh_edit->face_edits[j];
-            Memory_FreePointer(&face_edit->targets);
-        }
-
-        Memory_FreePointer(&mesh_edit->face_edits);
-        Memory_FreePointer(&mesh_edit->vertex_edits);
     }
 
-    Memory_FreePointer(&mesh_edits);
+    Scratch_Rewind(mark);
     Benchmark_End(benchmark, NULL);
 }
 
@@ -923,7 +919,9 @@ static void M_TextureOverwrites(
         const uint16_t source_width = VFile_ReadU16(fp);
         const uint16_t source_height = VFile_ReadU16(fp);
 
-        uint8_t *source_img = Memory_Alloc(source_width * source_height);
+        const SCRATCH_MARK mark = Scratch_Mark();
+        uint8_t *const source_img =
+            Scratch_AllocNoZero(source_width * source_height);
         VFile_Read(fp, source_img, source_width * source_height);
 
         // Copy the source image pixels directly into the target page.
@@ -947,7 +945,7 @@ static void M_TextureOverwrites(
             }
         }
 
-        Memory_FreePointer(&source_img);
+        Scratch_Rewind(mark);
     }
 
     Benchmark_End(benchmark, NULL);
@@ -1641,8 +1639,9 @@ void Inject_AllInjections(LEVEL_INFO *level_info)
 
     BENCHMARK *const benchmark = Benchmark_Start();
 
+    const SCRATCH_MARK mark = Scratch_Mark();
     uint16_t palette_map[256];
-    RGBA_8888 *source_pages = Memory_Alloc(
+    RGBA_8888 *const source_pages = Scratch_Alloc(
         m_Aggregate->texture_page_count * PAGE_SIZE * sizeof(RGBA_8888));
     int32_t source_page_count = 0;
     int32_t tpage_base = level_info->texture_page_count;
@@ -1687,7 +1686,7 @@ void Inject_AllInjections(LEVEL_INFO *level_info)
     }
 
     if (source_page_count) {
-        PACKER_DATA *data = Memory_Alloc(sizeof(PACKER_DATA));
+        PACKER_DATA *const data = Scratch_Alloc(sizeof(PACKER_DATA));
         data->level_page_count = level_info->texture_page_count;
         data->source_page_count = source_page_count;
         data->source_pages = source_pages;
@@ -1699,11 +1698,10 @@ void Inject_AllInjections(LEVEL_INFO *level_info)
             level_info->texture_page_count += Packer_GetAddedPageCount();
             level_info->texture_rgb_page_ptrs = data->level_pages;
         }
-
-        Memory_FreePointer(&source_pages);
-        Memory_FreePointer(&data);
     }
 
+    Scratch_Rewind(mark);
+
     Benchmark_End(benchmark, NULL);
 }
 
@@ -14,6 +14,7 @@
 #include "math/matrix.h"
 
 #include <libtrx/config.h>
+#include <libtrx/game/gamebuf.h>
 #include <libtrx/game/math.h>
 #include <libtrx/utils.h>
 
@@ -30,12 +31,146 @@
         }                                                                      \
     } while (0)
 
+#define GRID_SHIFT (WALL_SHIFT + 2)
+#define GRID_BUCKETS 1024
+#define MAX_COLLIDABLES 256
+
 ITEM *g_Items = NULL;
 int16_t g_NextItemActive = NO_ITEM;
 static int16_t m_NextItemFree = NO_ITEM;
 static BOUNDS_16 m_InterpolatedBounds = {};
 static int16_t m_MaxUsedItemCount = 0;
 
+// Spatial hash of the inactive items that have a collision routine, keyed
+// by their XZ cell. Inactive items do not move, so the hash only needs to
+// be rebuilt when items get linked, unlinked or (de)activated. Active items
+// are picked from the active list instead. Each item also remembers its
+// position in its room's item list, so that query results can be put back
+// into the order of a walk over the room lists.
+static struct {
+    bool dirty;
+    int32_t *bucket_starts;
+    int16_t *items;
+    int16_t *ranks;
+} m_Grid = {};
+static int16_t m_Collidables[MAX_COLLIDABLES];
+static int32_t m_CollidableKeys[MAX_COLLIDABLES];
+
+static bool M_IsGridItem(const ITEM *item);
+static void M_InvalidateGrid(const ITEM *item);
+static int32_t M_GetGridBucket(int32_t cell_x, int32_t cell_z);
+static void M_BuildGrid(void);
+static bool M_AddCollidable(
+    int16_t item_num, int32_t x1, int32_t z1, int32_t x2, int32_t z2,
+    const int16_t *room_nums, int32_t room_count, int32_t *count);
+
+static bool M_IsGridItem(const ITEM *const item)
+{
+    return !item->active && g_Objects[item->object_id].collision != NULL;
+}
+
+static void M_InvalidateGrid(const ITEM *const item)
+{
+    // Items without a collision routine never show up in the results, and
+    // relinking them keeps the relative order of the other items intact.
+    if (g_Objects[item->object_id].collision != NULL) {
+        m_Grid.dirty = true;
+    }
+}
+
+static int32_t M_GetGridBucket(const int32_t cell_x, const int32_t cell_z)
+{
+    const uint32_t hash =
+        ((uint32_t)cell_x * 73856093u) ^ ((uint32_t)cell_z * 19349663u);
+    return hash & (GRID_BUCKETS - 1);
+}
+
+static void M_BuildGrid(void)
+{
+    for (int32_t i = 0; i < m_MaxUsedItemCount; i++) {
+        m_Grid.ranks[i] = -1;
+    }
+    for (int32_t i = 0; i <= GRID_BUCKETS; i++) {
+        m_Grid.bucket_starts[i] = 0;
+    }
+
+    // Count the items per bucket, then turn the counts into bucket ends and
+    // fill the buckets back to front.
+    for (int32_t pass = 0; pass < 2; pass++) {
+        for (int32_t i = 0; i < g_RoomCount; i++) {
+            int16_t rank = 0;
+            for (int16_t item_num = g_RoomInfo[i].item_num;
+                 item_num != NO_ITEM; item_num = g_Items[item_num].next_item) {
+                const ITEM *const item = &g_Items[item_num];
+                m_Grid.ranks[item_num] = rank++;
+                if (!M_IsGridItem(item)) {
+                    continue;
+                }
+                const int32_t bucket = M_GetGridBucket(
+                    item->pos.x >> GRID_SHIFT, item->pos.z >> GRID_SHIFT);
+                if (pass == 0) {
+                    m_Grid.bucket_starts[bucket]++;
+                } else {
+                    m_Grid.items[--m_Grid.bucket_starts[bucket]] = item_num;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            int32_t total = 0;
+            for (int32_t i = 0; i < GRID_BUCKETS; i++) {
+                total += m_Grid.bucket_starts[i];
+                m_Grid.bucket_starts[i] = total;
+            }
+            m_Grid.bucket_starts[GRID_BUCKETS] = total;
+        }
+    }
+
+    m_Grid.dirty = false;
+}
+
+static bool M_AddCollidable(
+    const int16_t item_num, const int32_t x1, const int32_t z1,
+    const int32_t x2, const int32_t z2, const int16_t *const room_nums,
+    const int32_t room_count, int32_t *const count)
+{
+    const ITEM *const item = &g_Items[item_num];
+    const int16_t rank = m_Grid.ranks[item_num];
+    if (rank < 0 || item->pos.x < x1 || item->pos.x > x2 || item->pos.z < z1
+        || item->pos.z > z2) {
+        return true;
+    }
+
+    // A room listed twice gets walked twice, and so do its items.
+    for (int32_t i = 0; i < room_count; i++) {
+        if (room_nums[i] != item->room_num) {
+            continue;
+        }
+
+        const int32_t key = (i << 16) | rank;
+        int32_t j = *count;
+        while (j > 0 && m_CollidableKeys[j - 1] > key) {
+            j--;
+        }
+        if (j > 0 && m_CollidableKeys[j - 1] == key) {
+            continue;
+        }
+        if (*count >= MAX_COLLIDABLES) {
+            return false;
+        }
+
+        for (int32_t k = *count; k > j; k--) {
+            m_CollidableKeys[k] = m_CollidableKeys[k - 1];
+            m_Collidables[k] = m_Collidables[k - 1];
+        }
+        m_CollidableKeys[j] = key;
+        m_Collidables[j] = item_num;
+        (*count)++;
+    }
+
+    return true;
+}
+
 void Item_InitialiseArray(int32_t num_items)
 {
     g_NextItemActive = NO_ITEM;
@@ -45,6 +180,12 @@ void Item_InitialiseArray(int32_t num_items)
         g_Items[i].next_item = i + 1;
     }
     g_Items[num_items - 1].next_item = NO_ITEM;
+
+    m_Grid.dirty = true;
+    m_Grid.bucket_starts =
+        GameBuf_Alloc(sizeof(int32_t) * (GRID_BUCKETS + 1), GBUF_ITEMS);
+    m_Grid.items = GameBuf_Alloc(sizeof(int16_t) * num_items, GBUF_ITEMS);
+    m_Grid.ranks = GameBuf_Alloc(sizeof(int16_t) * num_items, GBUF_ITEMS);
 }
 
 int32_t Item_GetTotalCount(void)
@@ -52,6 +193,17 @@ int32_t Item_GetTotalCount(void)
     return m_MaxUsedItemCount;
 }
 
+int32_t Item_GetActiveCount(void)
+{
+    int32_t count = 0;
+    int16_t item_num = g_NextItemActive;
+    while (item_num != NO_ITEM) {
+        count++;
+        item_num = g_Items[item_num].next_active;
+    }
+    return count;
+}
+
 void Item_Control(void)
 {
     int16_t item_num = g_NextItemActive;
@@ -67,6 +219,54 @@ void Item_Control(void)
     Carrier_AnimateDrops();
 }
 
+const int16_t *Item_GetCollidables(
+    const XYZ_32 *const pos, const int32_t range,
+    const int16_t *const room_nums, const int32_t room_count,
+    int32_t *const out_count)
+{
+    if (m_Grid.dirty) {
+        M_BuildGrid();
+    }
+
+    const int32_t x1 = pos->x - range;
+    const int32_t z1 = pos->z - range;
+    const int32_t x2 = pos->x + range;
+    const int32_t z2 = pos->z + range;
+    int32_t count = 0;
+
+    // Cells that share a bucket return the same items; the keys of those
+    // duplicates collide and they are only added once.
+    for (int32_t cell_z = z1 >> GRID_SHIFT; cell_z <= z2 >> GRID_SHIFT;
+         cell_z++) {
+        for (int32_t cell_x = x1 >> GRID_SHIFT; cell_x <= x2 >> GRID_SHIFT;
+             cell_x++) {
+            const int32_t bucket = M_GetGridBucket(cell_x, cell_z);
+            for (int32_t i = m_Grid.bucket_starts[bucket];
+                 i < m_Grid.bucket_starts[bucket + 1]; i++) {
+                if (!M_AddCollidable(
+                        m_Grid.items[i], x1, z1, x2, z2, room_nums, room_count,
+                        &count)) {
+                    return NULL;
+                }
+            }
+        }
+    }
+
+    for (int16_t item_num = g_NextItemActive; item_num != NO_ITEM;
+         item_num = g_Items[item_num].next_active) {
+        if (g_Objects[g_Items[item_num].object_id].collision == NULL) {
+            continue;
+        }
+        if (!M_AddCollidable(
+                item_num, x1, z1, x2, z2, room_nums, room_count, &count)) {
+            return NULL;
+        }
+    }
+
+    *out_count = count;
+    return m_Collidables;
+}
+
 void Item_Kill(int16_t item_num)
 {
     ITEM *item = &g_Items[item_num];
@@ -145,6 +345,7 @@ void Item_Initialise(int16_t item_num)
     ROOM *const r = &g_RoomInfo[item->room_num];
     item->next_item = r->item_num;
     r->item_num = item_num;
+    M_InvalidateGrid(item);
     const int32_t z_sector = (item->pos.z - r->pos.z) >> WALL_SHIFT;
     const int32_t x_sector = (item->pos.x - r->pos.x) >> WALL_SHIFT;
     const SECTOR *const sector = &r->sectors[z_sector + x_sector * r->size.z];
@@ -168,6 +369,7 @@ void Item_RemoveActive(int16_t item_num)
     }
 
     item->active = 0;
+    M_InvalidateGrid(item);
 
     int16_t link_num = g_NextItemActive;
     if (link_num == item_num) {
@@ -188,6 +390,7 @@ void Item_RemoveDrawn(int16_t item_num)
 {
     ITEM *const item = &g_Items[item_num];
     ROOM *const r = &g_RoomInfo[item->room_num];
+    M_InvalidateGrid(item);
 
     int16_t link_num = r->item_num;
     if (link_num == item_num) {
@@ -218,6 +421,7 @@ void Item_AddActive(int16_t item_num)
     }
 
     item->active = 1;
+    M_InvalidateGrid(item);
     item->next_active = g_NextItemActive;
     g_NextItemActive = item_num;
 }
@@ -226,6 +430,7 @@ void Item_NewRoom(int16_t item_num, int16_t room_num)
 {
     ITEM *item = &g_Items[item_num];
     ROOM *r = &g_RoomInfo[item->room_num];
+    M_InvalidateGrid(item);
 
     if (item->room_num != NO_ROOM) {
         int16_t linknum = r->item_num;
@@ -308,6 +513,7 @@ int32_t Item_GlobalReplace(
              item_num = g_Items[item_num].next_item) {
             if (g_Items[item_num].object_id == src_object_id) {
                 g_Items[item_num].object_id = dst_object_id;
+                m_Grid.dirty = true;
                 changed++;
             }
         }
@@ -10,7 +10,15 @@ extern int16_t g_NextItemActive;
 
 void Item_InitialiseArray(int32_t num_items);
 int32_t Item_GetTotalCount(void);
+int32_t Item_GetActiveCount(void);
 void Item_Control(void);
+// Returns the items with a collision routine that are linked into the given
+// rooms and lie within range of pos on the XZ plane, in the order a walk
+// over the rooms' item lists would visit them. The array is reused by the
+// next call. Returns NULL if there are too many items to list.
+const int16_t *Item_GetCollidables(
+    const XYZ_32 *pos, int32_t range, const int16_t *room_nums,
+    int32_t room_count, int32_t *out_count);
 void Item_Kill(int16_t item_num);
 int16_t Item_Create(void);
 void Item_Initialise(int16_t item_num);
@@ -19,6 +19,7 @@
 #include "global/vars.h"
 
 #include <libtrx/game/math.h>
+#include <libtrx/memory.h>
 #include <libtrx/utils.h>
 #include <libtrx/vector.h>
 
@@ -400,22 +401,26 @@ bool Lara_Cheat_Teleport(int32_t x, int32_t y, int32_t z)
                     .y = y,
                     .z = ROUND_TO_SECTOR(z + dz * unit) + WALL_L / 2,
                 };
-                room_num = Room_GetIndexFromPos(point.x, point.y, point.z);
-                if (room_num == NO_ROOM) {
-                    continue;
-                }
-                sector = Room_GetSector(point.x, point.y, point.z, &room_num);
-                height = Room_GetHeight(sector, point.x, point.y, point.z);
-                if (height == NO_HEIGHT) {
-                    continue;
-                }
                 Vector_Add(points, (void *)&point);
             }
         }
 
+        int16_t *room_nums = Memory_Alloc(sizeof(int16_t) * points->count);
+        Room_GetIndicesFromPos(Vector_Get(points, 0), room_nums, points->count);
+
         int32_t best_distance = INT32_MAX;
         for (int32_t i = 0; i < points->count; i++) {
             const XYZ_32 *const point = (const XYZ_32 *)Vector_Get(points, i);
+            room_num = room_nums[i];
+            if (room_num == NO_ROOM) {
+                continue;
+            }
+            sector = Room_GetSector(point->x, point->y, point->z, &room_num);
+            height = Room_GetHeight(sector, point->x, point->y, point->z);
+            if (height == NO_HEIGHT) {
+                continue;
+            }
+
             const int32_t distance =
                 XYZ_32_GetDistance(point, &g_LaraItem->pos);
             if (distance < best_distance) {
@@ -426,6 +431,7 @@ bool Lara_Cheat_Teleport(int32_t x, int32_t y, int32_t z)
             }
         }
 
+        Memory_FreePointer(&room_nums);
         Vector_Free(points);
         if (best_distance == INT32_MAX) {
             return false;
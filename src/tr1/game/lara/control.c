@@ -26,6 +26,7 @@
 static int32_t m_OpenDoorsCheatCooldown = 0;
 
 static void M_WaterCurrent(COLL_INFO *coll);
+static void M_CollideItem(int16_t item_num, ITEM *lara_item, COLL_INFO *coll);
 static void M_BaddieCollision(ITEM *lara_item, COLL_INFO *coll);
 static SECTOR *M_GetCurrentSector(const ITEM *lara_item);
 
@@ -109,6 +110,28 @@ static void M_WaterCurrent(COLL_INFO *coll)
     coll->old.z = item->pos.z;
 }
 
+static void M_CollideItem(
+    const int16_t item_num, ITEM *const lara_item, COLL_INFO *const coll)
+{
+    const ITEM *const item = &g_Items[item_num];
+    if (!item->collidable || item->status == IS_INVISIBLE) {
+        return;
+    }
+
+    const OBJECT *const object = &g_Objects[item->object_id];
+    if (object->collision == NULL) {
+        return;
+    }
+
+    const int32_t x = lara_item->pos.x - item->pos.x;
+    const int32_t y = lara_item->pos.y - item->pos.y;
+    const int32_t z = lara_item->pos.z - item->pos.z;
+    if (x > -TARGET_DIST && x < TARGET_DIST && y > -TARGET_DIST
+        && y < TARGET_DIST && z > -TARGET_DIST && z < TARGET_DIST) {
+        object->collision(item_num, lara_item, coll);
+    }
+}
+
 static void M_BaddieCollision(ITEM *lara_item, COLL_INFO *coll)
 {
     lara_item->hit_status = 0;
@@ -121,24 +144,23 @@ static void M_BaddieCollision(ITEM *lara_item, COLL_INFO *coll)
     const int32_t roomies_count =
         Room_GetAdjoiningRooms(lara_item->room_num, roomies, 12);
 
-    for (int32_t i = 0; i < roomies_count; i++) {
-        int16_t item_num = g_RoomInfo[roomies[i]].item_num;
-        while (item_num != NO_ITEM) {
-            ITEM *item = &g_Items[item_num];
-            if (item->collidable && item->status != IS_INVISIBLE) {
-                OBJECT *object = &g_Objects[item->object_id];
-                if (object->collision) {
-                    int32_t x = lara_item->pos.x - item->pos.x;
-                    int32_t y = lara_item->pos.y - item->pos.y;
-                    int32_t z = lara_item->pos.z - item->pos.z;
-                    if (x > -TARGET_DIST && x < TARGET_DIST && y > -TARGET_DIST
-                        && y < TARGET_DIST && z > -TARGET_DIST
-                        && z < TARGET_DIST) {
-                        object->collision(item_num, lara_item, coll);
-                    }
-                }
+    // The extra sector covers Lara getting pushed around by the items she
+    // collides with along the way.
+    int32_t count;
+    const int16_t *const item_nums = Item_GetCollidables(
+        &lara_item->pos, TARGET_DIST + WALL_L, roomies, roomies_count,
+        &count);
+    if (item_nums != NULL) {
+        for (int32_t i = 0; i < count; i++) {
+            M_CollideItem(item_nums[i], lara_item, coll);
+        }
+    } else {
+        for (int32_t i = 0; i < roomies_count; i++) {
+            int16_t item_num = g_RoomInfo[roomies[i]].item_num;
+            while (item_num != NO_ITEM) {
+                M_CollideItem(item_num, lara_item, coll);
+                item_num = g_Items[item_num].next_item;
             }
-            item_num = item->next_item;
         }
     }
 
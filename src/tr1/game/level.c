@@ -27,10 +27,13 @@
 #include <libtrx/benchmark.h>
 #include <libtrx/config.h>
 #include <libtrx/debug.h>
+#include <libtrx/engine/audio.h>
 #include <libtrx/game/gamebuf.h>
 #include <libtrx/game/level.h>
+#include <libtrx/jobs.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/scratch.h>
 #include <libtrx/utils.h>
 #include <libtrx/virtual_file.h>
 
@@ -40,8 +43,7 @@
 static LEVEL_INFO m_LevelInfo = {};
 static INJECTION_INFO *m_InjectionInfo = NULL;
 
-static void M_LoadFromFile(
-    const char *filename, int32_t level_num, bool is_demo);
+static void M_LoadFromFile(VFILE *file, int32_t level_num, bool is_demo);
 static void M_LoadTexturePages(VFILE *file);
 static void M_LoadRooms(VFILE *file);
 static void M_LoadObjectMeshes(VFILE *file);
@@ -65,25 +67,27 @@ static void M_LoadPalette(VFILE *file);
 static void M_LoadCinematic(VFILE *file);
 static void M_LoadDemo(VFILE *file);
 static void M_LoadSamples(VFILE *file);
+static void M_ExpandTexturePage(void *arg);
+static void M_LoadAnimFramesJob(void *arg);
+static void M_MarkWaterEdgeVerticesJob(void *arg);
+static void M_CalculateMaxVerticesJob(void *arg);
+static void M_ObserveRoomsLoadJob(void *arg);
+static void M_DecodeSampleJob(void *arg);
+static void M_LoadSampleData(void);
 static void M_CompleteSetup(int32_t level_num);
 static void M_MarkWaterEdgeVertices(void);
 static size_t M_CalculateMaxVertices(void);
 
 static void M_LoadFromFile(
-    const char *filename, int32_t level_num, bool is_demo)
+    VFILE *const file, const int32_t level_num, const bool is_demo)
 {
     GameBuf_Reset();
 
-    VFILE *file = VFile_CreateFromPath(filename);
-    if (!file) {
-        Shell_ExitSystemFmt("M_LoadFromFile(): Could not open %s", filename);
-    }
-
     const int32_t version = VFile_ReadS32(file);
     if (version != 32) {
         Shell_ExitSystemFmt(
             "Level %d (%s) is version %d (this game code is version %d)",
-            level_num, filename, version, 32);
+            level_num, g_GameFlow.levels[level_num].level_file, version, 32);
     }
 
     M_LoadTexturePages(file);
@@ -123,8 +127,6 @@ static void M_LoadFromFile(
     M_LoadCinematic(file);
     M_LoadDemo(file);
     M_LoadSamples(file);
-
-    VFile_Close(file);
 }
 
 static void M_LoadTexturePages(VFILE *file)
@@ -132,11 +134,10 @@ static void M_LoadTexturePages(VFILE *file)
     BENCHMARK *const benchmark = Benchmark_Start();
     m_LevelInfo.texture_page_count = VFile_ReadS32(file);
     LOG_INFO("%d texture pages", m_LevelInfo.texture_page_count);
+    // The paletted pages are only needed until they are expanded to RGBA in
+    // M_CompleteSetup, so read them straight from the level file.
     m_LevelInfo.texture_palette_page_ptrs =
-        Memory_Alloc(m_LevelInfo.texture_page_count * PAGE_SIZE);
-    VFile_Read(
-        file, m_LevelInfo.texture_palette_page_ptrs,
-        PAGE_SIZE * m_LevelInfo.texture_page_count);
+        VFile_ViewU8(file, PAGE_SIZE * m_LevelInfo.texture_page_count);
     Benchmark_End(benchmark, NULL);
 }
 
@@ -257,8 +258,7 @@ static void M_LoadRooms(VFILE *file)
     }
 
     const int32_t fd_length = VFile_ReadS32(file);
-    m_LevelInfo.floor_data = Memory_Alloc(sizeof(int16_t) * fd_length);
-    VFile_Read(file, m_LevelInfo.floor_data, sizeof(int16_t) * fd_length);
+    m_LevelInfo.floor_data = VFile_ViewS16(file, fd_length);
     Benchmark_End(benchmark, NULL);
 }
 
@@ -273,9 +273,13 @@ static void M_LoadObjectMeshes(VFILE *const file)
 
     m_LevelInfo.mesh_ptr_count = VFile_ReadS32(file);
     LOG_INFO("%d object mesh indices", m_LevelInfo.mesh_ptr_count);
-    const int32_t alloc_size = m_LevelInfo.mesh_ptr_count * sizeof(int32_t);
-    int32_t *mesh_indices = Memory_Alloc(alloc_size);
-    VFile_Read(file, mesh_indices, alloc_size);
+    // The indices are not necessarily 4-byte aligned in the file, so they
+    // are copied out rather than viewed in place.
+    const SCRATCH_MARK mark = Scratch_Mark();
+    int32_t *const mesh_indices =
+        Scratch_AllocNoZero(sizeof(int32_t) * m_LevelInfo.mesh_ptr_count);
+    VFile_Read(
+        file, mesh_indices, sizeof(int32_t) * m_LevelInfo.mesh_ptr_count);
 
     const size_t end_pos = VFile_GetPos(file);
     VFile_SetPos(file, data_start_pos);
@@ -285,7 +289,7 @@ static void M_LoadObjectMeshes(VFILE *const file)
     Level_ReadObjectMeshes(m_LevelInfo.mesh_ptr_count, mesh_indices, file);
 
     VFile_SetPos(file, end_pos);
-    Memory_FreePointer(&mesh_indices);
+    Scratch_Rewind(mark);
 
     Benchmark_End(benchmark, NULL);
 }
@@ -350,7 +354,7 @@ static void M_LoadAnimFrames(VFILE *file)
     const int32_t raw_data_count = VFile_ReadS32(file);
     m_LevelInfo.anim_frame_data_count = raw_data_count;
     LOG_INFO("%d raw anim frames", m_LevelInfo.anim_frame_data_count);
-    m_LevelInfo.anim_frame_data = Memory_Alloc(
+    m_LevelInfo.anim_frame_data = Scratch_AllocNoZero(
         sizeof(int16_t)
         * (raw_data_count + m_InjectionInfo->anim_frame_data_count));
     VFile_Read(
@@ -754,36 +758,103 @@ static void M_LoadSamples(VFILE *file)
     Benchmark_End(benchmark, NULL);
 }
 
+static void M_ExpandTexturePage(void *const arg)
+{
+    const int32_t page_num = (intptr_t)arg;
+    RGBA_8888 *output =
+        &m_LevelInfo.texture_rgb_page_ptrs[page_num * PAGE_SIZE];
+    const uint8_t *input =
+        &m_LevelInfo.texture_palette_page_ptrs[page_num * PAGE_SIZE];
+    for (int32_t i = 0; i < PAGE_SIZE; i++) {
+        const uint8_t index = *input++;
+        if (index == 0) {
+            output->r = 0;
+            output->g = 0;
+            output->b = 0;
+            output->a = 0;
+        } else {
+            RGB_888 pix = m_LevelInfo.palette[index];
+            output->r = pix.r;
+            output->g = pix.g;
+            output->b = pix.b;
+            output->a = 255;
+        }
+        output++;
+    }
+}
+
+static void M_LoadAnimFramesJob(void *const arg)
+{
+    Anim_LoadFrames(
+        m_LevelInfo.anim_frame_data, m_LevelInfo.anim_frame_data_count);
+}
+
+static void M_MarkWaterEdgeVerticesJob(void *const arg)
+{
+    M_MarkWaterEdgeVertices();
+}
+
+static void M_CalculateMaxVerticesJob(void *const arg)
+{
+    size_t *const max_vertices = arg;
+    *max_vertices = M_CalculateMaxVertices();
+}
+
+static void M_ObserveRoomsLoadJob(void *const arg)
+{
+    Stats_ObserveRoomsLoad();
+}
+
+static void M_DecodeSampleJob(void *const arg)
+{
+    const int32_t sample_num = (intptr_t)arg;
+    Audio_Sample_Decode(sample_num);
+}
+
+static void M_LoadSampleData(void)
+{
+    const SCRATCH_MARK mark = Scratch_Mark();
+    size_t *const sample_sizes =
+        Scratch_AllocNoZero(sizeof(size_t) * m_LevelInfo.sample_count);
+    const char **const sample_pointers =
+        Scratch_AllocNoZero(sizeof(char *) * m_LevelInfo.sample_count);
+    for (int i = 0; i < m_LevelInfo.sample_count; i++) {
+        sample_pointers[i] =
+            m_LevelInfo.sample_data + m_LevelInfo.sample_offsets[i];
+    }
+
+    // NOTE: this assumes that sample pointers are sorted
+    for (int i = 0; i < m_LevelInfo.sample_count; i++) {
+        int current_offset = m_LevelInfo.sample_offsets[i];
+        int next_offset = i + 1 >= m_LevelInfo.sample_count
+            ? m_LevelInfo.sample_data_size
+            : m_LevelInfo.sample_offsets[i + 1];
+        sample_sizes[i] = next_offset - current_offset;
+    }
+
+    Sound_LoadSamples(m_LevelInfo.sample_count, sample_pointers, sample_sizes);
+
+    Scratch_Rewind(mark);
+}
+
 static void M_CompleteSetup(int32_t level_num)
 {
     BENCHMARK *const benchmark = Benchmark_Start();
 
     // Expand raw floor data into sectors
     Room_ParseFloorData(m_LevelInfo.floor_data);
-    Memory_FreePointer(&m_LevelInfo.floor_data);
 
-    // Expand paletted texture data to RGB
+    // Expand paletted texture data to RGB. This must finish before the
+    // injections run, as they can add more texture pages.
     m_LevelInfo.texture_rgb_page_ptrs = Memory_Alloc(
         m_LevelInfo.texture_page_count * PAGE_SIZE * sizeof(RGBA_8888));
-    RGBA_8888 *output = m_LevelInfo.texture_rgb_page_ptrs;
-    const uint8_t *input = m_LevelInfo.texture_palette_page_ptrs;
-    for (int32_t i = 0; i < m_LevelInfo.texture_page_count; i++) {
-        for (int32_t j = 0; j < PAGE_SIZE; j++) {
-            const uint8_t index = *input++;
-            if (index == 0) {
-                output->r = 0;
-                output->g = 0;
-                output->b = 0;
-                output->a = 0;
-            } else {
-                RGB_888 pix = m_LevelInfo.palette[index];
-                output->r = pix.r;
-                output->g = pix.g;
-                output->b = pix.b;
-                output->a = 255;
-            }
-            output++;
+    {
+        JOB_GRAPH *const graph = Jobs_CreateGraph();
+        for (int32_t i = 0; i < m_LevelInfo.texture_page_count; i++) {
+            Jobs_Add(graph, M_ExpandTexturePage, (void *)(intptr_t)i);
         }
+        Jobs_Run(graph);
+        Jobs_FreeGraph(graph);
     }
 
     // We inject explosions sprites and sounds, although in the original game,
@@ -792,17 +863,39 @@ static void M_CompleteSetup(int32_t level_num)
     Mutant_ToggleExplosions(g_Objects[O_EXPLOSION_1].loaded);
 
     Inject_AllInjections(&m_LevelInfo);
+    Room_BuildIndex();
 
     const int32_t frame_count = Anim_GetTotalFrameCount();
     Anim_InitialiseFrames(frame_count);
-    Anim_LoadFrames(
-        m_LevelInfo.anim_frame_data, m_LevelInfo.anim_frame_data_count);
-    Memory_FreePointer(&m_LevelInfo.anim_frame_data);
 
-    M_MarkWaterEdgeVertices();
+    // Initialise the sound effects.
+    M_LoadSampleData();
 
-    // Must be called post-injection to allow for floor data changes.
-    Stats_ObserveRoomsLoad();
+    // The passes below are independent of each other and run concurrently.
+    // GameBuf is not thread safe, so the jobs that allocate from it are
+    // chained.
+    size_t max_vertices = 0;
+    JOB_GRAPH *const graph = Jobs_CreateGraph();
+    {
+        const JOB_ID anim_frames_job =
+            Jobs_Add(graph, M_LoadAnimFramesJob, NULL);
+
+        // Must be called post-injection to allow for floor data changes.
+        const JOB_ID rooms_stats_job =
+            Jobs_Add(graph, M_ObserveRoomsLoadJob, NULL);
+        Jobs_AddDependency(graph, rooms_stats_job, anim_frames_job);
+
+        Jobs_Add(graph, M_MarkWaterEdgeVerticesJob, NULL);
+        Jobs_Add(graph, M_CalculateMaxVerticesJob, &max_vertices);
+
+        for (int32_t i = 0; i < m_LevelInfo.sample_count; i++) {
+            Jobs_Add(graph, M_DecodeSampleJob, (void *)(intptr_t)i);
+        }
+    }
+    Jobs_Run(graph);
+    Jobs_FreeGraph(graph);
+    // The raw frames live in the scratch arena, which Level_Load releases.
+    m_LevelInfo.anim_frame_data = NULL;
 
     // Must be called after all animations, meshes etc are initialised.
     Object_SetupAllObjects();
@@ -816,7 +909,6 @@ static void M_CompleteSetup(int32_t level_num)
     // Configure enemies who carry and drop items
     Carrier_InitialiseLevel(level_num);
 
-    const size_t max_vertices = M_CalculateMaxVertices();
     LOG_INFO("Maximum vertices: %d", max_vertices);
     Output_ReserveVertexBuffer(max_vertices);
 
@@ -831,32 +923,9 @@ static void M_CompleteSetup(int32_t level_num)
         g_TexturePagePtrs[i] = &final_texture_data[i * PAGE_SIZE];
     }
     Output_DownloadTextures(m_LevelInfo.texture_page_count);
+    Output_UploadRooms();
     Output_SetPalette(m_LevelInfo.palette, m_LevelInfo.palette_size);
 
-    // Initialise the sound effects.
-    size_t *sample_sizes =
-        Memory_Alloc(sizeof(size_t) * m_LevelInfo.sample_count);
-    const char **sample_pointers =
-        Memory_Alloc(sizeof(char *) * m_LevelInfo.sample_count);
-    for (int i = 0; i < m_LevelInfo.sample_count; i++) {
-        sample_pointers[i] =
-            m_LevelInfo.sample_data + m_LevelInfo.sample_offsets[i];
-    }
-
-    // NOTE: this assumes that sample pointers are sorted
-    for (int i = 0; i < m_LevelInfo.sample_count; i++) {
-        int current_offset = m_LevelInfo.sample_offsets[i];
-        int next_offset = i + 1 >= m_LevelInfo.sample_count
-            ? m_LevelInfo.sample_data_size
-            : m_LevelInfo.sample_offsets[i + 1];
-        sample_sizes[i] = next_offset - current_offset;
-    }
-
-    Sound_LoadSamples(m_LevelInfo.sample_count, sample_pointers, sample_sizes);
-
-    Memory_FreePointer(&sample_pointers);
-    Memory_FreePointer(&sample_sizes);
-
     Benchmark_End(benchmark, NULL);
 }
 
@@ -924,7 +993,6 @@ void Level_Load(int level_num)
     BENCHMARK *const benchmark = Benchmark_Start();
 
     // clean previous level data
-    Memory_FreePointer(&m_LevelInfo.texture_palette_page_ptrs);
     Memory_FreePointer(&m_LevelInfo.texture_rgb_page_ptrs);
     Memory_FreePointer(&m_LevelInfo.sample_offsets);
     Memory_FreePointer(&m_LevelInfo.palette);
@@ -939,11 +1007,27 @@ void Level_Load(int level_num)
         (g_GameFlow.levels[level_num].level_type == GFL_TITLE_DEMO_PC)
         | (g_GameFlow.levels[level_num].level_type == GFL_LEVEL_DEMO_PC);
 
-    M_LoadFromFile(g_GameFlow.levels[level_num].level_file, level_num, is_demo);
+    const char *const filename = g_GameFlow.levels[level_num].level_file;
+    VFILE *const file = VFile_CreateFromPath(filename);
+    if (!file) {
+        Shell_ExitSystemFmt("Level_Load(): Could not open %s", filename);
+    }
+
+    // The level file stays open until the setup is complete, as some of the
+    // data is consumed directly from it rather than being copied.
+    M_LoadFromFile(file, level_num, is_demo);
     M_CompleteSetup(level_num);
 
+    m_LevelInfo.texture_palette_page_ptrs = NULL;
+    m_LevelInfo.floor_data = NULL;
+    VFile_Close(file);
+
     Inject_Cleanup();
 
+    // Release the temporaries of the setup, along with any memory a big
+    // injection made the scratch arena grow by.
+    Scratch_Reset();
+
     Output_SetWaterColor(
         g_GameFlow.levels[level_num].water_color.override
             ? &g_GameFlow.levels[level_num].water_color.value
@@ -1,5 +1,6 @@
 #include "game/lot.h"
 
+#include "game/box.h"
 #include "game/items.h"
 #include "game/shell.h"
 #include "global/const.h"
@@ -24,6 +25,12 @@ void LOT_InitialiseArray(void)
             GameBuf_Alloc(sizeof(BOX_NODE) * g_NumberBoxes, GBUF_CREATURE_LOT);
     }
     m_SlotsUsed = 0;
+    Box_InitialisePathCache();
+}
+
+int32_t LOT_GetActiveCount(void)
+{
+    return m_SlotsUsed;
 }
 
 void LOT_DisableBaddieAI(int16_t item_num)
@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 void LOT_InitialiseArray(void);
+int32_t LOT_GetActiveCount(void);
 void LOT_DisableBaddieAI(int16_t item_num);
 bool LOT_EnableBaddieAI(int16_t item_num, int32_t always);
 void LOT_InitialiseSlot(int16_t item_num, int32_t slot);
@@ -7,6 +7,7 @@
 #include <libtrx/config.h>
 #include <libtrx/engine/audio.h>
 #include <libtrx/filesystem.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
 
@@ -77,11 +78,17 @@ static void M_StreamFinished(int stream_id, void *user_data)
 
 bool Music_Init(void)
 {
+    if (Headless_IsEnabled()) {
+        return false;
+    }
     return Audio_Init();
 }
 
 void Music_Shutdown(void)
 {
+    if (Headless_IsEnabled()) {
+        return;
+    }
     Audio_Shutdown();
 }
 
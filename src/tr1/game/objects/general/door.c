@@ -1,5 +1,6 @@
 #include "game/objects/general/door.h"
 
+#include "game/box.h"
 #include "game/collide.h"
 #include "game/items.h"
 #include "game/lara/common.h"
@@ -105,7 +106,7 @@ static void M_Shut(DOORPOS_DATA *const d)
 
     const int16_t box_num = d->block;
     if (box_num != NO_BOX) {
-        g_Boxes[box_num].overlap_index |= BLOCKED;
+        Box_SetBlocked(box_num, true);
     }
 }
 
@@ -121,7 +122,7 @@ static void M_Open(DOORPOS_DATA *const d)
 
     const int16_t box_num = d->block;
     if (box_num != NO_BOX) {
-        g_Boxes[box_num].overlap_index &= ~BLOCKED;
+        Box_SetBlocked(box_num, false);
     }
 }
 
@@ -18,10 +18,14 @@
 #include <libtrx/engine/image.h>
 #include <libtrx/filesystem.h>
 #include <libtrx/game/console/common.h>
+#include <libtrx/game/frame_stats.h>
 #include <libtrx/game/gamebuf.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/math.h>
 #include <libtrx/gfx/context.h>
 #include <libtrx/memory.h>
+#include <libtrx/profiler.h>
+#include <libtrx/scratch.h>
 #include <libtrx/utils.h>
 
 #include <math.h>
@@ -38,6 +42,12 @@ typedef struct {
     } edges[2];
 } LIGHTNING;
 
+typedef struct {
+    int32_t first_index;
+    int32_t index_count;
+    int32_t vertex_count;
+} ROOM_GEOMETRY;
+
 typedef struct {
     int16_t poly_count;
     int16_t vertex_count;
@@ -65,7 +75,11 @@ static int32_t m_WibbleTable[WIBBLE_SIZE] = {};
 static int32_t m_ShadeTable[WIBBLE_SIZE] = {};
 static int32_t m_RandTable[WIBBLE_SIZE] = {};
 
+static ROOM_GEOMETRY *m_RoomGeometry = NULL;
+static int32_t m_RoomTextureCount = 0;
+
 static PHD_VBUF *m_VBuf = NULL;
+static int32_t *m_VBufZv = NULL;
 static PHD_UV *m_EnvMapUV = NULL;
 static int32_t m_DrawDistFade = 0;
 static int32_t m_DrawDistMax = 0;
@@ -87,12 +101,22 @@ static void M_DrawTexturedFace4s(const FACE4 *faces, int32_t count);
 static void M_DrawObjectFace3EnvMap(const FACE3 *faces, int32_t count);
 static void M_DrawObjectFace4EnvMap(const FACE4 *faces, int32_t count);
 static void M_DrawRoomSprites(const ROOM_MESH *mesh);
+static uint16_t M_TransformVertices(
+    const int16_t *vertices, int32_t stride, int32_t first, int32_t count,
+    int32_t *zv_int);
 static bool M_CalcObjectVertices(const XYZ_16 *vertices, int16_t count);
 static void M_CalcVerticeLight(const OBJECT_MESH *mesh);
 static bool M_CalcVerticeEnvMap(const OBJECT_MESH *mesh);
 static void M_CalcSkyboxLight(const OBJECT_MESH *mesh);
+static void M_CalcRoomVertexShade(const ROOM_MESH *mesh, int32_t vertex_num);
 static void M_CalcRoomVertices(const ROOM_MESH *mesh);
 static void M_CalcRoomVerticesWibble(const ROOM_MESH *mesh);
+static void M_CalcRoomSpriteVertices(const ROOM_MESH *mesh);
+static GFX_3D_ROOM_VERTEX *M_AddRoomFace(
+    GFX_3D_ROOM_VERTEX *vertices, const ROOM_MESH *mesh, uint16_t texture,
+    const uint16_t *face_vertices, int32_t vertex_count);
+static void M_UploadRoomTextures(void);
+static void M_DrawRoomGeometry(int16_t room_num, bool wibble);
 static int32_t M_CalcFogShade(int32_t depth);
 static void M_CalcWibbleTable(void);
 
@@ -241,64 +265,48 @@ static void M_DrawRoomSprites(const ROOM_MESH *const mesh)
     }
 }
 
-static bool M_CalcObjectVertices(
-    const XYZ_16 *const vertices, const int16_t count)
-{
-    uint16_t total_clip = 0xFFFF;
-    for (int i = 0; i < count; i++) {
-        const XYZ_16 *const vertex = &vertices[i];
-        // clang-format off
-        double xv =
-            g_MatrixPtr->_00 * vertex->x +
-            g_MatrixPtr->_01 * vertex->y +
-            g_MatrixPtr->_02 * vertex->z +
-            g_MatrixPtr->_03;
-        double yv =
-            g_MatrixPtr->_10 * vertex->x +
-            g_MatrixPtr->_11 * vertex->y +
-            g_MatrixPtr->_12 * vertex->z +
-            g_MatrixPtr->_13;
-        double zv =
-            g_MatrixPtr->_20 * vertex->x +
-            g_MatrixPtr->_21 * vertex->y +
-            g_MatrixPtr->_22 * vertex->z +
-            g_MatrixPtr->_23;
-        // clang-format on
-
-        m_VBuf[i].xv = xv;
-        m_VBuf[i].yv = yv;
-        m_VBuf[i].zv = zv;
-
-        uint16_t clip_flags;
-        if (zv < Output_GetNearZ()) {
-            clip_flags = 0x8000;
-        } else {
-            clip_flags = 0;
-
-            double persp = g_PhdPersp / zv;
-            double xs = Viewport_GetCenterX() + xv * persp;
-            double ys = Viewport_GetCenterY() + yv * persp;
-
-            if (xs < g_PhdLeft) {
-                clip_flags |= 1;
-            } else if (xs > g_PhdRight) {
-                clip_flags |= 2;
-            }
-
-            if (ys < g_PhdTop) {
-                clip_flags |= 4;
-            } else if (ys > g_PhdBottom) {
-                clip_flags |= 8;
-            }
+static uint16_t M_TransformVertices(
+    const int16_t *const vertices, const int32_t stride, const int32_t first,
+    const int32_t count, int32_t *const zv_int)
+{
+    const MATH_PROJECTION proj = {
+        .matrix = (const int32_t *)g_MatrixPtr,
+        .persp = g_PhdPersp,
+        .center_x = Viewport_GetCenterX(),
+        .center_y = Viewport_GetCenterY(),
+        .near_z = Output_GetNearZ(),
+        .far_z = INFINITY,
+        .z_bias = 0.0,
+        .rhw_scale = 0.0,
+        .left = g_PhdLeft,
+        .top = g_PhdTop,
+        .right = g_PhdRight,
+        .bottom = g_PhdBottom,
+        .near_clip = (int16_t)0x8000,
+    };
 
-            m_VBuf[i].xs = xs;
-            m_VBuf[i].ys = ys;
-        }
+    PHD_VBUF *const vbuf = &m_VBuf[first];
+    const MATH_VERTEX_OUTPUT output = {
+        .stride = sizeof(PHD_VBUF),
+        .xv = &vbuf->xv,
+        .yv = &vbuf->yv,
+        .zv = &vbuf->zv,
+        .xs = &vbuf->xs,
+        .ys = &vbuf->ys,
+        .clip = &vbuf->clip,
+        .zv_int = zv_int != NULL ? &zv_int[first] : NULL,
+    };
 
-        m_VBuf[i].clip = clip_flags;
-        total_clip &= clip_flags;
-    }
+    return Math_TransformVertices(
+        &proj, &vertices[first * stride], stride, count, &output);
+}
 
+static bool M_CalcObjectVertices(
+    const XYZ_16 *const vertices, const int16_t count)
+{
+    const uint16_t total_clip = M_TransformVertices(
+        (const int16_t *)vertices, sizeof(XYZ_16) / sizeof(int16_t), 0, count,
+        NULL);
     return total_clip == 0;
 }
 
@@ -405,85 +413,47 @@ static void M_CalcSkyboxLight(const OBJECT_MESH *const mesh)
     }
 }
 
-static void M_CalcRoomVertices(const ROOM_MESH *const mesh)
+static void M_CalcRoomVertexShade(
+    const ROOM_MESH *const mesh, const int32_t vertex_num)
 {
-    for (int32_t i = 0; i < mesh->num_vertices; i++) {
-        PHD_VBUF *const vbuf = &m_VBuf[i];
-        const ROOM_VERTEX *const vertex = &mesh->vertices[i];
-
-        // clang-format off
-        const double xv = (
-            g_MatrixPtr->_00 * vertex->pos.x +
-            g_MatrixPtr->_01 * vertex->pos.y +
-            g_MatrixPtr->_02 * vertex->pos.z +
-            g_MatrixPtr->_03
-        );
-        const double yv = (
-            g_MatrixPtr->_10 * vertex->pos.x +
-            g_MatrixPtr->_11 * vertex->pos.y +
-            g_MatrixPtr->_12 * vertex->pos.z +
-            g_MatrixPtr->_13
-        );
-        const int32_t zv_int = (
-            g_MatrixPtr->_20 * vertex->pos.x +
-            g_MatrixPtr->_21 * vertex->pos.y +
-            g_MatrixPtr->_22 * vertex->pos.z +
-            g_MatrixPtr->_23
-        );
-        const double zv = zv_int;
-        // clang-format on
-
-        vbuf->xv = xv;
-        vbuf->yv = yv;
-        vbuf->zv = zv;
-        vbuf->g = vertex->shade & MAX_LIGHTING;
-
-        if (zv < Output_GetNearZ()) {
-            vbuf->clip = (int16_t)0x8000;
-        } else {
-            int16_t clip_flags = 0;
-            const int32_t depth = zv_int >> W2V_SHIFT;
-            if (depth > Output_GetDrawDistMax()) {
-                vbuf->g = MAX_LIGHTING;
-                if (!m_IsSkyboxEnabled) {
-                    clip_flags |= 16;
-                }
-            } else if (depth) {
-                vbuf->g += M_CalcFogShade(depth);
-                if (!m_IsWaterEffect) {
-                    CLAMPG(vbuf->g, MAX_LIGHTING);
-                }
-            }
-
-            const double persp = g_PhdPersp / (double)zv;
-            const double xs = Viewport_GetCenterX() + xv * persp;
-            const double ys = Viewport_GetCenterY() + yv * persp;
+    PHD_VBUF *const vbuf = &m_VBuf[vertex_num];
+    const ROOM_VERTEX *const vertex = &mesh->vertices[vertex_num];
 
-            if (xs < g_PhdLeft) {
-                clip_flags |= 1;
-            } else if (xs > g_PhdRight) {
-                clip_flags |= 2;
-            }
+    vbuf->g = vertex->shade & MAX_LIGHTING;
+    if (vbuf->clip < 0) {
+        return;
+    }
 
-            if (ys < g_PhdTop) {
-                clip_flags |= 4;
-            } else if (ys > g_PhdBottom) {
-                clip_flags |= 8;
-            }
+    const int32_t depth = m_VBufZv[vertex_num] >> W2V_SHIFT;
+    if (depth > Output_GetDrawDistMax()) {
+        vbuf->g = MAX_LIGHTING;
+        if (!m_IsSkyboxEnabled) {
+            vbuf->clip |= 16;
+        }
+    } else if (depth) {
+        vbuf->g += M_CalcFogShade(depth);
+        if (!m_IsWaterEffect) {
+            CLAMPG(vbuf->g, MAX_LIGHTING);
+        }
+    }
 
-            if (m_IsWaterEffect) {
-                vbuf->g += m_ShadeTable[(
-                    ((uint8_t)m_WibbleOffset
-                     + (uint8_t)
-                         m_RandTable[(mesh->num_vertices - i) % WIBBLE_SIZE])
-                    % WIBBLE_SIZE)];
-                CLAMP(vbuf->g, 0, 0x1FFF);
-            }
+    if (m_IsWaterEffect) {
+        vbuf->g += m_ShadeTable[(
+            ((uint8_t)m_WibbleOffset
+             + (uint8_t)
+                 m_RandTable[(mesh->num_vertices - vertex_num) % WIBBLE_SIZE])
+            % WIBBLE_SIZE)];
+        CLAMP(vbuf->g, 0, 0x1FFF);
+    }
+}
 
-            vbuf->xs = xs;
-            vbuf->ys = ys;
-            vbuf->clip = clip_flags;
-        }
+static void M_CalcRoomVertices(const ROOM_MESH *const mesh)
+{
+    M_TransformVertices(
+        (const int16_t *)mesh->vertices, sizeof(ROOM_VERTEX) / sizeof(int16_t),
+        0, mesh->num_vertices, m_VBufZv);
+    for (int32_t i = 0; i < mesh->num_vertices; i++) {
+        M_CalcRoomVertexShade(mesh, i);
     }
 }
 
@@ -520,6 +490,81 @@ static void M_CalcRoomVerticesWibble(const ROOM_MESH *const mesh)
     }
 }
 
+static void M_CalcRoomSpriteVertices(const ROOM_MESH *const mesh)
+{
+    for (int32_t i = 0; i < mesh->num_sprites; i++) {
+        const int32_t vertex_num = mesh->sprites[i].vertex;
+        M_TransformVertices(
+            (const int16_t *)mesh->vertices,
+            sizeof(ROOM_VERTEX) / sizeof(int16_t), vertex_num, 1, m_VBufZv);
+        M_CalcRoomVertexShade(mesh, vertex_num);
+    }
+}
+
+static GFX_3D_ROOM_VERTEX *M_AddRoomFace(
+    GFX_3D_ROOM_VERTEX *vertices, const ROOM_MESH *const mesh,
+    const uint16_t texture, const uint16_t *const face_vertices,
+    const int32_t vertex_count)
+{
+    for (int32_t i = 0; i < vertex_count; i++) {
+        const int32_t vertex_num = face_vertices[i];
+        const ROOM_VERTEX *const vertex = &mesh->vertices[vertex_num];
+        *vertices++ = (GFX_3D_ROOM_VERTEX) {
+            .x = vertex->pos.x,
+            .y = vertex->pos.y,
+            .z = vertex->pos.z,
+            .shade = vertex->shade & MAX_LIGHTING,
+            .texture = texture,
+            .corner = i,
+            .flags = (vertex->flags & NO_VERT_MOVE)
+                ? GFX_3D_ROOM_VERTEX_NO_WIBBLE
+                : 0,
+            .shade_phase = (uint8_t)m_RandTable
+                [(mesh->num_vertices - vertex_num) % WIBBLE_SIZE],
+        };
+    }
+    m_RoomTextureCount = MAX(m_RoomTextureCount, texture + 1);
+    return vertices;
+}
+
+static void M_UploadRoomTextures(void)
+{
+    S_Output_UploadRoomTextures(g_PhdTextureInfo, m_RoomTextureCount);
+}
+
+static void M_DrawRoomGeometry(const int16_t room_num, const bool wibble)
+{
+    const ROOM_GEOMETRY *const geometry = &m_RoomGeometry[room_num];
+    GFX_3D_ROOM_PARAMS params = {
+        .center_x = Viewport_GetCenterX(),
+        .center_y = Viewport_GetCenterY(),
+        .persp = g_PhdPersp,
+        .near_z = Output_GetNearZ(),
+        .draw_dist_fade = Output_GetDrawDistFade(),
+        .draw_dist_max = Output_GetDrawDistMax(),
+        .clip_far = !m_IsSkyboxEnabled,
+        .water_effect = m_IsWaterEffect,
+        .wibble_effect = wibble,
+        .wibble_offset = m_WibbleOffset,
+    };
+
+    const MATRIX *const mptr = g_MatrixPtr;
+    const int32_t matrix[3][4] = {
+        { mptr->_00, mptr->_01, mptr->_02, mptr->_03 },
+        { mptr->_10, mptr->_11, mptr->_12, mptr->_13 },
+        { mptr->_20, mptr->_21, mptr->_22, mptr->_23 },
+    };
+    for (int32_t i = 0; i < 3; i++) {
+        for (int32_t j = 0; j < 4; j++) {
+            params.matrix[i][j] = matrix[i][j];
+        }
+    }
+
+    S_Output_DrawRoomGeometry(
+        &params, geometry->first_index, geometry->index_count,
+        geometry->vertex_count);
+}
+
 static int32_t M_CalcFogShade(int32_t depth)
 {
     int32_t fog_begin = Output_GetDrawDistFade();
@@ -561,6 +606,7 @@ void Output_Shutdown(void)
 void Output_ReserveVertexBuffer(const size_t size)
 {
     m_VBuf = GameBuf_Alloc(size * sizeof(PHD_VBUF), GBUF_VERTEX_BUFFER);
+    m_VBufZv = GameBuf_Alloc(size * sizeof(int32_t), GBUF_VERTEX_BUFFER);
     m_EnvMapUV = GameBuf_Alloc(size * sizeof(PHD_UV), GBUF_VERTEX_BUFFER);
 }
 
@@ -579,6 +625,10 @@ void Output_ApplyRenderSettings(void)
 
 void Output_DownloadTextures(int page_count)
 {
+    // Headless runs never draw, so they keep nothing on the GPU.
+    if (Headless_IsEnabled()) {
+        return;
+    }
     S_Output_DownloadTextures(page_count);
 }
 
@@ -588,6 +638,76 @@ RGBA_8888 Output_RGB2RGBA(const RGB_888 color)
     return ret;
 }
 
+void Output_UploadRooms(void)
+{
+    m_RoomGeometry = NULL;
+    m_RoomTextureCount = 0;
+    if (Headless_IsEnabled() || !S_Output_IsRoomGeometrySupported()) {
+        return;
+    }
+
+    int32_t total_vertices = 0;
+    int32_t total_indices = 0;
+    for (int32_t i = 0; i < g_RoomCount; i++) {
+        const ROOM_MESH *const mesh = &g_RoomInfo[i].mesh;
+        total_vertices += mesh->num_face4s * 4 + mesh->num_face3s * 3;
+        total_indices += mesh->num_face4s * 6 + mesh->num_face3s * 3;
+    }
+
+    // Faces do not share vertices, as the same room vertex can have
+    // different texture coordinates in each face it is part of.
+    const SCRATCH_MARK mark = Scratch_Mark();
+    GFX_3D_ROOM_VERTEX *const vertices =
+        Scratch_AllocNoZero(total_vertices * sizeof(GFX_3D_ROOM_VERTEX));
+    uint32_t *const indices =
+        Scratch_AllocNoZero(total_indices * sizeof(uint32_t));
+    m_RoomGeometry =
+        GameBuf_Alloc(g_RoomCount * sizeof(ROOM_GEOMETRY), GBUF_ROOM_MESH);
+
+    GFX_3D_ROOM_VERTEX *vertex = vertices;
+    uint32_t *index = indices;
+    for (int32_t i = 0; i < g_RoomCount; i++) {
+        const ROOM_MESH *const mesh = &g_RoomInfo[i].mesh;
+        ROOM_GEOMETRY *const geometry = &m_RoomGeometry[i];
+        geometry->first_index = index - indices;
+        const GFX_3D_ROOM_VERTEX *const first_vertex = vertex;
+
+        // Same draw order and diagonal as M_DrawTexturedFace4s and
+        // M_DrawTexturedFace3s.
+        for (int32_t j = 0; j < mesh->num_face4s; j++) {
+            const FACE4 *const face = &mesh->face4s[j];
+            const uint32_t base = vertex - vertices;
+            vertex = M_AddRoomFace(
+                vertex, mesh, face->texture, face->vertices, 4);
+            *index++ = base + 0;
+            *index++ = base + 1;
+            *index++ = base + 2;
+            *index++ = base + 2;
+            *index++ = base + 3;
+            *index++ = base + 0;
+        }
+        for (int32_t j = 0; j < mesh->num_face3s; j++) {
+            const FACE3 *const face = &mesh->face3s[j];
+            const uint32_t base = vertex - vertices;
+            vertex = M_AddRoomFace(
+                vertex, mesh, face->texture, face->vertices, 3);
+            *index++ = base + 0;
+            *index++ = base + 1;
+            *index++ = base + 2;
+        }
+
+        geometry->index_count = (index - indices) - geometry->first_index;
+        geometry->vertex_count = vertex - first_vertex;
+    }
+
+    S_Output_UploadRoomGeometry(
+        vertices, total_vertices, indices, total_indices);
+    Scratch_Rewind(mark);
+
+    S_Output_SetRoomTables(m_WibbleTable, m_ShadeTable);
+    M_UploadRoomTextures();
+}
+
 void Output_DrawBlack(void)
 {
     Output_DrawBlackRectangle(255);
@@ -620,10 +740,11 @@ void Output_EndScene(void)
     S_Output_DisableDepthTest();
     S_Output_ClearDepthBuffer();
     Overlay_DrawFPSInfo();
+    FrameStats_Draw();
     Console_Draw();
     S_Output_EnableDepthTest();
     S_Output_RenderEnd();
-    S_Output_FlipScreen();
+    PROFILER_CALL("Flip", S_Output_FlipScreen());
     Shell_ProcessEvents();
     g_FPSCounter++;
 }
@@ -783,8 +904,23 @@ void Output_DrawSkybox(const OBJECT_MESH *const mesh)
     S_Output_EnableDepthTest();
 }
 
-void Output_DrawRoom(const ROOM_MESH *const mesh)
+void Output_DrawRoom(const int16_t room_num)
 {
+    const ROOM_MESH *const mesh = &g_RoomInfo[room_num].mesh;
+    if (m_RoomGeometry != NULL) {
+        if (m_IsWibbleEffect) {
+            S_Output_DisableDepthWrites();
+            M_DrawRoomGeometry(room_num, false);
+            S_Output_EnableDepthWrites();
+        }
+        M_DrawRoomGeometry(room_num, m_IsWibbleEffect);
+
+        // Room sprites are still drawn by the CPU.
+        M_CalcRoomSpriteVertices(mesh);
+        M_DrawRoomSprites(mesh);
+        return;
+    }
+
     M_CalcRoomVertices(mesh);
 
     if (m_IsWibbleEffect) {
@@ -1105,6 +1241,9 @@ void Output_LoadBackgroundFromFile(const char *const file_name)
     const char *old_path = m_BackdropImagePath;
     m_BackdropImagePath = File_GuessExtension(file_name, m_ImageExtensions);
     Memory_FreePointer(&old_path);
+    if (Headless_IsEnabled()) {
+        return;
+    }
 
     IMAGE *img = Image_CreateFromFileInto(
         m_BackdropImagePath, Viewport_GetWidth(), Viewport_GetHeight(),
@@ -1171,6 +1310,7 @@ void Output_AnimateTextures(const int32_t num_frames)
 {
     m_WibbleOffset = (m_WibbleOffset + num_frames) % WIBBLE_SIZE;
     m_AnimatedTexturesOffset += num_frames;
+    const bool is_animated = m_AnimatedTexturesOffset > 5;
     while (m_AnimatedTexturesOffset > 5) {
         const TEXTURE_RANGE *range = g_AnimTextureRanges;
         while (range) {
@@ -1200,6 +1340,12 @@ void Output_AnimateTextures(const int32_t num_frames)
         }
         m_AnimatedTexturesOffset -= 5;
     }
+
+    if (is_animated && m_RoomGeometry != NULL) {
+        // The retained room geometry looks the texture coordinates up on the
+        // GPU, so it needs to see the rotated textures.
+        M_UploadRoomTextures();
+    }
 }
 
 void Output_RotateLight(int16_t pitch, int16_t yaw)
@@ -13,6 +13,9 @@ void Output_ReserveVertexBuffer(size_t size);
 void Output_SetWindowSize(int width, int height);
 void Output_ApplyRenderSettings(void);
 void Output_DownloadTextures(int page_count);
+// Uploads the static geometry of all rooms to the GPU. Must be called after
+// the texture pages are downloaded.
+void Output_UploadRooms(void);
 
 RGBA_8888 Output_RGB2RGBA(const RGB_888 color);
 void Output_SetPalette(const RGB_888 *palette, size_t palette_size);
@@ -44,7 +47,7 @@ void Output_SetSkyboxEnabled(bool enabled);
 bool Output_IsSkyboxEnabled(void);
 void Output_DrawSkybox(const OBJECT_MESH *mesh);
 
-void Output_DrawRoom(const ROOM_MESH *mesh);
+void Output_DrawRoom(int16_t room_num);
 void Output_DrawShadow(int16_t size, const BOUNDS_16 *bounds, const ITEM *item);
 void Output_DrawLightningSegment(
     int32_t x1, int32_t y1, int32_t z1, int32_t x2, int32_t y2, int32_t z2,
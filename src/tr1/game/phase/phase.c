@@ -8,11 +8,15 @@
 #include "game/phase/phase_game.h"
 #include "game/phase/phase_inventory.h"
 #include "game/phase/phase_stats.h"
+#include "game/shell.h"
 #include "global/types.h"
 #include "global/vars.h"
 
+#include <libtrx/game/frame_stats.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/profiler.h>
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -42,18 +46,32 @@ static PHASE_CONTROL M_Control(int32_t nframes)
     }
 
     if (m_Phaser && m_Phaser->control) {
-        return m_Phaser->control(nframes);
+        PROFILER_ZONE zone;
+        Profiler_BeginZone(&zone, "Control");
+        const PHASE_CONTROL control = m_Phaser->control(nframes);
+        Profiler_EndZone(&zone);
+        return control;
     }
     return (PHASE_CONTROL) { .action = PHASE_ACTION_CONTINUE };
 }
 
 static void M_Draw(void)
 {
+    if (Headless_IsEnabled()) {
+        // Output_EndScene normally pumps the event queue; without it quit
+        // requests and SIGINT would go unnoticed.
+        Shell_ProcessEvents();
+        return;
+    }
+    PROFILER_ZONE zone;
+    Profiler_BeginZone(&zone, "Draw");
     Output_BeginScene();
     if (m_Phaser && m_Phaser->draw) {
         m_Phaser->draw();
     }
     Output_EndScene();
+    Profiler_EndZone(&zone);
+    FrameStats_Mark(FRAME_STATS_DRAW);
 }
 
 static void M_SetUnconditionally(const PHASE_ENUM phase, const void *args)
@@ -111,11 +129,14 @@ void Phase_Set(const PHASE_ENUM phase, const void *const args)
 
 static int32_t M_Wait(void)
 {
+    int32_t nframes;
     if (m_Phaser && m_Phaser->wait) {
-        return m_Phaser->wait();
+        nframes = m_Phaser->wait();
     } else {
-        return Clock_WaitTick();
+        nframes = Clock_WaitTick();
     }
+    FrameStats_Mark(FRAME_STATS_WAIT);
+    return nframes;
 }
 
 GAME_FLOW_COMMAND Phase_Run(void)
@@ -128,6 +149,7 @@ GAME_FLOW_COMMAND Phase_Run(void)
 
     while (1) {
         control = M_Control(nframes);
+        FrameStats_Mark(FRAME_STATS_CONTROL);
 
         if (m_PhaseToSet != PHASE_NULL) {
             if (control.action != PHASE_ACTION_NO_WAIT) {
@@ -161,6 +183,8 @@ GAME_FLOW_COMMAND Phase_Run(void)
             Interpolation_SetRate(1.0);
             M_Draw();
             nframes = M_Wait();
+            Profiler_EndFrame();
+            FrameStats_EndFrame();
         }
     }
 
@@ -28,7 +28,9 @@
 #include <libtrx/config.h>
 #include <libtrx/debug.h>
 #include <libtrx/game/fader.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/memory.h>
+#include <libtrx/profiler.h>
 #include <libtrx/utils.h>
 
 #include <stdbool.h>
@@ -181,6 +183,7 @@ static void M_PrepareConfig(void)
     g_Config.gameplay.enable_wading = false;
     g_Config.gameplay.target_mode = TLM_FULL;
     g_Config.gameplay.fix_bear_ai = false;
+    g_Config.gameplay.enable_shared_pathfinding = false;
 }
 
 static void M_RestoreConfig(void)
@@ -248,6 +251,7 @@ static void M_Start(const PHASE_DEMO_ARGS *const args)
         Shell_ExitSystem("Unable to initialize level");
     }
     g_GameInfo.current_level_type = GFL_DEMO;
+    Headless_LoadInput(g_DemoData, DEMO_COUNT_MAX);
 
     g_OverlayFlag = 1;
     Camera_Initialise();
@@ -311,17 +315,18 @@ static PHASE_CONTROL M_ControlRun(int32_t nframes)
         }
         Game_ProcessInput();
 
-        Item_Control();
-        Effect_Control();
+        PROFILER_CALL("Items", Item_Control());
+        PROFILER_CALL("Effects", Effect_Control());
 
-        Lara_Control();
+        PROFILER_CALL("Lara", Lara_Control());
         Lara_Hair_Control();
 
-        Camera_Update();
+        PROFILER_CALL("Camera", Camera_Update());
         Sound_ResetAmbient();
         ItemAction_RunActive();
         Sound_UpdateEffects();
         Overlay_BarHealthTimerTick();
+        Headless_TraceFrame();
 
         // Discard demo input; check for debounced real keypresses
         Input_Update();
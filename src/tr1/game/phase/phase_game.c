@@ -23,6 +23,7 @@
 #include "global/vars.h"
 
 #include <libtrx/memory.h>
+#include <libtrx/profiler.h>
 #include <libtrx/utils.h>
 
 #include <stdbool.h>
@@ -147,13 +148,13 @@ static PHASE_CONTROL M_Control(int32_t nframes)
             }
             return (PHASE_CONTROL) { .action = PHASE_ACTION_NO_WAIT };
         } else {
-            Item_Control();
-            Effect_Control();
+            PROFILER_CALL("Items", Item_Control());
+            PROFILER_CALL("Effects", Effect_Control());
 
-            Lara_Control();
+            PROFILER_CALL("Lara", Lara_Control());
             Lara_Hair_Control();
 
-            Camera_Update();
+            PROFILER_CALL("Camera", Camera_Update());
             Sound_ResetAmbient();
             ItemAction_RunActive();
             Sound_UpdateEffects();
@@ -1,5 +1,6 @@
 #include "game/room.h"
 
+#include "game/box.h"
 #include "game/camera.h"
 #include "game/items.h"
 #include "game/lara/misc.h"
@@ -14,6 +15,7 @@
 #include "global/const.h"
 #include "global/vars.h"
 
+#include <libtrx/debug.h>
 #include <libtrx/game/gamebuf.h>
 #include <libtrx/utils.h>
 
@@ -24,6 +26,23 @@ int32_t g_FlipEffect = -1;
 int32_t g_FlipStatus = 0;
 int32_t g_FlipMapTable[MAX_FLIP_MAPS] = {};
 
+#define MAX_INDEX_CELLS 64
+
+// Uniform grid over the XZ extents of the rooms, so that looking up a room
+// by position only tests the rooms overlapping a single cell. Each cell
+// lists its rooms in ascending order, which keeps the lowest matching room
+// number the result when rooms overlap.
+static struct {
+    int32_t min_x;
+    int32_t min_z;
+    int32_t shift;
+    int32_t size_x;
+    int32_t size_z;
+    int32_t *cell_starts;
+    int16_t *rooms;
+    int32_t room_entry_count;
+} m_Index = {};
+
 static void M_TriggerMusicTrack(int16_t track, const TRIGGER *const trigger);
 static void M_AddFlipItems(ROOM *r);
 static void M_RemoveFlipItems(ROOM *r);
@@ -34,6 +53,11 @@ static int16_t M_GetCeilingTiltHeight(
     const SECTOR *sector, const int32_t x, const int32_t z);
 static SECTOR *M_GetSkySector(const SECTOR *sector, int32_t x, int32_t z);
 static bool M_TestLava(const ITEM *const item);
+static bool M_GetIndexExtents(
+    const ROOM *room, int32_t *x1, int32_t *z1, int32_t *x2, int32_t *z2);
+static bool M_IsInside(const ROOM *room, int32_t x, int32_t y, int32_t z);
+static int32_t M_GetIndexCell(int32_t x, int32_t z);
+static void M_FillIndex(void);
 
 static void M_TriggerMusicTrack(int16_t track, const TRIGGER *const trigger)
 {
@@ -165,6 +189,97 @@ static void M_RemoveFlipItems(ROOM *r)
     }
 }
 
+static bool M_GetIndexExtents(
+    const ROOM *const room, int32_t *const x1, int32_t *const z1,
+    int32_t *const x2, int32_t *const z2)
+{
+    // Same bounds as M_IsInside, with the upper ones exclusive.
+    *x1 = room->pos.x + WALL_L;
+    *x2 = room->pos.x + (room->size.x << WALL_SHIFT) - WALL_L;
+    *z1 = room->pos.z + WALL_L;
+    *z2 = room->pos.z + (room->size.z << WALL_SHIFT) - WALL_L;
+    return *x1 < *x2 && *z1 < *z2;
+}
+
+static bool M_IsInside(
+    const ROOM *const room, const int32_t x, const int32_t y, const int32_t z)
+{
+    int32_t x1;
+    int32_t z1;
+    int32_t x2;
+    int32_t z2;
+    M_GetIndexExtents(room, &x1, &z1, &x2, &z2);
+    return x >= x1 && x < x2 && y >= room->max_ceiling && y <= room->min_floor
+        && z >= z1 && z < z2;
+}
+
+static int32_t M_GetIndexCell(const int32_t x, const int32_t z)
+{
+    if (x < m_Index.min_x || z < m_Index.min_z) {
+        return -1;
+    }
+    const int32_t cell_x = (x - m_Index.min_x) >> m_Index.shift;
+    const int32_t cell_z = (z - m_Index.min_z) >> m_Index.shift;
+    if (cell_x >= m_Index.size_x || cell_z >= m_Index.size_z) {
+        return -1;
+    }
+    return cell_z * m_Index.size_x + cell_x;
+}
+
+static void M_FillIndex(void)
+{
+    const int32_t cell_count = m_Index.size_x * m_Index.size_z;
+    for (int32_t i = 0; i <= cell_count; i++) {
+        m_Index.cell_starts[i] = 0;
+    }
+
+    // Count the rooms per cell, then turn the counts into cell ends and
+    // fill the cells back to front.
+    for (int32_t pass = 0; pass < 2; pass++) {
+        for (int32_t i = 0; i < g_RoomCount; i++) {
+            const int16_t room_num = pass == 0 ? i : g_RoomCount - 1 - i;
+            int32_t x1;
+            int32_t z1;
+            int32_t x2;
+            int32_t z2;
+            if (!M_GetIndexExtents(
+                    &g_RoomInfo[room_num], &x1, &z1, &x2, &z2)) {
+                continue;
+            }
+            const int32_t cx1 = (x1 - m_Index.min_x) >> m_Index.shift;
+            const int32_t cz1 = (z1 - m_Index.min_z) >> m_Index.shift;
+            const int32_t cx2 = (x2 - 1 - m_Index.min_x) >> m_Index.shift;
+            const int32_t cz2 = (z2 - 1 - m_Index.min_z) >> m_Index.shift;
+            for (int32_t cz = cz1; cz <= cz2; cz++) {
+                for (int32_t cx = cx1; cx <= cx2; cx++) {
+                    const int32_t cell = cz * m_Index.size_x + cx;
+                    if (pass == 0) {
+                        m_Index.cell_starts[cell]++;
+                    } else {
+                        m_Index.rooms[--m_Index.cell_starts[cell]] = room_num;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            int32_t total = 0;
+            for (int32_t i = 0; i < cell_count; i++) {
+                total += m_Index.cell_starts[i];
+                m_Index.cell_starts[i] = total;
+            }
+            m_Index.cell_starts[cell_count] = total;
+            if (m_Index.rooms == NULL) {
+                m_Index.room_entry_count = total;
+                m_Index.rooms = GameBuf_Alloc(
+                    MAX(total, 1) * sizeof(int16_t), GBUF_ROOMS);
+            }
+            // Flipping swaps rooms around, so the entry count never changes.
+            ASSERT(total == m_Index.room_entry_count);
+        }
+    }
+}
+
 int16_t Room_GetTiltType(const SECTOR *sector, int32_t x, int32_t y, int32_t z)
 {
     sector = Room_GetPitSector(sector, x, z);
@@ -504,23 +619,70 @@ int16_t Room_GetWaterHeight(int32_t x, int32_t y, int32_t z, int16_t room_num)
     }
 }
 
+void Room_BuildIndex(void)
+{
+    int32_t min_x = INT32_MAX;
+    int32_t min_z = INT32_MAX;
+    int32_t max_x = INT32_MIN;
+    int32_t max_z = INT32_MIN;
+    for (int32_t i = 0; i < g_RoomCount; i++) {
+        int32_t x1;
+        int32_t z1;
+        int32_t x2;
+        int32_t z2;
+        if (M_GetIndexExtents(&g_RoomInfo[i], &x1, &z1, &x2, &z2)) {
+            min_x = MIN(min_x, x1);
+            min_z = MIN(min_z, z1);
+            max_x = MAX(max_x, x2);
+            max_z = MAX(max_z, z2);
+        }
+    }
+    if (min_x > max_x) {
+        min_x = max_x = 0;
+        min_z = max_z = 0;
+    }
+
+    m_Index.min_x = min_x;
+    m_Index.min_z = min_z;
+    m_Index.shift = WALL_SHIFT;
+    while (((max_x - min_x) >> m_Index.shift) >= MAX_INDEX_CELLS
+           || ((max_z - min_z) >> m_Index.shift) >= MAX_INDEX_CELLS) {
+        m_Index.shift++;
+    }
+    m_Index.size_x = ((max_x - min_x) >> m_Index.shift) + 1;
+    m_Index.size_z = ((max_z - min_z) >> m_Index.shift) + 1;
+    m_Index.cell_starts = GameBuf_Alloc(
+        (m_Index.size_x * m_Index.size_z + 1) * sizeof(int32_t), GBUF_ROOMS);
+    m_Index.rooms = NULL;
+    M_FillIndex();
+}
+
 int16_t Room_GetIndexFromPos(const int32_t x, const int32_t y, const int32_t z)
 {
-    for (int i = 0; i < g_RoomCount; i++) {
-        const ROOM *const room = &g_RoomInfo[i];
-        const int32_t x1 = room->pos.x + WALL_L;
-        const int32_t x2 = room->pos.x + (room->size.x << WALL_SHIFT) - WALL_L;
-        const int32_t y1 = room->max_ceiling;
-        const int32_t y2 = room->min_floor;
-        const int32_t z1 = room->pos.z + WALL_L;
-        const int32_t z2 = room->pos.z + (room->size.z << WALL_SHIFT) - WALL_L;
-        if (x >= x1 && x < x2 && y >= y1 && y <= y2 && z >= z1 && z < z2) {
-            return i;
+    const int32_t cell = M_GetIndexCell(x, z);
+    if (cell == -1) {
+        return NO_ROOM;
+    }
+    for (int32_t i = m_Index.cell_starts[cell];
+         i < m_Index.cell_starts[cell + 1]; i++) {
+        const int16_t room_num = m_Index.rooms[i];
+        if (M_IsInside(&g_RoomInfo[room_num], x, y, z)) {
+            return room_num;
         }
     }
     return NO_ROOM;
 }
 
+void Room_GetIndicesFromPos(
+    const XYZ_32 *const positions, int16_t *const room_nums,
+    const int32_t count)
+{
+    for (int32_t i = 0; i < count; i++) {
+        room_nums[i] = Room_GetIndexFromPos(
+            positions[i].x, positions[i].y, positions[i].z);
+    }
+}
+
 BOUNDS_32 Room_GetWorldBounds(void)
 {
     BOUNDS_32 bounds = {
@@ -591,11 +753,7 @@ void Room_AlterFloorHeight(ITEM *item, int32_t height)
     }
 
     if (g_Boxes[sector->box].overlap_index & BLOCKABLE) {
-        if (height < 0) {
-            g_Boxes[sector->box].overlap_index |= BLOCKED;
-        } else {
-            g_Boxes[sector->box].overlap_index &= ~BLOCKED;
-        }
+        Box_SetBlocked(sector->box, height < 0);
     }
 }
 
@@ -631,6 +789,7 @@ void Room_FlipMap(void)
         M_AddFlipItems(r);
     }
 
+    M_FillIndex();
     g_FlipStatus = !g_FlipStatus;
 }
 
@@ -23,7 +23,11 @@ SECTOR *Room_GetPitSector(const SECTOR *sector, int32_t x, int32_t z);
 int16_t Room_GetCeiling(const SECTOR *sector, int32_t x, int32_t y, int32_t z);
 int16_t Room_GetHeight(const SECTOR *sector, int32_t x, int32_t y, int32_t z);
 int16_t Room_GetWaterHeight(int32_t x, int32_t y, int32_t z, int16_t room_num);
+// Must be called once the rooms are final, after the injections.
+void Room_BuildIndex(void);
 int16_t Room_GetIndexFromPos(int32_t x, int32_t y, int32_t z);
+void Room_GetIndicesFromPos(
+    const XYZ_32 *positions, int16_t *room_nums, int32_t count);
 BOUNDS_32 Room_GetWorldBounds(void);
 
 void Room_AlterFloorHeight(ITEM *item, int32_t height);
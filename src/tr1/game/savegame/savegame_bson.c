@@ -185,9 +185,7 @@ static JSON_VALUE *M_ParseFromBuffer(
         return NULL;
     }
 
-    JSON_VALUE *root = BSON_Parse(uncompressed, uncompressed_size);
-    Memory_FreePointer(&uncompressed);
-    return root;
+    return BSON_ParseInPlace(uncompressed, uncompressed_size, NULL);
 }
 
 static JSON_VALUE *M_ParseFromFile(MYFILE *fp, int32_t *version_out)
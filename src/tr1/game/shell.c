@@ -23,19 +23,24 @@
 #include "specific/s_shell.h"
 
 #include <libtrx/config.h>
+#include <libtrx/engine/audio.h>
 #include <libtrx/enum_map.h>
 #include <libtrx/filesystem.h>
+#include <libtrx/game/frame_stats.h>
 #include <libtrx/game/gamebuf.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/ui/common.h>
+#include <libtrx/jobs.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/scratch.h>
 
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-#define GAMEBUF_MEM_CAP 0x8000000
+#define GAMEBUF_CHUNK_SIZE 0x1000000
 #define LEVEL_TITLE_SIZE 25
 #define TIMESTAMP_SIZE 20
 
@@ -61,6 +66,9 @@ static void M_HandleConfigChange(const EVENT *const event, void *const data)
     if (CHANGED(audio.music_volume)) {
         Music_SetVolume(g_Config.audio.music_volume);
     }
+    if (CHANGED(audio.sample_interpolation)) {
+        Audio_Sample_SetInterpolation(g_Config.audio.sample_interpolation);
+    }
 
     if (CHANGED(gameplay.maximum_save_slots) && Savegame_IsInitialised()) {
         Savegame_Shutdown();
@@ -78,6 +86,7 @@ static void M_LoadConfig(void)
 
     Sound_SetMasterVolume(g_Config.audio.sound_volume);
     Music_SetVolume(g_Config.audio.music_volume);
+    Audio_Sample_SetInterpolation(g_Config.audio.sample_interpolation);
 }
 
 void Shell_Init(const char *gameflow_path)
@@ -111,13 +120,20 @@ void Shell_Init(const char *gameflow_path)
     Savegame_Init();
     Savegame_ScanSavedGames();
     Savegame_HighlightNewestSlot();
-    GameBuf_Init(GAMEBUF_MEM_CAP);
+    GameBuf_Init(GAMEBUF_CHUNK_SIZE);
+    Scratch_Init();
+    Jobs_Init();
     Console_Init();
+    FrameStats_Init();
 }
 
 void Shell_Shutdown(void)
 {
+    Headless_Shutdown();
+    FrameStats_Shutdown();
     Console_Shutdown();
+    Jobs_Shutdown();
+    Scratch_Shutdown();
     GameBuf_Shutdown();
     Savegame_Shutdown();
     GameFlow_Shutdown();
@@ -157,6 +173,7 @@ void Shell_Main(void)
             m_CurrentGameFlowPath = m_TR1XGameFlowDemoPath;
         }
     }
+    Headless_ParseArgs(arg_count, args);
     for (int i = 0; i < arg_count; i++) {
         Memory_FreePointer(&args[i]);
     }
@@ -169,6 +186,12 @@ void Shell_Main(void)
     Shell_Init(m_CurrentGameFlowPath);
 
     GAME_FLOW_COMMAND command = { .action = GF_EXIT_TO_TITLE };
+    if (Headless_IsEnabled()) {
+        command = (GAME_FLOW_COMMAND) {
+            .action = GF_START_DEMO,
+            .param = Headless_GetDemoNum(),
+        };
+    }
     bool intro_played = false;
 
     g_GameInfo.current_save_slot = -1;
@@ -230,6 +253,10 @@ void Shell_Main(void)
             break;
 
         case GF_EXIT_TO_TITLE:
+            if (Headless_IsEnabled()) {
+                loop_continue = false;
+                break;
+            }
             g_GameInfo.current_save_slot = -1;
             if (!intro_played) {
                 GameFlow_InterpretSequence(
@@ -8,6 +8,7 @@
 
 #include <libtrx/config.h>
 #include <libtrx/engine/audio.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/math.h>
 #include <libtrx/utils.h>
 
@@ -208,12 +209,20 @@ bool Sound_Init(void)
 
     m_MasterVolume = 32;
     m_MasterVolumeDefault = 32;
+    if (Headless_IsEnabled()) {
+        // Leave the audio device closed, which turns all sample and stream
+        // calls into no-ops.
+        return false;
+    }
     m_SoundIsActive = Audio_Init();
     return m_SoundIsActive;
 }
 
 void Sound_Shutdown(void)
 {
+    if (Headless_IsEnabled()) {
+        return;
+    }
     Audio_Shutdown();
 }
 
@@ -11,6 +11,7 @@
 #include <libtrx/debug.h>
 #include <libtrx/gfx/context.h>
 #include <libtrx/log.h>
+#include <libtrx/memory.h>
 
 #include <stddef.h>
 #include <string.h>
@@ -1272,6 +1273,67 @@ void S_Output_DownloadTextures(int32_t pages)
     m_EnvMapTexture = GFX_3D_Renderer_RegisterEnvironmentMap(m_Renderer3D);
 }
 
+bool S_Output_IsRoomGeometrySupported(void)
+{
+    return GFX_3D_Renderer_IsRoomGeometrySupported(m_Renderer3D);
+}
+
+void S_Output_UploadRoomGeometry(
+    const GFX_3D_ROOM_VERTEX *const vertices, const int32_t vertex_count,
+    const uint32_t *const indices, const int32_t index_count)
+{
+    GFX_3D_Renderer_UploadRoomGeometry(
+        m_Renderer3D, vertices, vertex_count, indices, index_count);
+}
+
+void S_Output_UploadRoomTextures(
+    const PHD_TEXTURE *const textures, const int32_t count)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    GFX_3D_ROOM_TEXTURE *const room_textures =
+        Memory_Alloc(count * sizeof(GFX_3D_ROOM_TEXTURE));
+    for (int32_t i = 0; i < count; i++) {
+        const PHD_TEXTURE *const texture = &textures[i];
+        GFX_3D_ROOM_TEXTURE *const room_texture = &room_textures[i];
+        room_texture->layer = m_TextureMap[texture->tpage];
+        for (int32_t j = 0; j < 4; j++) {
+            room_texture->uv[j][0] = texture->uv[j].u;
+            room_texture->uv[j][1] = texture->uv[j].v;
+        }
+    }
+    GFX_3D_Renderer_UploadRoomTextures(m_Renderer3D, room_textures, count);
+    Memory_Free(room_textures);
+}
+
+void S_Output_SetRoomTables(
+    const int32_t *const wibble_table, const int32_t *const shade_table)
+{
+    GFX_3D_Renderer_SetRoomTables(m_Renderer3D, wibble_table, shade_table);
+}
+
+void S_Output_DrawRoomGeometry(
+    GFX_3D_ROOM_PARAMS *const params, const int32_t first_index,
+    const int32_t index_count, const int32_t vertex_count)
+{
+    // Fill in the parts that S_Output_DrawTexturedTriangle takes care of in
+    // the software path.
+    params->res_z = g_FltResZ;
+    params->res_z_buf = g_FltResZBuf;
+    params->brightness = g_Config.visuals.brightness / 16.0f;
+    params->tint[0] = 1.0f;
+    params->tint[1] = 1.0f;
+    params->tint[2] = 1.0f;
+    Output_ApplyTint(&params->tint[0], &params->tint[1], &params->tint[2]);
+    params->pretty_pixels = g_Config.rendering.pretty_pixels
+        && g_Config.rendering.texture_filter == GFX_TF_NN;
+
+    GFX_3D_Renderer_DrawRoomGeometry(
+        m_Renderer3D, params, first_index, index_count, vertex_count);
+}
+
 void S_Output_ScreenBox(
     int32_t sx, int32_t sy, int32_t w, int32_t h, RGBA_8888 col_dark,
     RGBA_8888 col_light, float thickness)
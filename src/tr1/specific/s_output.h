@@ -3,6 +3,7 @@
 #include "global/types.h"
 
 #include <libtrx/engine/image.h>
+#include <libtrx/gfx/3d/room_renderer.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -26,6 +27,17 @@ void S_Output_SetWindowSize(int width, int height);
 void S_Output_ApplyRenderSettings(void);
 
 void S_Output_DownloadTextures(int32_t pages);
+
+bool S_Output_IsRoomGeometrySupported(void);
+void S_Output_UploadRoomGeometry(
+    const GFX_3D_ROOM_VERTEX *vertices, int32_t vertex_count,
+    const uint32_t *indices, int32_t index_count);
+void S_Output_UploadRoomTextures(const PHD_TEXTURE *textures, int32_t count);
+void S_Output_SetRoomTables(
+    const int32_t *wibble_table, const int32_t *shade_table);
+void S_Output_DrawRoomGeometry(
+    GFX_3D_ROOM_PARAMS *params, int32_t first_index, int32_t index_count,
+    int32_t vertex_count);
 void S_Output_SelectTexture(int32_t texture_num);
 void S_Output_DownloadBackdropSurface(const IMAGE *image);
 void S_Output_DrawBackdropSurface(void);
@@ -9,7 +9,9 @@
 #include "game/sound.h"
 
 #include <libtrx/config.h>
+#include <libtrx/engine/audio.h>
 #include <libtrx/filesystem.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/ui/common.h>
 #include <libtrx/gfx/common.h>
 #include <libtrx/gfx/context.h>
@@ -141,7 +143,9 @@ void S_Shell_Init(void)
     M_SetWindowPos(g_Config.window.x, g_Config.window.y, true);
     M_SetWindowSize(g_Config.window.width, g_Config.window.height, true);
     M_SetWindowMaximized(g_Config.window.is_maximized, true);
-    SDL_ShowWindow(m_Window);
+    if (!Headless_IsEnabled()) {
+        SDL_ShowWindow(m_Window);
+    }
 }
 
 void Shell_ProcessEvents(void)
@@ -218,6 +222,8 @@ void Shell_ProcessEvents(void)
             break;
         }
     }
+
+    Audio_Stream_ProcessFinished();
 }
 
 int main(int argc, char **argv)
@@ -0,0 +1,47 @@
+#include "game/console/cmd/sort_bench.h"
+
+#include "game/game_string.h"
+#include "game/render/common.h"
+
+#include <libtrx/strings.h>
+
+#include <SDL2/SDL_timer.h>
+
+#define DEFAULT_ITERATIONS 1000
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    int32_t iterations = DEFAULT_ITERATIONS;
+    if (!String_IsEmpty(ctx->args)
+        && (!String_ParseInteger(ctx->args, &iterations) || iterations <= 0)) {
+        return CR_BAD_INVOCATION;
+    }
+
+    const int32_t count = Render_GetSortCaptureCount();
+    if (count < 0) {
+        Render_RequestSortCapture();
+        Console_Log(GS(OSD_SORT_BENCH_CAPTURING));
+        return CR_SUCCESS;
+    }
+
+    const Uint64 start = SDL_GetPerformanceCounter();
+    for (int32_t i = 0; i < iterations; i++) {
+        Render_ReplaySortCapture();
+    }
+    const Uint64 end = SDL_GetPerformanceCounter();
+
+    const double usec = (double)(end - start) * 1000000.0
+        / SDL_GetPerformanceFrequency() / iterations;
+    Console_Log(GS(OSD_SORT_BENCH_RESULT), count, iterations, usec);
+
+    // Use a fresh poly list for the next run.
+    Render_RequestSortCapture();
+    return CR_SUCCESS;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_SortBench = {
+    .prefix = "sortbench",
+    .proc = M_Entrypoint,
+};
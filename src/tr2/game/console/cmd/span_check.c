@@ -0,0 +1,38 @@
+#include "game/console/cmd/span_check.h"
+
+#include "game/game_string.h"
+#include "game/render/swr.h"
+
+#include <libtrx/config.h>
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *ctx);
+
+static COMMAND_RESULT M_Entrypoint(const COMMAND_CONTEXT *const ctx)
+{
+    if (g_Config.rendering.render_mode != RM_SOFTWARE) {
+        return CR_UNAVAILABLE;
+    }
+
+    int32_t pixel_count;
+    int32_t poly_count;
+    int32_t mismatch_count;
+    double reference_msec;
+    double current_msec;
+    if (!Renderer_SW_GetSpanCheckResult(
+            &pixel_count, &poly_count, &mismatch_count, &reference_msec,
+            &current_msec)) {
+        Renderer_SW_RequestSpanCheck();
+        Console_Log(GS(OSD_SPAN_CHECK_CAPTURING));
+        return CR_SUCCESS;
+    }
+
+    Console_Log(
+        GS(OSD_SPAN_CHECK_RESULT), poly_count, pixel_count, mismatch_count,
+        reference_msec, current_msec);
+    return CR_SUCCESS;
+}
+
+CONSOLE_COMMAND g_Console_Cmd_SpanCheck = {
+    .prefix = "spancheck",
+    .proc = M_Entrypoint,
+};
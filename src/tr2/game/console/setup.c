@@ -1,5 +1,10 @@
 #include "game/console/setup.h"
 
+#include "game/console/cmd/sort_bench.h"
+#if defined(TR2X_SPAN_CHECK)
+    #include "game/console/cmd/span_check.h"
+#endif
+
 #include <libtrx/game/console/cmd/config.h>
 #include <libtrx/game/console/cmd/die.h>
 #include <libtrx/game/console/cmd/end_level.h>
@@ -11,9 +16,12 @@
 #include <libtrx/game/console/cmd/heal.h>
 #include <libtrx/game/console/cmd/kill.h>
 #include <libtrx/game/console/cmd/load_game.h>
+#include <libtrx/game/console/cmd/mem.h>
+#include <libtrx/game/console/cmd/perf.h>
 #include <libtrx/game/console/cmd/play_demo.h>
 #include <libtrx/game/console/cmd/play_level.h>
 #include <libtrx/game/console/cmd/pos.h>
+#include <libtrx/game/console/cmd/profile.h>
 #include <libtrx/game/console/cmd/save_game.h>
 #include <libtrx/game/console/cmd/set_health.h>
 #include <libtrx/game/console/cmd/sfx.h>
@@ -43,6 +51,13 @@ CONSOLE_COMMAND *g_ConsoleCommands[] = {
     &g_Console_Cmd_SetHealth,
     &g_Console_Cmd_GiveItem,
     &g_Console_Cmd_SFX,
+    &g_Console_Cmd_Mem,
+    &g_Console_Cmd_Profile,
+    &g_Console_Cmd_Perf,
+    &g_Console_Cmd_SortBench,
+#if defined(TR2X_SPAN_CHECK)
+    &g_Console_Cmd_SpanCheck,
+#endif
     // clang-format on
     NULL,
 };
@@ -9,6 +9,7 @@ void Effect_Control(void);
 EFFECT *Effect_Get(int16_t effect_num);
 int16_t Effect_GetNum(const EFFECT *effect);
 int16_t Effect_GetActiveNum(void);
+int32_t Effect_GetActiveCount(void);
 int16_t Effect_Create(int16_t room_num);
 void Effect_Kill(int16_t effect_num);
 void Effect_NewRoom(int16_t effect_num, int16_t room_num);
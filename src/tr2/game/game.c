@@ -22,7 +22,9 @@
 #include "game/stats.h"
 #include "global/vars.h"
 
+#include <libtrx/game/headless.h>
 #include <libtrx/log.h>
+#include <libtrx/profiler.h>
 #include <libtrx/utils.h>
 
 static GAME_FLOW_COMMAND M_Control(bool demo_mode);
@@ -116,11 +118,11 @@ static GAME_FLOW_COMMAND M_Control(const bool demo_mode)
 
     g_DynamicLightCount = 0;
 
-    Item_Control();
-    Effect_Control();
-    Lara_Control(false);
+    PROFILER_CALL("Items", Item_Control());
+    PROFILER_CALL("Effects", Effect_Control());
+    PROFILER_CALL("Lara", Lara_Control(false));
     Lara_Hair_Control(false);
-    Camera_Update();
+    PROFILER_CALL("Camera", Camera_Update());
     Sound_UpdateEffects();
     Sound_EndScene();
     ItemAction_RunActive();
@@ -138,6 +140,7 @@ GAME_FLOW_COMMAND Game_Control(const int32_t num_frames, const bool demo_mode)
     GAME_FLOW_COMMAND gf_cmd = { .action = GF_NOOP };
     for (int32_t i = 0; i < num_frames; i++) {
         gf_cmd = M_Control(demo_mode);
+        Headless_TraceFrame();
         if (gf_cmd.action != GF_NOOP) {
             break;
         }
@@ -152,8 +155,8 @@ GAME_FLOW_COMMAND Game_Control(const int32_t num_frames, const bool demo_mode)
 
 void Game_Draw(bool draw_overlay)
 {
-    Room_DrawAllRooms(g_Camera.pos.room_num);
-    Output_DrawPolyList();
+    PROFILER_CALL("Rooms", Room_DrawAllRooms(g_Camera.pos.room_num));
+    PROFILER_CALL("PolyList", Output_DrawPolyList());
     if (draw_overlay) {
         Overlay_DrawGameInfo(true);
         Output_DrawPolyList();
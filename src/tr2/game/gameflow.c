@@ -20,6 +20,7 @@
 #include <libtrx/benchmark.h>
 #include <libtrx/config.h>
 #include <libtrx/filesystem.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/objects/names.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
@@ -361,6 +362,10 @@ bool GF_LoadScriptFile(const char *const fname)
 bool GF_DoFrontendSequence(void)
 {
     GF_N_LoadStrings(-1);
+    if (Headless_IsEnabled()) {
+        // Skip the intro videos.
+        return false;
+    }
     const GAME_FLOW_COMMAND gf_cmd =
         GF_InterpretSequence(m_FrontendSequence, GFL_NORMAL);
     return gf_cmd.action == GF_EXIT_GAME;
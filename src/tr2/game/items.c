@@ -87,6 +87,17 @@ int32_t Item_GetTotalCount(void)
     return m_MaxUsedItemCount;
 }
 
+int32_t Item_GetActiveCount(void)
+{
+    int32_t count = 0;
+    int16_t item_num = g_NextItemActive;
+    while (item_num != NO_ITEM) {
+        count++;
+        item_num = g_Items[item_num].next_active;
+    }
+    return count;
+}
+
 int16_t Item_Create(void)
 {
     const int16_t item_num = m_NextItemFree;
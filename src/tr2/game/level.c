@@ -20,12 +20,32 @@
 #include <libtrx/filesystem.h>
 #include <libtrx/game/gamebuf.h>
 #include <libtrx/game/level.h>
+#include <libtrx/jobs.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/scratch.h>
+#include <libtrx/utils.h>
 
-static int16_t *m_FloorData = NULL;
+#include <string.h>
 
-static void M_LoadFromFile(const char *file_name, int32_t level_num);
+#define SAMPLE_HEADER_SIZE 0x2C
+
+typedef struct {
+    size_t offset;
+    size_t size;
+} SAMPLE_FILE_ENTRY;
+
+// Byte ranges of every WAV in main.sfx, built once per process.
+static struct {
+    char *path;
+    size_t file_size;
+    int32_t count;
+    SAMPLE_FILE_ENTRY *entries;
+} m_SampleIndex = {};
+
+static const int16_t *m_FloorData = NULL;
+
+static void M_LoadFromFile(VFILE *file, int32_t level_num);
 static void M_LoadRooms(VFILE *file);
 static void M_LoadMeshBase(VFILE *file);
 static void M_LoadMeshes(VFILE *file);
@@ -46,6 +66,8 @@ static void M_LoadBoxes(VFILE *file);
 static void M_LoadAnimatedTextures(VFILE *file);
 static void M_LoadCinematic(VFILE *file);
 static void M_LoadDemo(VFILE *file);
+static bool M_IndexSampleFile(const char *path, const VFILE *file);
+static void M_DecodeSampleJob(void *arg);
 static void M_LoadSamples(VFILE *file);
 static void M_CompleteSetup(void);
 
@@ -189,12 +211,10 @@ static void M_LoadRooms(VFILE *const file)
         r->effect_num = NO_EFFECT;
     }
 
-    // TODO: store this temporarily in a m_LevelInfo property similar to TR1 and
-    // release after parsing.
+    // The raw floor data is only needed until it is parsed into sectors in
+    // M_CompleteSetup, so read it straight from the level file.
     const int32_t floor_data_size = VFile_ReadS32(file);
-    m_FloorData =
-        GameBuf_Alloc(sizeof(int16_t) * floor_data_size, GBUF_FLOOR_DATA);
-    VFile_Read(file, m_FloorData, sizeof(int16_t) * floor_data_size);
+    m_FloorData = VFile_ViewS16(file, floor_data_size);
 
 finish:
     Benchmark_End(benchmark, NULL);
@@ -215,8 +235,12 @@ static void M_LoadMeshes(VFILE *const file)
     BENCHMARK *const benchmark = Benchmark_Start();
     const int32_t num_mesh_ptrs = VFile_ReadS32(file);
     LOG_INFO("mesh pointers: %d", num_mesh_ptrs);
+
+    // The indices are not necessarily 4-byte aligned in the file, so they
+    // are copied out rather than viewed in place.
+    const SCRATCH_MARK mark = Scratch_Mark();
     int32_t *const mesh_indices =
-        (int32_t *)Memory_Alloc(sizeof(int32_t) * num_mesh_ptrs);
+        Scratch_AllocNoZero(sizeof(int32_t) * num_mesh_ptrs);
     VFile_Read(file, mesh_indices, sizeof(int32_t) * num_mesh_ptrs);
 
     g_Meshes =
@@ -224,8 +248,8 @@ static void M_LoadMeshes(VFILE *const file)
     for (int32_t i = 0; i < num_mesh_ptrs; i++) {
         g_Meshes[i] = &g_MeshBase[mesh_indices[i] / 2];
     }
+    Scratch_Rewind(mark);
 
-    Memory_Free(mesh_indices);
     Benchmark_End(benchmark, NULL);
 }
 
@@ -235,7 +259,7 @@ static int32_t M_LoadAnims(VFILE *const file, int32_t **frame_pointers)
     const int32_t num_anims = VFile_ReadS32(file);
     LOG_INFO("anims: %d", num_anims);
     if (frame_pointers != NULL) {
-        *frame_pointers = Memory_Alloc(sizeof(int32_t) * num_anims);
+        *frame_pointers = Scratch_AllocNoZero(sizeof(int32_t) * num_anims);
     }
     Anim_InitialiseAnims(num_anims);
     Level_ReadAnims(0, num_anims, file, frame_pointers);
@@ -664,10 +688,65 @@ static void M_LoadDemo(VFILE *const file)
     Benchmark_End(benchmark, NULL);
 }
 
+static bool M_IndexSampleFile(const char *const path, const VFILE *const file)
+{
+    if (m_SampleIndex.path != NULL && strcmp(m_SampleIndex.path, path) == 0
+        && m_SampleIndex.file_size == file->size) {
+        return true;
+    }
+
+    BENCHMARK *const benchmark = Benchmark_Start();
+    Memory_FreePointer(&m_SampleIndex.path);
+    Memory_FreePointer(&m_SampleIndex.entries);
+    m_SampleIndex.count = 0;
+
+    int32_t capacity = 0;
+    size_t pos = 0;
+    while (pos + SAMPLE_HEADER_SIZE <= file->size) {
+        const char *const header = file->content + pos;
+        if (*(const int32_t *)(header + 0) != 0x46464952
+            || *(const int32_t *)(header + 8) != 0x45564157
+            || *(const int32_t *)(header + 36) != 0x61746164) {
+            LOG_ERROR(
+                "Unexpected sample header for sample %d",
+                m_SampleIndex.count);
+            break;
+        }
+        const int32_t data_size = *(const int32_t *)(header + 0x28);
+        const int32_t aligned_size = (data_size + 1) & ~1;
+
+        if (m_SampleIndex.count == capacity) {
+            capacity = MAX(capacity * 2, 256);
+            m_SampleIndex.entries = Memory_Realloc(
+                m_SampleIndex.entries, sizeof(SAMPLE_FILE_ENTRY) * capacity);
+        }
+        SAMPLE_FILE_ENTRY *const entry =
+            &m_SampleIndex.entries[m_SampleIndex.count++];
+        entry->offset = pos;
+        entry->size =
+            MIN(SAMPLE_HEADER_SIZE + (size_t)aligned_size, file->size - pos);
+        pos += SAMPLE_HEADER_SIZE + aligned_size;
+    }
+
+    m_SampleIndex.path = Memory_DupStr(path);
+    m_SampleIndex.file_size = file->size;
+    LOG_INFO("Indexed %d samples in %s", m_SampleIndex.count, path);
+    Benchmark_End(benchmark, NULL);
+    return m_SampleIndex.count > 0;
+}
+
+static void M_DecodeSampleJob(void *const arg)
+{
+    const int32_t sample_id = (intptr_t)arg;
+    Audio_Sample_Decode(sample_id);
+}
+
 static void M_LoadSamples(VFILE *const file)
 {
     BENCHMARK *const benchmark = Benchmark_Start();
+    const SCRATCH_MARK mark = Scratch_Mark();
     int32_t *sample_offsets = NULL;
+    VFILE *sfx_file = NULL;
 
     Audio_Sample_CloseAll();
     Audio_Sample_UnloadAll();
@@ -695,85 +774,74 @@ static void M_LoadSamples(VFILE *const file)
         goto finish;
     }
 
-    sample_offsets = Memory_Alloc(sizeof(int32_t) * num_samples);
+    sample_offsets = Scratch_AllocNoZero(sizeof(int32_t) * num_samples);
     VFile_Read(file, sample_offsets, sizeof(int32_t) * num_samples);
 
-    const char *const file_name = "data\\main.sfx";
-    const char *full_path = File_GetFullPath(file_name);
-    LOG_DEBUG("Loading samples from %s", full_path);
-    MYFILE *const fp = File_Open(full_path, FILE_OPEN_READ);
-    Memory_FreePointer(&full_path);
+    if (!g_SoundIsActive) {
+        // There is no audio device to decode the samples for, for example
+        // in headless mode.
+        goto finish;
+    }
 
-    if (fp == NULL) {
+    const char *const file_name = "data\\main.sfx";
+    LOG_DEBUG("Loading samples from %s", file_name);
+    sfx_file = VFile_CreateFromPath(file_name);
+    if (sfx_file == NULL) {
         Shell_ExitSystemFmt("Could not open %s file", file_name);
         goto finish;
     }
 
-    // TODO: refactor these WAVE/RIFF shenanigans
-    int32_t sample_id = 0;
-    for (int32_t i = 0; sample_id < num_samples; i++) {
-        char header[0x2C];
-        File_ReadData(fp, header, 0x2C);
-        if (*(int32_t *)(header + 0) != 0x46464952
-            || *(int32_t *)(header + 8) != 0x45564157
-            || *(int32_t *)(header + 36) != 0x61746164) {
-            LOG_ERROR("Unexpected sample header for sample %d", i);
-            goto finish;
-        }
-        const int32_t data_size = *(int32_t *)(header + 0x28);
-        const int32_t aligned_size = (data_size + 1) & ~1;
+    // The level only refers to the n-th WAV in main.sfx, so look the samples
+    // up in an index of the file rather than walking it every time.
+    if (!M_IndexSampleFile(file_name, sfx_file)) {
+        goto finish;
+    }
 
-        if (sample_offsets[sample_id] != i) {
-            File_Seek(fp, aligned_size, FILE_SEEK_CUR);
-            continue;
+    JOB_GRAPH *const graph = Jobs_CreateGraph();
+    for (int32_t sample_id = 0; sample_id < num_samples; sample_id++) {
+        const int32_t wav_num = sample_offsets[sample_id];
+        if (wav_num < 0 || wav_num >= m_SampleIndex.count) {
+            LOG_ERROR("Invalid sample %d (%d)", sample_id, wav_num);
+            break;
         }
 
-        const size_t sample_data_size = 0x2C + aligned_size;
-        char *sample_data = Memory_Alloc(sample_data_size);
-        memcpy(sample_data, header, 0x2C);
-        File_ReadData(fp, sample_data + 0x2C, aligned_size);
-
-        const bool result =
-            Audio_Sample_LoadSingle(sample_id, sample_data, sample_data_size);
-        Memory_FreePointer(&sample_data);
-
-        if (!result) {
-            goto finish;
+        const SAMPLE_FILE_ENTRY *const entry = &m_SampleIndex.entries[wav_num];
+        if (!Audio_Sample_LoadSingle(
+                sample_id, sfx_file->content + entry->offset, entry->size)) {
+            break;
         }
-
-        sample_id++;
+        Jobs_Add(graph, M_DecodeSampleJob, (void *)(intptr_t)sample_id);
     }
-    File_Close(fp);
+    Jobs_Run(graph);
+    Jobs_FreeGraph(graph);
 
 finish:
-    Memory_FreePointer(&sample_offsets);
+    if (sfx_file != NULL) {
+        VFile_Close(sfx_file);
+    }
+    Scratch_Rewind(mark);
     Benchmark_End(benchmark, NULL);
 }
 
-static void M_LoadFromFile(const char *const file_name, const int32_t level_num)
+static void M_LoadFromFile(VFILE *const file, const int32_t level_num)
 {
     LOG_DEBUG("%s (num=%d)", g_GF_LevelNames[level_num], level_num);
     GameBuf_Reset();
 
     BENCHMARK *const benchmark = Benchmark_Start();
 
-    const char *full_path = File_GetFullPath(file_name);
-    strcpy(g_LevelFileName, full_path);
-    VFILE *const file = VFile_CreateFromPath(full_path);
-    Memory_FreePointer(&full_path);
-
     const int32_t version = VFile_ReadS32(file);
     if (version > 45) {
         Shell_ExitSystemFmt(
             "FATAL: Level %d (%s) requires a new TOMB2.EXE (version %d) to run",
-            level_num, full_path, file_name);
+            level_num, g_LevelFileName, version);
     }
 
     if (version < 45) {
         Shell_ExitSystemFmt(
             "FATAL: Level %d (%s) is OUT OF DATE (version %d). COPY NEW "
             "EDITORS AND REMAKE LEVEL",
-            level_num, full_path, file_name);
+            level_num, g_LevelFileName, version);
     }
 
     M_LoadPalettes(file);
@@ -784,6 +852,7 @@ static void M_LoadFromFile(const char *const file_name, const int32_t level_num)
     M_LoadMeshBase(file);
     M_LoadMeshes(file);
 
+    const SCRATCH_MARK mark = Scratch_Mark();
     int32_t *frame_pointers = NULL;
     const int32_t num_anims = M_LoadAnims(file, &frame_pointers);
     M_LoadAnimChanges(file);
@@ -797,7 +866,7 @@ static void M_LoadFromFile(const char *const file_name, const int32_t level_num)
         // TODO: this is horrible
         anim->frame_ptr = ((int16_t *)g_AnimFrames) + frame_pointers[i] / 2;
     }
-    Memory_FreePointer(&frame_pointers);
+    Scratch_Rewind(mark);
 
     M_LoadObjects(file);
     Object_SetupAllObjects();
@@ -817,7 +886,6 @@ static void M_LoadFromFile(const char *const file_name, const int32_t level_num)
     M_LoadDemo(file);
     M_LoadSamples(file);
 
-    VFile_Close(file);
     Benchmark_End(benchmark, NULL);
 }
 
@@ -827,7 +895,6 @@ static void M_CompleteSetup(void)
 
     // Expand raw floor data into sectors
     Room_ParseFloorData(m_FloorData);
-    // TODO: store raw FD temporarily, release here and eliminate g_FloorData
 
     Inject_AllInjections();
 
@@ -845,16 +912,33 @@ static void M_CompleteSetup(void)
 
 bool Level_Load(const char *const file_name, const int32_t level_num)
 {
+    const char *full_path = File_GetFullPath(file_name);
+    strcpy(g_LevelFileName, full_path);
+    VFILE *const file = VFile_CreateFromPath(full_path);
+    Memory_FreePointer(&full_path);
+    if (file == NULL) {
+        Shell_ExitSystemFmt("Could not open %s", file_name);
+        return false;
+    }
+
     BENCHMARK *const benchmark = Benchmark_Start();
 
     const GAME_FLOW_NEW_LEVEL *const level = &g_GameFlowNew.levels[level_num];
     Inject_Init(level->injections.count, level->injections.data_paths);
 
-    M_LoadFromFile(file_name, level_num);
+    // The level file stays open until the setup is complete, as some of the
+    // data is consumed directly from it rather than being copied.
+    M_LoadFromFile(file, level_num);
     M_CompleteSetup();
 
+    m_FloorData = NULL;
+    VFile_Close(file);
+
     Inject_Cleanup();
 
+    // Give back any memory a big level made the scratch arena grow by.
+    Scratch_Reset();
+
     Benchmark_End(benchmark, NULL);
 
     return true;
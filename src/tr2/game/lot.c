@@ -24,6 +24,11 @@ void LOT_InitialiseArray(void)
     m_SlotsUsed = 0;
 }
 
+int32_t LOT_GetActiveCount(void)
+{
+    return m_SlotsUsed;
+}
+
 void LOT_DisableBaddieAI(const int16_t item_num)
 {
     CREATURE *creature;
@@ -3,6 +3,7 @@
 #include "global/types.h"
 
 void LOT_InitialiseArray(void);
+int32_t LOT_GetActiveCount(void);
 void LOT_DisableBaddieAI(int16_t item_num);
 bool LOT_EnableBaddieAI(int16_t item_num, bool always);
 void LOT_InitialiseSlot(int16_t item_num, int32_t slot);
@@ -13,8 +13,11 @@
 #include <libtrx/config.h>
 #include <libtrx/game/math.h>
 #include <libtrx/log.h>
+#include <libtrx/profiler.h>
 #include <libtrx/utils.h>
 
+#include <math.h>
+
 static int32_t m_TickComp = 0;
 static int32_t m_RoomLightShades[4] = {};
 static ROOM_LIGHT_TABLE m_RoomLightTables[WIBBLE_SIZE] = {};
@@ -22,8 +25,12 @@ static LIGHT m_DynamicLights[MAX_DYNAMIC_LIGHTS] = {};
 static float m_WibbleTable[32];
 static int16_t m_ShadesTable[32];
 static int32_t m_RandomTable[32];
+static int32_t m_VBufZv[MAX_PHD_VBUF];
 
 static int32_t M_CalcFogShade(int32_t depth);
+static uint16_t M_TransformVertices(
+    const int16_t *obj_ptr, int32_t stride, int32_t count, double far_z,
+    int16_t near_clip, int32_t *zv_int);
 
 static const int16_t *M_CalcRoomVerticesWibble(const int16_t *obj_ptr);
 
@@ -196,78 +203,51 @@ void Output_InsertSkybox(const int16_t *obj_ptr)
     }
 }
 
-const int16_t *Output_CalcObjectVertices(const int16_t *obj_ptr)
+static uint16_t M_TransformVertices(
+    const int16_t *const obj_ptr, const int32_t stride, const int32_t count,
+    const double far_z, const int16_t near_clip, int32_t *const zv_int)
 {
-    const double base_z = g_Config.rendering.enable_zbuffer
-        ? 0.0
-        : (g_MidSort << (W2V_SHIFT + 8));
-    uint8_t total_clip = 0xFF;
-
-    obj_ptr++; // skip poly counter
-    const int32_t vtx_count = *obj_ptr++;
-
-    for (int32_t i = 0; i < vtx_count; i++) {
-        PHD_VBUF *const vbuf = &g_PhdVBuf[i];
-
-        // clang-format off
-        const MATRIX *const mptr = g_MatrixPtr;
-        const double xv = (
-            mptr->_00 * obj_ptr[0] +
-            mptr->_01 * obj_ptr[1] +
-            mptr->_02 * obj_ptr[2] +
-            mptr->_03
-        );
-        const double yv = (
-            mptr->_10 * obj_ptr[0] +
-            mptr->_11 * obj_ptr[1] +
-            mptr->_12 * obj_ptr[2] +
-            mptr->_13
-        );
-        double zv = (
-            mptr->_20 * obj_ptr[0] +
-            mptr->_21 * obj_ptr[1] +
-            mptr->_22 * obj_ptr[2] +
-            mptr->_23
-        );
-        // clang-format on
-
-        vbuf->xv = xv;
-        vbuf->yv = yv;
-
-        uint8_t clip_flags;
-        if (zv < g_FltNearZ) {
-            vbuf->zv = zv;
-            clip_flags = 0x80;
-        } else {
-            if (zv >= g_FltFarZ) {
-                vbuf->zv = g_FltFarZ;
-            } else {
-                vbuf->zv = zv + base_z;
-            }
+    const MATH_PROJECTION proj = {
+        .matrix = (const int32_t *)g_MatrixPtr,
+        .persp = g_FltPersp,
+        .center_x = g_FltWinCenterX,
+        .center_y = g_FltWinCenterY,
+        .near_z = g_FltNearZ,
+        .far_z = far_z,
+        .z_bias = g_Config.rendering.enable_zbuffer
+            ? 0.0
+            : (g_MidSort << (W2V_SHIFT + 8)),
+        .rhw_scale = g_FltRhwOPersp,
+        .left = g_FltWinLeft,
+        .top = g_FltWinTop,
+        .right = g_FltWinRight,
+        .bottom = g_FltWinBottom,
+        .near_clip = near_clip,
+    };
 
-            const double persp = g_FltPersp / zv;
-            vbuf->xs = persp * xv + g_FltWinCenterX;
-            vbuf->ys = persp * yv + g_FltWinCenterY;
-            vbuf->rhw = persp * g_FltRhwOPersp;
+    const MATH_VERTEX_OUTPUT output = {
+        .stride = sizeof(PHD_VBUF),
+        .xv = &g_PhdVBuf[0].xv,
+        .yv = &g_PhdVBuf[0].yv,
+        .zv = &g_PhdVBuf[0].zv,
+        .xs = &g_PhdVBuf[0].xs,
+        .ys = &g_PhdVBuf[0].ys,
+        .rhw = &g_PhdVBuf[0].rhw,
+        .clip = &g_PhdVBuf[0].clip,
+        .zv_int = zv_int,
+    };
 
-            clip_flags = 0x00;
-            if (vbuf->xs < g_FltWinLeft) {
-                clip_flags |= 1;
-            } else if (vbuf->xs > g_FltWinRight) {
-                clip_flags |= 2;
-            }
+    return Math_TransformVertices(&proj, obj_ptr, stride, count, &output);
+}
 
-            if (vbuf->ys < g_FltWinTop) {
-                clip_flags |= 4;
-            } else if (vbuf->ys > g_FltWinBottom) {
-                clip_flags |= 8;
-            }
-        }
+const int16_t *Output_CalcObjectVertices(const int16_t *obj_ptr)
+{
+    obj_ptr++; // skip poly counter
+    const int32_t vtx_count = *obj_ptr++;
 
-        vbuf->clip = clip_flags;
-        total_clip &= clip_flags;
-        obj_ptr += 3;
-    }
+    const uint16_t total_clip =
+        M_TransformVertices(obj_ptr, 3, vtx_count, g_FltFarZ, 0x80, NULL);
+    obj_ptr += 3 * vtx_count;
 
     return total_clip == 0 ? obj_ptr : 0;
 }
@@ -344,41 +324,14 @@ const int16_t *Output_CalcVerticeLight(const int16_t *obj_ptr)
 
 const int16_t *Output_CalcRoomVertices(const int16_t *obj_ptr, int32_t far_clip)
 {
-    const double base_z = g_Config.rendering.enable_zbuffer
-        ? 0.0
-        : (g_MidSort << (W2V_SHIFT + 8));
     const int32_t vtx_count = *obj_ptr++;
 
+    M_TransformVertices(
+        obj_ptr, 6, vtx_count, INFINITY, (int16_t)0xFF80, m_VBufZv);
+
     for (int32_t i = 0; i < vtx_count; i++) {
         PHD_VBUF *const vbuf = &g_PhdVBuf[i];
 
-        // clang-format off
-        const MATRIX *const mptr = g_MatrixPtr;
-        const double xv = (
-            mptr->_00 * obj_ptr[0] +
-            mptr->_01 * obj_ptr[1] +
-            mptr->_02 * obj_ptr[2] +
-            mptr->_03
-        );
-        const double yv = (
-            mptr->_10 * obj_ptr[0] +
-            mptr->_11 * obj_ptr[1] +
-            mptr->_12 * obj_ptr[2] +
-            mptr->_13
-        );
-        const int32_t zv_int = (
-            mptr->_20 * obj_ptr[0] +
-            mptr->_21 * obj_ptr[1] +
-            mptr->_22 * obj_ptr[2] +
-            mptr->_23
-        );
-        const double zv = zv_int;
-        // clang-format on
-
-        vbuf->xv = xv;
-        vbuf->yv = yv;
-        vbuf->zv = zv;
-
         int16_t shade = obj_ptr[5];
         if (g_IsWaterEffect) {
             shade += m_ShadesTable
@@ -387,49 +340,21 @@ const int16_t *Output_CalcRoomVertices(const int16_t *obj_ptr, int32_t far_clip)
                  % WIBBLE_SIZE];
         }
 
-        uint16_t clip_flags = 0;
-        if (zv < g_FltNearZ) {
-            clip_flags = 0xFF80;
-        } else {
-            const double persp = g_FltPersp / zv;
-            const int32_t depth = zv_int >> W2V_SHIFT;
-            vbuf->zv += base_z;
-
+        if (vbuf->clip >= 0) {
+            const int32_t depth = m_VBufZv[i] >> W2V_SHIFT;
             if (depth < FOG_END) {
                 if (depth > FOG_START) {
                     shade += depth - FOG_START;
                 }
-                vbuf->rhw = persp * g_FltRhwOPersp;
             } else {
-                // clip_flags = far_clip;
+                // vbuf->clip = far_clip;
                 shade = 0x1FFF;
                 vbuf->zv = g_FltFarZ;
-                vbuf->rhw = persp * g_FltRhwOPersp;
-            }
-
-            double xs = xv * persp + g_FltWinCenterX;
-            double ys = yv * persp + g_FltWinCenterY;
-
-            if (xs < g_FltWinLeft) {
-                clip_flags |= 1;
-            } else if (xs > g_FltWinRight) {
-                clip_flags |= 2;
             }
-
-            if (ys < g_FltWinTop) {
-                clip_flags |= 4;
-            } else if (ys > g_FltWinBottom) {
-                clip_flags |= 8;
-            }
-
-            vbuf->xs = xs;
-            vbuf->ys = ys;
-            // clip_flags |= (~((uint8_t)(vbuf->zv / 0x155555.p0))) << 8;
         }
 
         CLAMP(shade, 0, 0x1FFF);
         vbuf->g = shade;
-        vbuf->clip = clip_flags;
         obj_ptr += 6;
     }
 
@@ -640,7 +565,7 @@ void Output_BeginScene(void)
 
 void Output_EndScene(void)
 {
-    Render_EndScene();
+    PROFILER_CALL("EndScene", Render_EndScene());
     Shell_ProcessEvents();
 }
 
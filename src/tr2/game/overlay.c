@@ -14,6 +14,7 @@
 #include "global/vars.h"
 
 #include <libtrx/config.h>
+#include <libtrx/game/frame_stats.h>
 #include <libtrx/utils.h>
 
 #include <stdio.h>
@@ -158,6 +159,7 @@ void Overlay_DrawGameInfo(const bool pickup_state)
     }
     Overlay_DrawAmmoInfo();
     Overlay_DrawModeInfo();
+    FrameStats_Draw();
     Console_Draw();
     Text_Draw();
 }
@@ -14,10 +14,12 @@
 #include "game/room.h"
 #include "game/sound.h"
 #include "game/stats.h"
+#include "global/const.h"
 #include "global/vars.h"
 
 #include <libtrx/config.h>
 #include <libtrx/game/fader.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
 
@@ -82,6 +84,9 @@ static bool M_LoadLevel(M_PRIV *const p)
     if (!Level_Initialise(p->level_num, GFL_DEMO)) {
         return false;
     }
+    if (Headless_LoadInput(g_DemoPtr, MAX_DEMO_SIZE)) {
+        g_IsDemoLoaded = true;
+    }
 
     g_LevelComplete = false;
     if (!g_IsDemoLoaded) {
@@ -2,6 +2,7 @@
 
 #include "decomp/decomp.h"
 #include "game/render/hwr.h"
+#include "game/render/null.h"
 #include "game/render/priv.h"
 #include "game/render/swr.h"
 #include "game/render/util.h"
@@ -10,6 +11,7 @@
 
 #include <libtrx/config.h>
 #include <libtrx/debug.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/gfx/fade/fade_renderer.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
@@ -17,6 +19,7 @@
 
 static RENDERER m_Renderer_SW = {};
 static RENDERER m_Renderer_HW = {};
+static RENDERER m_Renderer_Null = {};
 static RENDERER *m_PreviousRenderer = NULL;
 static GFX_FADE_RENDERER *m_FadeRenderer = NULL;
 static GFX_2D_RENDERER *m_BackgroundRenderer = NULL;
@@ -36,7 +39,9 @@ static void M_ResetPolyList(void);
 static RENDERER *M_GetRenderer(void)
 {
     RENDERER *r = NULL;
-    if (g_Config.rendering.render_mode == RM_SOFTWARE) {
+    if (Headless_IsEnabled()) {
+        r = &m_Renderer_Null;
+    } else if (g_Config.rendering.render_mode == RM_SOFTWARE) {
         r = &m_Renderer_SW;
     } else if (g_Config.rendering.render_mode == RM_HARDWARE) {
         r = &m_Renderer_HW;
@@ -78,6 +83,7 @@ void Render_Init(void)
     m_BackgroundRenderer = GFX_2D_Renderer_Create();
     Renderer_SW_Prepare(&m_Renderer_SW);
     Renderer_HW_Prepare(&m_Renderer_HW);
+    Renderer_Null_Prepare(&m_Renderer_Null);
 }
 
 void Render_Shutdown(void)
@@ -167,7 +173,8 @@ void Render_LoadBackgroundFromTexture(
     const PHD_TEXTURE *const texture, const int32_t repeat_x,
     const int32_t repeat_y)
 {
-    if (g_TexturePageBuffer16[texture->tex_page] == NULL) {
+    if (Headless_IsEnabled()
+        || g_TexturePageBuffer16[texture->tex_page] == NULL) {
         return;
     }
 
@@ -212,6 +219,10 @@ void Render_LoadBackgroundFromTexture(
 
 void Render_LoadBackgroundFromImage(const IMAGE *const image)
 {
+    if (Headless_IsEnabled()) {
+        return;
+    }
+
     if (m_Background.surface != NULL) {
         GFX_2D_Surface_Free(m_Background.surface);
         m_Background.surface = NULL;
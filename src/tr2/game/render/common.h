@@ -42,6 +42,14 @@ void Render_UnloadBackground(void);
 void Render_DrawBackground(void);
 
 void Render_DrawPolyList(void);
+
+// Keeps a copy of the next unsorted poly list, so that sorting it can be
+// benchmarked.
+void Render_RequestSortCapture(void);
+// Returns -1 if nothing has been captured yet.
+int32_t Render_GetSortCaptureCount(void);
+// Sorts a copy of the captured poly list.
+void Render_ReplaySortCapture(void);
 void Render_DrawBlackRectangle(int32_t opacity);
 
 void Render_ClearZBuffer(void);
@@ -0,0 +1,63 @@
+#include "game/render/null.h"
+
+// The renderer used in headless mode. It keeps no GPU resources: texture
+// pages and palettes are never uploaded, and all primitives are dropped.
+
+static void M_Init(RENDERER *renderer);
+static void M_Shutdown(RENDERER *renderer);
+static void M_Open(RENDERER *renderer);
+static void M_Close(RENDERER *renderer);
+static void M_Reset(RENDERER *renderer, RENDER_RESET_FLAGS flags);
+static void M_BeginScene(RENDERER *renderer);
+static void M_EndScene(RENDERER *renderer);
+static void M_DrawPolyList(RENDERER *renderer);
+
+static void M_Init(RENDERER *const renderer)
+{
+    renderer->initialized = true;
+}
+
+static void M_Shutdown(RENDERER *const renderer)
+{
+    renderer->initialized = false;
+}
+
+static void M_Open(RENDERER *const renderer)
+{
+    renderer->open = true;
+}
+
+static void M_Close(RENDERER *const renderer)
+{
+    renderer->open = false;
+}
+
+static void M_Reset(RENDERER *const renderer, const RENDER_RESET_FLAGS flags)
+{
+}
+
+static void M_BeginScene(RENDERER *const renderer)
+{
+}
+
+static void M_EndScene(RENDERER *const renderer)
+{
+}
+
+static void M_DrawPolyList(RENDERER *const renderer)
+{
+}
+
+void Renderer_Null_Prepare(RENDERER *const renderer)
+{
+    // Leaving the primitive callbacks unset makes Render_Insert* skip the
+    // object data without drawing it.
+    renderer->Init = M_Init;
+    renderer->Open = M_Open;
+    renderer->Close = M_Close;
+    renderer->Shutdown = M_Shutdown;
+    renderer->BeginScene = M_BeginScene;
+    renderer->EndScene = M_EndScene;
+    renderer->Reset = M_Reset;
+    renderer->DrawPolyList = M_DrawPolyList;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "game/render/priv.h"
+
+void Renderer_Null_Prepare(RENDERER *renderer);
@@ -5,9 +5,21 @@
 #include <libtrx/config.h>
 #include <libtrx/utils.h>
 
+#include <string.h>
+
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX_SIZE (1 << SORT_RADIX_BITS)
+#define SORT_RADIX_PASSES (32 / SORT_RADIX_BITS)
+
 bool g_DiscardTransparent = false;
 
-static void M_QuickSort(int32_t left, int32_t right);
+static SORT_ITEM m_SortTemp[MAX_SORT_ITEMS];
+static SORT_ITEM m_SortCapture[MAX_SORT_ITEMS];
+static int32_t m_SortCaptureCount = -1;
+static bool m_SortCaptureRequested = false;
+
+static inline uint32_t M_GetSortKey(const SORT_ITEM *item);
+static void M_RadixSort(SORT_ITEM *items, SORT_ITEM *temp, int32_t count);
 static inline void M_ClipG(
     VERTEX_INFO *buf, const VERTEX_INFO *vtx1, const VERTEX_INFO *vtx2,
     float clip);
@@ -15,35 +27,65 @@ static inline void M_ClipGUV(
     VERTEX_INFO *buf, const VERTEX_INFO *vtx1, const VERTEX_INFO *vtx2,
     float clip);
 
-static void M_QuickSort(const int32_t left, const int32_t right)
+static inline uint32_t M_GetSortKey(const SORT_ITEM *const item)
 {
-    const int32_t compare = g_SortBuffer[(left + right) / 2]._1;
-    int32_t i = left;
-    int32_t j = right;
+    // Flip the sign bit so that the keys order the same way as unsigned
+    // integers.
+    return (uint32_t)item->_1 ^ 0x80000000;
+}
 
-    do {
-        while ((i < right) && (g_SortBuffer[i]._1 > compare)) {
-            i++;
-        }
-        while ((left < j) && (compare > g_SortBuffer[j]._1)) {
-            j--;
+static void M_RadixSort(
+    SORT_ITEM *const items, SORT_ITEM *const temp, const int32_t count)
+{
+    uint32_t histograms[SORT_RADIX_PASSES][SORT_RADIX_SIZE] = {};
+    for (int32_t i = 0; i < count; i++) {
+        const uint32_t key = M_GetSortKey(&items[i]);
+        for (int32_t pass = 0; pass < SORT_RADIX_PASSES; pass++) {
+            histograms[pass][(key >> (pass * SORT_RADIX_BITS)) & 0xFF]++;
         }
-        if (i > j) {
-            break;
+    }
+
+    SORT_ITEM *src = items;
+    SORT_ITEM *dst = temp;
+    for (int32_t pass = 0; pass < SORT_RADIX_PASSES; pass++) {
+        const int32_t shift = pass * SORT_RADIX_BITS;
+        const uint32_t *const histogram = histograms[pass];
+
+        // Skip the digits that all the keys share, typically the top ones.
+        if (histogram[(M_GetSortKey(&src[0]) >> shift) & 0xFF]
+            == (uint32_t)count) {
+            continue;
         }
 
-        SORT_ITEM tmp_item;
-        SWAP(g_SortBuffer[i], g_SortBuffer[j], tmp_item);
+        uint32_t offsets[SORT_RADIX_SIZE];
+        uint32_t offset = 0;
+        for (int32_t i = 0; i < SORT_RADIX_SIZE; i++) {
+            offsets[i] = offset;
+            offset += histogram[i];
+        }
 
-        i++;
-        j--;
-    } while (i <= j);
+        for (int32_t i = 0; i < count; i++) {
+            const uint32_t digit = (M_GetSortKey(&src[i]) >> shift) & 0xFF;
+            dst[offsets[digit]++] = src[i];
+        }
 
-    if (left < j) {
-        M_QuickSort(left, j);
+        SORT_ITEM *const swap = src;
+        src = dst;
+        dst = swap;
     }
-    if (i < right) {
-        M_QuickSort(i, right);
+
+    // src now holds the items in ascending order, with equal keys in the
+    // order they were inserted. The poly list is drawn back to front, so
+    // reverse it.
+    if (src == items) {
+        for (int32_t i = 0, j = count - 1; i < j; i++, j--) {
+            SORT_ITEM tmp_item;
+            SWAP(items[i], items[j], tmp_item);
+        }
+    } else {
+        for (int32_t i = 0; i < count; i++) {
+            items[i] = src[count - 1 - i];
+        }
     }
 }
 
@@ -94,12 +136,35 @@ double Render_CalculatePolyZ(
 
 void Render_SortPolyList(void)
 {
+    if (m_SortCaptureRequested) {
+        memcpy(m_SortCapture, g_SortBuffer, g_SurfaceCount * sizeof(SORT_ITEM));
+        m_SortCaptureCount = g_SurfaceCount;
+        m_SortCaptureRequested = false;
+    }
+
     if (g_SurfaceCount) {
-        for (int32_t i = 0; i < g_SurfaceCount; i++) {
-            g_SortBuffer[i]._1 += i;
-        }
-        M_QuickSort(0, g_SurfaceCount - 1);
+        M_RadixSort(g_SortBuffer, m_SortTemp, g_SurfaceCount);
+    }
+}
+
+void Render_RequestSortCapture(void)
+{
+    m_SortCaptureRequested = true;
+}
+
+int32_t Render_GetSortCaptureCount(void)
+{
+    return m_SortCaptureCount;
+}
+
+void Render_ReplaySortCapture(void)
+{
+    static SORT_ITEM items[MAX_SORT_ITEMS];
+    if (m_SortCaptureCount <= 0) {
+        return;
     }
+    memcpy(items, m_SortCapture, m_SortCaptureCount * sizeof(SORT_ITEM));
+    M_RadixSort(items, m_SortTemp, m_SortCaptureCount);
 }
 
 int32_t Render_GetUVAdjustment(void)
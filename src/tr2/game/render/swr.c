@@ -3,19 +3,32 @@
 #include "decomp/decomp.h"
 #include "game/output.h"
 #include "game/render/priv.h"
+#include "game/render/swr_priv.h"
 #include "global/vars.h"
 
 #include <libtrx/benchmark.h>
 #include <libtrx/debug.h>
+#include <libtrx/jobs.h>
 #include <libtrx/memory.h>
 #include <libtrx/utils.h>
 
-#define MAKE_Q_ID(g) ((g >> 16) & 0xFF)
-#define MAKE_TEX_ID(v, u) ((((v >> 16) & 0xFF) << 8) | ((u >> 16) & 0xFF))
-#define MAKE_PAL_IDX(c) (c)
-#define PIX_FMT uint8_t
+#include <SDL2/SDL_timer.h>
+
+#include <string.h>
+
+// The span kernels keep __m256i values on the stack, which 64-bit MinGW
+// builds do not align to 32 bytes (GCC bug 54412), so Windows builds use
+// the plain loops.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)            \
+    && !defined(_WIN32)
+    #include <immintrin.h>
+    #define M_USE_AVX2
+#endif
+
 #define PIX_FMT_GL GL_UNSIGNED_BYTE
 #define ALPHA_FMT uint8_t
+#define MAX_BANDS 32
+#define MIN_BAND_HEIGHT 16
 
 typedef enum {
     POLY_GTMAP,
@@ -29,6 +42,18 @@ typedef enum {
     POLY_SPRITE,
 } POLY_TYPE;
 
+// A horizontal slice of the target surface, rasterized by a single job. Each
+// band walks the whole sorted poly list and draws only the rows between y1
+// and y2, so the painter's order is kept within every band.
+typedef struct {
+    int32_t y1;
+    int32_t y2;
+    int32_t xgen_y1;
+    int32_t xgen_y2;
+    GFX_2D_SURFACE *surface;
+    GFX_2D_SURFACE *surface_alpha;
+} M_BAND;
+
 typedef struct {
     GFX_2D_RENDERER *renderer_2d;
     GFX_2D_SURFACE *surface;
@@ -42,24 +67,12 @@ typedef struct {
     uint16_t y;
 } XGEN_X;
 
-typedef struct {
-    int32_t x1;
-    int32_t x2;
-} XBUF_X;
-
 typedef struct {
     int16_t x;
     int16_t y;
     int16_t g;
 } XGEN_XG;
 
-typedef struct {
-    int32_t x1;
-    int32_t g1;
-    int32_t x2;
-    int32_t g2;
-} XBUF_XG;
-
 typedef struct {
     uint16_t x;
     uint16_t y;
@@ -68,17 +81,6 @@ typedef struct {
     uint16_t v;
 } XGEN_XGUV;
 
-typedef struct {
-    int32_t x1;
-    int32_t g1;
-    int32_t u1;
-    int32_t v1;
-    int32_t x2;
-    int32_t g2;
-    int32_t u2;
-    int32_t v2;
-} XBUF_XGUV;
-
 typedef struct {
     uint16_t x;
     uint16_t y;
@@ -87,25 +89,55 @@ typedef struct {
     float u;
     float v;
 } XGEN_XGUVP;
+#pragma pack(pop)
 
+// Per-pixel stepping state of a single span.
 typedef struct {
-    int32_t x1;
-    int32_t g1;
-    float u1;
-    float v1;
-    float rhw1;
-    int32_t x2;
-    int32_t g2;
-    float u2;
-    float v2;
-    float rhw2;
-} XBUF_XGUVP;
-#pragma pack(pop)
+    int32_t g;
+    int32_t u;
+    int32_t v;
+    int32_t g_add;
+    int32_t u_add;
+    int32_t v_add;
+} SPAN_STEP;
+
+typedef void (*SPAN_GOURAUD_FUNC)(
+    PIX_FMT *line_ptr, int32_t count, SPAN_STEP *span,
+    const GOURAUD_ENTRY *gt);
+typedef void (*SPAN_TEXTURED_FUNC)(
+    PIX_FMT *line_ptr, int32_t count, SPAN_STEP *span, const uint8_t *tex_page,
+    int32_t pixel_width, bool is_masked);
 
 static VERTEX_INFO m_VBuffer[32] = {};
 static void *m_XBuffer = NULL;
-static int32_t m_XGenY1 = 0;
-static int32_t m_XGenY2 = 0;
+static M_BAND m_Bands[MAX_BANDS] = {};
+static int32_t m_BandCount = 0;
+static SPAN_GOURAUD_FUNC m_DrawSpanGouraud = NULL;
+static SPAN_TEXTURED_FUNC m_DrawSpanTextured = NULL;
+
+#if defined(TR2X_SPAN_CHECK)
+static bool m_UseReferenceSpans = false;
+
+static struct {
+    bool requested;
+    int32_t pixel_count;
+    int32_t mismatch_count;
+    int32_t poly_count;
+    double reference_msec;
+    double current_msec;
+} m_SpanCheck = { .pixel_count = -1 };
+#endif
+
+static void M_DrawSpanGouraud_C(
+    PIX_FMT *line_ptr, int32_t count, SPAN_STEP *span,
+    const GOURAUD_ENTRY *gt);
+static void M_DrawSpanTextured_C(
+    PIX_FMT *line_ptr, int32_t count, SPAN_STEP *span, const uint8_t *tex_page,
+    int32_t pixel_width, bool is_masked);
+static void M_SelectSpanKernel(void);
+static void M_DrawSpanPersp(
+    PIX_FMT *line_ptr, int32_t count, SPAN_STEP *span, const uint8_t *tex_page,
+    bool is_masked);
 
 static void M_FlatA(
     GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2, uint8_t color_idx);
@@ -119,6 +151,12 @@ static void M_GTMapA(
 static void M_WGTMapA(
     GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2,
     const uint8_t *tex_page);
+static void M_TexturedA(
+    GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2,
+    const uint8_t *tex_page, bool is_masked);
+static void M_TexturedPersp32FP(
+    GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2,
+    const uint8_t *tex_page, bool is_masked);
 static void M_GTMapPersp32FP(
     GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2,
     const uint8_t *tex_page);
@@ -126,9 +164,11 @@ static void M_WGTMapPersp32FP(
     GFX_2D_SURFACE *target_surface, int32_t y1, int32_t y2,
     const uint8_t *tex_page);
 
-static bool M_XGenX(const int16_t *obj_ptr);
-static bool M_XGenXG(const int16_t *obj_ptr);
-static bool M_XGenXGUV(const int16_t *obj_ptr);
+static bool M_XGenFinish(M_BAND *band, int32_t y_min, int32_t y_max);
+static bool M_XGenX(const int16_t *obj_ptr, M_BAND *band);
+static bool M_XGenXG(const int16_t *obj_ptr, M_BAND *band);
+static bool M_XGenXGUV(const int16_t *obj_ptr, M_BAND *band);
+static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr, M_BAND *band);
 
 static void M_OccludeX(GFX_2D_SURFACE *alpha_surface, int32_t y1, int32_t y2);
 static void M_OccludeXG(GFX_2D_SURFACE *alpha_surface, int32_t y1, int32_t y2);
@@ -137,33 +177,21 @@ static void M_OccludeXGUV(
 static void M_OccludeXGUVP(
     GFX_2D_SURFACE *alpha_surface, int32_t y1, int32_t y2);
 
-static void M_DrawPolyFlat(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyTrans(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyGouraud(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyGTMap(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyWGTMap(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyGTMapPersp(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyWGTMapPersp(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawPolyLine(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
-static void M_DrawScaledSpriteC(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *target_surface,
-    GFX_2D_SURFACE *alpha_surface);
+static void M_DrawPolyFlat(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyTrans(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyGouraud(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyGTMap(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyWGTMap(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyGTMapPersp(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyWGTMapPersp(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawPolyLine(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawScaledSpriteC(const int16_t *obj_ptr, M_BAND *band);
+static void M_DrawBand(void *user_data);
+static void M_SetupBands(const M_PRIV *priv);
+static void M_DrawBands(void);
+#if defined(TR2X_SPAN_CHECK)
+static void M_CheckSpans(M_PRIV *priv);
+#endif
 
 static const int16_t *M_InsertObjectG3(
     RENDERER *renderer, const int16_t *obj_ptr, int32_t num,
@@ -192,8 +220,7 @@ static void M_InsertSprite(
     RENDERER *renderer, int32_t z, int32_t x0, int32_t y0, const int32_t x1,
     int32_t y1, int32_t sprite_idx, const int16_t shade);
 
-static void (*m_PolyDrawRoutines[])(
-    const int16_t *, GFX_2D_SURFACE *, GFX_2D_SURFACE *) = {
+static void (*m_PolyDrawRoutines[])(const int16_t *, M_BAND *) = {
     // clang-format off
     [POLY_GTMAP]        = M_DrawPolyGTMap,
     [POLY_WGTMAP]       = M_DrawPolyWGTMap,
@@ -207,6 +234,192 @@ static void (*m_PolyDrawRoutines[])(
     // clang-format on
 };
 
+static void M_DrawSpanGouraud_C(
+    PIX_FMT *const line_ptr, const int32_t count, SPAN_STEP *const span,
+    const GOURAUD_ENTRY *const gt)
+{
+    int32_t g = span->g;
+    for (int32_t i = 0; i < count; i++) {
+        line_ptr[i] = MAKE_PAL_IDX(gt->index[MAKE_Q_ID(g)]);
+        g += span->g_add;
+    }
+    span->g = g;
+}
+
+// Draws count texels, each of them pixel_width pixels wide. Masked spans
+// skip the texels that use palette index 0.
+static void M_DrawSpanTextured_C(
+    PIX_FMT *const line_ptr, const int32_t count, SPAN_STEP *const span,
+    const uint8_t *const tex_page, const int32_t pixel_width,
+    const bool is_masked)
+{
+    int32_t g = span->g;
+    int32_t u = span->u;
+    int32_t v = span->v;
+    for (int32_t i = 0; i < count; i++) {
+        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v, u)];
+        if (!is_masked || color_idx != 0) {
+            const uint8_t color = g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+            PIX_FMT *const pix_ptr = line_ptr + i * pixel_width;
+            pix_ptr[0] = MAKE_PAL_IDX(color);
+            if (pixel_width == 2) {
+                pix_ptr[1] = MAKE_PAL_IDX(color);
+            }
+        }
+        g += span->g_add;
+        u += span->u_add;
+        v += span->v_add;
+    }
+    span->g = g;
+    span->u = u;
+    span->v = v;
+}
+
+#if defined(M_USE_AVX2)
+// Looks up one byte per lane. Each lane loads the aligned dword that holds
+// its byte, so the gather never reads past the end of a table whose size
+// is a multiple of four, such as a texture page or a depth-q row.
+__attribute__((target("avx2"))) static inline __m256i M_GatherBytes_AVX2(
+    const uint8_t *const table, const __m256i offsets)
+{
+    const __m256i dwords = _mm256_i32gather_epi32(
+        (const int *)table, _mm256_andnot_si256(_mm256_set1_epi32(3), offsets),
+        1);
+    const __m256i shifts =
+        _mm256_slli_epi32(_mm256_and_si256(offsets, _mm256_set1_epi32(3)), 3);
+    return _mm256_and_si256(
+        _mm256_srlv_epi32(dwords, shifts), _mm256_set1_epi32(0xFF));
+}
+
+// Packs the low byte of each lane into the low 8 bytes of the result.
+__attribute__((target("avx2"))) static inline __m128i M_PackBytes_AVX2(
+    const __m256i values)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8,
+        12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i packed = _mm256_shuffle_epi8(values, shuffle);
+    return _mm_unpacklo_epi32(
+        _mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+__attribute__((target("avx2"))) static inline __m256i M_StartLanes_AVX2(
+    const int32_t start, const int32_t add)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm256_add_epi32(
+        _mm256_set1_epi32(start),
+        _mm256_mullo_epi32(lanes, _mm256_set1_epi32(add)));
+}
+
+__attribute__((target("avx2"))) static void M_DrawSpanGouraud_AVX2(
+    PIX_FMT *const line_ptr, const int32_t count, SPAN_STEP *const span,
+    const GOURAUD_ENTRY *const gt)
+{
+    const int32_t block_count = count / 8;
+    if (block_count > 0) {
+        __m256i gv = M_StartLanes_AVX2(span->g, span->g_add);
+        const __m256i g_step = _mm256_set1_epi32(span->g_add * 8);
+        const __m256i q_mask = _mm256_set1_epi32(0xFF);
+
+        for (int32_t i = 0; i < block_count; i++) {
+            const __m256i q_id =
+                _mm256_and_si256(_mm256_srli_epi32(gv, 16), q_mask);
+            const __m256i color = M_GatherBytes_AVX2(gt->index, q_id);
+            _mm_storel_epi64(
+                (__m128i *)&line_ptr[i * 8], M_PackBytes_AVX2(color));
+            gv = _mm256_add_epi32(gv, g_step);
+        }
+
+        span->g = (uint32_t)span->g + (uint32_t)block_count * 8 * span->g_add;
+    }
+    M_DrawSpanGouraud_C(
+        &line_ptr[block_count * 8], count - block_count * 8, span, gt);
+}
+
+// Draws 8 texels per step: two gathers look up the texel and its depth-q
+// shade, and masked spans blend the texels that use palette index 0 back
+// to the pixels already on the surface.
+__attribute__((target("avx2"))) static void M_DrawSpanTextured_AVX2(
+    PIX_FMT *const line_ptr, const int32_t count, SPAN_STEP *const span,
+    const uint8_t *const tex_page, const int32_t pixel_width,
+    const bool is_masked)
+{
+    const int32_t block_count = count / 8;
+    if (block_count > 0) {
+        const uint8_t *const depth_q = g_DepthQTable[0].index;
+        __m256i gv = M_StartLanes_AVX2(span->g, span->g_add);
+        __m256i uv = M_StartLanes_AVX2(span->u, span->u_add);
+        __m256i vv = M_StartLanes_AVX2(span->v, span->v_add);
+        const __m256i g_step = _mm256_set1_epi32(span->g_add * 8);
+        const __m256i u_step = _mm256_set1_epi32(span->u_add * 8);
+        const __m256i v_step = _mm256_set1_epi32(span->v_add * 8);
+        const __m256i row_mask = _mm256_set1_epi32(0xFF00);
+        const __m256i col_mask = _mm256_set1_epi32(0xFF);
+
+        for (int32_t i = 0; i < block_count; i++) {
+            const __m256i tex_id = _mm256_or_si256(
+                _mm256_and_si256(_mm256_srli_epi32(vv, 8), row_mask),
+                _mm256_and_si256(_mm256_srli_epi32(uv, 16), col_mask));
+            const __m256i color_idx = M_GatherBytes_AVX2(tex_page, tex_id);
+            const __m256i q_offset =
+                _mm256_and_si256(_mm256_srli_epi32(gv, 8), row_mask);
+            const __m256i color = M_GatherBytes_AVX2(
+                depth_q, _mm256_or_si256(q_offset, color_idx));
+            __m128i pixels = M_PackBytes_AVX2(color);
+            __m128i keep = _mm_setzero_si128();
+            if (is_masked) {
+                keep = M_PackBytes_AVX2(
+                    _mm256_cmpeq_epi32(color_idx, _mm256_setzero_si256()));
+            }
+
+            __m128i *const pix_ptr = (__m128i *)&line_ptr[i * 8 * pixel_width];
+            if (pixel_width == 2) {
+                pixels = _mm_unpacklo_epi8(pixels, pixels);
+                if (is_masked) {
+                    keep = _mm_unpacklo_epi8(keep, keep);
+                    pixels = _mm_blendv_epi8(
+                        pixels, _mm_loadu_si128(pix_ptr), keep);
+                }
+                _mm_storeu_si128(pix_ptr, pixels);
+            } else {
+                if (is_masked) {
+                    pixels = _mm_blendv_epi8(
+                        pixels, _mm_loadl_epi64(pix_ptr), keep);
+                }
+                _mm_storel_epi64(pix_ptr, pixels);
+            }
+
+            gv = _mm256_add_epi32(gv, g_step);
+            uv = _mm256_add_epi32(uv, u_step);
+            vv = _mm256_add_epi32(vv, v_step);
+        }
+
+        span->g = (uint32_t)span->g + (uint32_t)block_count * 8 * span->g_add;
+        span->u = (uint32_t)span->u + (uint32_t)block_count * 8 * span->u_add;
+        span->v = (uint32_t)span->v + (uint32_t)block_count * 8 * span->v_add;
+        // GCC does not always clear the upper halves after the gathers, and
+        // leaving them dirty slows down the SSE code that runs next.
+        _mm256_zeroupper();
+    }
+    M_DrawSpanTextured_C(
+        &line_ptr[block_count * 8 * pixel_width], count - block_count * 8,
+        span, tex_page, pixel_width, is_masked);
+}
+#endif
+
+static void M_SelectSpanKernel(void)
+{
+    m_DrawSpanGouraud = M_DrawSpanGouraud_C;
+    m_DrawSpanTextured = M_DrawSpanTextured_C;
+#if defined(M_USE_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        m_DrawSpanGouraud = M_DrawSpanGouraud_AVX2;
+        m_DrawSpanTextured = M_DrawSpanTextured_AVX2;
+    }
+#endif
+}
+
 static void M_FlatA(
     GFX_2D_SURFACE *const target_surface, int32_t y1, int32_t y2,
     const uint8_t color_idx)
@@ -273,6 +486,13 @@ static void M_GourA(
     GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
     const uint8_t color_idx)
 {
+#if defined(TR2X_SPAN_CHECK)
+    if (m_UseReferenceSpans) {
+        Renderer_SW_RefGourA(target_surface, m_XBuffer, y1, y2, color_idx);
+        return;
+    }
+#endif
+
     int32_t y_size = y2 - y1;
     if (y_size <= 0) {
         return;
@@ -285,32 +505,23 @@ static void M_GourA(
 
     while (y_size > 0) {
         const int32_t x = xbuf->x1 / PHD_ONE;
-        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
-        if (x_size <= 0) {
-            goto loop_end;
-        }
-
-        int32_t g = xbuf->g1;
-        const int32_t g_add = (xbuf->g2 - g) / x_size;
-
-        PIX_FMT *line_ptr = draw_ptr + x;
-        while (x_size > 0) {
-            *line_ptr = MAKE_PAL_IDX(gt->index[MAKE_Q_ID(g)]);
-            line_ptr++;
-            g += g_add;
-            x_size--;
+        const int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size > 0) {
+            SPAN_STEP span = {
+                .g = xbuf->g1,
+                .g_add = (xbuf->g2 - xbuf->g1) / x_size,
+            };
+            m_DrawSpanGouraud(draw_ptr + x, x_size, &span, gt);
         }
-
-    loop_end:
         y_size--;
         xbuf++;
         draw_ptr += stride;
     }
 }
 
-static void M_GTMapA(
+static inline void M_TexturedA(
     GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
-    const uint8_t *const tex_page)
+    const uint8_t *const tex_page, const bool is_masked)
 {
     int32_t y_size = y2 - y1;
     if (y_size <= 0) {
@@ -323,219 +534,79 @@ static void M_GTMapA(
 
     while (y_size > 0) {
         const int32_t x = xbuf->x1 / PHD_ONE;
-        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
-        if (x_size <= 0) {
-            goto loop_end;
-        }
-
-        int32_t g = xbuf->g1;
-        int32_t u = xbuf->u1;
-        int32_t v = xbuf->v1;
-        const int32_t g_add = (xbuf->g2 - g) / x_size;
-        const int32_t u_add = (xbuf->u2 - u) / x_size;
-        const int32_t v_add = (xbuf->v2 - v) / x_size;
-
-        PIX_FMT *line_ptr = draw_ptr + x;
-        while (x_size > 0) {
-            uint8_t color_idx = tex_page[MAKE_TEX_ID(v, u)];
-            *line_ptr =
-                MAKE_PAL_IDX(g_DepthQTable[MAKE_Q_ID(g)].index[color_idx]);
-            line_ptr++;
-            g += g_add;
-            u += u_add;
-            v += v_add;
-            x_size--;
+        const int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size > 0) {
+            SPAN_STEP span = {
+                .g = xbuf->g1,
+                .u = xbuf->u1,
+                .v = xbuf->v1,
+                .g_add = (xbuf->g2 - xbuf->g1) / x_size,
+                .u_add = (xbuf->u2 - xbuf->u1) / x_size,
+                .v_add = (xbuf->v2 - xbuf->v1) / x_size,
+            };
+            m_DrawSpanTextured(
+                draw_ptr + x, x_size, &span, tex_page, 1, is_masked);
         }
-
-    loop_end:
         y_size--;
         xbuf++;
         draw_ptr += stride;
     }
 }
 
-static void M_WGTMapA(
-    GFX_2D_SURFACE *target_surface, const int32_t y1, const int32_t y2,
-    const uint8_t *tex_page)
+static void M_GTMapA(
+    GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
+    const uint8_t *const tex_page)
 {
-    int32_t y_size = y2 - y1;
-    if (y_size <= 0) {
+#if defined(TR2X_SPAN_CHECK)
+    if (m_UseReferenceSpans) {
+        Renderer_SW_RefGTMapA(target_surface, m_XBuffer, y1, y2, tex_page);
         return;
     }
-
-    const int32_t stride = target_surface->desc.pitch;
-    const XBUF_XGUV *xbuf = (const XBUF_XGUV *)m_XBuffer + y1;
-    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
-
-    while (y_size > 0) {
-        const int32_t x = xbuf->x1 / PHD_ONE;
-        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
-        if (x_size <= 0) {
-            goto loop_end;
-        }
-
-        int32_t g = xbuf->g1;
-        int32_t u = xbuf->u1;
-        int32_t v = xbuf->v1;
-        const int32_t g_add = (xbuf->g2 - g) / x_size;
-        const int32_t u_add = (xbuf->u2 - u) / x_size;
-        const int32_t v_add = (xbuf->v2 - v) / x_size;
-
-        PIX_FMT *line_ptr = draw_ptr + x;
-        while (x_size > 0) {
-            const uint8_t color_idx = tex_page[MAKE_TEX_ID(v, u)];
-            if (color_idx != 0) {
-                *line_ptr =
-                    MAKE_PAL_IDX(g_DepthQTable[MAKE_Q_ID(g)].index[color_idx]);
-            }
-            line_ptr++;
-            g += g_add;
-            u += u_add;
-            v += v_add;
-            x_size--;
-        }
-
-    loop_end:
-        y_size--;
-        xbuf++;
-        draw_ptr += stride;
-    }
+#endif
+    M_TexturedA(target_surface, y1, y2, tex_page, false);
 }
 
-static void M_GTMapPersp32FP(
+static void M_WGTMapA(
     GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
     const uint8_t *const tex_page)
 {
-    int32_t y_size = y2 - y1;
-    if (y_size <= 0) {
+#if defined(TR2X_SPAN_CHECK)
+    if (m_UseReferenceSpans) {
+        Renderer_SW_RefWGTMapA(target_surface, m_XBuffer, y1, y2, tex_page);
         return;
     }
+#endif
+    M_TexturedA(target_surface, y1, y2, tex_page, true);
+}
 
-    const int32_t stride = target_surface->desc.pitch;
-    const XBUF_XGUVP *xbuf = (const XBUF_XGUVP *)m_XBuffer + y1;
-    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
-
-    while (y_size > 0) {
-        const int32_t x = xbuf->x1 / PHD_ONE;
-        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
-        if (x_size <= 0) {
-            goto loop_end;
-        }
-
-        int32_t g = xbuf->g1;
-        double u = xbuf->u1;
-        double v = xbuf->v1;
-        double rhw = xbuf->rhw1;
-
-        const int32_t g_add = (xbuf->g2 - g) / x_size;
-
-        int32_t u0 = PHD_HALF * u / rhw;
-        int32_t v0 = PHD_HALF * v / rhw;
-
-        PIX_FMT *line_ptr = draw_ptr + x;
-        int32_t batch_size = 32;
-
-        if (x_size >= batch_size) {
-            const double u_add =
-                (xbuf->u2 - u) / (double)x_size * (double)batch_size;
-            const double v_add =
-                (xbuf->v2 - v) / (double)x_size * (double)batch_size;
-            const double rhw_add =
-                (xbuf->rhw2 - rhw) / (double)x_size * (double)batch_size;
-
-            while (x_size >= batch_size) {
-                u += u_add;
-                v += v_add;
-                rhw += rhw_add;
-
-                const int32_t u1 = PHD_HALF * u / rhw;
-                const int32_t v1 = PHD_HALF * v / rhw;
-
-                const int32_t u0_add = (u1 - u0) / batch_size;
-                const int32_t v0_add = (v1 - v0) / batch_size;
-
-                if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
-                    int32_t batch_counter = batch_size / 2;
-                    while (batch_counter--) {
-                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                        const uint8_t color =
-                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                        *line_ptr++ = MAKE_PAL_IDX(color);
-                        *line_ptr++ = MAKE_PAL_IDX(color);
-                        g += g_add * 2;
-                        u0 += u0_add * 2;
-                        v0 += v0_add * 2;
-                    }
-                } else {
-                    int32_t batch_counter = batch_size;
-                    while (batch_counter--) {
-                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                        const uint8_t color =
-                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                        *line_ptr++ = MAKE_PAL_IDX(color);
-                        g += g_add;
-                        u0 += u0_add;
-                        v0 += v0_add;
-                    }
-                }
-
-                u0 = u1;
-                v0 = v1;
-                x_size -= batch_size;
-            }
-        }
-
-        if (x_size > 1) {
-            const int32_t u1 = PHD_HALF * xbuf->u2 / xbuf->rhw2;
-            const int32_t v1 = PHD_HALF * xbuf->v2 / xbuf->rhw2;
-            const int32_t u0_add = (u1 - u0) / x_size;
-            const int32_t v0_add = (v1 - v0) / x_size;
-
-            batch_size = x_size & ~1;
-            x_size -= batch_size;
-
-            if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
-                int32_t batch_counter = batch_size / 2;
-                while (batch_counter--) {
-                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                    const uint8_t color =
-                        g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                    *line_ptr++ = MAKE_PAL_IDX(color);
-                    *line_ptr++ = MAKE_PAL_IDX(color);
-                    g += g_add * 2;
-                    u0 += u0_add * 2;
-                    v0 += v0_add * 2;
-                }
-            } else {
-                int32_t batch_counter = batch_size;
-                while (batch_counter--) {
-                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                    const uint8_t color =
-                        g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                    *line_ptr++ = MAKE_PAL_IDX(color);
-                    g += g_add;
-                    u0 += u0_add;
-                    v0 += v0_add;
-                }
-            }
-        }
-
-        if (x_size == 1) {
-            const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-            const uint8_t color = g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-            *line_ptr = MAKE_PAL_IDX(color);
-        }
-
-    loop_end:
-        y_size--;
-        xbuf++;
-        draw_ptr += stride;
+// Draws an even number of pixels with affine stepping. When the texture
+// barely changes between pixels, each texel is drawn twice as wide.
+static inline void M_DrawSpanPersp(
+    PIX_FMT *const line_ptr, const int32_t count, SPAN_STEP *const span,
+    const uint8_t *const tex_page, const bool is_masked)
+{
+    if ((ABS(span->u_add) + ABS(span->v_add)) >= (PHD_ONE / 2)) {
+        m_DrawSpanTextured(line_ptr, count, span, tex_page, 1, is_masked);
+        return;
     }
+
+    SPAN_STEP pair_span = {
+        .g = span->g,
+        .u = span->u,
+        .v = span->v,
+        .g_add = span->g_add * 2,
+        .u_add = span->u_add * 2,
+        .v_add = span->v_add * 2,
+    };
+    m_DrawSpanTextured(line_ptr, count / 2, &pair_span, tex_page, 2, is_masked);
+    span->g = pair_span.g;
+    span->u = pair_span.u;
+    span->v = pair_span.v;
 }
 
-static void M_WGTMapPersp32FP(
+static inline void M_TexturedPersp32FP(
     GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
-    const uint8_t *const tex_page)
+    const uint8_t *const tex_page, const bool is_masked)
 {
     int32_t y_size = y2 - y1;
     if (y_size <= 0) {
@@ -582,39 +653,18 @@ static void M_WGTMapPersp32FP(
                 const int32_t u1 = PHD_HALF * u / rhw;
                 const int32_t v1 = PHD_HALF * v / rhw;
 
-                const int32_t u0_add = (u1 - u0) / batch_size;
-                const int32_t v0_add = (v1 - v0) / batch_size;
-
-                if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
-                    int32_t batch_counter = batch_size / 2;
-                    while (batch_counter--) {
-                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                        if (color_idx != 0) {
-                            const uint8_t color =
-                                g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                            line_ptr[0] = MAKE_PAL_IDX(color);
-                            line_ptr[1] = MAKE_PAL_IDX(color);
-                        }
-                        line_ptr += 2;
-                        g += g_add * 2;
-                        u0 += u0_add * 2;
-                        v0 += v0_add * 2;
-                    }
-                } else {
-                    int32_t batch_counter = batch_size;
-                    while (batch_counter--) {
-                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                        if (color_idx != 0) {
-                            const uint8_t color =
-                                g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                            *line_ptr = MAKE_PAL_IDX(color);
-                        }
-                        line_ptr++;
-                        g += g_add;
-                        u0 += u0_add;
-                        v0 += v0_add;
-                    }
-                }
+                SPAN_STEP span = {
+                    .g = g,
+                    .u = u0,
+                    .v = v0,
+                    .g_add = g_add,
+                    .u_add = (u1 - u0) / batch_size,
+                    .v_add = (v1 - v0) / batch_size,
+                };
+                M_DrawSpanPersp(
+                    line_ptr, batch_size, &span, tex_page, is_masked);
+                line_ptr += batch_size;
+                g = span.g;
 
                 u0 = u1;
                 v0 = v1;
@@ -625,47 +675,28 @@ static void M_WGTMapPersp32FP(
         if (x_size > 1) {
             const int32_t u1 = PHD_HALF * xbuf->u2 / xbuf->rhw2;
             const int32_t v1 = PHD_HALF * xbuf->v2 / xbuf->rhw2;
-            const int32_t u0_add = (u1 - u0) / x_size;
-            const int32_t v0_add = (v1 - v0) / x_size;
+            SPAN_STEP span = {
+                .g = g,
+                .u = u0,
+                .v = v0,
+                .g_add = g_add,
+                .u_add = (u1 - u0) / x_size,
+                .v_add = (v1 - v0) / x_size,
+            };
 
             batch_size = x_size & ~1;
             x_size -= batch_size;
 
-            if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
-                int32_t batch_counter = batch_size / 2;
-                while (batch_counter--) {
-                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                    if (color_idx != 0) {
-                        const uint8_t color =
-                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                        line_ptr[0] = MAKE_PAL_IDX(color);
-                        line_ptr[1] = MAKE_PAL_IDX(color);
-                    }
-                    line_ptr += 2;
-                    g += g_add * 2;
-                    u0 += u0_add * 2;
-                    v0 += v0_add * 2;
-                };
-            } else {
-                int32_t batch_counter = batch_size;
-                while (batch_counter--) {
-                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-                    if (color_idx != 0) {
-                        const uint8_t color =
-                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
-                        *line_ptr = MAKE_PAL_IDX(color);
-                    }
-                    line_ptr++;
-                    g += g_add;
-                    u0 += u0_add;
-                    v0 += v0_add;
-                }
-            }
+            M_DrawSpanPersp(line_ptr, batch_size, &span, tex_page, is_masked);
+            line_ptr += batch_size;
+            g = span.g;
+            u0 = span.u;
+            v0 = span.v;
         }
 
         if (x_size == 1) {
             const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
-            if (color_idx != 0) {
+            if (!is_masked || color_idx != 0) {
                 const uint8_t color =
                     g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
                 *line_ptr = MAKE_PAL_IDX(color);
@@ -679,6 +710,34 @@ static void M_WGTMapPersp32FP(
     }
 }
 
+static void M_GTMapPersp32FP(
+    GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
+    const uint8_t *const tex_page)
+{
+#if defined(TR2X_SPAN_CHECK)
+    if (m_UseReferenceSpans) {
+        Renderer_SW_RefGTMapPersp32FP(
+            target_surface, m_XBuffer, y1, y2, tex_page);
+        return;
+    }
+#endif
+    M_TexturedPersp32FP(target_surface, y1, y2, tex_page, false);
+}
+
+static void M_WGTMapPersp32FP(
+    GFX_2D_SURFACE *const target_surface, const int32_t y1, const int32_t y2,
+    const uint8_t *const tex_page)
+{
+#if defined(TR2X_SPAN_CHECK)
+    if (m_UseReferenceSpans) {
+        Renderer_SW_RefWGTMapPersp32FP(
+            target_surface, m_XBuffer, y1, y2, tex_page);
+        return;
+    }
+#endif
+    M_TexturedPersp32FP(target_surface, y1, y2, tex_page, true);
+}
+
 static void M_OccludeX(
     GFX_2D_SURFACE *const alpha_surface, const int32_t y1, const int32_t y2)
 {
@@ -775,7 +834,19 @@ static void M_OccludeXGUVP(
     }
 }
 
-static bool M_XGenX(const int16_t *obj_ptr)
+static bool M_XGenFinish(
+    M_BAND *const band, const int32_t y_min, const int32_t y_max)
+{
+    if (y_min == y_max) {
+        return false;
+    }
+
+    band->xgen_y1 = MAX(y_min, band->y1);
+    band->xgen_y2 = MIN(y_max, band->y2);
+    return band->xgen_y1 < band->xgen_y2;
+}
+
+static bool M_XGenX(const int16_t *obj_ptr, M_BAND *const band)
 {
     int32_t pt_count = *obj_ptr++;
     const XGEN_X *pt2 = (const XGEN_X *)obj_ptr;
@@ -794,13 +865,16 @@ static bool M_XGenX(const int16_t *obj_ptr)
         if (y1 < y2) {
             CLAMPG(y_min, y1);
             const int32_t x_size = x2 - x1;
-            int32_t y_size = y2 - y1;
+            const int32_t y_size = y2 - y1;
+            const int32_t y_start = MAX(y1, band->y1);
+            int32_t row_count = MIN(y2, band->y2) - y_start;
 
-            XBUF_X *x_ptr = (XBUF_X *)m_XBuffer + y1;
+            XBUF_X *x_ptr = (XBUF_X *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             int32_t x = x1 * PHD_ONE + (PHD_ONE - 1);
+            x += x_add * (y_start - y1);
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 x_ptr->x2 = x;
                 x_ptr++;
@@ -808,13 +882,16 @@ static bool M_XGenX(const int16_t *obj_ptr)
         } else if (y2 < y1) {
             CLAMPL(y_max, y1);
             const int32_t x_size = x1 - x2;
-            int32_t y_size = y1 - y2;
+            const int32_t y_size = y1 - y2;
+            const int32_t y_start = MAX(y2, band->y1);
+            int32_t row_count = MIN(y1, band->y2) - y_start;
 
-            XBUF_X *x_ptr = (XBUF_X *)m_XBuffer + y2;
+            XBUF_X *x_ptr = (XBUF_X *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             int32_t x = x2 * PHD_ONE + 1;
+            x += x_add * (y_start - y2);
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 x_ptr->x1 = x;
                 x_ptr++;
@@ -822,16 +899,10 @@ static bool M_XGenX(const int16_t *obj_ptr)
         }
     }
 
-    if (y_min == y_max) {
-        return false;
-    }
-
-    m_XGenY1 = y_min;
-    m_XGenY2 = y_max;
-    return true;
+    return M_XGenFinish(band, y_min, y_max);
 }
 
-static bool M_XGenXG(const int16_t *obj_ptr)
+static bool M_XGenXG(const int16_t *obj_ptr, M_BAND *const band)
 {
     int32_t pt_count = *obj_ptr++;
     const XGEN_XG *pt2 = (const XGEN_XG *)obj_ptr;
@@ -853,15 +924,18 @@ static bool M_XGenXG(const int16_t *obj_ptr)
             CLAMPG(y_min, y1);
             const int32_t g_size = g2 - g1;
             const int32_t x_size = x2 - x1;
-            int32_t y_size = y2 - y1;
+            const int32_t y_size = y2 - y1;
+            const int32_t y_start = MAX(y1, band->y1);
+            const int32_t y_skip = y_start - y1;
+            int32_t row_count = MIN(y2, band->y2) - y_start;
 
-            XBUF_XG *xg_ptr = (XBUF_XG *)m_XBuffer + y1;
+            XBUF_XG *xg_ptr = (XBUF_XG *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
-            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1);
-            int32_t g = g1 * PHD_HALF;
+            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1) + x_add * y_skip;
+            int32_t g = g1 * PHD_HALF + g_add * y_skip;
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 xg_ptr->x2 = x;
@@ -872,15 +946,18 @@ static bool M_XGenXG(const int16_t *obj_ptr)
             CLAMPL(y_max, y1);
             const int32_t g_size = g1 - g2;
             const int32_t x_size = x1 - x2;
-            int32_t y_size = y1 - y2;
+            const int32_t y_size = y1 - y2;
+            const int32_t y_start = MAX(y2, band->y1);
+            const int32_t y_skip = y_start - y2;
+            int32_t row_count = MIN(y1, band->y2) - y_start;
 
-            XBUF_XG *xg_ptr = (XBUF_XG *)m_XBuffer + y2;
+            XBUF_XG *xg_ptr = (XBUF_XG *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
-            int32_t x = x2 * PHD_ONE + 1;
-            int32_t g = g2 * PHD_HALF;
+            int32_t x = x2 * PHD_ONE + 1 + x_add * y_skip;
+            int32_t g = g2 * PHD_HALF + g_add * y_skip;
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 xg_ptr->x1 = x;
@@ -890,16 +967,10 @@ static bool M_XGenXG(const int16_t *obj_ptr)
         }
     }
 
-    if (y_min == y_max) {
-        return false;
-    }
-
-    m_XGenY1 = y_min;
-    m_XGenY2 = y_max;
-    return true;
+    return M_XGenFinish(band, y_min, y_max);
 }
 
-static bool M_XGenXGUV(const int16_t *obj_ptr)
+static bool M_XGenXGUV(const int16_t *obj_ptr, M_BAND *const band)
 {
     int32_t pt_count = *obj_ptr++;
     const XGEN_XGUV *pt2 = (const XGEN_XGUV *)obj_ptr;
@@ -927,19 +998,22 @@ static bool M_XGenXGUV(const int16_t *obj_ptr)
             const int32_t u_size = u2 - u1;
             const int32_t v_size = v2 - v1;
             const int32_t x_size = x2 - x1;
-            int32_t y_size = y2 - y1;
+            const int32_t y_size = y2 - y1;
+            const int32_t y_start = MAX(y1, band->y1);
+            const int32_t y_skip = y_start - y1;
+            int32_t row_count = MIN(y2, band->y2) - y_start;
 
-            XBUF_XGUV *xguv_ptr = (XBUF_XGUV *)m_XBuffer + y1;
+            XBUF_XGUV *xguv_ptr = (XBUF_XGUV *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
             const int32_t u_add = PHD_HALF * u_size / y_size;
             const int32_t v_add = PHD_HALF * v_size / y_size;
-            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1);
-            int32_t g = g1 * PHD_HALF;
-            int32_t u = u1 * PHD_HALF;
-            int32_t v = v1 * PHD_HALF;
+            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1) + x_add * y_skip;
+            int32_t g = g1 * PHD_HALF + g_add * y_skip;
+            int32_t u = u1 * PHD_HALF + u_add * y_skip;
+            int32_t v = v1 * PHD_HALF + v_add * y_skip;
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 u += u_add;
@@ -956,19 +1030,22 @@ static bool M_XGenXGUV(const int16_t *obj_ptr)
             const int32_t u_size = u1 - u2;
             const int32_t v_size = v1 - v2;
             const int32_t x_size = x1 - x2;
-            int32_t y_size = y1 - y2;
+            const int32_t y_size = y1 - y2;
+            const int32_t y_start = MAX(y2, band->y1);
+            const int32_t y_skip = y_start - y2;
+            int32_t row_count = MIN(y1, band->y2) - y_start;
 
-            XBUF_XGUV *xguv_ptr = (XBUF_XGUV *)m_XBuffer + y2;
+            XBUF_XGUV *xguv_ptr = (XBUF_XGUV *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
             const int32_t u_add = PHD_HALF * u_size / y_size;
             const int32_t v_add = PHD_HALF * v_size / y_size;
-            int32_t x = x2 * PHD_ONE + 1;
-            int32_t g = g2 * PHD_HALF;
-            int32_t u = u2 * PHD_HALF;
-            int32_t v = v2 * PHD_HALF;
+            int32_t x = x2 * PHD_ONE + 1 + x_add * y_skip;
+            int32_t g = g2 * PHD_HALF + g_add * y_skip;
+            int32_t u = u2 * PHD_HALF + u_add * y_skip;
+            int32_t v = v2 * PHD_HALF + v_add * y_skip;
 
-            while (y_size--) {
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 u += u_add;
@@ -982,19 +1059,11 @@ static bool M_XGenXGUV(const int16_t *obj_ptr)
         }
     }
 
-    if (y_min == y_max) {
-        return false;
-    }
-
-    m_XGenY1 = y_min;
-    m_XGenY2 = y_max;
-    return true;
+    return M_XGenFinish(band, y_min, y_max);
 }
 
-static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr)
+static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr, M_BAND *const band)
 {
-    const uint8_t *const old = g_TexturePageBuffer8[5];
-
     int32_t pt_count = *obj_ptr++;
     const XGEN_XGUVP *pt2 = (const XGEN_XGUVP *)obj_ptr;
     const XGEN_XGUVP *pt1 = pt2 + (pt_count - 1);
@@ -1026,21 +1095,32 @@ static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr)
             const float v_size = v2 - v1;
             const float rhw_size = rhw2 - rhw1;
             const int32_t x_size = x2 - x1;
-            int32_t y_size = y2 - y1;
+            const int32_t y_size = y2 - y1;
+            const int32_t y_start = MAX(y1, band->y1);
+            const int32_t y_skip = y_start - y1;
+            int32_t row_count = MIN(y2, band->y2) - y_start;
 
-            XBUF_XGUVP *xguv_ptr = (XBUF_XGUVP *)m_XBuffer + y1;
+            XBUF_XGUVP *xguv_ptr = (XBUF_XGUVP *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
             const float u_add = u_size / (float)y_size;
             const float v_add = v_size / (float)y_size;
             const float rhw_add = rhw_size / (float)y_size;
-            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1);
-            int32_t g = g1 * PHD_HALF;
+            int32_t x = x1 * PHD_ONE + (PHD_ONE - 1) + x_add * y_skip;
+            int32_t g = g1 * PHD_HALF + g_add * y_skip;
             float u = u1;
             float v = v1;
             float rhw = rhw1;
 
-            while (y_size--) {
+            // Step the floats one row at a time, so that every band ends up
+            // with the same rounding as a single full-screen pass.
+            for (int32_t i = 0; i < y_skip && row_count > 0; i++) {
+                u += u_add;
+                v += v_add;
+                rhw += rhw_add;
+            }
+
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 u += u_add;
@@ -1060,21 +1140,30 @@ static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr)
             const float v_size = v1 - v2;
             const float rhw_size = rhw1 - rhw2;
             const int32_t x_size = x1 - x2;
-            int32_t y_size = y1 - y2;
+            const int32_t y_size = y1 - y2;
+            const int32_t y_start = MAX(y2, band->y1);
+            const int32_t y_skip = y_start - y2;
+            int32_t row_count = MIN(y1, band->y2) - y_start;
 
-            XBUF_XGUVP *xguv_ptr = (XBUF_XGUVP *)m_XBuffer + y2;
+            XBUF_XGUVP *xguv_ptr = (XBUF_XGUVP *)m_XBuffer + y_start;
             const int32_t x_add = PHD_ONE * x_size / y_size;
             const int32_t g_add = PHD_HALF * g_size / y_size;
             const float u_add = u_size / (float)y_size;
             const float v_add = v_size / (float)y_size;
             const float rhw_add = rhw_size / (float)y_size;
-            int32_t x = x2 * PHD_ONE + 1;
-            int32_t g = g2 * PHD_HALF;
+            int32_t x = x2 * PHD_ONE + 1 + x_add * y_skip;
+            int32_t g = g2 * PHD_HALF + g_add * y_skip;
             float u = u2;
             float v = v2;
             float rhw = rhw2;
 
-            while (y_size--) {
+            for (int32_t i = 0; i < y_skip && row_count > 0; i++) {
+                u += u_add;
+                v += v_add;
+                rhw += rhw_add;
+            }
+
+            while (row_count-- > 0) {
                 x += x_add;
                 g += g_add;
                 u += u_add;
@@ -1090,93 +1179,84 @@ static bool M_XGenXGUVPerspFP(const int16_t *obj_ptr)
         }
     }
 
-    if (y_min == y_max) {
-        return false;
-    }
-
-    m_XGenY1 = y_min;
-    m_XGenY2 = y_max;
-    return true;
+    return M_XGenFinish(band, y_min, y_max);
 }
 
 static void M_DrawPolyFlat(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenX(obj_ptr + 1)) {
-        M_OccludeX(alpha_surface, m_XGenY1, m_XGenY2);
-        M_FlatA(target_surface, m_XGenY1, m_XGenY2, *obj_ptr);
+    if (M_XGenX(obj_ptr + 1, band)) {
+        M_OccludeX(band->surface_alpha, band->xgen_y1, band->xgen_y2);
+        M_FlatA(band->surface, band->xgen_y1, band->xgen_y2, *obj_ptr);
     }
 }
 
 static void M_DrawPolyTrans(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenX(obj_ptr + 1)) {
-        M_OccludeX(alpha_surface, m_XGenY1, m_XGenY2);
-        M_TransA(target_surface, m_XGenY1, m_XGenY2, *obj_ptr);
+    if (M_XGenX(obj_ptr + 1, band)) {
+        M_OccludeX(band->surface_alpha, band->xgen_y1, band->xgen_y2);
+        M_TransA(band->surface, band->xgen_y1, band->xgen_y2, *obj_ptr);
     }
 }
 
 static void M_DrawPolyGouraud(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenXG(obj_ptr + 1)) {
-        M_OccludeXG(alpha_surface, m_XGenY1, m_XGenY2);
-        M_GourA(target_surface, m_XGenY1, m_XGenY2, *obj_ptr);
+    if (M_XGenXG(obj_ptr + 1, band)) {
+        M_OccludeXG(band->surface_alpha, band->xgen_y1, band->xgen_y2);
+        M_GourA(band->surface, band->xgen_y1, band->xgen_y2, *obj_ptr);
     }
 }
 
 static void M_DrawPolyGTMap(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenXGUV(obj_ptr + 1)) {
-        M_OccludeXGUV(alpha_surface, m_XGenY1, m_XGenY2);
+    if (M_XGenXGUV(obj_ptr + 1, band)) {
+        M_OccludeXGUV(band->surface_alpha, band->xgen_y1, band->xgen_y2);
         M_GTMapA(
-            target_surface, m_XGenY1, m_XGenY2, g_TexturePageBuffer8[*obj_ptr]);
+            band->surface, band->xgen_y1, band->xgen_y2,
+            g_TexturePageBuffer8[*obj_ptr]);
     }
 }
 
 static void M_DrawPolyWGTMap(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenXGUV(obj_ptr + 1)) {
-        M_OccludeXGUV(alpha_surface, m_XGenY1, m_XGenY2);
+    if (M_XGenXGUV(obj_ptr + 1, band)) {
+        M_OccludeXGUV(band->surface_alpha, band->xgen_y1, band->xgen_y2);
         M_WGTMapA(
-            target_surface, m_XGenY1, m_XGenY2, g_TexturePageBuffer8[*obj_ptr]);
+            band->surface, band->xgen_y1, band->xgen_y2,
+            g_TexturePageBuffer8[*obj_ptr]);
     }
 }
 
 static void M_DrawPolyGTMapPersp(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenXGUVPerspFP(obj_ptr + 1)) {
-        M_OccludeXGUVP(alpha_surface, m_XGenY1, m_XGenY2);
+    if (M_XGenXGUVPerspFP(obj_ptr + 1, band)) {
+        M_OccludeXGUVP(band->surface_alpha, band->xgen_y1, band->xgen_y2);
         M_GTMapPersp32FP(
-            target_surface, m_XGenY1, m_XGenY2, g_TexturePageBuffer8[*obj_ptr]);
+            band->surface, band->xgen_y1, band->xgen_y2,
+            g_TexturePageBuffer8[*obj_ptr]);
     }
 }
 
 static void M_DrawPolyWGTMapPersp(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
-    if (M_XGenXGUVPerspFP(obj_ptr + 1)) {
-        M_OccludeXGUVP(alpha_surface, m_XGenY1, m_XGenY2);
+    if (M_XGenXGUVPerspFP(obj_ptr + 1, band)) {
+        M_OccludeXGUVP(band->surface_alpha, band->xgen_y1, band->xgen_y2);
         M_WGTMapPersp32FP(
-            target_surface, m_XGenY1, m_XGenY2, g_TexturePageBuffer8[*obj_ptr]);
+            band->surface, band->xgen_y1, band->xgen_y2,
+            g_TexturePageBuffer8[*obj_ptr]);
     }
 }
 
-static void M_DrawPolyLine(
-    const int16_t *obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+static void M_DrawPolyLine(const int16_t *obj_ptr, M_BAND *const band)
 {
+    GFX_2D_SURFACE *const target_surface = band->surface;
+    GFX_2D_SURFACE *const alpha_surface = band->surface_alpha;
     int32_t x1 = *obj_ptr++;
     int32_t y1 = *obj_ptr++;
     int32_t x2 = *obj_ptr++;
@@ -1230,7 +1310,9 @@ static void M_DrawPolyLine(
     ALPHA_FMT *alpha_ptr = &alpha_surface->buffer[x1 + stride * y1];
 
     if (!x_size && !y_size) {
-        *draw_ptr = lcolor;
+        if (y1 >= band->y1 && y1 < band->y2) {
+            *draw_ptr = lcolor;
+        }
         //*alpha_ptr = 255;
         return;
     }
@@ -1253,30 +1335,41 @@ static void M_DrawPolyLine(
 
     int32_t col_add;
     int32_t row_add;
+    int32_t col_y_add;
+    int32_t row_y_add;
     int32_t cols;
     int32_t rows;
     if (x_size >= y_size) {
         col_add = x_add;
         row_add = y_add;
+        col_y_add = 0;
+        row_y_add = y_add / stride;
         cols = x_size + 1;
         rows = y_size + 1;
     } else {
         col_add = y_add;
         row_add = x_add;
+        col_y_add = y_add / stride;
+        row_y_add = 0;
         cols = y_size + 1;
         rows = x_size + 1;
     }
 
+    int32_t y = y1;
     int32_t part_sum = 0;
     int32_t part = PHD_ONE * rows / cols;
     for (int32_t i = 0; i < cols; i++) {
         part_sum += part;
-        *draw_ptr = lcolor;
+        if (y >= band->y1 && y < band->y2) {
+            *draw_ptr = lcolor;
+        }
         draw_ptr += col_add;
+        y += col_y_add;
         //*alpha_ptr = 255;
         // alpha_ptr += col_add;
         if (part_sum >= PHD_ONE) {
             draw_ptr += row_add;
+            y += row_y_add;
             // alpha_ptr += row_add;
             part_sum -= PHD_ONE;
         }
@@ -1284,9 +1377,10 @@ static void M_DrawPolyLine(
 }
 
 static void M_DrawScaledSpriteC(
-    const int16_t *const obj_ptr, GFX_2D_SURFACE *const target_surface,
-    GFX_2D_SURFACE *const alpha_surface)
+    const int16_t *const obj_ptr, M_BAND *const band)
 {
+    GFX_2D_SURFACE *const target_surface = band->surface;
+    GFX_2D_SURFACE *const alpha_surface = band->surface_alpha;
     int32_t x0 = obj_ptr[0];
     int32_t y0 = obj_ptr[1];
     int32_t x1 = obj_ptr[2];
@@ -1311,12 +1405,16 @@ static void M_DrawScaledSpriteC(
         u_base -= x0 * u_add;
         x0 = 0;
     }
-    if (y0 < 0) {
-        v_base -= y0 * v_add;
-        y0 = 0;
+    if (y0 < band->y1) {
+        v_base += (band->y1 - y0) * v_add;
+        y0 = band->y1;
     }
     CLAMPG(x1, g_PhdWinMaxX + 1);
     CLAMPG(y1, g_PhdWinMaxY + 1);
+    CLAMPG(y1, band->y2);
+    if (y0 >= y1) {
+        return;
+    }
 
     const int32_t stride = target_surface->desc.pitch;
     const int32_t width = x1 - x0;
@@ -1349,10 +1447,106 @@ static void M_DrawScaledSpriteC(
     }
 }
 
+static void M_DrawBand(void *const user_data)
+{
+    M_BAND *const band = user_data;
+    for (int32_t i = 0; i < g_SurfaceCount; i++) {
+        const int16_t *obj_ptr = (const int16_t *)g_SortBuffer[i]._0;
+        const int16_t poly_type = *obj_ptr++;
+        m_PolyDrawRoutines[poly_type](obj_ptr, band);
+    }
+}
+
+static void M_SetupBands(const M_PRIV *const priv)
+{
+    // Use twice as many bands as there are threads, since some parts of the
+    // screen are usually much busier than others.
+    const int32_t thread_count = Jobs_GetWorkerCount() + 1;
+    const int32_t height = priv->surface->desc.height;
+    m_BandCount = thread_count > 1 ? thread_count * 2 : 1;
+    CLAMPG(m_BandCount, MAX_BANDS);
+    CLAMPG(m_BandCount, MAX(height / MIN_BAND_HEIGHT, 1));
+
+    for (int32_t i = 0; i < m_BandCount; i++) {
+        M_BAND *const band = &m_Bands[i];
+        band->y1 = height * i / m_BandCount;
+        band->y2 = height * (i + 1) / m_BandCount;
+        band->surface = priv->surface;
+        band->surface_alpha = priv->surface_alpha;
+    }
+}
+
+static void M_DrawBands(void)
+{
+    if (m_BandCount == 1) {
+        M_DrawBand(&m_Bands[0]);
+        return;
+    }
+
+    JOB_GRAPH *const graph = Jobs_CreateGraph();
+    for (int32_t i = 0; i < m_BandCount; i++) {
+        Jobs_Add(graph, M_DrawBand, &m_Bands[i]);
+    }
+    Jobs_Run(graph);
+    Jobs_FreeGraph(graph);
+}
+
+#if defined(TR2X_SPAN_CHECK)
+static void M_CheckSpans(M_PRIV *const priv)
+{
+    // Draw the same poly list over the same starting image, once with the
+    // original span fillers and once with the current ones, and time both.
+    GFX_2D_SURFACE *const surface = priv->surface;
+    GFX_2D_SURFACE *const surface_alpha = priv->surface_alpha;
+    const size_t size = surface->desc.pitch * surface->desc.height;
+    const size_t alpha_size = surface_alpha->desc.pitch
+        * surface_alpha->desc.height;
+    uint8_t *start = Memory_Alloc(size);
+    uint8_t *start_alpha = Memory_Alloc(alpha_size);
+    uint8_t *reference = Memory_Alloc(size);
+    memcpy(start, surface->buffer, size);
+    memcpy(start_alpha, surface_alpha->buffer, alpha_size);
+
+    m_UseReferenceSpans = true;
+    const Uint64 reference_start = SDL_GetPerformanceCounter();
+    M_DrawBands();
+    const Uint64 reference_end = SDL_GetPerformanceCounter();
+    m_UseReferenceSpans = false;
+    memcpy(reference, surface->buffer, size);
+
+    memcpy(surface->buffer, start, size);
+    memcpy(surface_alpha->buffer, start_alpha, alpha_size);
+    const Uint64 current_start = SDL_GetPerformanceCounter();
+    M_DrawBands();
+    const Uint64 current_end = SDL_GetPerformanceCounter();
+
+    int32_t mismatch_count = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (surface->buffer[i] != reference[i]) {
+            mismatch_count++;
+        }
+    }
+
+    m_SpanCheck.requested = false;
+    m_SpanCheck.pixel_count = size / sizeof(PIX_FMT);
+    m_SpanCheck.mismatch_count = mismatch_count;
+    m_SpanCheck.poly_count = g_SurfaceCount;
+    m_SpanCheck.reference_msec = (double)(reference_end - reference_start)
+        * 1000.0 / SDL_GetPerformanceFrequency();
+    m_SpanCheck.current_msec = (double)(current_end - current_start) * 1000.0
+        / SDL_GetPerformanceFrequency();
+
+    Memory_FreePointer(&start);
+    Memory_FreePointer(&start_alpha);
+    Memory_FreePointer(&reference);
+}
+#endif
+
 static void M_Init(RENDERER *const renderer)
 {
     M_PRIV *const priv = Memory_Alloc(sizeof(M_PRIV));
     priv->renderer_2d = GFX_2D_Renderer_Create();
+    M_SelectSpanKernel();
     renderer->priv = priv;
     renderer->initialized = true;
 }
@@ -1394,6 +1588,7 @@ static void M_Open(RENDERER *const renderer)
         ASSERT(priv->surface_alpha != NULL);
     }
 
+    M_SetupBands(priv);
     renderer->open = true;
 }
 
@@ -1405,6 +1600,7 @@ static void M_Close(RENDERER *const renderer)
     }
 
     Memory_FreePointer(&m_XBuffer);
+    m_BandCount = 0;
 
     if (priv->surface != NULL) {
         GFX_2D_Surface_Free(priv->surface);
@@ -1477,12 +1673,15 @@ static void M_DrawPolyList(RENDERER *const renderer)
 
     Render_SortPolyList();
 
-    for (int32_t i = 0; i < g_SurfaceCount; i++) {
-        const int16_t *obj_ptr = (const int16_t *)g_SortBuffer[i]._0;
-        const int16_t poly_type = *obj_ptr++;
-        m_PolyDrawRoutines[poly_type](
-            obj_ptr, priv->surface, priv->surface_alpha);
+#if defined(TR2X_SPAN_CHECK)
+    if (m_SpanCheck.requested) {
+        M_CheckSpans(priv);
+    } else {
+        M_DrawBands();
     }
+#else
+    M_DrawBands();
+#endif
 
     GFX_2D_Renderer_UploadSurface(priv->renderer_2d, priv->surface);
     GFX_2D_Renderer_UploadAlphaSurface(priv->renderer_2d, priv->surface_alpha);
@@ -2375,3 +2574,27 @@ void Renderer_SW_Prepare(RENDERER *const renderer)
     renderer->InsertTransOctagon = M_InsertTransOctagon;
     renderer->InsertSprite = M_InsertSprite;
 }
+
+#if defined(TR2X_SPAN_CHECK)
+void Renderer_SW_RequestSpanCheck(void)
+{
+    m_SpanCheck.requested = true;
+}
+
+bool Renderer_SW_GetSpanCheckResult(
+    int32_t *const out_pixel_count, int32_t *const out_poly_count,
+    int32_t *const out_mismatch_count, double *const out_reference_msec,
+    double *const out_current_msec)
+{
+    if (m_SpanCheck.pixel_count < 0) {
+        return false;
+    }
+    *out_pixel_count = m_SpanCheck.pixel_count;
+    *out_poly_count = m_SpanCheck.poly_count;
+    *out_mismatch_count = m_SpanCheck.mismatch_count;
+    *out_reference_msec = m_SpanCheck.reference_msec;
+    *out_current_msec = m_SpanCheck.current_msec;
+    m_SpanCheck.pixel_count = -1;
+    return true;
+}
+#endif
@@ -3,3 +3,14 @@
 #include "game/render/priv.h"
 
 void Renderer_SW_Prepare(RENDERER *renderer);
+
+#if defined(TR2X_SPAN_CHECK)
+// Draws the next frame with both the vectorised span fillers and the original
+// ones they replaced, times both passes and counts the pixels that differ.
+void Renderer_SW_RequestSpanCheck(void);
+// Returns false if no frame has been checked since the last call.
+bool Renderer_SW_GetSpanCheckResult(
+    int32_t *out_pixel_count, int32_t *out_poly_count,
+    int32_t *out_mismatch_count, double *out_reference_msec,
+    double *out_current_msec);
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <libtrx/gfx/2d/2d_surface.h>
+
+#include <stdint.h>
+
+#define MAKE_Q_ID(g) ((g >> 16) & 0xFF)
+#define MAKE_TEX_ID(v, u) ((((v >> 16) & 0xFF) << 8) | ((u >> 16) & 0xFF))
+#define MAKE_PAL_IDX(c) (c)
+#define PIX_FMT uint8_t
+
+#pragma pack(push, 1)
+typedef struct {
+    int32_t x1;
+    int32_t x2;
+} XBUF_X;
+
+typedef struct {
+    int32_t x1;
+    int32_t g1;
+    int32_t x2;
+    int32_t g2;
+} XBUF_XG;
+
+typedef struct {
+    int32_t x1;
+    int32_t g1;
+    int32_t u1;
+    int32_t v1;
+    int32_t x2;
+    int32_t g2;
+    int32_t u2;
+    int32_t v2;
+} XBUF_XGUV;
+
+typedef struct {
+    int32_t x1;
+    int32_t g1;
+    float u1;
+    float v1;
+    float rhw1;
+    int32_t x2;
+    int32_t g2;
+    float u2;
+    float v2;
+    float rhw2;
+} XBUF_XGUVP;
+#pragma pack(pop)
+
+#if defined(TR2X_SPAN_CHECK)
+// The span fillers from before the SIMD kernels. /spancheck draws a frame
+// with them and with the current fillers, and compares the two.
+void Renderer_SW_RefGourA(
+    GFX_2D_SURFACE *target_surface, const void *x_buffer, int32_t y1,
+    int32_t y2, uint8_t color_idx);
+void Renderer_SW_RefGTMapA(
+    GFX_2D_SURFACE *target_surface, const void *x_buffer, int32_t y1,
+    int32_t y2, const uint8_t *tex_page);
+void Renderer_SW_RefWGTMapA(
+    GFX_2D_SURFACE *target_surface, const void *x_buffer, int32_t y1,
+    int32_t y2, const uint8_t *tex_page);
+void Renderer_SW_RefGTMapPersp32FP(
+    GFX_2D_SURFACE *target_surface, const void *x_buffer, int32_t y1,
+    int32_t y2, const uint8_t *tex_page);
+void Renderer_SW_RefWGTMapPersp32FP(
+    GFX_2D_SURFACE *target_surface, const void *x_buffer, int32_t y1,
+    int32_t y2, const uint8_t *tex_page);
+#endif
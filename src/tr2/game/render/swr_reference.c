@@ -0,0 +1,414 @@
+#include "game/render/swr_priv.h"
+#include "global/vars.h"
+
+#include <libtrx/utils.h>
+
+void Renderer_SW_RefGourA(
+    GFX_2D_SURFACE *const target_surface, const void *const x_buffer,
+    const int32_t y1, const int32_t y2, const uint8_t color_idx)
+{
+    int32_t y_size = y2 - y1;
+    if (y_size <= 0) {
+        return;
+    }
+
+    const int32_t stride = target_surface->desc.pitch;
+    const XBUF_XG *xbuf = (const XBUF_XG *)x_buffer + y1;
+    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
+    const GOURAUD_ENTRY *gt = g_GouraudTable + color_idx;
+
+    while (y_size > 0) {
+        const int32_t x = xbuf->x1 / PHD_ONE;
+        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size <= 0) {
+            goto loop_end;
+        }
+
+        int32_t g = xbuf->g1;
+        const int32_t g_add = (xbuf->g2 - g) / x_size;
+
+        PIX_FMT *line_ptr = draw_ptr + x;
+        while (x_size > 0) {
+            *line_ptr = MAKE_PAL_IDX(gt->index[MAKE_Q_ID(g)]);
+            line_ptr++;
+            g += g_add;
+            x_size--;
+        }
+
+    loop_end:
+        y_size--;
+        xbuf++;
+        draw_ptr += stride;
+    }
+}
+
+void Renderer_SW_RefGTMapA(
+    GFX_2D_SURFACE *const target_surface, const void *const x_buffer,
+    const int32_t y1, const int32_t y2, const uint8_t *const tex_page)
+{
+    int32_t y_size = y2 - y1;
+    if (y_size <= 0) {
+        return;
+    }
+
+    const int32_t stride = target_surface->desc.pitch;
+    const XBUF_XGUV *xbuf = (const XBUF_XGUV *)x_buffer + y1;
+    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
+
+    while (y_size > 0) {
+        const int32_t x = xbuf->x1 / PHD_ONE;
+        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size <= 0) {
+            goto loop_end;
+        }
+
+        int32_t g = xbuf->g1;
+        int32_t u = xbuf->u1;
+        int32_t v = xbuf->v1;
+        const int32_t g_add = (xbuf->g2 - g) / x_size;
+        const int32_t u_add = (xbuf->u2 - u) / x_size;
+        const int32_t v_add = (xbuf->v2 - v) / x_size;
+
+        PIX_FMT *line_ptr = draw_ptr + x;
+        while (x_size > 0) {
+            uint8_t color_idx = tex_page[MAKE_TEX_ID(v, u)];
+            *line_ptr =
+                MAKE_PAL_IDX(g_DepthQTable[MAKE_Q_ID(g)].index[color_idx]);
+            line_ptr++;
+            g += g_add;
+            u += u_add;
+            v += v_add;
+            x_size--;
+        }
+
+    loop_end:
+        y_size--;
+        xbuf++;
+        draw_ptr += stride;
+    }
+}
+
+void Renderer_SW_RefWGTMapA(
+    GFX_2D_SURFACE *const target_surface, const void *const x_buffer,
+    const int32_t y1, const int32_t y2, const uint8_t *const tex_page)
+{
+    int32_t y_size = y2 - y1;
+    if (y_size <= 0) {
+        return;
+    }
+
+    const int32_t stride = target_surface->desc.pitch;
+    const XBUF_XGUV *xbuf = (const XBUF_XGUV *)x_buffer + y1;
+    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
+
+    while (y_size > 0) {
+        const int32_t x = xbuf->x1 / PHD_ONE;
+        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size <= 0) {
+            goto loop_end;
+        }
+
+        int32_t g = xbuf->g1;
+        int32_t u = xbuf->u1;
+        int32_t v = xbuf->v1;
+        const int32_t g_add = (xbuf->g2 - g) / x_size;
+        const int32_t u_add = (xbuf->u2 - u) / x_size;
+        const int32_t v_add = (xbuf->v2 - v) / x_size;
+
+        PIX_FMT *line_ptr = draw_ptr + x;
+        while (x_size > 0) {
+            const uint8_t color_idx = tex_page[MAKE_TEX_ID(v, u)];
+            if (color_idx != 0) {
+                *line_ptr =
+                    MAKE_PAL_IDX(g_DepthQTable[MAKE_Q_ID(g)].index[color_idx]);
+            }
+            line_ptr++;
+            g += g_add;
+            u += u_add;
+            v += v_add;
+            x_size--;
+        }
+
+    loop_end:
+        y_size--;
+        xbuf++;
+        draw_ptr += stride;
+    }
+}
+
+void Renderer_SW_RefGTMapPersp32FP(
+    GFX_2D_SURFACE *const target_surface, const void *const x_buffer,
+    const int32_t y1, const int32_t y2, const uint8_t *const tex_page)
+{
+    int32_t y_size = y2 - y1;
+    if (y_size <= 0) {
+        return;
+    }
+
+    const int32_t stride = target_surface->desc.pitch;
+    const XBUF_XGUVP *xbuf = (const XBUF_XGUVP *)x_buffer + y1;
+    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
+
+    while (y_size > 0) {
+        const int32_t x = xbuf->x1 / PHD_ONE;
+        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size <= 0) {
+            goto loop_end;
+        }
+
+        int32_t g = xbuf->g1;
+        double u = xbuf->u1;
+        double v = xbuf->v1;
+        double rhw = xbuf->rhw1;
+
+        const int32_t g_add = (xbuf->g2 - g) / x_size;
+
+        int32_t u0 = PHD_HALF * u / rhw;
+        int32_t v0 = PHD_HALF * v / rhw;
+
+        PIX_FMT *line_ptr = draw_ptr + x;
+        int32_t batch_size = 32;
+
+        if (x_size >= batch_size) {
+            const double u_add =
+                (xbuf->u2 - u) / (double)x_size * (double)batch_size;
+            const double v_add =
+                (xbuf->v2 - v) / (double)x_size * (double)batch_size;
+            const double rhw_add =
+                (xbuf->rhw2 - rhw) / (double)x_size * (double)batch_size;
+
+            while (x_size >= batch_size) {
+                u += u_add;
+                v += v_add;
+                rhw += rhw_add;
+
+                const int32_t u1 = PHD_HALF * u / rhw;
+                const int32_t v1 = PHD_HALF * v / rhw;
+
+                const int32_t u0_add = (u1 - u0) / batch_size;
+                const int32_t v0_add = (v1 - v0) / batch_size;
+
+                if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
+                    int32_t batch_counter = batch_size / 2;
+                    while (batch_counter--) {
+                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                        const uint8_t color =
+                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                        *line_ptr++ = MAKE_PAL_IDX(color);
+                        *line_ptr++ = MAKE_PAL_IDX(color);
+                        g += g_add * 2;
+                        u0 += u0_add * 2;
+                        v0 += v0_add * 2;
+                    }
+                } else {
+                    int32_t batch_counter = batch_size;
+                    while (batch_counter--) {
+                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                        const uint8_t color =
+                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                        *line_ptr++ = MAKE_PAL_IDX(color);
+                        g += g_add;
+                        u0 += u0_add;
+                        v0 += v0_add;
+                    }
+                }
+
+                u0 = u1;
+                v0 = v1;
+                x_size -= batch_size;
+            }
+        }
+
+        if (x_size > 1) {
+            const int32_t u1 = PHD_HALF * xbuf->u2 / xbuf->rhw2;
+            const int32_t v1 = PHD_HALF * xbuf->v2 / xbuf->rhw2;
+            const int32_t u0_add = (u1 - u0) / x_size;
+            const int32_t v0_add = (v1 - v0) / x_size;
+
+            batch_size = x_size & ~1;
+            x_size -= batch_size;
+
+            if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
+                int32_t batch_counter = batch_size / 2;
+                while (batch_counter--) {
+                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                    const uint8_t color =
+                        g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                    *line_ptr++ = MAKE_PAL_IDX(color);
+                    *line_ptr++ = MAKE_PAL_IDX(color);
+                    g += g_add * 2;
+                    u0 += u0_add * 2;
+                    v0 += v0_add * 2;
+                }
+            } else {
+                int32_t batch_counter = batch_size;
+                while (batch_counter--) {
+                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                    const uint8_t color =
+                        g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                    *line_ptr++ = MAKE_PAL_IDX(color);
+                    g += g_add;
+                    u0 += u0_add;
+                    v0 += v0_add;
+                }
+            }
+        }
+
+        if (x_size == 1) {
+            const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+            const uint8_t color = g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+            *line_ptr = MAKE_PAL_IDX(color);
+        }
+
+    loop_end:
+        y_size--;
+        xbuf++;
+        draw_ptr += stride;
+    }
+}
+
+void Renderer_SW_RefWGTMapPersp32FP(
+    GFX_2D_SURFACE *const target_surface, const void *const x_buffer,
+    const int32_t y1, const int32_t y2, const uint8_t *const tex_page)
+{
+    int32_t y_size = y2 - y1;
+    if (y_size <= 0) {
+        return;
+    }
+
+    const int32_t stride = target_surface->desc.pitch;
+    const XBUF_XGUVP *xbuf = (const XBUF_XGUVP *)x_buffer + y1;
+    PIX_FMT *draw_ptr = target_surface->buffer + y1 * stride;
+
+    while (y_size > 0) {
+        const int32_t x = xbuf->x1 / PHD_ONE;
+        int32_t x_size = (xbuf->x2 / PHD_ONE) - x;
+        if (x_size <= 0) {
+            goto loop_end;
+        }
+
+        int32_t g = xbuf->g1;
+        double u = xbuf->u1;
+        double v = xbuf->v1;
+        double rhw = xbuf->rhw1;
+
+        const int32_t g_add = (xbuf->g2 - g) / x_size;
+
+        int32_t u0 = PHD_HALF * u / rhw;
+        int32_t v0 = PHD_HALF * v / rhw;
+
+        PIX_FMT *line_ptr = draw_ptr + x;
+        int32_t batch_size = 32;
+
+        if (x_size >= batch_size) {
+            const double u_add =
+                (xbuf->u2 - u) / (double)x_size * (double)batch_size;
+            const double v_add =
+                (xbuf->v2 - v) / (double)x_size * (double)batch_size;
+            const double rhw_add =
+                (xbuf->rhw2 - rhw) / (double)x_size * (double)batch_size;
+
+            while (x_size >= batch_size) {
+                u += u_add;
+                v += v_add;
+                rhw += rhw_add;
+
+                const int32_t u1 = PHD_HALF * u / rhw;
+                const int32_t v1 = PHD_HALF * v / rhw;
+
+                const int32_t u0_add = (u1 - u0) / batch_size;
+                const int32_t v0_add = (v1 - v0) / batch_size;
+
+                if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
+                    int32_t batch_counter = batch_size / 2;
+                    while (batch_counter--) {
+                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                        if (color_idx != 0) {
+                            const uint8_t color =
+                                g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                            line_ptr[0] = MAKE_PAL_IDX(color);
+                            line_ptr[1] = MAKE_PAL_IDX(color);
+                        }
+                        line_ptr += 2;
+                        g += g_add * 2;
+                        u0 += u0_add * 2;
+                        v0 += v0_add * 2;
+                    }
+                } else {
+                    int32_t batch_counter = batch_size;
+                    while (batch_counter--) {
+                        const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                        if (color_idx != 0) {
+                            const uint8_t color =
+                                g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                            *line_ptr = MAKE_PAL_IDX(color);
+                        }
+                        line_ptr++;
+                        g += g_add;
+                        u0 += u0_add;
+                        v0 += v0_add;
+                    }
+                }
+
+                u0 = u1;
+                v0 = v1;
+                x_size -= batch_size;
+            }
+        }
+
+        if (x_size > 1) {
+            const int32_t u1 = PHD_HALF * xbuf->u2 / xbuf->rhw2;
+            const int32_t v1 = PHD_HALF * xbuf->v2 / xbuf->rhw2;
+            const int32_t u0_add = (u1 - u0) / x_size;
+            const int32_t v0_add = (v1 - v0) / x_size;
+
+            batch_size = x_size & ~1;
+            x_size -= batch_size;
+
+            if ((ABS(u0_add) + ABS(v0_add)) < (PHD_ONE / 2)) {
+                int32_t batch_counter = batch_size / 2;
+                while (batch_counter--) {
+                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                    if (color_idx != 0) {
+                        const uint8_t color =
+                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                        line_ptr[0] = MAKE_PAL_IDX(color);
+                        line_ptr[1] = MAKE_PAL_IDX(color);
+                    }
+                    line_ptr += 2;
+                    g += g_add * 2;
+                    u0 += u0_add * 2;
+                    v0 += v0_add * 2;
+                };
+            } else {
+                int32_t batch_counter = batch_size;
+                while (batch_counter--) {
+                    const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+                    if (color_idx != 0) {
+                        const uint8_t color =
+                            g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                        *line_ptr = MAKE_PAL_IDX(color);
+                    }
+                    line_ptr++;
+                    g += g_add;
+                    u0 += u0_add;
+                    v0 += v0_add;
+                }
+            }
+        }
+
+        if (x_size == 1) {
+            const uint8_t color_idx = tex_page[MAKE_TEX_ID(v0, u0)];
+            if (color_idx != 0) {
+                const uint8_t color =
+                    g_DepthQTable[MAKE_Q_ID(g)].index[color_idx];
+                *line_ptr = MAKE_PAL_IDX(color);
+            }
+        }
+
+    loop_end:
+        y_size--;
+        xbuf++;
+        draw_ptr += stride;
+    }
+}
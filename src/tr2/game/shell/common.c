@@ -22,18 +22,23 @@
 #include "global/vars.h"
 
 #include <libtrx/config.h>
+#include <libtrx/engine/audio.h>
 #include <libtrx/enum_map.h>
+#include <libtrx/game/frame_stats.h>
 #include <libtrx/game/gamebuf.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/shell.h>
 #include <libtrx/game/ui/common.h>
+#include <libtrx/jobs.h>
 #include <libtrx/log.h>
 #include <libtrx/memory.h>
+#include <libtrx/scratch.h>
 
 #include <SDL2/SDL.h>
 #include <stdarg.h>
 #include <stdio.h>
 
-#define GAMEBUF_MEM_CAP 0x780000
+#define GAMEBUF_CHUNK_SIZE 0x780000
 
 static Uint64 m_UpdateDebounce = 0;
 static const char *m_CurrentGameFlowPath = "cfg/TR2X_gameflow.json5";
@@ -275,6 +280,7 @@ static void M_LoadConfig(void)
 
     Sound_SetMasterVolume(g_Config.audio.sound_volume);
     Music_SetVolume(g_Config.audio.music_volume);
+    Audio_Sample_SetInterpolation(g_Config.audio.sample_interpolation);
 }
 
 static void M_HandleConfigChange(const EVENT *const event, void *const data)
@@ -290,6 +296,9 @@ static void M_HandleConfigChange(const EVENT *const event, void *const data)
     if (CHANGED(audio.music_volume)) {
         Music_SetVolume(g_Config.audio.music_volume);
     }
+    if (CHANGED(audio.sample_interpolation)) {
+        Audio_Sample_SetInterpolation(g_Config.audio.sample_interpolation);
+    }
 
     if (CHANGED(window.is_fullscreen) || CHANGED(window.is_maximized)
         || CHANGED(window.x) || CHANGED(window.y) || CHANGED(window.width)
@@ -340,6 +349,7 @@ void Shell_Main(void)
     Text_Init();
     UI_Init();
     Console_Init();
+    FrameStats_Init();
 
     Input_Init();
     Sound_Init();
@@ -374,8 +384,12 @@ void Shell_Main(void)
     InitialiseStartInfo();
     S_FrontEndCheck();
 
-    GameBuf_Init(GAMEBUF_MEM_CAP);
-    M_DisplayLegal();
+    GameBuf_Init(GAMEBUF_CHUNK_SIZE);
+    Scratch_Init();
+    Jobs_Init();
+    if (!Headless_IsEnabled()) {
+        M_DisplayLegal();
+    }
 
     const bool is_frontend_fail = GF_DoFrontendSequence();
     if (g_IsGameToExit) {
@@ -390,6 +404,12 @@ void Shell_Main(void)
 
     GAME_FLOW_COMMAND gf_cmd =
         GF_TranslateScriptCommand(g_GameFlow.first_option);
+    if (Headless_IsEnabled()) {
+        gf_cmd = (GAME_FLOW_COMMAND) {
+            .action = GF_START_DEMO,
+            .param = Headless_GetDemoNum(),
+        };
+    }
     bool is_loop_continued = true;
     while (is_loop_continued) {
         switch (gf_cmd.action) {
@@ -438,7 +458,9 @@ void Shell_Main(void)
             break;
 
         case GF_EXIT_TO_TITLE:
-            if (g_GameFlow.title_disabled) {
+            if (Headless_IsEnabled()) {
+                is_loop_continued = false;
+            } else if (g_GameFlow.title_disabled) {
                 gf_cmd = GF_TranslateScriptCommand(g_GameFlow.title_replace);
                 if (gf_cmd.action == GF_NOOP
                     || gf_cmd.action == GF_EXIT_TO_TITLE) {
@@ -462,11 +484,15 @@ void Shell_Main(void)
 
 void Shell_Shutdown(void)
 {
+    Headless_Shutdown();
     GameString_Shutdown();
+    FrameStats_Shutdown();
     Console_Shutdown();
     Render_Shutdown();
     Text_Shutdown();
     UI_Shutdown();
+    Jobs_Shutdown();
+    Scratch_Shutdown();
     GameBuf_Shutdown();
     Config_Shutdown();
 }
@@ -487,8 +513,10 @@ void Shell_Start(void)
     Render_Init();
     M_SyncToWindow();
 
-    SDL_ShowWindow(g_SDLWindow);
-    SDL_RaiseWindow(g_SDLWindow);
+    if (!Headless_IsEnabled()) {
+        SDL_ShowWindow(g_SDLWindow);
+        SDL_RaiseWindow(g_SDLWindow);
+    }
     M_RefreshRendererViewport();
 }
 
@@ -572,6 +600,8 @@ void Shell_ProcessEvents(void)
             break;
         }
     }
+
+    Audio_Stream_ProcessFinished();
 }
 
 SDL_Window *Shell_GetWindow(void)
@@ -6,6 +6,7 @@
 
 #include <libtrx/config.h>
 #include <libtrx/engine/audio.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/game/math.h>
 #include <libtrx/log.h>
 #include <libtrx/utils.h>
@@ -135,6 +136,12 @@ void Sound_Init(void)
         m_DecibelLUT[i] = (log2(1.0 / DECIBEL_LUT_SIZE) - log2(1.0 / i)) * 1000;
     }
 
+    if (Headless_IsEnabled()) {
+        // Leave the audio device closed, which turns all sample and stream
+        // calls into no-ops.
+        return;
+    }
+
     if (!Audio_Init()) {
         LOG_ERROR("Failed to initialize libtrx sound system");
         return;
@@ -39,7 +39,7 @@ int32_t g_PhdWinHeight;
 int32_t g_PhdWinCenterX;
 int32_t g_PhdWinCenterY;
 float g_FltWinTop;
-SORT_ITEM g_SortBuffer[4000];
+SORT_ITEM g_SortBuffer[MAX_SORT_ITEMS];
 float g_FltWinLeft;
 int32_t g_PhdFarZ;
 float g_FltRhwOPersp;
@@ -63,7 +63,7 @@ int32_t g_PhdWinWidth;
 int32_t g_PhdViewDistance;
 DEPTHQ_ENTRY g_DepthQTable[32];
 int32_t g_LsDivider;
-PHD_VBUF g_PhdVBuf[1500];
+PHD_VBUF g_PhdVBuf[MAX_PHD_VBUF];
 uint8_t *g_TexturePageBuffer8[MAX_TEXTURE_PAGES] = {};
 float g_FltWinRight;
 XYZ_32 g_LsVectorView;
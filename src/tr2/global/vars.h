@@ -60,7 +60,7 @@ extern int32_t g_PhdWinWidth;
 extern int32_t g_PhdViewDistance;
 extern DEPTHQ_ENTRY g_DepthQTable[32];
 extern int32_t g_LsDivider;
-extern PHD_VBUF g_PhdVBuf[];
+extern PHD_VBUF g_PhdVBuf[MAX_PHD_VBUF];
 extern uint8_t *g_TexturePageBuffer8[MAX_TEXTURE_PAGES];
 extern float g_FltWinRight;
 extern XYZ_32 g_LsVectorView;
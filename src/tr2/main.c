@@ -3,12 +3,14 @@
 #include "global/vars.h"
 
 #include <libtrx/filesystem.h>
+#include <libtrx/game/headless.h>
 #include <libtrx/log.h>
 
 int main(int argc, char **argv)
 {
     Log_Init(File_GetFullPath("TR2X.log"));
     g_IsGameToExit = false;
+    Headless_ParseArgs(argc, argv);
     Shell_Setup();
     Shell_Main();
     Shell_Shutdown();